@@ -0,0 +1,96 @@
+// Module allowlist path matching: throughput and allocations per lookup.
+// Usage: allowlist_bench [repetitions]
+
+#include "module_allowlist.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* block = malloc(size ? size : 1);
+    if (!block) {
+        abort();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+using namespace ProcessScope;
+
+// Module paths spread over trusted and untrusted locations, like a sweep's module lists
+static std::vector<std::string> BuildPaths(size_t count) {
+    static const char* const kPrefixes[] = {
+        "C:\\Windows\\System32\\",
+        "C:\\Program Files\\Common Files\\",
+        "C:\\Users\\alice\\AppData\\Local\\App17\\",
+        "C:\\Users\\alice\\AppData\\Local\\Temp\\",
+        "D:\\Vendors\\vendor123\\bin\\",
+        "C:\\ProgramData\\Agent\\",
+        "E:\\build\\out\\"
+    };
+    const size_t prefixCount = sizeof(kPrefixes) / sizeof(kPrefixes[0]);
+
+    std::mt19937 random(1);
+    std::vector<std::string> paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        paths.push_back(std::string(kPrefixes[random() % prefixCount]) + "module" + std::to_string(random() % 100000) + ".dll");
+    }
+    return paths;
+}
+
+static void Run(const char* name, const ModuleAllowlist& allowlist, const std::vector<std::string>& paths, int repetitions) {
+    size_t matched = 0;
+    size_t allocations = g_allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        for (const auto& path : paths) {
+            matched += allowlist.MatchesPath(path) ? 1 : 0;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    allocations = g_allocations - allocations;
+
+    double lookups = static_cast<double>(paths.size()) * repetitions;
+    printf("%-28s %10.0f lookups  %8.3f s  %6.2f M/s  %zu matched  %zu allocations\n",
+           name, lookups, seconds, lookups / (std::max)(seconds, 1e-9) / 1e6, matched, allocations);
+}
+
+int main(int argc, char* argv[]) {
+    int repetitions = argc > 1 ? (std::max)(1, atoi(argv[1])) : 50;
+    std::vector<std::string> paths = BuildPaths(100000);
+
+    Run("built-in rules", ModuleAllowlist::BuiltIn(), paths, repetitions);
+
+    // The built-ins plus 200 vendor directories and 50 per-user globs
+    ModuleAllowlist large;
+    std::string error;
+    large.AddRule("path %SystemRoot%\\System32\\", error);
+    large.AddRule("path %SystemRoot%\\SysWOW64\\", error);
+    large.AddRule("path %ProgramFiles%\\", error);
+    large.AddRule("path %ProgramFiles(x86)%\\", error);
+    large.AddRule("path %ProgramData%\\", error);
+    for (int i = 0; i < 200; i++) {
+        large.AddRule("path D:\\Vendors\\vendor" + std::to_string(i) + "\\bin\\", error);
+    }
+    for (int i = 0; i < 50; i++) {
+        large.AddRule("glob C:\\Users\\*\\AppData\\Local\\App" + std::to_string(i) + "\\*.dll", error);
+    }
+    large.Compile();
+    Run("255 path and glob rules", large, paths, repetitions);
+    return 0;
+}
@@ -0,0 +1,418 @@
+#include "baseline_store.h"
+#include "module_allowlist.h"
+#include "scan_backend.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace ProcessScope {
+
+    static const char kBaselineMagic[8] = { 'P', 'S', 'B', 'A', 'S', 'E', '0', '1' };
+    static const DWORD kBaselineVersion = 1;
+
+    // Features kept per image and kind; past this, new modules are no longer learned for it
+    static const size_t kMaxFeaturesPerImage = 4096;
+
+    static const ULONGLONG kFnvOffset = 0xCBF29CE484222325ULL;
+    static const ULONGLONG kFnvPrime = 0x100000001B3ULL;
+
+    struct BaselineHeader {
+        char magic[8];
+        DWORD version;
+        DWORD slotCount;
+        DWORD imageCount;
+        DWORD reserved;
+        ULONGLONG imagesOffset;
+        ULONGLONG featuresOffset;
+        ULONGLONG stringsOffset;
+        ULONGLONG fileSize;
+    };
+
+    struct BaselineImageRecord {
+        ULONGLONG key;              // 0 = empty slot
+        DWORD observations;
+        DWORD pathOffset;           // Relative to the strings section
+        ULONGLONG modulesOffset;
+        ULONGLONG startsOffset;
+        DWORD moduleSlots;
+        DWORD startSlots;
+        double sums[kBaselineCounters];
+        double squares[kBaselineCounters];
+    };
+
+    struct BaselineFeatureRecord {
+        ULONGLONG hash;             // 0 = empty slot
+        DWORD seen;
+        DWORD reserved;
+    };
+
+    static ULONGLONG FnvAppend(const void* data, size_t size, ULONGLONG hash) {
+        const BYTE* bytes = static_cast<const BYTE*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * kFnvPrime;
+        }
+        return hash;
+    }
+
+    static DWORD TableSlots(size_t entries) {
+        DWORD slots = 4;
+        while (slots < entries * 2) {
+            slots <<= 1;
+        }
+        return slots;
+    }
+
+    static std::string ModuleNameOf(const std::string& startSymbol) {
+        return startSymbol.substr(0, startSymbol.find_first_of("!+"));
+    }
+
+    ULONGLONG BaselineHash(const std::string& text) {
+        ULONGLONG hash = kFnvOffset;
+        for (char c : text) {
+            BYTE lower = static_cast<BYTE>(tolower(static_cast<unsigned char>(c)));
+            hash = (hash ^ lower) * kFnvPrime;
+        }
+        return hash != 0 ? hash : 1;
+    }
+
+    BaselineObservation BaselineObservation::FromScan(const std::vector<ModuleInfo>& modules, const std::vector<ThreadInfo>& threads,
+                                                      const std::vector<MemoryRegion>& regions) {
+        BaselineObservation observation;
+        for (const auto& module : modules) {
+            observation.modules.push_back(BaselineHash(module.fullPath));
+        }
+
+        ThreadEnumerator enumerator;
+        for (const auto& thread : threads) {
+            if (!thread.startSymbol.empty()) {
+                observation.startModules.push_back(BaselineHash(ModuleNameOf(thread.startSymbol)));
+            }
+            if (thread.startAddress != 0 && !enumerator.IsStartAddressInModule(thread.startAddress, modules)) {
+                observation.counters[static_cast<size_t>(BaselineCounter::AnomalousThreads)]++;
+            }
+        }
+
+        // Same region classes as RiskScorer::ScoreSuspiciousMemory and ScoreModifiedImageCode
+        for (const auto& region : regions) {
+            if (region.isSuspicious) {
+                if (region.protection.find("RWX") != std::string::npos) {
+                    observation.counters[static_cast<size_t>(BaselineCounter::RwxRegions)]++;
+                } else if (region.isExecutable && region.type == "PRIVATE") {
+                    observation.counters[static_cast<size_t>(BaselineCounter::ExecutablePrivateRegions)]++;
+                }
+            }
+            if (region.isImage && region.isExecutable && region.pages.privatePages > 0) {
+                observation.counters[static_cast<size_t>(BaselineCounter::ModifiedImageRegions)]++;
+            }
+        }
+        return observation;
+    }
+
+    DWORD ImageBaseline::Observations() const {
+        return record_ ? record_->observations : 0;
+    }
+
+    bool ImageBaseline::HasFeature(ULONGLONG offset, DWORD slots, ULONGLONG hash) const {
+        const BaselineHeader* header = reinterpret_cast<const BaselineHeader*>(base_);
+        if (slots == 0 || offset + static_cast<ULONGLONG>(slots) * sizeof(BaselineFeatureRecord) > header->fileSize) {
+            return false;
+        }
+        const BaselineFeatureRecord* table = reinterpret_cast<const BaselineFeatureRecord*>(base_ + offset);
+        for (DWORD probe = 0, slot = static_cast<DWORD>(hash) & (slots - 1); probe < slots; probe++, slot = (slot + 1) & (slots - 1)) {
+            if (table[slot].hash == hash) {
+                return true;
+            }
+            if (table[slot].hash == 0) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool ImageBaseline::HasModule(ULONGLONG pathHash) const {
+        return record_ && HasFeature(record_->modulesOffset, record_->moduleSlots, pathHash);
+    }
+
+    bool ImageBaseline::HasStartModule(ULONGLONG nameHash) const {
+        return record_ && HasFeature(record_->startsOffset, record_->startSlots, nameHash);
+    }
+
+    size_t ImageBaseline::TypicalCount(BaselineCounter counter) const {
+        if (!record_ || record_->observations == 0) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(counter);
+        double n = record_->observations;
+        double mean = record_->sums[index] / n;
+        double variance = (std::max)(0.0, record_->squares[index] / n - mean * mean);
+        return static_cast<size_t>(std::floor(mean + 2 * std::sqrt(variance) + 1e-9));
+    }
+
+    bool BaselineStore::Open(const std::string& path, std::string& error) {
+        file_.Close();
+        pending_.clear();
+        learned_ = 0;
+        path_ = path;
+
+        if (!FileExists(path)) {
+            return true;
+        }
+        if (!file_.Open(path)) {
+            error = "Failed to open baseline store " + path + ": " + GetLastErrorString();
+            path_.clear();
+            return false;
+        }
+
+        const BaselineHeader* header = reinterpret_cast<const BaselineHeader*>(file_.data());
+        bool valid = file_.size() >= sizeof(BaselineHeader) &&
+                     memcmp(header->magic, kBaselineMagic, sizeof(kBaselineMagic)) == 0 &&
+                     header->version == kBaselineVersion && header->fileSize == file_.size() &&
+                     header->slotCount != 0 && (header->slotCount & (header->slotCount - 1)) == 0 &&
+                     header->imagesOffset + static_cast<ULONGLONG>(header->slotCount) * sizeof(BaselineImageRecord) <= header->featuresOffset &&
+                     header->featuresOffset <= header->stringsOffset && header->stringsOffset <= header->fileSize;
+        if (!valid) {
+            error = path + " is not a baseline store";
+            file_.Close();
+            path_.clear();
+            return false;
+        }
+        return true;
+    }
+
+    size_t BaselineStore::ImageCount() const {
+        return file_ ? reinterpret_cast<const BaselineHeader*>(file_.data())->imageCount : 0;
+    }
+
+    ULONGLONG BaselineStore::ImageKey(const ProcessInfo& process, ImageSource& images) {
+        const std::string& path = process.fullPath.empty() ? process.name : process.fullPath;
+        ULONGLONG key = BaselineHash(path);
+        ImageDigest digest;
+        ImageAttributes attributes;
+        if (images.GetDigest(path, digest)) {
+            key = FnvAppend(digest.bytes, sizeof(digest.bytes), key);
+        } else if (images.GetAttributes(path, attributes)) {
+            // Unreadable image: size and last write time are the closest stand-in for its contents.
+            // Hashed as the size high and low words, then the FILETIME, so existing keys still match.
+            DWORD words[4] = {
+                static_cast<DWORD>(attributes.fileSize >> 32), static_cast<DWORD>(attributes.fileSize),
+                static_cast<DWORD>(attributes.lastWriteTime), static_cast<DWORD>(attributes.lastWriteTime >> 32)
+            };
+            key = FnvAppend(words, sizeof(words), key);
+        }
+        return key != 0 ? key : 1;
+    }
+
+    const BaselineImageRecord* BaselineStore::FindRecord(ULONGLONG key) const {
+        if (!file_) {
+            return nullptr;
+        }
+        const BaselineHeader* header = reinterpret_cast<const BaselineHeader*>(file_.data());
+        const BaselineImageRecord* table = reinterpret_cast<const BaselineImageRecord*>(file_.data() + header->imagesOffset);
+        DWORD mask = header->slotCount - 1;
+        for (DWORD probe = 0, slot = static_cast<DWORD>(key) & mask; probe <= mask; probe++, slot = (slot + 1) & mask) {
+            if (table[slot].key == key) {
+                return &table[slot];
+            }
+            if (table[slot].key == 0) {
+                break;
+            }
+        }
+        return nullptr;
+    }
+
+    ImageBaseline BaselineStore::Find(ULONGLONG imageKey) const {
+        const BaselineImageRecord* record = FindRecord(imageKey);
+        return record ? ImageBaseline(record, file_.data()) : ImageBaseline();
+    }
+
+    void BaselineStore::Learn(ULONGLONG imageKey, const std::string& imagePath, const BaselineObservation& observation) {
+        Profile& profile = pending_[imageKey];
+        profile.imagePath = imagePath;
+        profile.observations++;
+        for (ULONGLONG module : observation.modules) {
+            profile.modules[module] = 1;
+        }
+        for (ULONGLONG module : observation.startModules) {
+            profile.startModules[module] = 1;
+        }
+        for (size_t i = 0; i < kBaselineCounters; i++) {
+            profile.sums[i] += observation.counters[i];
+            profile.squares[i] += observation.counters[i] * observation.counters[i];
+        }
+        learned_++;
+    }
+
+    void BaselineStore::LoadProfiles(std::unordered_map<ULONGLONG, Profile>& profiles) const {
+        if (!file_) {
+            return;
+        }
+        const BYTE* base = file_.data();
+        const BaselineHeader* header = reinterpret_cast<const BaselineHeader*>(base);
+        const BaselineImageRecord* table = reinterpret_cast<const BaselineImageRecord*>(base + header->imagesOffset);
+
+        auto loadFeatures = [&](ULONGLONG offset, DWORD slots, std::unordered_map<ULONGLONG, DWORD>& features) {
+            if (offset + static_cast<ULONGLONG>(slots) * sizeof(BaselineFeatureRecord) > header->fileSize) {
+                return;
+            }
+            const BaselineFeatureRecord* records = reinterpret_cast<const BaselineFeatureRecord*>(base + offset);
+            for (DWORD i = 0; i < slots; i++) {
+                if (records[i].hash != 0) {
+                    features[records[i].hash] = records[i].seen;
+                }
+            }
+        };
+
+        for (DWORD slot = 0; slot < header->slotCount; slot++) {
+            const BaselineImageRecord& record = table[slot];
+            if (record.key == 0) {
+                continue;
+            }
+            Profile& profile = profiles[record.key];
+            profile.observations = record.observations;
+            memcpy(profile.sums, record.sums, sizeof(profile.sums));
+            memcpy(profile.squares, record.squares, sizeof(profile.squares));
+            ULONGLONG pathOffset = header->stringsOffset + record.pathOffset;
+            if (pathOffset + sizeof(DWORD) <= header->fileSize) {
+                DWORD length;
+                memcpy(&length, base + pathOffset, sizeof(length));
+                if (pathOffset + sizeof(DWORD) + length <= header->fileSize) {
+                    profile.imagePath.assign(reinterpret_cast<const char*>(base + pathOffset + sizeof(DWORD)), length);
+                }
+            }
+            loadFeatures(record.modulesOffset, record.moduleSlots, profile.modules);
+            loadFeatures(record.startsOffset, record.startSlots, profile.startModules);
+        }
+    }
+
+    bool BaselineStore::Save(BaselineSaveStats& stats, std::string& error) {
+        stats = BaselineSaveStats();
+        if (path_.empty()) {
+            error = "Baseline store is not open";
+            return false;
+        }
+
+        std::unordered_map<ULONGLONG, Profile> profiles;
+        LoadProfiles(profiles);
+
+        auto mergeFeatures = [](std::unordered_map<ULONGLONG, DWORD>& into, const std::unordered_map<ULONGLONG, DWORD>& from) {
+            for (const auto& feature : from) {
+                auto existing = into.find(feature.first);
+                if (existing != into.end()) {
+                    existing->second += feature.second;
+                } else if (into.size() < kMaxFeaturesPerImage) {
+                    into.insert(feature);
+                }
+            }
+        };
+        for (const auto& entry : pending_) {
+            Profile& profile = profiles[entry.first];
+            const Profile& learned = entry.second;
+            profile.imagePath = learned.imagePath;
+            profile.observations += learned.observations;
+            mergeFeatures(profile.modules, learned.modules);
+            mergeFeatures(profile.startModules, learned.startModules);
+            for (size_t i = 0; i < kBaselineCounters; i++) {
+                profile.sums[i] += learned.sums[i];
+                profile.squares[i] += learned.squares[i];
+            }
+        }
+
+        BaselineHeader header = {};
+        memcpy(header.magic, kBaselineMagic, sizeof(kBaselineMagic));
+        header.version = kBaselineVersion;
+        header.slotCount = TableSlots((std::max)(profiles.size(), static_cast<size_t>(8)));
+        header.imageCount = static_cast<DWORD>(profiles.size());
+        header.imagesOffset = sizeof(BaselineHeader);
+        header.featuresOffset = header.imagesOffset + static_cast<ULONGLONG>(header.slotCount) * sizeof(BaselineImageRecord);
+
+        std::vector<BaselineImageRecord> images(header.slotCount);
+        memset(images.data(), 0, images.size() * sizeof(BaselineImageRecord));
+        std::vector<BaselineFeatureRecord> features;
+        std::vector<BYTE> strings;
+
+        auto writeFeatures = [&](const std::unordered_map<ULONGLONG, DWORD>& source, ULONGLONG& offset, DWORD& slots) {
+            if (source.empty()) {
+                offset = header.featuresOffset;
+                slots = 0;
+                return;
+            }
+            slots = TableSlots(source.size());
+            size_t first = features.size();
+            features.resize(first + slots);
+            memset(features.data() + first, 0, slots * sizeof(BaselineFeatureRecord));
+            offset = header.featuresOffset + first * sizeof(BaselineFeatureRecord);
+            for (const auto& feature : source) {
+                DWORD slot = static_cast<DWORD>(feature.first) & (slots - 1);
+                while (features[first + slot].hash != 0) {
+                    slot = (slot + 1) & (slots - 1);
+                }
+                features[first + slot].hash = feature.first;
+                features[first + slot].seen = feature.second;
+            }
+        };
+
+        DWORD mask = header.slotCount - 1;
+        for (const auto& entry : profiles) {
+            DWORD slot = static_cast<DWORD>(entry.first) & mask;
+            while (images[slot].key != 0) {
+                slot = (slot + 1) & mask;
+            }
+            BaselineImageRecord& record = images[slot];
+            const Profile& profile = entry.second;
+            record.key = entry.first;
+            record.observations = profile.observations;
+            record.pathOffset = static_cast<DWORD>(strings.size());
+            DWORD length = static_cast<DWORD>(profile.imagePath.size());
+            strings.insert(strings.end(), reinterpret_cast<const BYTE*>(&length), reinterpret_cast<const BYTE*>(&length) + sizeof(length));
+            strings.insert(strings.end(), profile.imagePath.begin(), profile.imagePath.end());
+            memcpy(record.sums, profile.sums, sizeof(record.sums));
+            memcpy(record.squares, profile.squares, sizeof(record.squares));
+            writeFeatures(profile.modules, record.modulesOffset, record.moduleSlots);
+            writeFeatures(profile.startModules, record.startsOffset, record.startSlots);
+        }
+
+        header.stringsOffset = header.featuresOffset + features.size() * sizeof(BaselineFeatureRecord);
+        header.fileSize = header.stringsOffset + strings.size();
+
+        // The mapping would keep the old file from being replaced
+        file_.Close();
+
+        std::string temporaryPath = path_ + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                error = "Failed to create " + temporaryPath;
+                file_.Open(path_);
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(images.data()), images.size() * sizeof(BaselineImageRecord));
+            file.write(reinterpret_cast<const char*>(features.data()), features.size() * sizeof(BaselineFeatureRecord));
+            file.write(reinterpret_cast<const char*>(strings.data()), strings.size());
+            if (!file) {
+                error = "Failed to write " + temporaryPath;
+                file_.Open(path_);
+                return false;
+            }
+        }
+
+        if (!RenameFileOver(temporaryPath, path_)) {
+            error = "Failed to replace " + path_ + ": " + GetLastErrorString();
+            RemoveFile(temporaryPath);
+            file_.Open(path_);
+            return false;
+        }
+
+        stats.images = profiles.size();
+        stats.learned = learned_;
+        stats.fileBytes = header.fileSize;
+        pending_.clear();
+        learned_ = 0;
+        if (!file_.Open(path_)) {
+            error = "Failed to reopen " + path_ + ": " + GetLastErrorString();
+            return false;
+        }
+        return true;
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include "module_enum.h"
+#include "thread_enum.h"
+#include "memory_scan.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    class ImageSource;
+
+    // Per-process counts learned for each image; risk factors up to the learned typical count are
+    // treated as normal for that image
+    enum class BaselineCounter { RwxRegions, ExecutablePrivateRegions, ModifiedImageRegions, AnomalousThreads, Count };
+
+    const size_t kBaselineCounters = static_cast<size_t>(BaselineCounter::Count);
+
+    // Observations of an image before its baseline is used for scoring
+    const DWORD kBaselineMinObservations = 3;
+
+    // Lowercased FNV-1a, used for image keys and module paths
+    ULONGLONG BaselineHash(const std::string& text);
+
+    // What one scan contributes to its image's baseline
+    struct BaselineObservation {
+        std::vector<ULONGLONG> modules;         // Hashes of lowercased module paths
+        std::vector<ULONGLONG> startModules;    // Hashes of lowercased module names that threads start in
+        double counters[kBaselineCounters];
+
+        BaselineObservation() : counters() {}
+
+        static BaselineObservation FromScan(const std::vector<ModuleInfo>& modules, const std::vector<ThreadInfo>& threads,
+                                            const std::vector<MemoryRegion>& regions);
+    };
+
+    struct BaselineImageRecord;
+    struct BaselineFeatureRecord;
+
+    // Read-only view of one image's learned profile inside a mapped store. Empty when the image
+    // is unknown; stays valid until the store is saved or closed.
+    class ImageBaseline {
+    private:
+        const BaselineImageRecord* record_;
+        const BYTE* base_;
+
+        bool HasFeature(ULONGLONG offset, DWORD slots, ULONGLONG hash) const;
+
+    public:
+        ImageBaseline() : record_(nullptr), base_(nullptr) {}
+        ImageBaseline(const BaselineImageRecord* record, const BYTE* base) : record_(record), base_(base) {}
+
+        DWORD Observations() const;
+        bool IsEstablished() const { return Observations() >= kBaselineMinObservations; }
+        bool HasModule(ULONGLONG pathHash) const;
+        bool HasStartModule(ULONGLONG nameHash) const;
+
+        // Mean plus two standard deviations of the per-process count, rounded down
+        size_t TypicalCount(BaselineCounter counter) const;
+    };
+
+    struct BaselineSaveStats {
+        size_t images;
+        size_t learned;         // Observations added since the store was opened
+        ULONGLONG fileBytes;
+
+        BaselineSaveStats() : images(0), learned(0), fileBytes(0) {}
+    };
+
+    // Learned per-image profiles in one file that is mapped read-only while scoring.
+    // File layout (little-endian):
+    //   [header]   magic "PSBASE01", version, slot count (a power of two), image count, section offsets
+    //   [images]   open-addressed table of image records keyed by image key (0 = empty slot):
+    //              observation count, path, counter sums and sums of squares, and the offset and slot
+    //              count of the image's module and thread start module tables
+    //   [features] open-addressed tables of (hash, times seen), one per image and feature kind
+    //   [strings]  uint32 length + bytes
+    // Each lookup is a hash probe, so scoring a process costs O(1) per module and per counter.
+    // New observations are kept in memory and merged into a rewritten file by Save, which writes
+    // beside the old file and renames over it.
+    class BaselineStore {
+    private:
+        struct Profile {
+            std::string imagePath;
+            DWORD observations;
+            std::unordered_map<ULONGLONG, DWORD> modules;
+            std::unordered_map<ULONGLONG, DWORD> startModules;
+            double sums[kBaselineCounters];
+            double squares[kBaselineCounters];
+
+            Profile() : observations(0), sums(), squares() {}
+        };
+
+        MappedFile file_;
+        std::string path_;
+        std::unordered_map<ULONGLONG, Profile> pending_;
+        size_t learned_;
+
+        const BaselineImageRecord* FindRecord(ULONGLONG key) const;
+        void LoadProfiles(std::unordered_map<ULONGLONG, Profile>& profiles) const;
+
+    public:
+        BaselineStore() : learned_(0) {}
+        BaselineStore(const BaselineStore&) = delete;
+        BaselineStore& operator=(const BaselineStore&) = delete;
+
+        // A missing file is an empty store, created on the first Save
+        bool Open(const std::string& path, std::string& error);
+        bool IsOpen() const { return !path_.empty(); }
+        size_t ImageCount() const;
+
+        // Image path plus the SHA-256 of the file, so a replaced binary starts a new baseline. Falls
+        // back to the file's size and last write time when the file cannot be read.
+        static ULONGLONG ImageKey(const ProcessInfo& process, ImageSource& images);
+
+        ImageBaseline Find(ULONGLONG imageKey) const;
+
+        // Queues an observation; Find keeps returning the profile as of Open until Save
+        void Learn(ULONGLONG imageKey, const std::string& imagePath, const BaselineObservation& observation);
+
+        bool Save(BaselineSaveStats& stats, std::string& error);
+    };
+
+} // namespace ProcessScope
@@ -1,29 +1,110 @@
 #include "cli.h"
-#include "json.hpp"
+#include "report.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
-#include <fstream>
-#include <cstdlib>
-
-using json = nlohmann::json;
+#include <sstream>
 
 namespace ProcessScope {
 
+    // Default per-process budget for --scan-all when --timeout is not given
+    static const DWORD kDefaultSweepTimeoutMs = 30000;
+
+    // Where scan reports are exported, and the inverted index over them
+    static const char kReportsDirectory[] = "./reports";
+    static const char kReportIndexFile[] = "./reports/reports.idx";
+
+    // How far back --prioritize looks for earlier Medium and High reports
+    static const char kPriorRiskWindow[] = "7d";
+
+    // Sweep-wide cancellation, signalled by Ctrl+C so in-flight scans return partial results
+    static CancellationToken g_sweepCancellation;
+
+    static BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType) {
+        if (ctrlType == CTRL_C_EVENT || ctrlType == CTRL_BREAK_EVENT) {
+            g_sweepCancellation.Cancel();
+            return TRUE;
+        }
+        return FALSE;
+    }
+
     int CLI::Run(int argc, char* argv[]) {
         if (argc < 2) {
             std::cout << "ProcessScope - Windows Process & Memory Inspection Toolkit\n";
             std::cout << "Usage:\n";
             std::cout << "  ProcessScope.exe --list                    List running processes\n";
+            std::cout << "  ProcessScope.exe --tree                    Show the process tree\n";
             std::cout << "  ProcessScope.exe --scan <pid>              Scan a specific process\n";
             std::cout << "  ProcessScope.exe --scan-all                Scan all accessible processes\n";
+            std::cout << "  ProcessScope.exe --daemon                  Serve scan requests on a local named pipe\n";
+            std::cout << "  ProcessScope.exe --watch                   Scan new processes as they start\n";
+            std::cout << "  ProcessScope.exe --index                   Index new and changed reports in ./reports\n";
+            std::cout << "  ProcessScope.exe --query <expr>            Search the report history, e.g.\n";
+            std::cout << "                                             \"unsigned:*\\evil.dll risk:high since:7d\"\n";
+            std::cout << "Options:\n";
+            std::cout << "  --filter <expr>                            Only list/scan matching processes, e.g.\n";
+            std::cout << "                                             \"session==1 && path~'C:\\Program Files\\*'\"\n";
+            std::cout << "  --triage <score>                           --scan-all: cheap tier-1 pass for every process,\n";
+            std::cout << "                                             full scan only when the tier-1 score >= <score>\n";
+            std::cout << "  --timeout <ms>                             Per-process scan budget (0 = unlimited,\n";
+            std::cout << "                                             default " << kDefaultSweepTimeoutMs << " for --scan-all)\n";
+            std::cout << "  --sample <MB>                              --scan/--scan-all: sample page contents of the whole\n";
+            std::cout << "                                             address space within <MB> per process\n";
+            std::cout << "  --strings <n>                              --scan/--scan-all: report the top <n> ASCII/UTF-16\n";
+            std::cout << "                                             strings in flagged regions\n";
+            std::cout << "  --thread-samples <n>                       --scan/--scan-all: sample where each running thread\n";
+            std::cout << "                                             executes <n> times and flag unbacked code\n";
+            std::cout << "  --thread-interval <ms>                     Wait between thread samples (default "
+                      << kDefaultThreadSampleIntervalMs << ")\n";
+            std::cout << "  --baseline <file>                          --scan/--scan-all: score against per-image baselines\n";
+            std::cout << "                                             learned in <file> and update them\n";
+            std::cout << "  --allowlist <file>                         --scan/--scan-all: trust the modules matched by the\n";
+            std::cout << "                                             rules in <file> instead of the built-in locations\n";
+            std::cout << "  --dump <file>                              Store suspicious regions of High-risk processes\n";
+            std::cout << "                                             in a deduplicated evidence archive\n";
+            std::cout << "  --similar <file>                           --scan-all: report regions similar to a corpus of\n";
+            std::cout << "                                             known-bad digests (\"<digest> [label]\" per line)\n";
+            std::cout << "  --max-distance <n>                         Similarity distance threshold (default " << kDefaultSimilarityThreshold << ")\n";
+            std::cout << "  --record <file>                            --scan/--scan-all: save everything read from the host\n";
+            std::cout << "                                             as a replayable snapshot\n";
+            std::cout << "  --replay <file>                            --scan/--scan-all: scan a recorded snapshot instead\n";
+            std::cout << "                                             of the live host\n";
+            std::cout << "  --pipe <name>                              --daemon: pipe name (default ProcessScope)\n";
+            std::cout << "  --isolate                                  --scan-all: scan in worker processes; a worker that\n";
+            std::cout << "                                             crashes or hangs is restarted and its target skipped\n";
+            std::cout << "  --prioritize                               --scan-all: scan likely findings first, using earlier\n";
+            std::cout << "                                             reports and tier-zero image and age checks\n";
+            std::cout << "  --partition                                --scan-all: interleave sessions and total risk per session\n";
+            std::cout << "  --partition-budget <ms>                    --scan-all: scan time per session; the rest of a\n";
+            std::cout << "                                             session is skipped once it is spent\n";
+            std::cout << "  --partition-concurrency <n>                --isolate: concurrent scans per session (0 = unlimited)\n";
+            std::cout << "  --workers <n>                              --daemon: concurrent clients, --watch/--isolate:\n";
+            std::cout << "                                             concurrent scans (default 4)\n";
+            std::cout << "  --poll <ms>                                --watch: snapshot/flush interval (default "
+                      << WatchOptions().pollIntervalMs << ")\n";
+            std::cout << "  --no-etw                                   --watch: use snapshot polling even when elevated\n";
+            std::cout << "  --metrics <file>                           --scan-all/--daemon/--watch: write Prometheus metrics\n";
+            std::cout << "                                             to <file> every interval\n";
+            std::cout << "  --metrics-port <port>                      Serve Prometheus metrics on http://127.0.0.1:<port>/metrics\n";
+            std::cout << "  --metrics-interval <ms>                    Metrics file interval (default "
+                      << MetricsExportOptions().intervalMs << ")\n";
             return 1;
         }
 
         std::string command = argv[1];
         
         if (command == "--list") {
+            if (!ParseOptions(argc, argv, 2)) {
+                return 1;
+            }
             PrintProcessList();
             return 0;
+        } else if (command == "--tree") {
+            if (!ParseOptions(argc, argv, 2)) {
+                return 1;
+            }
+            PrintProcessTree();
+            return 0;
         } else if (command == "--scan") {
             if (argc < 3) {
                 std::cerr << "Error: PID required for --scan command\n";
@@ -31,8 +112,14 @@ namespace ProcessScope {
             }
             
             DWORD pid = std::stoul(argv[2]);
-            ScanResult result = ScanProcess(pid);
+            if (!ParseOptions(argc, argv, 3) || !SetUpBackend() || !OpenArchive() || !OpenBaselines()) {
+                return 1;
+            }
+            
+            ScanResult result = scanner_.ScanProcess(pid, GetScanOptions());
             PrintScanResult(result);
+            DumpEvidence(result);
+            LearnBaseline(result);
             
             if (result.success) {
                 std::string filename = GenerateJsonFilename(pid);
@@ -43,80 +130,683 @@ namespace ProcessScope {
                 }
             }
             
+            if (!CloseArchive() || !SaveBaselines() || !SaveRecording()) {
+                return 1;
+            }
             return result.success ? 0 : 1;
         } else if (command == "--scan-all") {
-            std::vector<ProcessInfo> processes = processEnumerator_.EnumerateProcesses();
-            int successCount = 0;
-            int totalCount = 0;
-            
-            for (const auto& process : processes) {
-                totalCount++;
-                std::cout << "Scanning PID " << process.pid << " (" << process.name << ")...\n";
-                
-                ScanResult result = ScanProcess(process.pid);
-                if (result.success) {
-                    successCount++;
-                    std::string filename = GenerateJsonFilename(process.pid);
-                    ExportToJson(result, filename);
-                }
+            if (!ParseOptions(argc, argv, 2) || !SetUpBackend() || !OpenArchive() || !OpenBaselines()) {
+                return 1;
             }
-            
-            std::cout << "\nScan completed: " << successCount << "/" << totalCount << " processes scanned successfully\n";
-            return 0;
+            int exitCode = RunSweep();
+            return SaveRecording() ? exitCode : 1;
+        } else if (command == "--daemon") {
+            if (!ParseOptions(argc, argv, 2)) {
+                return 1;
+            }
+            return RunDaemon();
+        } else if (command == "--watch") {
+            if (!ParseOptions(argc, argv, 2) || !OpenArchive()) {
+                return 1;
+            }
+            return RunWatch();
+        } else if (command == "--index") {
+            return UpdateReportIndex() ? 0 : 1;
+        } else if (command == "--query") {
+            if (argc < 3) {
+                std::cerr << "Error: Query expression required for --query command\n";
+                return 1;
+            }
+            return RunQuery(argv[2]);
+        } else if (command == "--worker" && argc == 4) {
+            // Internal: started by SweepSupervisor with an inherited mapping handle and a slot
+            HANDLE mapping = reinterpret_cast<HANDLE>(static_cast<UINT_PTR>(std::stoull(argv[2])));
+            return RunSweepWorker(mapping, std::stoul(argv[3]));
         } else {
             std::cerr << "Error: Unknown command '" << command << "'\n";
             return 1;
         }
     }
 
-    ScanResult CLI::ScanProcess(DWORD pid) {
-        ScanResult result;
+    ScanOptions CLI::GetScanOptions() const {
+        ScanOptions scanOptions;
+        scanOptions.timeoutMs = options_.timeoutMs;
+        scanOptions.cancellation = &g_sweepCancellation;
+        scanOptions.sampling.byteBudget = options_.sampleBudget;
+        scanOptions.strings.maxStrings = options_.stringCount;
+        scanOptions.threadSampling = options_.threadSampling;
+        scanOptions.baselines = baselines_.IsOpen() ? &baselines_ : nullptr;
+        scanOptions.allowlist = options_.allowlistPath.empty() ? nullptr : &allowlist_;
+        return scanOptions;
+    }
+
+    int CLI::RunSweep() {
+        if (!options_.timeoutSet) {
+            options_.timeoutMs = kDefaultSweepTimeoutMs;
+        }
+        if (options_.isolate && (options_.triageEnabled || !options_.recordPath.empty() || !options_.replayPath.empty())) {
+            std::cerr << "Error: --isolate cannot be combined with --triage, --record or --replay\n";
+            return 1;
+        }
         
-        // Get process information
-        result.processInfo = processEnumerator_.GetProcessInfo(pid);
-        if (result.processInfo.pid == 0) {
-            result.errorMessage = "Process not found or access denied";
-            return result;
+        // Load the corpus up front so a bad file fails before the sweep rather than after it
+        std::vector<SimilarityEntry> corpus;
+        if (!options_.similarCorpus.empty()) {
+            std::string error;
+            if (!LoadSimilarityCorpus(options_.similarCorpus, corpus, error)) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+        }
+        PriorRiskMap priorRisk;
+        if (options_.prioritize) {
+            LoadPriorRisk(priorRisk);
         }
+        SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
+        if (!StartMetrics()) {
+            return 1;
+        }
+        MetricsShard* metricsShard = metricsExporter_.IsRunning() ? metrics_.CreateShard() : nullptr;
+        scanner_.SetMetrics(metricsShard);
+        
+        SweepOptions sweepOptions;
+        sweepOptions.scan = GetScanOptions();
+        sweepOptions.filter = &filter_;
+        sweepOptions.triageEnabled = options_.triageEnabled;
+        sweepOptions.triageThreshold = options_.triageThreshold;
+        sweepOptions.partition = options_.partition;
+        sweepOptions.priority.enabled = options_.prioritize;
+        sweepOptions.priority.priorRisk = &priorRisk;
+        
+        FingerprintIndex fingerprints;
+        sweepOptions.fingerprints = &fingerprints;
+        SimilarityIndex similarity;
+        sweepOptions.similarity = &similarity;
         
-        // Open process handle
-        Handle hProcess(OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid));
-        if (!hProcess) {
-            result.errorMessage = "Failed to open process: " + GetLastErrorString();
-            return result;
+        SweepCallbacks callbacks;
+        callbacks.onProcessStart = [](const ProcessInfo& process) {
+            std::cout << "Scanning PID " << process.pid << " (" << process.name << ")...\n";
+        };
+        callbacks.onEscalate = [](const ProcessInfo&, const RiskAssessment& triage) {
+            std::cout << "  Tier-1 score " << triage.score << " (" << triage.details << ") escalating to full scan\n";
+        };
+        callbacks.onResult = [this](const ScanResult& result) {
+            if (!result.success) {
+                // Crashed and hung workers are worth seeing as they happen
+                if (options_.isolate && !result.accessDenied) {
+                    std::cout << "  " << result.errorMessage << "\n";
+                }
+                return;
+            }
+            if (result.truncated) {
+                std::cout << "  Scan budget exceeded during " << result.truncatedPhase
+                          << " phase, partial results kept\n";
+            }
+            ExportToJson(result, GenerateJsonFilename(result.processInfo.pid));
+            DumpEvidence(result);
+            LearnBaseline(result);
+        };
+        
+        SweepSupervisor supervisor;
+        SweepSummary summary;
+        if (options_.isolate) {
+            IsolatedSweepOptions isolatedOptions;
+            isolatedOptions.sweep = sweepOptions;
+            isolatedOptions.workerCount = options_.daemon.workerCount;
+            isolatedOptions.metrics = metricsShard;
+            summary = supervisor.Run(isolatedOptions, callbacks);
+        } else {
+            summary = scanner_.Sweep(sweepOptions, callbacks);
         }
         
-        try {
-            // Enumerate modules
-            result.modules = moduleEnumerator_.EnumerateModules(hProcess.get());
-            
-            // Enumerate threads
-            result.threads = threadEnumerator_.EnumerateThreads(pid);
-            
-            // Check for anomalous thread starts
-            for (auto& thread : result.threads) {
-                if (thread.startAddress != 0) {
-                    thread.anomalousStart = !threadEnumerator_.IsStartAddressInModule(thread.startAddress, result.modules);
+        if (summary.cancelled) {
+            std::cout << "Sweep cancelled\n";
+        }
+        PrintEnumerationStats(summary.enumeration);
+        std::cout << "\nScan completed: " << summary.successCount << "/" << summary.totalCount << " processes scanned successfully";
+        if (summary.truncatedCount > 0) {
+            std::cout << " (" << summary.truncatedCount << " truncated)";
+        }
+        std::cout << "\n";
+        std::cout << "Sweep time: " << static_cast<long long>(summary.elapsedMs) << " ms\n";
+        if (summary.firstHighMs >= 0) {
+            std::cout << "First High finding: PID " << summary.firstHighPid << " after "
+                      << static_cast<long long>(summary.firstHighMs) << " ms\n";
+        }
+        if (options_.triageEnabled) {
+            PrintTriageStats(summary.triage);
+        }
+        if (options_.isolate) {
+            PrintIsolationStats(supervisor.LastStats());
+        }
+        if (options_.partition.interleave) {
+            PrintPartitionStats(summary.partitions);
+        }
+        PrintClusters(fingerprints);
+        PrintCorpusMatches(similarity, corpus);
+        StopMetrics();
+        bool archiveClosed = CloseArchive();
+        return SaveBaselines() && archiveClosed ? 0 : 1;
+    }
+
+    bool CLI::SetUpBackend() {
+        if (!options_.replayPath.empty()) {
+            if (!options_.recordPath.empty() || !options_.dumpPath.empty()) {
+                std::cerr << "Error: --replay cannot be combined with --record or --dump\n";
+                return false;
+            }
+            std::string error;
+            if (!snapshot_.Load(options_.replayPath, error)) {
+                std::cerr << "Error: " << error << "\n";
+                return false;
+            }
+            backend_.reset(new ReplayBackend(snapshot_));
+            scanner_.SetBackend(backend_.get());
+        } else if (!options_.recordPath.empty()) {
+            backend_.reset(new RecordingBackend(scanner_.Backend(), snapshot_));
+            scanner_.SetBackend(backend_.get());
+        }
+        return true;
+    }
+
+    bool CLI::SaveRecording() {
+        if (options_.recordPath.empty()) {
+            return true;
+        }
+        
+        std::string error;
+        if (!snapshot_.Save(options_.recordPath, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        std::cout << "Snapshot of " << snapshot_.targets.size() << " processes recorded to: " << options_.recordPath << "\n";
+        return true;
+    }
+
+    bool CLI::OpenArchive() {
+        if (options_.dumpPath.empty()) {
+            return true;
+        }
+        
+        std::string error;
+        if (!archive_.Open(options_.dumpPath, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    void CLI::DumpEvidence(const ScanResult& result) {
+        if (!archive_.IsOpen() || !result.success || result.riskAssessment.level != RiskLevel::High) {
+            return;
+        }
+        
+        std::string error;
+        size_t pagesBefore = archive_.Stats().pages;
+        if (archive_.AddProcess(result, error)) {
+            std::cout << "  Dumped " << (archive_.Stats().pages - pagesBefore) << " pages of suspicious regions\n";
+        } else {
+            std::cout << "  Warning: evidence dump failed: " << error << "\n";
+        }
+    }
+
+    bool CLI::CloseArchive() {
+        if (!archive_.IsOpen()) {
+            return true;
+        }
+        
+        std::string error;
+        if (!archive_.Close(error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        
+        const DumpStats& stats = archive_.Stats();
+        std::cout << "Evidence archive " << options_.dumpPath << ": " << stats.processes << " processes, "
+                  << stats.regions << " regions, " << stats.pages << " pages (" << stats.zeroPages << " zero, "
+                  << stats.unreadablePages << " unreadable, " << stats.uniquePages << " unique), "
+                  << stats.bytesWritten << " bytes written\n";
+        return true;
+    }
+
+    bool CLI::OpenBaselines() {
+        if (options_.baselinePath.empty()) {
+            return true;
+        }
+        
+        std::string error;
+        if (!baselines_.Open(options_.baselinePath, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    void CLI::LearnBaseline(const ScanResult& result) {
+        // Truncated scans would understate what is typical; High-risk ones may be the compromise itself
+        if (!baselines_.IsOpen() || !result.success || result.truncated || result.riskAssessment.level == RiskLevel::High) {
+            return;
+        }
+        
+        const ProcessInfo& process = result.processInfo;
+        baselines_.Learn(BaselineStore::ImageKey(process, scanner_.Backend().Images()), process.fullPath.empty() ? process.name : process.fullPath,
+                         BaselineObservation::FromScan(result.modules, result.threads, result.memoryRegions));
+    }
+
+    bool CLI::SaveBaselines() {
+        if (!baselines_.IsOpen()) {
+            return true;
+        }
+        
+        std::string error;
+        BaselineSaveStats stats;
+        if (!baselines_.Save(stats, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        
+        std::cout << "Baseline store " << options_.baselinePath << ": " << stats.learned << " observations learned, "
+                  << stats.images << " images, " << stats.fileBytes << " bytes\n";
+        return true;
+    }
+
+    int CLI::RunDaemon() {
+        SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
+        if (!StartMetrics()) {
+            return 1;
+        }
+        options_.daemon.metrics = metricsExporter_.IsRunning() ? &metrics_ : nullptr;
+        
+        ScanDaemon daemon(options_.daemon);
+        std::string error;
+        if (!daemon.Start(error)) {
+            std::cerr << "Error: " << error << "\n";
+            StopMetrics();
+            return 1;
+        }
+        
+        std::cout << "Listening on " << WStringToString(daemon.PipePath()) << " with "
+                  << options_.daemon.workerCount << " workers (Ctrl+C to stop)\n";
+        while (!g_sweepCancellation.IsCancelled()) {
+            Sleep(200);
+        }
+        
+        std::cout << "Stopping daemon...\n";
+        daemon.Stop();
+        StopMetrics();
+        return 0;
+    }
+
+    int CLI::RunWatch() {
+        SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
+        if (!StartMetrics()) {
+            return 1;
+        }
+        
+        WatchOptions watchOptions;
+        watchOptions.scan = GetScanOptions();
+        watchOptions.filter = &filter_;
+        watchOptions.workerCount = options_.daemon.workerCount;
+        watchOptions.pollIntervalMs = options_.pollIntervalMs;
+        watchOptions.preferEtw = options_.preferEtw;
+        watchOptions.metrics = metricsExporter_.IsRunning() ? &metrics_ : nullptr;
+        
+        WatchCallbacks callbacks;
+        callbacks.onResult = [this](const ProcessEvent& event, const ScanResult& result) {
+            std::cout << "PID " << event.pid << " (" << event.name << ") parent " << event.ppid;
+            if (!event.parentName.empty()) {
+                std::cout << " (" << event.parentName << ")";
+            }
+            std::cout << ": " << GetRiskLevelName(result.riskAssessment.level) << " risk, score "
+                      << result.riskAssessment.score << "\n";
+            ExportToJson(result, GenerateJsonFilename(result.processInfo.pid));
+            DumpEvidence(result);
+        };
+        
+        std::cout << "Watching for new processes with " << watchOptions.workerCount << " workers (Ctrl+C to stop)\n";
+        WatchService service;
+        WatchSummary summary;
+        std::string error;
+        bool watched = service.Run(watchOptions, callbacks, g_sweepCancellation, summary, error);
+        StopMetrics();
+        if (!watched) {
+            std::cerr << "Error: " << error << "\n";
+            CloseArchive();
+            return 1;
+        }
+        
+        std::cout << "\nEvent source: " << ProcessWatcher::SourceName(summary.source);
+        if (!summary.etwError.empty()) {
+            std::cout << " (ETW unavailable: " << summary.etwError << ")";
+        }
+        std::cout << "\n";
+        std::cout << "Events: " << summary.events << ", filtered " << summary.filtered << ", prioritized "
+                  << summary.prioritized << ", scanned " << summary.scanned << ", gone before scan " << summary.gone
+                  << ", dropped at stop " << summary.dropped << "\n";
+        PrintLatency("Creation to scan start", summary.creationToScan);
+        PrintLatency("Event to scan start", summary.eventToScan);
+        return CloseArchive() ? 0 : 1;
+    }
+
+    void CLI::PrintLatency(const char* label, const LatencySummary& latency) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << label << " (ms): p50 " << latency.p50Ms << ", p90 " << latency.p90Ms << ", p99 " << latency.p99Ms
+                  << ", max " << latency.maxMs << " over " << latency.count << " events\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    bool CLI::StartMetrics() {
+        const MetricsExportOptions& metrics = options_.metrics;
+        if (metrics.filePath.empty() && metrics.port == 0) {
+            return true;
+        }
+        
+        std::string error;
+        if (!metricsExporter_.Start(metrics_, metrics, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        if (!metrics.filePath.empty()) {
+            std::cout << "Writing metrics to " << metrics.filePath << " every " << metrics.intervalMs << " ms\n";
+        }
+        if (metrics.port != 0) {
+            std::cout << "Serving metrics on http://127.0.0.1:" << metrics.port << "/metrics\n";
+        }
+        return true;
+    }
+
+    void CLI::StopMetrics() {
+        // Detach first so the final write holds every scan that was recorded
+        scanner_.SetMetrics(nullptr);
+        metricsExporter_.Stop();
+    }
+
+    bool CLI::UpdateReportIndex() {
+        IndexUpdateStats stats;
+        std::string error;
+        if (!ReportIndex::Update(kReportsDirectory, kReportIndexFile, stats, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        
+        std::cout << "Report index: " << stats.documents << " reports, " << stats.terms << " terms, "
+                  << stats.indexBytes << " bytes (" << stats.added << " added, " << stats.replaced << " replaced, "
+                  << stats.removed << " removed";
+        if (stats.failed > 0) {
+            std::cout << ", " << stats.failed << " unreadable";
+        }
+        std::cout << ") in " << std::fixed << std::setprecision(1) << stats.elapsedMs << " ms\n";
+        std::cout.unsetf(std::ios::floatfield);
+        return true;
+    }
+
+    int CLI::RunQuery(const std::string& expression) {
+        // Ingest whatever was written since the last query so answers cover the whole history
+        if (!UpdateReportIndex()) {
+            return 1;
+        }
+        
+        ReportIndex index;
+        std::vector<ReportHit> hits;
+        QueryStats stats;
+        std::string error;
+        if (!index.Open(kReportIndexFile, error) || !index.Query(expression, hits, stats, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        
+        std::cout << "\n" << std::left << std::setw(22) << "Timestamp"
+                  << std::setw(8) << "PID"
+                  << std::setw(30) << "Process"
+                  << std::setw(8) << "Risk"
+                  << "Report\n";
+        std::cout << std::string(100, '-') << "\n";
+        for (const auto& hit : hits) {
+            std::cout << std::left << std::setw(22) << hit.timestamp
+                      << std::setw(8) << hit.pid
+                      << std::setw(30) << (hit.processName.length() > 27 ? hit.processName.substr(0, 27) + "..." : hit.processName)
+                      << std::setw(8) << hit.riskLevel
+                      << kReportsDirectory << "/" << hit.fileName << "\n";
+        }
+        
+        std::cout << "\n" << hits.size() << " of " << stats.documents << " reports matched (" << stats.termsMatched
+                  << " terms, " << stats.postingsDecoded << " postings) in " << std::fixed << std::setprecision(2)
+                  << stats.elapsedMs << " ms\n";
+        std::cout.unsetf(std::ios::floatfield);
+        return 0;
+    }
+
+    void CLI::LoadPriorRisk(PriorRiskMap& priorRisk) {
+        // Without a report history the sweep is still ordered by the tier-zero checks alone
+        if (!UpdateReportIndex()) {
+            return;
+        }
+        ReportIndex index;
+        std::string error;
+        if (!index.Open(kReportIndexFile, error)) {
+            std::cerr << "Warning: " << error << "\n";
+            return;
+        }
+
+        // High is queried last so it wins for images reported at both levels
+        const std::pair<const char*, RiskLevel> levels[] = { { "medium", RiskLevel::Medium }, { "high", RiskLevel::High } };
+        for (const auto& level : levels) {
+            std::vector<ReportHit> hits;
+            QueryStats stats;
+            std::string expression = std::string("risk:") + level.first + " since:" + kPriorRiskWindow;
+            if (!index.Query(expression, hits, stats, error)) {
+                std::cerr << "Warning: " << error << "\n";
+                return;
+            }
+            for (const auto& hit : hits) {
+                priorRisk[ToLower(hit.processName)] = level.second;
+            }
+        }
+        std::cout << "Prior risk: " << priorRisk.size() << " images reported Medium or High in the last "
+                  << kPriorRiskWindow << "\n";
+    }
+
+    void CLI::PrintTriageStats(const TriageStats& stats) {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Tier 1: " << stats.tier1Processes << " processes, " << stats.tier1Regions
+                  << " regions queried, " << stats.tier1Ms << " ms\n";
+        std::cout << "Tier 2: " << stats.tier2Processes << " processes (threshold " << options_.triageThreshold << "), "
+                  << stats.tier2Modules << " modules verified, " << stats.tier2Regions << " regions, "
+                  << stats.tier2Ms << " ms\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    void CLI::PrintIsolationStats(const IsolationStats& stats) {
+        std::cout << "Workers: " << stats.workers << " started, " << stats.crashes << " crashed, "
+                  << stats.hangs << " hung";
+        if (stats.lost > 0) {
+            std::cout << ", " << stats.lost << " results lost";
+        }
+        if (stats.threadsResumed > 0) {
+            std::cout << ", " << stats.threadsResumed << " target threads resumed";
+        }
+        if (stats.unscanned > 0) {
+            std::cout << ", " << stats.unscanned << " processes left without a worker";
+        }
+        std::cout << "\n";
+        if (!stats.blacklisted.empty()) {
+            std::cout << "Blacklisted PIDs:";
+            for (DWORD pid : stats.blacklisted) {
+                std::cout << " " << pid;
+            }
+            std::cout << "\n";
+        }
+    }
+
+    void CLI::PrintPartitionStats(const std::vector<PartitionStats>& partitions) {
+        std::cout << "\n" << std::left << std::setw(10) << "Session"
+                  << std::setw(11) << "Processes"
+                  << std::setw(9) << "Scanned"
+                  << std::setw(8) << "Failed"
+                  << std::setw(9) << "Skipped"
+                  << std::setw(8) << "Medium"
+                  << std::setw(6) << "High"
+                  << std::setw(18) << "Max score (PID)"
+                  << std::setw(11) << "Score sum"
+                  << "Scan ms\n";
+        std::cout << std::string(100, '-') << "\n";
+        for (const auto& stats : partitions) {
+            std::string maxScore = std::to_string(stats.maxScore);
+            if (stats.maxScorePid != 0) {
+                maxScore += " (" + std::to_string(stats.maxScorePid) + ")";
+            }
+            std::cout << std::setw(10) << stats.sessionId
+                      << std::setw(11) << stats.processes
+                      << std::setw(9) << stats.scanned
+                      << std::setw(8) << stats.failed
+                      << std::setw(9) << stats.skipped
+                      << std::setw(8) << stats.mediumRisk
+                      << std::setw(6) << stats.highRisk
+                      << std::setw(18) << maxScore
+                      << std::setw(11) << stats.totalScore
+                      << static_cast<long long>(stats.scanMs) << "\n";
+        }
+    }
+
+    void CLI::PrintClusters(const FingerprintIndex& fingerprints) {
+        std::vector<RegionCluster> clusters = fingerprints.Clusters(2);
+        std::cout << "Region fingerprints: " << fingerprints.UniqueCount() << " unique, "
+                  << clusters.size() << " shared by 2+ processes\n";
+        
+        for (const auto& cluster : clusters) {
+            std::cout << "  " << FingerprintToString(cluster.fingerprint) << "  " << cluster.size << " bytes  "
+                      << cluster.protection << "  " << cluster.processCount << " processes"
+                      << (cluster.isSuspicious ? "  [SUSPICIOUS]" : "") << "\n";
+            std::cout << "   ";
+            for (const auto& member : cluster.members) {
+                std::cout << " " << member.pid << " (" << member.processName << ")";
+            }
+            std::cout << "\n";
+        }
+        
+        if (!clusters.empty()) {
+            std::string filename = std::string(kReportsDirectory) + "/clusters_" + GetTimestamp() + ".json";
+            if (WriteClusterReport(clusters, filename)) {
+                std::cout << "Cluster report exported to: " << filename << "\n";
+            }
+        }
+    }
+
+    void CLI::PrintCorpusMatches(const SimilarityIndex& similarity, const std::vector<SimilarityEntry>& corpus) {
+        std::cout << "Similarity digests: " << similarity.Size() << "\n";
+        if (options_.similarCorpus.empty()) {
+            return;
+        }
+        
+        size_t matched = 0;
+        for (const auto& known : corpus) {
+            std::vector<SimilarityMatch> matches = similarity.Query(known.digest, options_.maxDistance);
+            if (matches.empty()) {
+                continue;
+            }
+            matched++;
+            std::cout << "  " << known.label << ": " << matches.size() << " similar regions\n";
+            for (const auto& match : matches) {
+                SimilarityEntry entry = similarity.Entry(match.entry);
+                std::cout << "    distance " << std::setw(3) << match.distance << "  PID " << entry.pid
+                          << " (" << entry.processName << ")  0x" << std::hex << entry.baseAddress << std::dec
+                          << "  " << entry.size << " bytes\n";
+            }
+        }
+        std::cout << "Corpus entries matched: " << matched << "/" << corpus.size()
+                  << " (max distance " << options_.maxDistance << ")\n";
+    }
+
+    bool CLI::ParseOptions(int argc, char* argv[], int firstOption) {
+        for (int i = firstOption; i < argc; i++) {
+            std::string option = argv[i];
+            if (option == "--timeout" && i + 1 < argc) {
+                options_.timeoutMs = std::stoul(argv[++i]);
+                options_.timeoutSet = true;
+            } else if (option == "--triage" && i + 1 < argc) {
+                options_.triageThreshold = std::stoi(argv[++i]);
+                options_.triageEnabled = true;
+            } else if (option == "--sample" && i + 1 < argc) {
+                options_.sampleBudget = std::stoull(argv[++i]) << 20;
+            } else if (option == "--strings" && i + 1 < argc) {
+                options_.stringCount = std::stoul(argv[++i]);
+            } else if (option == "--thread-samples" && i + 1 < argc) {
+                options_.threadSampling.rounds = std::stoul(argv[++i]);
+            } else if (option == "--thread-interval" && i + 1 < argc) {
+                options_.threadSampling.intervalMs = std::stoul(argv[++i]);
+            } else if (option == "--baseline" && i + 1 < argc) {
+                options_.baselinePath = argv[++i];
+            } else if (option == "--allowlist" && i + 1 < argc) {
+                options_.allowlistPath = argv[++i];
+                std::string error;
+                if (!allowlist_.Load(options_.allowlistPath, error)) {
+                    std::cerr << "Error: Invalid allowlist: " << error << "\n";
+                    return false;
+                }
+            } else if (option == "--dump" && i + 1 < argc) {
+                options_.dumpPath = argv[++i];
+            } else if (option == "--similar" && i + 1 < argc) {
+                options_.similarCorpus = argv[++i];
+            } else if (option == "--max-distance" && i + 1 < argc) {
+                options_.maxDistance = std::stoi(argv[++i]);
+            } else if (option == "--record" && i + 1 < argc) {
+                options_.recordPath = argv[++i];
+            } else if (option == "--replay" && i + 1 < argc) {
+                options_.replayPath = argv[++i];
+            } else if (option == "--poll" && i + 1 < argc) {
+                options_.pollIntervalMs = std::stoul(argv[++i]);
+            } else if (option == "--prioritize") {
+                options_.prioritize = true;
+            } else if (option == "--partition") {
+                options_.partition.interleave = true;
+            } else if (option == "--partition-budget" && i + 1 < argc) {
+                options_.partition.budgetMs = std::stoul(argv[++i]);
+                options_.partition.interleave = true;
+            } else if (option == "--partition-concurrency" && i + 1 < argc) {
+                options_.partition.maxConcurrent = std::stoul(argv[++i]);
+                options_.partition.interleave = true;
+            } else if (option == "--isolate") {
+                options_.isolate = true;
+            } else if (option == "--no-etw") {
+                options_.preferEtw = false;
+            } else if (option == "--metrics" && i + 1 < argc) {
+                options_.metrics.filePath = argv[++i];
+            } else if (option == "--metrics-port" && i + 1 < argc) {
+                options_.metrics.port = static_cast<unsigned short>(std::stoul(argv[++i]));
+            } else if (option == "--metrics-interval" && i + 1 < argc) {
+                options_.metrics.intervalMs = std::stoul(argv[++i]);
+            } else if (option == "--pipe" && i + 1 < argc) {
+                options_.daemon.pipeName = argv[++i];
+            } else if (option == "--workers" && i + 1 < argc) {
+                options_.daemon.workerCount = std::stoul(argv[++i]);
+            } else if (option == "--filter" && i + 1 < argc) {
+                options_.filterExpression = argv[++i];
+                std::string error;
+                if (!filter_.Compile(options_.filterExpression, error)) {
+                    std::cerr << "Error: Invalid filter: " << error << "\n";
+                    return false;
                 }
+            } else {
+                std::cerr << "Error: Unknown or incomplete option '" << option << "'\n";
+                return false;
             }
-            
-            // Scan memory regions
-            result.memoryRegions = memoryScanner_.ScanMemoryRegions(hProcess.get());
-            
-            // Calculate risk score
-            result.riskAssessment = riskScorer_.CalculateRiskScore(
-                result.processInfo, result.modules, result.threads, result.memoryRegions);
-            
-            result.success = true;
-        } catch (const std::exception& e) {
-            result.errorMessage = "Exception during scan: " + std::string(e.what());
+        }
+        return true;
+    }
+
+    void CLI::PrintEnumerationStats(const EnumerationStats& stats) {
+        if (filter_.IsEmpty()) {
+            return;
         }
         
-        return result;
+        std::cout << "Filter matched " << stats.matched << "/" << stats.snapshotCount << " processes ("
+                  << stats.rejectedEarly << " rejected before OpenProcess, " << stats.opened << " opened) in "
+                  << std::fixed << std::setprecision(1) << stats.elapsedMs << " ms\n";
+        std::cout.unsetf(std::ios::floatfield);
     }
 
     void CLI::PrintProcessList() {
-        std::vector<ProcessInfo> processes = processEnumerator_.EnumerateProcesses();
+        std::vector<ProcessInfo> processes = processEnumerator_.EnumerateProcesses(&filter_);
         
         std::cout << std::left << std::setw(8) << "PID" 
                   << std::setw(8) << "PPID" 
@@ -136,6 +826,21 @@ namespace ProcessScope {
         }
         
         std::cout << "\nTotal processes: " << processes.size() << "\n";
+        PrintEnumerationStats(processEnumerator_.LastStats());
+    }
+
+    void CLI::PrintProcessTree() {
+        std::vector<ProcessInfo> processes = processEnumerator_.EnumerateProcesses(&filter_);
+        
+        ProcessTree tree;
+        tree.Build(processes);
+        tree.Print(std::cout);
+        
+        std::cout << "\nTotal processes: " << processes.size() << "\n";
+        if (tree.ReusedPidCount() > 0) {
+            std::cout << "Orphans with reused parent PID: " << tree.ReusedPidCount() << "\n";
+        }
+        PrintEnumerationStats(processEnumerator_.LastStats());
     }
 
     void CLI::PrintScanResult(const ScanResult& result) {
@@ -171,8 +876,9 @@ namespace ProcessScope {
         std::cout << "\n=== THREADS (" << result.threads.size() << ") ===\n";
         std::cout << std::left << std::setw(10) << "TID"
                   << std::setw(18) << "Start Address"
-                  << "Anomalous\n";
-        std::cout << std::string(40, '-') << "\n";
+                  << std::setw(11) << "Anomalous"
+                  << "Symbol\n";
+        std::cout << std::string(80, '-') << "\n";
         
         for (const auto& thread : result.threads) {
             std::cout << std::left << std::setw(10) << thread.tid;
@@ -181,7 +887,8 @@ namespace ProcessScope {
             } else {
                 std::cout << std::setw(18) << "Unknown";
             }
-            std::cout << (thread.anomalousStart ? " Yes" : " No") << "\n";
+            std::cout << std::setw(11) << (thread.anomalousStart ? " Yes" : " No")
+                      << (thread.startSymbol.empty() ? "-" : thread.startSymbol) << "\n";
         }
         
         std::cout << "\n=== MEMORY SUMMARY ===\n";
@@ -206,123 +913,141 @@ namespace ProcessScope {
         std::cout << "RWX regions: " << rwxRegions << "\n";
         std::cout << "Executable private regions: " << executablePrivateRegions << "\n";
         
-        std::cout << "\n=== RISK ASSESSMENT ===\n";
-        std::string levelStr;
-        switch (result.riskAssessment.level) {
-            case RiskLevel::Low:    levelStr = "Low"; break;
-            case RiskLevel::Medium: levelStr = "Medium"; break;
-            case RiskLevel::High:   levelStr = "High"; break;
+        int peHeaderRegions = 0;
+        size_t modifiedImageRegions = 0;
+        size_t modifiedImagePages = 0;
+        size_t suspiciousPages = 0;
+        size_t suspiciousResidentPages = 0;
+        for (const auto& region : result.memoryRegions) {
+            if (region.hasPeHeader) {
+                peHeaderRegions++;
+            }
+            if (region.isImage && region.isExecutable && region.pages.privatePages > 0) {
+                modifiedImageRegions++;
+                modifiedImagePages += region.pages.privatePages;
+            }
+            if (region.isSuspicious && region.pages.analyzed) {
+                suspiciousPages += region.pages.pageCount;
+                suspiciousResidentPages += region.pages.residentPages;
+            }
+        }
+        std::cout << "Private regions with PE header: " << peHeaderRegions << "\n";
+        std::cout << "Modified image code pages: " << modifiedImagePages << " in " << modifiedImageRegions << " regions\n";
+        if (suspiciousPages > 0) {
+            std::cout << "Suspicious region residency: " << suspiciousResidentPages << "/" << suspiciousPages << " pages\n";
+        }
+        if (result.contentSample.sampled) {
+            PrintContentSample(result.contentSample);
+        }
+        if (result.strings.extracted) {
+            PrintStrings(result.strings);
+        }
+        if (result.threadSampling.sampled) {
+            PrintThreadSampling(result);
         }
         
+        std::cout << "\n=== RISK ASSESSMENT ===\n";
         std::cout << "Risk Score: " << result.riskAssessment.score << "\n";
-        std::cout << "Risk Level: " << levelStr << "\n";
+        std::cout << "Risk Level: " << GetRiskLevelName(result.riskAssessment.level) << "\n";
         std::cout << "Details: " << result.riskAssessment.details << "\n";
+        
+        std::cout << "\n=== SCAN TIMING ===\n";
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Modules: " << result.timings.modulesMs << " ms\n"
+                  << "Threads: " << result.timings.threadsMs << " ms\n"
+                  << "Memory: " << result.timings.memoryMs << " ms\n"
+                  << "Risk: " << result.timings.riskMs << " ms\n"
+                  << "Total: " << result.timings.totalMs << " ms\n";
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << "Memory reads: " << result.memoryReads.requests << " requests in "
+                  << result.memoryReads.syscalls << " syscalls, " << result.memoryReads.bytesTransferred
+                  << " bytes, " << result.memoryReads.cacheHits << " cache hits\n";
+        std::cout << "Page queries: " << result.pageQueries.pagesQueried << " pages in "
+                  << result.pageQueries.queries << " calls\n";
+        if (result.truncated) {
+            std::cout << "Warning: scan budget exceeded during " << result.truncatedPhase
+                      << " phase; results are partial\n";
+        }
     }
 
-    bool CLI::ExportToJson(const ScanResult& result, const std::string& filename) {
-        try {
-            json j;
-            
-            j["tool_info"]["name"] = "ProcessScope";
-            j["tool_info"]["version"] = "1.0.0";
-            j["tool_info"]["timestamp"] = GetTimestamp();
-            
-            j["host_info"]["computer_name"] = []() -> std::string {
-                char* env = nullptr;
-                size_t len = 0;
-                _dupenv_s(&env, &len, "COMPUTERNAME");
-                std::string result = env ? env : "Unknown";
-                if (env) free(env);
-                return result;
-            }();
-            j["host_info"]["username"] = []() -> std::string {
-                char* env = nullptr;
-                size_t len = 0;
-                _dupenv_s(&env, &len, "USERNAME");
-                std::string result = env ? env : "Unknown";
-                if (env) free(env);
-                return result;
-            }();
-            
-            j["process"]["pid"] = result.processInfo.pid;
-            j["process"]["ppid"] = result.processInfo.ppid;
-            j["process"]["name"] = result.processInfo.name;
-            j["process"]["full_path"] = result.processInfo.fullPath;
-            j["process"]["architecture"] = result.processInfo.architecture;
-            j["process"]["session_id"] = result.processInfo.sessionId;
-            
-            j["modules"] = json::array();
-            for (const auto& module : result.modules) {
-                json m;
-                m["name"] = module.name;
-                m["full_path"] = module.fullPath;
-                m["base_address"] = "0x" + std::to_string(module.baseAddress);
-                m["size"] = module.size;
-                m["signed"] = module.isSigned;
-                m["signer_name"] = module.signerName;
-                j["modules"].push_back(m);
-            }
-            
-            j["threads"] = json::array();
-            for (const auto& thread : result.threads) {
-                json t;
-                t["tid"] = thread.tid;
-                if (thread.startAddress != 0) {
-                    t["start_address"] = "0x" + std::to_string(thread.startAddress);
-                } else {
-                    t["start_address"] = nullptr;
-                }
-                t["anomalous_start"] = thread.anomalousStart;
-                j["threads"].push_back(t);
+    void CLI::PrintContentSample(const ContentSample& sample) {
+        std::cout << "\n=== CONTENT SAMPLE ===\n";
+        std::cout << "Read " << sample.bytesRead << " of " << sample.budgetBytes << " budget bytes in "
+                  << std::fixed << std::setprecision(1) << sample.elapsedMs << " ms"
+                  << (sample.flaggedComplete ? "" : " (flagged regions only partly covered)") << "\n";
+        std::cout << std::left << std::setw(18) << "Stratum" << std::setw(12) << "Pages" << std::setw(12) << "Sampled"
+                  << std::setw(26) << "PE headers (95% CI)" << "High entropy (95% CI)\n";
+        auto range = [](const SampleEstimate& estimate) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(0) << estimate.estimate << " [" << estimate.lower << ", " << estimate.upper << "]";
+            return text.str();
+        };
+        for (size_t s = 0; s < kSampleStrata; s++) {
+            const SampleStratum& stratum = sample.strata[s];
+            if (stratum.pages == 0) {
+                continue;
             }
-            
-            j["memory_regions"] = json::array();
-            for (const auto& region : result.memoryRegions) {
-                json r;
-                r["base_address"] = "0x" + std::to_string(region.baseAddress);
-                r["size"] = region.size;
-                r["state"] = region.state;
-                r["type"] = region.type;
-                r["protection"] = region.protection;
-                r["is_executable"] = region.isExecutable;
-                r["is_writable"] = region.isWritable;
-                r["is_suspicious"] = region.isSuspicious;
-                j["memory_regions"].push_back(r);
+            std::cout << std::setw(18) << ContentSample::StratumName(static_cast<SampleStratumKind>(s))
+                      << std::setw(12) << stratum.pages << std::setw(12) << stratum.sampledPages
+                      << std::setw(26) << range(stratum.peHeaders) << range(stratum.highEntropy) << "\n";
+        }
+        std::cout << std::setw(42) << "Total" << std::setw(26) << range(sample.peHeaders) << range(sample.highEntropy) << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+        for (const auto& hit : sample.hits) {
+            std::cout << "  0x" << std::hex << hit.address << std::dec
+                      << ((hit.indicators & kIndicatorPeHeader) ? "  PE header" : "")
+                      << ((hit.indicators & kIndicatorHighEntropy) ? "  high entropy" : "") << "\n";
+        }
+    }
+
+    void CLI::PrintStrings(const StringExtraction& strings) {
+        std::cout << "\n=== STRINGS ===\n";
+        std::cout << strings.uniqueStrings << " unique of " << strings.totalStrings << " strings in " << strings.regions
+                  << " flagged regions (" << strings.bytesScanned << " bytes in " << std::fixed << std::setprecision(1)
+                  << strings.elapsedMs << " ms" << (strings.complete ? "" : ", stopped early") << ")\n";
+        std::cout.unsetf(std::ios::floatfield);
+        for (const auto& extracted : strings.strings) {
+            std::cout << "  0x" << std::hex << extracted.address << std::dec << (extracted.wide ? "  W  " : "  A  ")
+                      << extracted.text;
+            if (extracted.occurrences > 1) {
+                std::cout << "  (x" << extracted.occurrences << ")";
             }
-            
-            j["risk_assessment"]["score"] = result.riskAssessment.score;
-            std::string levelStr;
-            switch (result.riskAssessment.level) {
-                case RiskLevel::Low:    levelStr = "Low"; break;
-                case RiskLevel::Medium: levelStr = "Medium"; break;
-                case RiskLevel::High:   levelStr = "High"; break;
-            }
-            j["risk_assessment"]["level"] = levelStr;
-            j["risk_assessment"]["details"] = result.riskAssessment.details;
-            
-            // Create directory if it doesn't exist
-            size_t lastSlash = filename.find_last_of("\\/");
-            if (lastSlash != std::string::npos) {
-                std::string directory = filename.substr(0, lastSlash);
-                CreateDirectoryRecursive(directory);
+            std::cout << "\n";
+        }
+    }
+
+    void CLI::PrintThreadSampling(const ScanResult& result) {
+        const ThreadSamplingStats& stats = result.threadSampling;
+        std::cout << "\n=== THREAD ACTIVITY ===\n";
+        std::cout << stats.samples << " samples of " << stats.threads << " threads in " << stats.rounds << " rounds ("
+                  << stats.idleSkips << " idle skips, " << stats.inaccessible << " inaccessible), "
+                  << stats.unbackedSamples << " in unbacked memory\n";
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Overhead: " << stats.suspensions << " suspensions, " << stats.suspendedMs << " ms suspended over "
+                  << stats.windowMs << " ms (" << stats.overheadPercent << "% of thread time, longest "
+                  << stats.maxSuspendUs << " us), sampler CPU " << stats.samplerCpuMs << " ms\n";
+        std::cout.unsetf(std::ios::floatfield);
+        
+        for (const auto& thread : result.threads) {
+            if (thread.samples == 0) {
+                continue;
             }
-            
-            std::ofstream file(filename);
-            if (!file.is_open()) {
-                return false;
+            std::cout << "  TID " << std::left << std::setw(8) << thread.tid
+                      << thread.samples << " samples, " << thread.unbackedSamples << " unbacked, at 0x"
+                      << std::hex << thread.sampledAddress << std::dec;
+            if (!thread.sampledSymbol.empty()) {
+                std::cout << " (" << thread.sampledSymbol << ")";
             }
-            
-            file << j.dump(4);
-            file.close();
-            
-            return true;
-        } catch (const std::exception&) {
-            return false;
+            std::cout << "\n";
         }
     }
 
+    bool CLI::ExportToJson(const ScanResult& result, const std::string& filename) {
+        return WriteReportFile(result, filename);
+    }
+
     std::string CLI::GenerateJsonFilename(DWORD pid) {
-        return "./reports/" + std::to_string(pid) + "_" + GetTimestamp() + ".json";
+        return std::string(kReportsDirectory) + "/" + std::to_string(pid) + "_" + GetTimestamp() + ".json";
     }
 
 } // namespace ProcessScope
@@ -1,38 +1,93 @@
 #pragma once
 
 #include "util.h"
-#include "process_enum.h"
-#include "module_enum.h"
-#include "thread_enum.h"
-#include "memory_scan.h"
-#include "risk_score.h"
+#include "scanner.h"
+#include "daemon.h"
+#include "evidence_archive.h"
+#include "replay_backend.h"
+#include "watch_service.h"
+#include "report_index.h"
+#include "isolated_sweep.h"
+#include <memory>
 #include <string>
 
 namespace ProcessScope {
 
-    struct ScanResult {
-        ProcessInfo processInfo;
-        std::vector<ModuleInfo> modules;
-        std::vector<ThreadInfo> threads;
-        std::vector<MemoryRegion> memoryRegions;
-        RiskAssessment riskAssessment;
-        std::string errorMessage;
-        bool success;
+    // Command-line options shared by the scan commands
+    struct CLIOptions {
+        DWORD timeoutMs;
+        bool timeoutSet;
+        std::string filterExpression;
+        bool triageEnabled;
+        int triageThreshold;
+        DaemonOptions daemon;
+        std::string dumpPath;
+        std::string similarCorpus;
+        std::string recordPath;
+        std::string replayPath;
+        std::string baselinePath;
+        std::string allowlistPath;
+        DWORD pollIntervalMs;
+        bool preferEtw;
+        bool isolate;
+        ULONGLONG sampleBudget;
+        size_t stringCount;
+        ThreadSampleOptions threadSampling;
+        PartitionOptions partition;
+        bool prioritize;
+        int maxDistance;
+        MetricsExportOptions metrics;
         
-        ScanResult() : success(false) {}
+        CLIOptions() : timeoutMs(0), timeoutSet(false), triageEnabled(false), triageThreshold(0),
+                       maxDistance(kDefaultSimilarityThreshold), pollIntervalMs(WatchOptions().pollIntervalMs),
+                       preferEtw(true), isolate(false), sampleBudget(0), stringCount(0), prioritize(false) {}
     };
 
     class CLI {
     private:
         ProcessEnumerator processEnumerator_;
-        ModuleEnumerator moduleEnumerator_;
-        ThreadEnumerator threadEnumerator_;
-        MemoryScanner memoryScanner_;
-        RiskScorer riskScorer_;
+        ProcessScanner scanner_;
+        CLIOptions options_;
+        ProcessFilter filter_;
+        EvidenceArchive archive_;
+        HostSnapshot snapshot_;
+        std::unique_ptr<ScanBackend> backend_;
+        ScanMetrics metrics_;
+        MetricsExporter metricsExporter_;
+        BaselineStore baselines_;
+        ModuleAllowlist allowlist_;
         
-        ScanResult ScanProcess(DWORD pid);
+        bool ParseOptions(int argc, char* argv[], int firstOption);
+        ScanOptions GetScanOptions() const;
+        int RunSweep();
+        int RunDaemon();
+        int RunWatch();
+        void PrintLatency(const char* label, const LatencySummary& latency);
+        bool StartMetrics();
+        void StopMetrics();
+        bool UpdateReportIndex();
+        int RunQuery(const std::string& expression);
+        void LoadPriorRisk(PriorRiskMap& priorRisk);
+        bool SetUpBackend();
+        bool SaveRecording();
+        bool OpenArchive();
+        void DumpEvidence(const ScanResult& result);
+        bool CloseArchive();
+        bool OpenBaselines();
+        void LearnBaseline(const ScanResult& result);
+        bool SaveBaselines();
+        void PrintTriageStats(const TriageStats& stats);
+        void PrintIsolationStats(const IsolationStats& stats);
+        void PrintPartitionStats(const std::vector<PartitionStats>& partitions);
+        void PrintClusters(const FingerprintIndex& fingerprints);
+        void PrintCorpusMatches(const SimilarityIndex& similarity, const std::vector<SimilarityEntry>& corpus);
+        void PrintEnumerationStats(const EnumerationStats& stats);
         void PrintProcessList();
+        void PrintProcessTree();
         void PrintScanResult(const ScanResult& result);
+        void PrintContentSample(const ContentSample& sample);
+        void PrintStrings(const StringExtraction& strings);
+        void PrintThreadSampling(const ScanResult& result);
         bool ExportToJson(const ScanResult& result, const std::string& filename);
         std::string GenerateJsonFilename(DWORD pid);
         
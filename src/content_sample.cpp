@@ -0,0 +1,292 @@
+#include "content_sample.h"
+#include "scan_backend.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace ProcessScope {
+
+    // Every non-empty stratum gets at least this many pages, budget permitting
+    static const ULONGLONG kMinStratumPages = 16;
+
+    // Consecutive picked pages are read together, up to this many per call
+    static const size_t kMaxRunPages = 16;
+
+    static const double kHighEntropyBits = 7.2;
+    static const double kConfidenceZ = 1.96;    // 95%
+
+    // Relative sampling rate of the unflagged strata: payloads are staged in private memory far
+    // more often than in image sections or file mappings
+    static const double kStratumWeights[kSampleStrata] = {
+        0.0,    // Flagged: always covered in full first
+        1.0,    // ImageCode
+        1.0,    // ImageData
+        4.0,    // PrivateWritable
+        2.0,    // PrivateReadOnly
+        1.0,    // Mapped
+    };
+
+    const char* ContentSample::StratumName(SampleStratumKind kind) {
+        switch (kind) {
+            case SampleStratumKind::Flagged: return "flagged";
+            case SampleStratumKind::ImageCode: return "image_code";
+            case SampleStratumKind::ImageData: return "image_data";
+            case SampleStratumKind::PrivateWritable: return "private_writable";
+            case SampleStratumKind::PrivateReadOnly: return "private_readonly";
+            case SampleStratumKind::Mapped: return "mapped";
+            default: return "unknown";
+        }
+    }
+
+    // SplitMix64: small, fast and good enough to spread picks; not for anything adversarial
+    static ULONGLONG NextRandom(ULONGLONG& state) {
+        ULONGLONG z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static double PageEntropy(const BYTE* page, size_t size) {
+        size_t counts[256] = {};
+        for (size_t i = 0; i < size; i++) {
+            counts[page[i]]++;
+        }
+        double entropy = 0;
+        for (size_t count : counts) {
+            if (count > 0) {
+                double p = static_cast<double>(count) / size;
+                entropy -= p * std::log2(p);
+            }
+        }
+        return entropy;
+    }
+
+    static BYTE InspectPage(const BYTE* page, size_t size, bool checkPeHeader) {
+        BYTE indicators = 0;
+        if (checkPeHeader && size >= 0x40 && page[0] == 'M' && page[1] == 'Z') {
+            DWORD ntOffset;
+            memcpy(&ntOffset, page + 0x3C, sizeof(ntOffset));
+            DWORD signature = 0;
+            if (ntOffset >= 0x40 && ntOffset <= size - sizeof(signature)) {
+                memcpy(&signature, page + ntOffset, sizeof(signature));
+            }
+            if (signature == IMAGE_NT_SIGNATURE) {
+                indicators |= kIndicatorPeHeader;
+            }
+        }
+        if (PageEntropy(page, size) > kHighEntropyBits) {
+            indicators |= kIndicatorHighEntropy;
+        }
+        return indicators;
+    }
+
+    // Wilson score interval for hits out of sampled pages, scaled to the stratum. The finite
+    // population correction enters as a larger effective sample size, so the interval narrows
+    // as the sample approaches the whole stratum and still starts at zero when nothing was found.
+    static SampleEstimate Estimate(ULONGLONG hits, ULONGLONG sampled, ULONGLONG population) {
+        SampleEstimate estimate;
+        if (sampled == 0) {
+            estimate.upper = static_cast<double>(population);
+            return estimate;
+        }
+        if (sampled >= population) {
+            estimate.estimate = estimate.lower = estimate.upper = static_cast<double>(hits);
+            return estimate;
+        }
+
+        double n = static_cast<double>(sampled);
+        double N = static_cast<double>(population);
+        double p = hits / n;
+        double z2 = kConfidenceZ * kConfidenceZ;
+        double effective = n * (N - 1) / (N - n);
+        double denominator = 1 + z2 / effective;
+        double center = (p + z2 / (2 * effective)) / denominator;
+        double half = kConfidenceZ * std::sqrt(p * (1 - p) / effective + z2 / (4 * effective * effective)) / denominator;
+
+        // Pages already seen are certain either way
+        estimate.estimate = p * N;
+        estimate.lower = (std::max)((std::max)(0.0, center - half) * N, static_cast<double>(hits));
+        estimate.upper = (std::min)((std::min)(1.0, center + half) * N, N - (n - hits));
+        return estimate;
+    }
+
+    static void AddEstimate(SampleEstimate& total, const SampleEstimate& part) {
+        total.estimate += part.estimate;
+        total.lower += part.lower;
+        total.upper += part.upper;
+    }
+
+    ContentSample ContentSampler::Sample(MemorySource& source, const std::vector<SampleRange>& ranges,
+                                         const ContentSampleOptions& options, const ScanContext& context) {
+        auto start = std::chrono::steady_clock::now();
+        const size_t pageSize = GetSystemPageSize();
+        ContentSample sample;
+        sample.sampled = true;
+        sample.budgetBytes = options.byteBudget;
+
+        std::vector<size_t> members[kSampleStrata];
+        for (size_t i = 0; i < ranges.size(); i++) {
+            SampleStratum& stratum = sample.strata[static_cast<size_t>(ranges[i].stratum)];
+            stratum.regions++;
+            stratum.pages += (ranges[i].size + pageSize - 1) / pageSize;
+            members[static_cast<size_t>(ranges[i].stratum)].push_back(i);
+        }
+
+        // Flagged pages first, keeping an eighth of the budget for light coverage of everything else
+        ULONGLONG quota[kSampleStrata] = {};
+        ULONGLONG budgetPages = (std::max)(options.byteBudget / pageSize, static_cast<ULONGLONG>(1));
+        ULONGLONG unflaggedPages = 0;
+        for (size_t s = 1; s < kSampleStrata; s++) {
+            unflaggedPages += sample.strata[s].pages;
+        }
+        ULONGLONG reserve = (std::min)(unflaggedPages, budgetPages / 8);
+        quota[0] = (std::min)(sample.strata[0].pages, budgetPages - reserve);
+        sample.flaggedComplete = quota[0] == sample.strata[0].pages;
+        ULONGLONG remaining = budgetPages - quota[0];
+
+        for (size_t s = 1; s < kSampleStrata && remaining > 0; s++) {
+            quota[s] = (std::min)((std::min)(kMinStratumPages, sample.strata[s].pages), remaining);
+            remaining -= quota[s];
+        }
+
+        // Share the rest in proportion to weight times size; a stratum whose share would exceed
+        // its size is read in full and the difference shared again among the others
+        while (remaining > 0) {
+            double totalWeight = 0;
+            for (size_t s = 1; s < kSampleStrata; s++) {
+                if (quota[s] < sample.strata[s].pages) {
+                    totalWeight += kStratumWeights[s] * sample.strata[s].pages;
+                }
+            }
+            if (totalWeight == 0) {
+                break;
+            }
+            bool filled = false;
+            for (size_t s = 1; s < kSampleStrata; s++) {
+                ULONGLONG room = sample.strata[s].pages - quota[s];
+                if (room > 0 && remaining * (kStratumWeights[s] * sample.strata[s].pages / totalWeight) >= room) {
+                    quota[s] += room;
+                    remaining -= room;
+                    filled = true;
+                }
+            }
+            if (!filled) {
+                ULONGLONG granted = 0;
+                for (size_t s = 1; s < kSampleStrata; s++) {
+                    if (quota[s] < sample.strata[s].pages) {
+                        ULONGLONG share = static_cast<ULONGLONG>(remaining * (kStratumWeights[s] * sample.strata[s].pages / totalWeight));
+                        quota[s] += share;
+                        granted += share;
+                    }
+                }
+                remaining -= (std::min)(granted, remaining);
+                break;
+            }
+        }
+
+        std::vector<BYTE> buffer(kMaxRunPages * pageSize);
+        ULONGLONG random = options.seed;
+        bool stopped = false;
+
+        for (size_t s = 0; s < kSampleStrata && !stopped; s++) {
+            SampleStratum& stratum = sample.strata[s];
+            ULONGLONG population = stratum.pages;
+            ULONGLONG picks = quota[s];
+            if (picks == 0) {
+                continue;
+            }
+            bool checkPeHeader = s != static_cast<size_t>(SampleStratumKind::ImageCode) &&
+                                 s != static_cast<size_t>(SampleStratumKind::ImageData);
+
+            // Jittered systematic picks in ascending page order, mapped onto the stratum's ranges
+            size_t member = 0;
+            ULONGLONG memberFirstPage = 0;
+            uintptr_t runStart = 0;
+            size_t runPages = 0;
+
+            auto flush = [&]() {
+                size_t done = 0;
+                while (done < runPages) {
+                    size_t bytesRead = source.Read(runStart + done * pageSize, buffer.data(), (runPages - done) * pageSize);
+                    size_t whole = bytesRead / pageSize;
+                    for (size_t p = 0; p < whole; p++) {
+                        BYTE indicators = InspectPage(buffer.data() + p * pageSize, pageSize, checkPeHeader);
+                        stratum.sampledPages++;
+                        if (indicators & kIndicatorPeHeader) {
+                            stratum.peHeaderPages++;
+                        }
+                        if (indicators & kIndicatorHighEntropy) {
+                            stratum.highEntropyPages++;
+                        }
+                        if (indicators && sample.hits.size() < kMaxSampleHits) {
+                            SampleHit hit;
+                            hit.address = runStart + (done + p) * pageSize;
+                            hit.indicators = indicators;
+                            sample.hits.push_back(hit);
+                        }
+                    }
+                    sample.bytesRead += whole * pageSize;
+                    done += whole;
+                    if (done < runPages) {
+                        stratum.unreadablePages++;
+                        done++;
+                    }
+                }
+                runPages = 0;
+            };
+
+            for (ULONGLONG i = 0; i < picks; i++) {
+                ULONGLONG low = population / picks * i + population % picks * i / picks;
+                ULONGLONG high = population / picks * (i + 1) + population % picks * (i + 1) / picks;
+                ULONGLONG page = low + (high > low ? NextRandom(random) % (high - low) : 0);
+
+                const SampleRange* range = &ranges[members[s][member]];
+                ULONGLONG rangePages = (range->size + pageSize - 1) / pageSize;
+                while (page >= memberFirstPage + rangePages) {
+                    memberFirstPage += rangePages;
+                    range = &ranges[members[s][++member]];
+                    rangePages = (range->size + pageSize - 1) / pageSize;
+                }
+                uintptr_t address = range->baseAddress + static_cast<size_t>(page - memberFirstPage) * pageSize;
+
+                if (runPages > 0 && (address != runStart + runPages * pageSize || runPages == kMaxRunPages)) {
+                    if (context.ShouldStop()) {
+                        stopped = true;
+                        break;
+                    }
+                    flush();
+                }
+                if (runPages == 0) {
+                    runStart = address;
+                }
+                runPages++;
+            }
+            if (!stopped && runPages > 0) {
+                flush();
+            }
+        }
+
+        for (size_t s = 0; s < kSampleStrata; s++) {
+            // Unreadable picks are assumed to stand for unreadable pages, not for unseen contents,
+            // and the readable share of the picks for the readable share of the stratum
+            SampleStratum& stratum = sample.strata[s];
+            ULONGLONG picked = stratum.sampledPages + stratum.unreadablePages;
+            ULONGLONG readable = stratum.pages;
+            if (picked > 0) {
+                readable = static_cast<ULONGLONG>(static_cast<double>(stratum.pages) * stratum.sampledPages / picked + 0.5);
+                readable = (std::max)(readable, stratum.sampledPages);
+            }
+            stratum.peHeaders = Estimate(stratum.peHeaderPages, stratum.sampledPages, readable);
+            stratum.highEntropy = Estimate(stratum.highEntropyPages, stratum.sampledPages, readable);
+            AddEstimate(sample.peHeaders, stratum.peHeaders);
+            AddEstimate(sample.highEntropy, stratum.highEntropy);
+        }
+        if (stopped || sample.strata[0].sampledPages + sample.strata[0].unreadablePages < sample.strata[0].pages) {
+            sample.flaggedComplete = false;
+        }
+
+        sample.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return sample;
+    }
+
+} // namespace ProcessScope
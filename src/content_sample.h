@@ -0,0 +1,99 @@
+#pragma once
+
+#include "util.h"
+#include "scan_context.h"
+#include <vector>
+
+namespace ProcessScope {
+
+    class MemorySource;
+
+    // Page contents looked for by the sampler
+    const BYTE kIndicatorPeHeader = 0x01;       // DOS and NT header at the page start, outside mapped images
+    const BYTE kIndicatorHighEntropy = 0x02;    // Over 7.2 bits per byte: compressed or encrypted payload
+
+    // Region classes sampled at different rates. Flagged regions (suspicious, executable private
+    // or carrying a PE header) are covered in full; the rest share what is left of the budget.
+    enum class SampleStratumKind { Flagged, ImageCode, ImageData, PrivateWritable, PrivateReadOnly, Mapped, Count };
+
+    const size_t kSampleStrata = static_cast<size_t>(SampleStratumKind::Count);
+
+    struct ContentSampleOptions {
+        ULONGLONG byteBudget;   // Bytes read per process; 0 disables sampling
+        ULONGLONG seed;         // Mixed with the PID and creation time, so a rescan picks the same pages
+
+        ContentSampleOptions() : byteBudget(0), seed(0) {}
+    };
+
+    // Estimated number of pages with an indicator and its 95% confidence interval
+    struct SampleEstimate {
+        double estimate;
+        double lower;
+        double upper;
+
+        SampleEstimate() : estimate(0), lower(0), upper(0) {}
+    };
+
+    struct SampleStratum {
+        size_t regions;
+        ULONGLONG pages;
+        ULONGLONG sampledPages;     // Read and inspected
+        ULONGLONG unreadablePages;  // Picked but not readable; left out of the estimates
+        ULONGLONG peHeaderPages;
+        ULONGLONG highEntropyPages;
+        SampleEstimate peHeaders;
+        SampleEstimate highEntropy;
+
+        SampleStratum() : regions(0), pages(0), sampledPages(0), unreadablePages(0), peHeaderPages(0), highEntropyPages(0) {}
+    };
+
+    struct SampleHit {
+        uintptr_t address;
+        BYTE indicators;
+
+        SampleHit() : address(0), indicators(0) {}
+    };
+
+    // Outcome of sampling one address space
+    struct ContentSample {
+        bool sampled;
+        ULONGLONG budgetBytes;
+        ULONGLONG bytesRead;
+        bool flaggedComplete;       // Every flagged page was inspected, so flagged counts are exact
+        SampleStratum strata[kSampleStrata];
+        SampleEstimate peHeaders;   // Whole address space: sums of the stratum estimates and bounds
+        SampleEstimate highEntropy;
+        std::vector<SampleHit> hits;    // The first kMaxSampleHits pages found, in address order per stratum
+        double elapsedMs;
+
+        ContentSample() : sampled(false), budgetBytes(0), bytesRead(0), flaggedComplete(true), elapsedMs(0) {}
+
+        static const char* StratumName(SampleStratumKind kind);
+    };
+
+    const size_t kMaxSampleHits = 64;
+
+    // Address range and the stratum it is sampled in
+    struct SampleRange {
+        uintptr_t baseAddress;
+        size_t size;
+        SampleStratumKind stratum;
+
+        SampleRange(uintptr_t base, size_t length, SampleStratumKind kind) : baseAddress(base), size(length), stratum(kind) {}
+    };
+
+    // Stratified random sampling of page contents within a byte budget. Flagged pages are read
+    // first and in full; if they alone exceed seven eighths of the budget they are sampled too.
+    // The remainder is split across the other strata in proportion to stratum size times a
+    // per-stratum weight, with at least a few pages for every non-empty stratum. Within a stratum,
+    // pages are picked by jittered systematic sampling: the stratum is cut into equal intervals
+    // and one random page is taken from each, so picks are spread out and come in address order.
+    // Estimates scale the hit rate to the stratum; bounds are Wilson score intervals, which stay
+    // meaningful when nothing was found, and are exact for fully read strata.
+    class ContentSampler {
+    public:
+        ContentSample Sample(MemorySource& source, const std::vector<SampleRange>& ranges,
+                             const ContentSampleOptions& options, const ScanContext& context);
+    };
+
+} // namespace ProcessScope
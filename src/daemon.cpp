@@ -0,0 +1,366 @@
+#include "daemon.h"
+#include "report.h"
+#include <cstring>
+
+namespace ProcessScope {
+
+    static const DWORD kPipeBufferSize = 64 * 1024;
+    static const DWORD kMaxFrameSize = 16 * 1024 * 1024;
+
+    // Bounds-checked little-endian reader over a request payload
+    class FrameReader {
+    private:
+        const std::vector<BYTE>& data_;
+        size_t offset_;
+        bool ok_;
+
+    public:
+        explicit FrameReader(const std::vector<BYTE>& data) : data_(data), offset_(0), ok_(true) {}
+
+        bool ok() const { return ok_; }
+
+        BYTE ReadByte() {
+            if (offset_ + 1 > data_.size()) {
+                ok_ = false;
+                return 0;
+            }
+            return data_[offset_++];
+        }
+
+        DWORD ReadU32() {
+            if (offset_ + 4 > data_.size()) {
+                ok_ = false;
+                return 0;
+            }
+            DWORD value = static_cast<DWORD>(data_[offset_]) |
+                          (static_cast<DWORD>(data_[offset_ + 1]) << 8) |
+                          (static_cast<DWORD>(data_[offset_ + 2]) << 16) |
+                          (static_cast<DWORD>(data_[offset_ + 3]) << 24);
+            offset_ += 4;
+            return value;
+        }
+
+        std::string ReadString() {
+            DWORD length = ReadU32();
+            if (!ok_ || offset_ + length > data_.size()) {
+                ok_ = false;
+                return std::string();
+            }
+            std::string value(reinterpret_cast<const char*>(data_.data() + offset_), length);
+            offset_ += length;
+            return value;
+        }
+    };
+
+    // One pipe instance opened for overlapped I/O. Each call waits for its operation or the
+    // daemon's stop event, whichever comes first, and cancels the operation on stop.
+    class PipeChannel {
+    private:
+        HANDLE pipe_;
+        HANDLE stopEvent_;
+        Handle ioEvent_;
+
+        bool Complete(OVERLAPPED& overlapped, BOOL started, DWORD& transferred) {
+            if (!started && GetLastError() != ERROR_IO_PENDING) {
+                return false;
+            }
+            HANDLE events[2] = { ioEvent_.get(), stopEvent_ };
+            if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0) {
+                // The OVERLAPPED lives on this stack frame, so wait for the cancel to land
+                CancelIoEx(pipe_, &overlapped);
+                GetOverlappedResult(pipe_, &overlapped, &transferred, TRUE);
+                return false;
+            }
+            return GetOverlappedResult(pipe_, &overlapped, &transferred, FALSE) != FALSE;
+        }
+
+        OVERLAPPED Start() {
+            OVERLAPPED overlapped = {};
+            overlapped.hEvent = ioEvent_.get();
+            return overlapped;
+        }
+
+    public:
+        PipeChannel(HANDLE pipe, HANDLE stopEvent)
+            : pipe_(pipe), stopEvent_(stopEvent), ioEvent_(CreateEventW(nullptr, TRUE, FALSE, nullptr)) {}
+
+        bool IsValid() const { return static_cast<bool>(ioEvent_); }
+
+        bool Connect() {
+            OVERLAPPED overlapped = Start();
+            if (ConnectNamedPipe(pipe_, &overlapped)) {
+                return true;
+            }
+            if (GetLastError() == ERROR_PIPE_CONNECTED) {
+                return true;
+            }
+            DWORD transferred = 0;
+            return Complete(overlapped, FALSE, transferred);
+        }
+
+        bool Read(BYTE* buffer, DWORD size, DWORD& bytesRead) {
+            OVERLAPPED overlapped = Start();
+            BOOL started = ReadFile(pipe_, buffer, size, nullptr, &overlapped);
+            return Complete(overlapped, started, bytesRead);
+        }
+
+        bool Write(const char* buffer, DWORD size, DWORD& written) {
+            OVERLAPPED overlapped = Start();
+            BOOL started = WriteFile(pipe_, buffer, size, nullptr, &overlapped);
+            return Complete(overlapped, started, written);
+        }
+    };
+
+    static bool ReadExact(PipeChannel& channel, BYTE* buffer, DWORD size) {
+        while (size > 0) {
+            DWORD bytesRead = 0;
+            if (!channel.Read(buffer, size, bytesRead) || bytesRead == 0) {
+                return false;
+            }
+            buffer += bytesRead;
+            size -= bytesRead;
+        }
+        return true;
+    }
+
+    static bool ReadFrame(PipeChannel& channel, std::vector<BYTE>& payload) {
+        BYTE header[4];
+        if (!ReadExact(channel, header, sizeof(header))) {
+            return false;
+        }
+        DWORD length = static_cast<DWORD>(header[0]) | (static_cast<DWORD>(header[1]) << 8) |
+                       (static_cast<DWORD>(header[2]) << 16) | (static_cast<DWORD>(header[3]) << 24);
+        if (length == 0 || length > kMaxFrameSize) {
+            return false;
+        }
+        payload.resize(length);
+        return ReadExact(channel, payload.data(), length);
+    }
+
+    static bool WriteFrame(PipeChannel& channel, DaemonResponse type, const std::string& body) {
+        // Header, type and body go out in one write so a frame is never interleaved
+        DWORD length = static_cast<DWORD>(body.size() + 1);
+        std::string frame;
+        frame.reserve(4 + length);
+        frame.push_back(static_cast<char>(length & 0xFF));
+        frame.push_back(static_cast<char>((length >> 8) & 0xFF));
+        frame.push_back(static_cast<char>((length >> 16) & 0xFF));
+        frame.push_back(static_cast<char>((length >> 24) & 0xFF));
+        frame.push_back(static_cast<char>(type));
+        frame += body;
+
+        const char* cursor = frame.data();
+        DWORD remaining = static_cast<DWORD>(frame.size());
+        while (remaining > 0) {
+            DWORD written = 0;
+            if (!channel.Write(cursor, remaining, written) || written == 0) {
+                return false;
+            }
+            cursor += written;
+            remaining -= written;
+        }
+        return true;
+    }
+
+    ScanDaemon::ScanDaemon(const DaemonOptions& options) : options_(options) {
+        pipePath_ = L"\\\\.\\pipe\\" + StringToWString(options_.pipeName);
+        if (options_.workerCount == 0) {
+            options_.workerCount = 1;
+        }
+    }
+
+    ScanDaemon::~ScanDaemon() {
+        Stop();
+    }
+
+    bool ScanDaemon::Start(std::string& error) {
+        stopEvent_ = Handle(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+        if (!stopEvent_) {
+            error = "Failed to create stop event: " + GetLastErrorString();
+            return false;
+        }
+
+        // Create every instance up front; the first claims the name so a second daemon fails fast
+        for (unsigned i = 0; i < options_.workerCount; i++) {
+            DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (i == 0 ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+            HANDLE pipe = CreateNamedPipeW(pipePath_.c_str(), openMode,
+                                           PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                           PIPE_UNLIMITED_INSTANCES, kPipeBufferSize, kPipeBufferSize, 0, nullptr);
+            if (pipe == INVALID_HANDLE_VALUE) {
+                error = "Failed to create pipe " + WStringToString(pipePath_) + ": " + GetLastErrorString();
+                for (HANDLE created : pipes_) {
+                    CloseHandle(created);
+                }
+                pipes_.clear();
+                return false;
+            }
+            pipes_.push_back(pipe);
+        }
+
+        for (HANDLE pipe : pipes_) {
+            workers_.emplace_back(&ScanDaemon::WorkerLoop, this, pipe);
+        }
+        return true;
+    }
+
+    void ScanDaemon::Stop() {
+        if (workers_.empty()) {
+            return;
+        }
+
+        // Cancels in-flight scans; the event ends every pipe wait, whether it has started yet or not
+        stop_.Cancel();
+        SetEvent(stopEvent_.get());
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+
+        for (HANDLE pipe : pipes_) {
+            CloseHandle(pipe);
+        }
+        pipes_.clear();
+    }
+
+    void ScanDaemon::WorkerLoop(HANDLE pipe) {
+        // One warm scanner per worker for the daemon's lifetime
+        ProcessScanner scanner;
+        if (options_.metrics) {
+            scanner.SetMetrics(options_.metrics->CreateShard());
+        }
+
+        PipeChannel channel(pipe, stopEvent_.get());
+        if (!channel.IsValid()) {
+            return;
+        }
+        while (!stop_.IsCancelled()) {
+            bool connected = channel.Connect();
+            if (stop_.IsCancelled()) {
+                break;
+            }
+            if (connected) {
+                ServeClient(channel, scanner);
+                // Blocks until the client has read everything, so only when not stopping
+                if (!stop_.IsCancelled()) {
+                    FlushFileBuffers(pipe);
+                }
+            }
+            DisconnectNamedPipe(pipe);
+        }
+    }
+
+    void ScanDaemon::ServeClient(PipeChannel& channel, ProcessScanner& scanner) {
+        std::vector<BYTE> request;
+        while (!stop_.IsCancelled() && ReadFrame(channel, request)) {
+            if (!HandleRequest(channel, scanner, request)) {
+                break;
+            }
+        }
+    }
+
+    bool ScanDaemon::HandleRequest(PipeChannel& channel, ProcessScanner& scanner, const std::vector<BYTE>& request) {
+        FrameReader reader(request);
+        BYTE type = reader.ReadByte();
+
+        // Cancelled when the daemon stops or the client goes away mid-stream
+        CancellationToken requestCancel(&stop_);
+        bool writeOk = true;
+
+        if (type == static_cast<BYTE>(DaemonRequest::Scan)) {
+            ScanOptions scanOptions;
+            scanOptions.timeoutMs = reader.ReadU32();
+            scanOptions.cancellation = &requestCancel;
+            DWORD count = reader.ReadU32();
+            std::vector<DWORD> pids;
+            for (DWORD i = 0; reader.ok() && i < count; i++) {
+                pids.push_back(reader.ReadU32());
+            }
+            if (!reader.ok()) {
+                return WriteFrame(channel, DaemonResponse::Error, "Malformed scan request") &&
+                       WriteFrame(channel, DaemonResponse::Done, "{}");
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            size_t succeeded = 0;
+            for (DWORD pid : pids) {
+                if (requestCancel.IsCancelled()) {
+                    break;
+                }
+                ScanResult result = scanner.ScanProcess(pid, scanOptions);
+                if (result.success) {
+                    succeeded++;
+                    writeOk = WriteFrame(channel, DaemonResponse::Result, SerializeScanResult(result, -1));
+                } else {
+                    writeOk = WriteFrame(channel, DaemonResponse::Error, "PID " + std::to_string(pid) + ": " + result.errorMessage);
+                }
+                if (!writeOk) {
+                    return false;
+                }
+            }
+
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return WriteFrame(channel, DaemonResponse::Done,
+                              "{\"scanned\":" + std::to_string(pids.size()) +
+                              ",\"succeeded\":" + std::to_string(succeeded) +
+                              ",\"elapsed_ms\":" + std::to_string(elapsedMs) + "}");
+        }
+
+        if (type == static_cast<BYTE>(DaemonRequest::List) || type == static_cast<BYTE>(DaemonRequest::Sweep)) {
+            SweepOptions sweepOptions;
+            sweepOptions.scan.cancellation = &requestCancel;
+            if (type == static_cast<BYTE>(DaemonRequest::Sweep)) {
+                sweepOptions.scan.timeoutMs = reader.ReadU32();
+                int threshold = static_cast<int>(reader.ReadU32());
+                sweepOptions.triageEnabled = threshold >= 0;
+                sweepOptions.triageThreshold = threshold;
+            }
+            std::string expression = reader.ReadString();
+            if (!reader.ok()) {
+                return WriteFrame(channel, DaemonResponse::Error, "Malformed request") &&
+                       WriteFrame(channel, DaemonResponse::Done, "{}");
+            }
+
+            ProcessFilter filter;
+            if (!expression.empty()) {
+                std::string error;
+                if (!filter.Compile(expression, error)) {
+                    return WriteFrame(channel, DaemonResponse::Error, "Invalid filter: " + error) &&
+                           WriteFrame(channel, DaemonResponse::Done, "{}");
+                }
+                sweepOptions.filter = &filter;
+            }
+
+            if (type == static_cast<BYTE>(DaemonRequest::List)) {
+                std::vector<ProcessInfo> processes = scanner.Backend().EnumerateProcesses(sweepOptions.filter);
+                return WriteFrame(channel, DaemonResponse::List, SerializeProcessList(processes, -1)) &&
+                       WriteFrame(channel, DaemonResponse::Done, "{\"count\":" + std::to_string(processes.size()) + "}");
+            }
+
+            // Stream each result back the moment it completes
+            SweepCallbacks callbacks;
+            callbacks.onResult = [&](const ScanResult& result) {
+                if (writeOk && result.success) {
+                    writeOk = WriteFrame(channel, DaemonResponse::Result, SerializeScanResult(result, -1));
+                    if (!writeOk) {
+                        requestCancel.Cancel();
+                    }
+                }
+            };
+
+            SweepSummary summary = scanner.Sweep(sweepOptions, callbacks);
+            if (!writeOk) {
+                return false;
+            }
+            return WriteFrame(channel, DaemonResponse::Done,
+                              "{\"scanned\":" + std::to_string(summary.totalCount) +
+                              ",\"succeeded\":" + std::to_string(summary.successCount) +
+                              ",\"truncated\":" + std::to_string(summary.truncatedCount) +
+                              ",\"tier2\":" + std::to_string(summary.triage.tier2Processes) +
+                              ",\"elapsed_ms\":" + std::to_string(summary.elapsedMs) + "}");
+        }
+
+        return WriteFrame(channel, DaemonResponse::Error, "Unknown request type " + std::to_string(type)) &&
+               WriteFrame(channel, DaemonResponse::Done, "{}");
+    }
+
+} // namespace ProcessScope
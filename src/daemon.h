@@ -0,0 +1,73 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include "metrics.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Wire protocol. Every message is a frame: [uint32 little-endian payload length][payload].
+    // Request payload is [uint8 type][body]; strings are [uint32 length][UTF-8 bytes].
+    //   Scan  (1): [uint32 timeoutMs][uint32 count][uint32 pid] * count
+    //   List  (2): [string filter]
+    //   Sweep (3): [uint32 timeoutMs][int32 triageThreshold, -1 = off][string filter]
+    // Response payload is [uint8 type][body]; one request yields any number of frames ending in Done.
+    //   Result (1): compact JSON scan report, streamed as soon as each scan completes
+    //   List   (2): compact JSON process array
+    //   Error  (3): UTF-8 message
+    //   Done   (4): compact JSON summary
+    enum class DaemonRequest : BYTE {
+        Scan = 1,
+        List = 2,
+        Sweep = 3
+    };
+
+    enum class DaemonResponse : BYTE {
+        Result = 1,
+        List = 2,
+        Error = 3,
+        Done = 4
+    };
+
+    struct DaemonOptions {
+        std::string pipeName;
+        unsigned workerCount;
+        ScanMetrics* metrics;   // Each worker records into its own shard; may be null
+
+        DaemonOptions() : pipeName("ProcessScope"), workerCount(4), metrics(nullptr) {}
+    };
+
+    class PipeChannel;
+
+    // Long-lived scan service on a local named pipe (\\.\pipe\<name>). Each worker thread owns a
+    // pipe instance and a warm ProcessScanner and serves one client at a time; the export-table
+    // and signature caches are process-wide, so they stay warm across requests. Pipe I/O is
+    // overlapped and every wait also watches the stop event, so Stop() never waits on a client.
+    class ScanDaemon {
+    private:
+        DaemonOptions options_;
+        std::wstring pipePath_;
+        CancellationToken stop_;
+        Handle stopEvent_;
+        std::vector<HANDLE> pipes_;
+        std::vector<std::thread> workers_;
+
+        void WorkerLoop(HANDLE pipe);
+        void ServeClient(PipeChannel& channel, ProcessScanner& scanner);
+        bool HandleRequest(PipeChannel& channel, ProcessScanner& scanner, const std::vector<BYTE>& request);
+
+    public:
+        explicit ScanDaemon(const DaemonOptions& options);
+        ~ScanDaemon();
+        ScanDaemon(const ScanDaemon&) = delete;
+        ScanDaemon& operator=(const ScanDaemon&) = delete;
+
+        bool Start(std::string& error);
+        void Stop();
+        const std::wstring& PipePath() const { return pipePath_; }
+    };
+
+} // namespace ProcessScope
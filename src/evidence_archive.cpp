@@ -0,0 +1,295 @@
+#include "evidence_archive.h"
+#include "report.h"
+#include "remote_memory.h"
+#include "json.hpp"
+#include <cstring>
+
+#pragma comment(lib, "bcrypt.lib")
+
+using json = nlohmann::json;
+
+namespace ProcessScope {
+
+    static const char kArchiveMagic[8] = { 'P', 'S', 'D', 'U', 'M', 'P', '1', '\0' };
+    static const DWORD kArchiveVersion = 1;
+
+    // Sequential write size; large writes keep the archive cheap even on slow disks
+    static const size_t kWriteBufferSize = 4 * 1024 * 1024;
+
+    // Pages read from the target per batch
+    static const size_t kReadWindowPages = 256;
+
+    static bool IsZeroPage(const BYTE* page, size_t size) {
+        const ULONGLONG* words = reinterpret_cast<const ULONGLONG*>(page);
+        for (size_t i = 0; i < size / sizeof(ULONGLONG); i++) {
+            if (words[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static std::string ToHexString(const BYTE* data, size_t size) {
+        static const char kDigits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(size * 2);
+        for (size_t i = 0; i < size; i++) {
+            hex.push_back(kDigits[data[i] >> 4]);
+            hex.push_back(kDigits[data[i] & 0x0F]);
+        }
+        return hex;
+    }
+
+    static std::string FormatAddress(uintptr_t address) {
+        std::stringstream ss;
+        ss << "0x" << std::hex << address;
+        return ss.str();
+    }
+
+    bool EvidenceArchive::PageHash::operator==(const PageHash& other) const {
+        return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+    }
+
+    size_t EvidenceArchive::PageHashHasher::operator()(const PageHash& hash) const {
+        // SHA-256 output is already uniformly distributed
+        size_t value;
+        memcpy(&value, hash.bytes, sizeof(value));
+        return value;
+    }
+
+    EvidenceArchive::EvidenceArchive() : pageSize_(GetSystemPageSize()), buffered_(0), algorithm_(nullptr) {}
+
+    EvidenceArchive::~EvidenceArchive() {
+        if (algorithm_) {
+            BCryptCloseAlgorithmProvider(algorithm_, 0);
+        }
+    }
+
+    bool EvidenceArchive::Open(const std::string& path, std::string& error) {
+        if (!algorithm_) {
+            DWORD objectLength = 0;
+            ULONG resultLength = 0;
+            if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&algorithm_, BCRYPT_SHA256_ALGORITHM, nullptr, 0)) ||
+                !BCRYPT_SUCCESS(BCryptGetProperty(algorithm_, BCRYPT_OBJECT_LENGTH, reinterpret_cast<PUCHAR>(&objectLength),
+                                                  sizeof(objectLength), &resultLength, 0))) {
+                error = "SHA-256 provider unavailable";
+                return false;
+            }
+            hashObject_.resize(objectLength);
+        }
+
+        file_ = Handle(CreateFileW(StringToWString(path).c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                   CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+        if (!file_) {
+            error = "Failed to create " + path + ": " + GetLastErrorString();
+            return false;
+        }
+
+        // Reserve the header page; it is filled in by Close()
+        writeBuffer_.assign(kWriteBufferSize, 0);
+        buffered_ = pageSize_;
+        return true;
+    }
+
+    bool EvidenceArchive::Append(const void* data, size_t size) {
+        const BYTE* bytes = static_cast<const BYTE*>(data);
+        while (size > 0) {
+            size_t chunk = (std::min)(size, writeBuffer_.size() - buffered_);
+            memcpy(writeBuffer_.data() + buffered_, bytes, chunk);
+            buffered_ += chunk;
+            bytes += chunk;
+            size -= chunk;
+            if (buffered_ == writeBuffer_.size() && !Flush()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool EvidenceArchive::Flush() {
+        size_t offset = 0;
+        while (offset < buffered_) {
+            DWORD written = 0;
+            if (!WriteFile(file_.get(), writeBuffer_.data() + offset, static_cast<DWORD>(buffered_ - offset), &written, nullptr) ||
+                written == 0) {
+                return false;
+            }
+            offset += written;
+        }
+        stats_.bytesWritten += buffered_;
+        buffered_ = 0;
+        return true;
+    }
+
+    bool EvidenceArchive::HashPage(const BYTE* page, PageHash& hash) {
+        BCRYPT_HASH_HANDLE hashHandle = nullptr;
+        bool ok = BCRYPT_SUCCESS(BCryptCreateHash(algorithm_, &hashHandle, hashObject_.data(),
+                                                  static_cast<ULONG>(hashObject_.size()), nullptr, 0, 0)) &&
+                  BCRYPT_SUCCESS(BCryptHashData(hashHandle, const_cast<PUCHAR>(page), static_cast<ULONG>(pageSize_), 0)) &&
+                  BCRYPT_SUCCESS(BCryptFinishHash(hashHandle, hash.bytes, sizeof(hash.bytes), 0));
+        if (hashHandle) {
+            BCryptDestroyHash(hashHandle);
+        }
+        return ok;
+    }
+
+    bool EvidenceArchive::StorePage(const BYTE* page, LONGLONG& pageNumber) {
+        PageHash hash;
+        if (!HashPage(page, hash)) {
+            return false;
+        }
+
+        auto existing = pageIndex_.find(hash);
+        if (existing != pageIndex_.end()) {
+            pageNumber = existing->second;
+            return true;
+        }
+
+        pageNumber = static_cast<LONGLONG>(pageHashes_.size());
+        if (!Append(page, pageSize_)) {
+            return false;
+        }
+        pageHashes_.push_back(hash);
+        pageIndex_.emplace(hash, pageNumber);
+        stats_.uniquePages++;
+        return true;
+    }
+
+    bool EvidenceArchive::AddProcess(const ScanResult& result, std::string& error) {
+        if (!IsOpen()) {
+            error = "Archive is not open";
+            return false;
+        }
+
+        Handle hProcess(OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, result.processInfo.pid));
+        if (!hProcess) {
+            error = "Failed to open process: " + GetLastErrorString();
+            return false;
+        }
+
+        ProcessEntry entry;
+        entry.pid = result.processInfo.pid;
+        entry.name = result.processInfo.name;
+        entry.fullPath = result.processInfo.fullPath;
+        entry.riskScore = result.riskAssessment.score;
+        entry.riskLevel = GetRiskLevelName(result.riskAssessment.level);
+
+        // Every page is read exactly once, so the reader runs without a cache
+        RemoteMemoryReader reader(hProcess.get(), 0);
+        std::vector<BYTE> window(kReadWindowPages * pageSize_);
+        std::vector<ReadRequest> requests;
+
+        for (const auto& region : result.memoryRegions) {
+            if (!region.isSuspicious) {
+                continue;
+            }
+
+            RegionEntry regionEntry;
+            regionEntry.baseAddress = region.baseAddress;
+            regionEntry.size = region.size;
+            regionEntry.protection = region.protection;
+            regionEntry.type = region.type;
+
+            size_t pageCount = (region.size + pageSize_ - 1) / pageSize_;
+            regionEntry.pages.reserve(pageCount);
+            for (size_t first = 0; first < pageCount; first += kReadWindowPages) {
+                size_t count = (std::min)(kReadWindowPages, pageCount - first);
+                requests.clear();
+                for (size_t i = 0; i < count; i++) {
+                    requests.emplace_back(region.baseAddress + (first + i) * pageSize_, pageSize_, &window[i * pageSize_]);
+                }
+                reader.ReadBatch(requests);
+
+                for (size_t i = 0; i < count; i++) {
+                    const BYTE* page = &window[i * pageSize_];
+                    LONGLONG pageNumber;
+                    if (requests[i].bytesRead < pageSize_) {
+                        pageNumber = kUnreadablePage;
+                        stats_.unreadablePages++;
+                    } else if (IsZeroPage(page, pageSize_)) {
+                        pageNumber = kZeroPage;
+                        stats_.zeroPages++;
+                    } else if (!StorePage(page, pageNumber)) {
+                        error = "Failed to store page: " + GetLastErrorString();
+                        return false;
+                    }
+                    regionEntry.pages.push_back(pageNumber);
+                    stats_.pages++;
+                }
+            }
+
+            entry.regions.push_back(std::move(regionEntry));
+            stats_.regions++;
+        }
+
+        processes_.push_back(std::move(entry));
+        stats_.processes++;
+        return true;
+    }
+
+    bool EvidenceArchive::Close(std::string& error) {
+        if (!IsOpen()) {
+            return true;
+        }
+
+        json index;
+        index["page_size"] = pageSize_;
+        index["timestamp"] = GetTimestamp();
+        index["pages"] = json::array();
+        for (const auto& hash : pageHashes_) {
+            index["pages"].push_back(ToHexString(hash.bytes, sizeof(hash.bytes)));
+        }
+        index["processes"] = json::array();
+        for (const auto& process : processes_) {
+            json p;
+            p["pid"] = process.pid;
+            p["name"] = process.name;
+            p["full_path"] = process.fullPath;
+            p["risk_score"] = process.riskScore;
+            p["risk_level"] = process.riskLevel;
+            p["regions"] = json::array();
+            for (const auto& region : process.regions) {
+                json r;
+                r["base_address"] = FormatAddress(region.baseAddress);
+                r["size"] = region.size;
+                r["protection"] = region.protection;
+                r["type"] = region.type;
+                r["pages"] = region.pages;
+                p["regions"].push_back(r);
+            }
+            index["processes"].push_back(p);
+        }
+
+        ULONGLONG indexOffset = (static_cast<ULONGLONG>(pageHashes_.size()) + 1) * pageSize_;
+        std::string indexText = index.dump();
+        if (!Append(indexText.data(), indexText.size()) || !Flush()) {
+            error = "Failed to write archive index: " + GetLastErrorString();
+            file_ = Handle();
+            return false;
+        }
+
+        // Header fields, little-endian
+        BYTE header[48] = {};
+        ULONGLONG pageCount = pageHashes_.size();
+        ULONGLONG indexSize = indexText.size();
+        DWORD pageSize = static_cast<DWORD>(pageSize_);
+        memcpy(header, kArchiveMagic, sizeof(kArchiveMagic));
+        memcpy(header + 8, &kArchiveVersion, sizeof(DWORD));
+        memcpy(header + 12, &pageSize, sizeof(DWORD));
+        memcpy(header + 16, &pageCount, sizeof(ULONGLONG));
+        memcpy(header + 24, &indexOffset, sizeof(ULONGLONG));
+        memcpy(header + 32, &indexSize, sizeof(ULONGLONG));
+
+        LARGE_INTEGER start;
+        start.QuadPart = 0;
+        DWORD written = 0;
+        bool ok = SetFilePointerEx(file_.get(), start, nullptr, FILE_BEGIN) &&
+                  WriteFile(file_.get(), header, sizeof(header), &written, nullptr) && written == sizeof(header);
+        if (!ok) {
+            error = "Failed to write archive header: " + GetLastErrorString();
+        }
+        file_ = Handle();
+        return ok;
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include <bcrypt.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Totals for an archive; uniquePages * page size is roughly the payload on disk
+    struct DumpStats {
+        size_t processes;
+        size_t regions;
+        size_t pages;
+        size_t zeroPages;
+        size_t unreadablePages;
+        size_t uniquePages;
+        ULONGLONG bytesWritten;
+
+        DumpStats() : processes(0), regions(0), pages(0), zeroPages(0), unreadablePages(0), uniquePages(0), bytesWritten(0) {}
+    };
+
+    // Content-addressed dump of suspicious regions. File layout:
+    //   [header, one page]  magic "PSDUMP1", version, page size, page count, index offset and size
+    //   [page 0][page 1]... each distinct page exactly once, page n at offset (n + 1) * page size
+    //   [index]             JSON: SHA-256 per stored page, and process -> region -> page numbers,
+    //                       where -1 is an all-zero page and -2 an unreadable one
+    // Pages are written through a large buffer, so the file is produced by sequential multi-megabyte writes.
+    class EvidenceArchive {
+    private:
+        struct PageHash {
+            BYTE bytes[32];
+            bool operator==(const PageHash& other) const;
+        };
+        struct PageHashHasher {
+            size_t operator()(const PageHash& hash) const;
+        };
+        struct RegionEntry {
+            uintptr_t baseAddress;
+            size_t size;
+            std::string protection;
+            std::string type;
+            std::vector<LONGLONG> pages;
+        };
+        struct ProcessEntry {
+            DWORD pid;
+            std::string name;
+            std::string fullPath;
+            int riskScore;
+            std::string riskLevel;
+            std::vector<RegionEntry> regions;
+        };
+
+        Handle file_;
+        size_t pageSize_;
+        std::vector<BYTE> writeBuffer_;
+        size_t buffered_;
+        std::unordered_map<PageHash, LONGLONG, PageHashHasher> pageIndex_;
+        std::vector<PageHash> pageHashes_;
+        std::vector<ProcessEntry> processes_;
+        DumpStats stats_;
+        BCRYPT_ALG_HANDLE algorithm_;
+        std::vector<BYTE> hashObject_;
+
+        bool Append(const void* data, size_t size);
+        bool Flush();
+        bool HashPage(const BYTE* page, PageHash& hash);
+        bool StorePage(const BYTE* page, LONGLONG& pageNumber);
+
+    public:
+        static const LONGLONG kZeroPage = -1;
+        static const LONGLONG kUnreadablePage = -2;
+
+        EvidenceArchive();
+        ~EvidenceArchive();
+        EvidenceArchive(const EvidenceArchive&) = delete;
+        EvidenceArchive& operator=(const EvidenceArchive&) = delete;
+
+        bool Open(const std::string& path, std::string& error);
+
+        // Reopens the process and stores every region the scan flagged as suspicious
+        bool AddProcess(const ScanResult& result, std::string& error);
+
+        // Writes the index and patches the header; the archive is unusable until this succeeds
+        bool Close(std::string& error);
+
+        bool IsOpen() const { return static_cast<bool>(file_); }
+        const DumpStats& Stats() const { return stats_; }
+    };
+
+} // namespace ProcessScope
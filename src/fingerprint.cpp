@@ -0,0 +1,178 @@
+#include "fingerprint.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ProcessScope {
+
+    static const ULONGLONG kPrime1 = 11400714785074694791ULL;
+    static const ULONGLONG kPrime2 = 14029467366897019727ULL;
+    static const ULONGLONG kPrime3 = 1609587929392839161ULL;
+    static const ULONGLONG kPrime4 = 9650029242287828579ULL;
+    static const ULONGLONG kPrime5 = 2870177450012600261ULL;
+
+    static inline ULONGLONG RotateLeft(ULONGLONG value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static inline ULONGLONG Load64(const BYTE* data) {
+        ULONGLONG value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static inline ULONGLONG Round(ULONGLONG accumulator, ULONGLONG input) {
+        accumulator += input * kPrime2;
+        accumulator = RotateLeft(accumulator, 31);
+        return accumulator * kPrime1;
+    }
+
+    static inline ULONGLONG MergeRound(ULONGLONG accumulator, ULONGLONG value) {
+        accumulator ^= Round(0, value);
+        return accumulator * kPrime1 + kPrime4;
+    }
+
+    void NormalizeRegionBytes(BYTE* data, size_t size, uintptr_t regionBase, size_t regionSize) {
+        ULONGLONG low = regionBase;
+        ULONGLONG high = static_cast<ULONGLONG>(regionBase) + regionSize;
+
+        for (size_t offset = 0; offset + sizeof(ULONGLONG) <= size; offset += sizeof(ULONGLONG)) {
+            ULONGLONG value = Load64(data + offset);
+            if (value >= low && value < high) {
+                value -= low;
+                memcpy(data + offset, &value, sizeof(value));
+            }
+        }
+
+        // 32-bit targets store 4-byte pointers; only possible when the region sits below 4 GB
+        if (high <= 0xFFFFFFFFULL) {
+            for (size_t offset = 0; offset + sizeof(DWORD) <= size; offset += sizeof(DWORD)) {
+                DWORD value;
+                memcpy(&value, data + offset, sizeof(value));
+                if (value >= low && value < high) {
+                    value -= static_cast<DWORD>(low);
+                    memcpy(data + offset, &value, sizeof(value));
+                }
+            }
+        }
+    }
+
+    ULONGLONG HashBytes(const BYTE* data, size_t size, ULONGLONG seed) {
+        const BYTE* cursor = data;
+        const BYTE* end = data + size;
+        ULONGLONG hash;
+
+        if (size >= 32) {
+            ULONGLONG v1 = seed + kPrime1 + kPrime2;
+            ULONGLONG v2 = seed + kPrime2;
+            ULONGLONG v3 = seed;
+            ULONGLONG v4 = seed - kPrime1;
+            const BYTE* limit = end - 32;
+            do {
+                v1 = Round(v1, Load64(cursor));
+                v2 = Round(v2, Load64(cursor + 8));
+                v3 = Round(v3, Load64(cursor + 16));
+                v4 = Round(v4, Load64(cursor + 24));
+                cursor += 32;
+            } while (cursor <= limit);
+
+            hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        } else {
+            hash = seed + kPrime5;
+        }
+
+        hash += static_cast<ULONGLONG>(size);
+
+        while (cursor + 8 <= end) {
+            hash ^= Round(0, Load64(cursor));
+            hash = RotateLeft(hash, 27) * kPrime1 + kPrime4;
+            cursor += 8;
+        }
+        if (cursor + 4 <= end) {
+            DWORD value;
+            memcpy(&value, cursor, sizeof(value));
+            hash ^= static_cast<ULONGLONG>(value) * kPrime1;
+            hash = RotateLeft(hash, 23) * kPrime2 + kPrime3;
+            cursor += 4;
+        }
+        while (cursor < end) {
+            hash ^= static_cast<ULONGLONG>(*cursor) * kPrime5;
+            hash = RotateLeft(hash, 11) * kPrime1;
+            cursor++;
+        }
+
+        hash ^= hash >> 33;
+        hash *= kPrime2;
+        hash ^= hash >> 29;
+        hash *= kPrime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    ULONGLONG FingerprintRegion(BYTE* prefix, size_t prefixSize, uintptr_t regionBase, size_t regionSize) {
+        NormalizeRegionBytes(prefix, prefixSize, regionBase, regionSize);
+        ULONGLONG fingerprint = HashBytes(prefix, prefixSize, static_cast<ULONGLONG>(regionSize));
+        // Zero is reserved for "not fingerprinted"
+        return fingerprint != 0 ? fingerprint : 1;
+    }
+
+    std::string FingerprintToString(ULONGLONG fingerprint) {
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << fingerprint;
+        return ss.str();
+    }
+
+    void FingerprintIndex::Add(DWORD pid, const std::string& processName, uintptr_t baseAddress, size_t size,
+                               const std::string& protection, bool isSuspicious, ULONGLONG fingerprint) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        RegionCluster& cluster = clusters_[fingerprint];
+        if (cluster.members.empty()) {
+            cluster.fingerprint = fingerprint;
+            cluster.size = size;
+            cluster.protection = protection;
+        }
+        cluster.isSuspicious = cluster.isSuspicious || isSuspicious;
+        bool newProcess = std::none_of(cluster.members.begin(), cluster.members.end(),
+                                       [pid](const ClusterMember& existing) { return existing.pid == pid; });
+        if (newProcess) {
+            cluster.processCount++;
+        }
+
+        ClusterMember member;
+        member.pid = pid;
+        member.processName = processName;
+        member.baseAddress = baseAddress;
+        cluster.members.push_back(member);
+    }
+
+    size_t FingerprintIndex::ProcessCount(ULONGLONG fingerprint) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = clusters_.find(fingerprint);
+        return it != clusters_.end() ? it->second.processCount : 0;
+    }
+
+    std::vector<RegionCluster> FingerprintIndex::Clusters(size_t minProcesses) const {
+        std::vector<RegionCluster> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& entry : clusters_) {
+                if (entry.second.processCount >= minProcesses) {
+                    result.push_back(entry.second);
+                }
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const RegionCluster& a, const RegionCluster& b) {
+            return a.processCount != b.processCount ? a.processCount > b.processCount : a.fingerprint < b.fingerprint;
+        });
+        return result;
+    }
+
+    size_t FingerprintIndex::UniqueCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return clusters_.size();
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "util.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Bytes of each executable private region that are fingerprinted
+    const size_t kFingerprintBytes = 64 * 1024;
+
+    // Rewrite absolute pointers into the region as offsets from its base, so copies of the same
+    // code mapped at different addresses normalize to the same bytes
+    void NormalizeRegionBytes(BYTE* data, size_t size, uintptr_t regionBase, size_t regionSize);
+
+    // XXH64-style hash: four independent 64-bit lanes that compilers keep in vector registers
+    ULONGLONG HashBytes(const BYTE* data, size_t size, ULONGLONG seed = 0);
+
+    // Fingerprint of a normalized region prefix; the region size is mixed in so a stub and a
+    // larger region that starts with it do not collide
+    ULONGLONG FingerprintRegion(BYTE* prefix, size_t prefixSize, uintptr_t regionBase, size_t regionSize);
+
+    std::string FingerprintToString(ULONGLONG fingerprint);
+
+    // One process holding a copy of a clustered region
+    struct ClusterMember {
+        DWORD pid;
+        std::string processName;
+        uintptr_t baseAddress;
+    };
+
+    // Identical regions found across the processes of a run
+    struct RegionCluster {
+        ULONGLONG fingerprint;
+        size_t size;
+        std::string protection;
+        bool isSuspicious;
+        size_t processCount;    // Distinct PIDs among members
+        std::vector<ClusterMember> members;
+
+        RegionCluster() : fingerprint(0), size(0), isSuspicious(false), processCount(0) {}
+    };
+
+    // Run-wide fingerprint table shared by every scan in a sweep (or daemon lifetime).
+    // Thread-safe; lookups used by the risk engine take the same lock as inserts.
+    class FingerprintIndex {
+    private:
+        mutable std::mutex mutex_;
+        std::unordered_map<ULONGLONG, RegionCluster> clusters_;
+
+    public:
+        void Add(DWORD pid, const std::string& processName, uintptr_t baseAddress, size_t size,
+                 const std::string& protection, bool isSuspicious, ULONGLONG fingerprint);
+
+        // Distinct processes already holding this fingerprint
+        size_t ProcessCount(ULONGLONG fingerprint) const;
+
+        // Clusters seen in at least minProcesses processes, most widespread first
+        std::vector<RegionCluster> Clusters(size_t minProcesses) const;
+
+        size_t UniqueCount() const;
+    };
+
+} // namespace ProcessScope
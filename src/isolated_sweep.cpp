@@ -0,0 +1,747 @@
+#include "isolated_sweep.h"
+#include "result_codec.h"
+#include "metrics.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace ProcessScope {
+
+    static const DWORD kSharedMagic = 0x57535350;     // "PSSW"
+    static const DWORD kSharedVersion = 4;
+    static const size_t kCacheLine = 64;
+
+    // Largest single result accepted from a ring; anything bigger means the stream is corrupt
+    static const DWORD kMaxRecordBytes = 256u << 20;
+    static const DWORD kMinRingBytes = 64u << 10;
+    static const DWORD kMaxRingBytes = 1u << 30;
+
+    static const DWORD kDefaultHangGraceMs = 10000;
+    static const DWORD kUnlimitedHangTimeoutMs = 300000;   // When scans have no budget of their own
+    static const DWORD kPollIntervalMs = 2;
+    static const DWORD kMonitorIntervalMs = 50;
+
+    // A worker that dies this many times in a row before claiming anything is not restarted
+    static const int kMaxStartFailures = 3;
+
+    static const UINT kHungExitCode = 0xDEAD;
+    static const int kWorkerSetupFailed = 2;
+    static const int kWorkerOrphaned = 3;
+
+    // Queue entry states. Entries start Blocked when their partition limits concurrency and are
+    // released by the supervisor; a worker claims a Ready entry by swapping in kEntryClaimed plus
+    // its slot, so the owner of every claim is known even if the worker dies straight after.
+    static const LONG kEntryBlocked = 0;
+    static const LONG kEntryReady = 1;
+    static const LONG kEntrySkipped = 2;
+    static const LONG kEntryClaimed = 0x100;
+
+    struct SharedHeader {
+        DWORD magic;
+        DWORD version;
+        DWORD supervisorPid;
+        DWORD slotCount;
+        DWORD ringBytes;
+        DWORD entryCount;
+        DWORD timeoutMs;
+        DWORD reserved;
+        ULONGLONG sampleBudget;
+        ULONGLONG sampleSeed;
+        DWORD stringCount;
+        DWORD stringMinLength;
+        ULONGLONG stringBudget;
+        DWORD threadSampleRounds;
+        DWORD threadSampleIntervalMs;
+        ULONGLONG queueOffset;
+        ULONGLONG slotsOffset;
+        ULONGLONG slotStride;
+        ULONGLONG totalBytes;
+        volatile LONG firstOpen;        // No entry before this one is Blocked or Ready
+        volatile LONG stop;
+    };
+
+    struct QueueEntry {
+        ULONGLONG infoOffset;
+        DWORD infoSize;
+        DWORD pid;
+        volatile LONG state;
+        DWORD reserved;
+    };
+
+    // Head and tail live on separate cache lines so producer and consumer do not share one
+    struct WorkerSlot {
+        volatile LONG64 head;           // Bytes ever written; advanced by the worker only
+        BYTE headPadding[kCacheLine - sizeof(LONG64)];
+        volatile LONG64 tail;           // Bytes ever consumed; advanced by the supervisor only
+        BYTE tailPadding[kCacheLine - sizeof(LONG64)];
+        volatile LONG64 scanStartTick;  // Written before currentEntry
+        volatile LONG currentEntry;     // -1 while idle
+        volatile LONG finished;         // Set when the worker leaves its loop normally
+        volatile LONG suspendedThread;  // TID the worker holds suspended while sampling, else 0
+    };
+
+    struct RecordHeader {
+        DWORD entry;
+        DWORD length;
+    };
+
+    static size_t AlignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Interlocked accesses are full barriers, which orders the ring bytes against head and tail
+    static LONG64 LoadShared(volatile LONG64* value) {
+        return InterlockedCompareExchange64(value, 0, 0);
+    }
+
+    static LONG LoadShared(volatile LONG* value) {
+        return InterlockedCompareExchange(value, 0, 0);
+    }
+
+    static WorkerSlot* SlotAt(BYTE* base, const SharedHeader* header, DWORD slot) {
+        return reinterpret_cast<WorkerSlot*>(base + header->slotsOffset + slot * header->slotStride);
+    }
+
+    static BYTE* RingAt(WorkerSlot* slot) {
+        return reinterpret_cast<BYTE*>(slot) + AlignUp(sizeof(WorkerSlot), kCacheLine);
+    }
+
+    static void ResetSlot(WorkerSlot* slot) {
+        InterlockedExchange64(&slot->head, 0);
+        InterlockedExchange64(&slot->tail, 0);
+        InterlockedExchange64(&slot->scanStartTick, 0);
+        InterlockedExchange(&slot->currentEntry, -1);
+        InterlockedExchange(&slot->finished, 0);
+        InterlockedExchange(&slot->suspendedThread, 0);
+    }
+
+    // Streams bytes into the ring, publishing each chunk as it is copied so records larger than
+    // the ring still get through. Waits while the ring is full; fails if the supervisor is gone.
+    static bool RingWrite(WorkerSlot* slot, DWORD capacity, HANDLE supervisor, const BYTE* data, size_t size) {
+        BYTE* ring = RingAt(slot);
+        LONG64 head = slot->head;
+        while (size > 0) {
+            size_t free = capacity - static_cast<size_t>(head - LoadShared(&slot->tail));
+            if (free == 0) {
+                if (WaitForSingleObject(supervisor, 1) == WAIT_OBJECT_0) {
+                    return false;
+                }
+                continue;
+            }
+            size_t offset = static_cast<size_t>(head) & (capacity - 1);
+            size_t chunk = (std::min)((std::min)(size, free), static_cast<size_t>(capacity) - offset);
+            memcpy(ring + offset, data, chunk);
+            head += chunk;
+            data += chunk;
+            size -= chunk;
+            InterlockedExchange64(&slot->head, head);
+        }
+        return true;
+    }
+
+    static std::wstring GetExecutablePath() {
+        std::vector<WCHAR> buffer(MAX_PATH);
+        for (;;) {
+            DWORD length = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()));
+            if (length == 0) {
+                return std::wstring();
+            }
+            if (length < buffer.size()) {
+                return std::wstring(buffer.data(), length);
+            }
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+
+    int RunSweepWorker(HANDLE mapping, DWORD slotIndex) {
+        // A crash must end the process at once rather than wait on an error dialog
+        SetErrorMode(SEM_FAILCRITICALERRORS | SEM_NOGPFAULTERRORBOX | SEM_NOOPENFILEERRORBOX);
+
+        BYTE* base = static_cast<BYTE*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (!base) {
+            return kWorkerSetupFailed;
+        }
+        MEMORY_BASIC_INFORMATION mbi;
+        SharedHeader* header = reinterpret_cast<SharedHeader*>(base);
+        if (VirtualQuery(base, &mbi, sizeof(mbi)) == 0 || mbi.RegionSize < sizeof(SharedHeader) ||
+            header->magic != kSharedMagic || header->version != kSharedVersion ||
+            header->totalBytes > mbi.RegionSize || slotIndex >= header->slotCount ||
+            (header->ringBytes & (header->ringBytes - 1)) != 0 ||
+            header->slotsOffset + header->slotStride * header->slotCount > header->totalBytes) {
+            UnmapViewOfFile(base);
+            return kWorkerSetupFailed;
+        }
+
+        Handle supervisor(OpenProcess(SYNCHRONIZE, FALSE, header->supervisorPid));
+        if (!supervisor) {
+            UnmapViewOfFile(base);
+            return kWorkerSetupFailed;
+        }
+
+        QueueEntry* queue = reinterpret_cast<QueueEntry*>(base + header->queueOffset);
+        WorkerSlot* slot = SlotAt(base, header, slotIndex);
+
+        // Forwards the stop flag to in-flight scans, and takes the worker down with the supervisor
+        CancellationToken cancellation;
+        std::atomic<bool> done(false);
+        std::thread monitor([&]() {
+            while (!done) {
+                if (WaitForSingleObject(supervisor.get(), kMonitorIntervalMs) == WAIT_OBJECT_0) {
+                    ExitProcess(kWorkerOrphaned);
+                }
+                if (LoadShared(&header->stop)) {
+                    cancellation.Cancel();
+                }
+            }
+        });
+
+        ProcessScanner scanner;
+        ScanOptions scanOptions;
+        scanOptions.timeoutMs = header->timeoutMs;
+        scanOptions.sampling.byteBudget = header->sampleBudget;
+        scanOptions.sampling.seed = header->sampleSeed;
+        scanOptions.strings.maxStrings = header->stringCount;
+        scanOptions.strings.minLength = header->stringMinLength;
+        scanOptions.strings.byteBudget = header->stringBudget;
+        scanOptions.threadSampling.rounds = header->threadSampleRounds;
+        scanOptions.threadSampling.intervalMs = header->threadSampleIntervalMs;
+        scanOptions.threadSampling.suspendedThread = &slot->suspendedThread;
+        scanOptions.cancellation = &cancellation;
+        std::vector<BYTE> record;
+
+        while (!LoadShared(&header->stop)) {
+            // Claim the first Ready entry; while others are still Blocked, wait for their release
+            LONG entry = -1;
+            bool blocked = false;
+            for (LONG i = (std::max)(LoadShared(&header->firstOpen), 0L); static_cast<DWORD>(i) < header->entryCount; i++) {
+                LONG state = LoadShared(&queue[i].state);
+                if (state == kEntryReady &&
+                    InterlockedCompareExchange(&queue[i].state, kEntryClaimed + static_cast<LONG>(slotIndex), kEntryReady) == kEntryReady) {
+                    entry = i;
+                    break;
+                }
+                blocked = blocked || state == kEntryBlocked;
+            }
+            if (entry < 0) {
+                if (!blocked || WaitForSingleObject(supervisor.get(), 1) == WAIT_OBJECT_0) {
+                    break;
+                }
+                continue;
+            }
+            InterlockedExchange64(&slot->scanStartTick, static_cast<LONG64>(GetTickCount64()));
+            InterlockedExchange(&slot->currentEntry, entry);
+
+            ScanResult result;
+            ProcessInfo info;
+            const QueueEntry& item = queue[entry];
+            if (item.infoOffset + item.infoSize <= header->totalBytes &&
+                DecodeProcessInfo(base + item.infoOffset, item.infoSize, info)) {
+                result = scanner.ScanProcess(info, nullptr, scanOptions);
+            } else {
+                result.processInfo.pid = item.pid;
+                result.errorMessage = "Corrupt queue entry";
+            }
+
+            record.assign(sizeof(RecordHeader), 0);
+            EncodeScanResult(result, record);
+            RecordHeader recordHeader;
+            recordHeader.entry = static_cast<DWORD>(entry);
+            recordHeader.length = static_cast<DWORD>(record.size() - sizeof(RecordHeader));
+            memcpy(record.data(), &recordHeader, sizeof(recordHeader));
+            if (!RingWrite(slot, header->ringBytes, supervisor.get(), record.data(), record.size())) {
+                break;
+            }
+            InterlockedExchange(&slot->currentEntry, -1);
+        }
+
+        InterlockedExchange(&slot->finished, 1);
+        done = true;
+        monitor.join();
+        UnmapViewOfFile(base);
+        return 0;
+    }
+
+    namespace {
+
+        struct Worker {
+            Handle process;
+            std::vector<BYTE> pending;  // Ring bytes not yet forming a whole record
+            bool running;
+            bool killedForHang;
+            int startFailures;
+
+            Worker() : running(false), killedForHang(false), startFailures(0) {}
+        };
+
+    } // namespace
+
+    static bool LaunchWorker(const std::wstring& executable, HANDLE mapping, DWORD slot, Worker& worker) {
+        std::wstring commandLine = L"\"" + executable + L"\" --worker " +
+                                   std::to_wstring(reinterpret_cast<UINT_PTR>(mapping)) + L" " + std::to_wstring(slot);
+        STARTUPINFOEXW startup = {};
+        startup.StartupInfo.cb = sizeof(startup);
+        PROCESS_INFORMATION info = {};
+
+        // Inheritance is limited to the mapping; bInheritHandles alone would pass down every
+        // inheritable handle this process holds. Workers get no console and so no Ctrl+C.
+        SIZE_T attributeBytes = 0;
+        InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeBytes);
+        std::vector<BYTE> attributeBuffer(attributeBytes);
+        startup.lpAttributeList = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeBuffer.data());
+        if (attributeBytes == 0 || !InitializeProcThreadAttributeList(startup.lpAttributeList, 1, 0, &attributeBytes)) {
+            return false;
+        }
+        HANDLE inherited = mapping;
+        bool launched = UpdateProcThreadAttribute(startup.lpAttributeList, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST,
+                                                  &inherited, sizeof(inherited), nullptr, nullptr) &&
+                        CreateProcessW(executable.c_str(), &commandLine[0], nullptr, nullptr, TRUE,
+                                       CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT, nullptr, nullptr,
+                                       &startup.StartupInfo, &info);
+        DeleteProcThreadAttributeList(startup.lpAttributeList);
+        if (!launched) {
+            return false;
+        }
+        CloseHandle(info.hThread);
+        worker.process = Handle(info.hProcess);
+        worker.pending.clear();
+        worker.running = true;
+        worker.killedForHang = false;
+        return true;
+    }
+
+    SweepSummary SweepSupervisor::Run(const IsolatedSweepOptions& options, const SweepCallbacks& callbacks) {
+        SweepSummary summary;
+        lastStats_ = IsolationStats();
+        auto sweepStart = std::chrono::steady_clock::now();
+        const SweepOptions& sweep = options.sweep;
+
+        std::vector<ProcessInfo> processes = backend_.EnumerateProcesses(sweep.filter);
+        summary.enumeration = backend_.LastEnumerationStats();
+
+        ProcessTree tree;
+        tree.Build(processes);
+        PriorityOptions priority = sweep.priority;
+        if (priority.referenceTime == 0) {
+            priority.referenceTime = GetCurrentFileTime();
+        }
+        SweepPartitioner partitioner;
+        partitioner.Build(processes, tree, PrioritizedOrder(processes, tree, priority), sweep.partition);
+        std::vector<int> ownScores(processes.size(), 0);
+        std::vector<LineageInfo> lineages(processes.size());
+
+        // Queue entries in parent-first order; a result is reported once its parent's has been
+        std::vector<size_t> queue;
+        std::vector<size_t> positionOf(processes.size(), SIZE_MAX);
+        for (size_t index : partitioner.Order()) {
+            if (IsBlacklisted(processes[index].pid)) {
+                lastStats_.skipped++;
+            } else {
+                positionOf[index] = queue.size();
+                queue.push_back(index);
+            }
+        }
+
+        std::vector<std::vector<BYTE>> infos(queue.size());
+        size_t infoBytes = 0;
+        for (size_t i = 0; i < queue.size(); i++) {
+            EncodeProcessInfo(processes[queue[i]], infos[i]);
+            infoBytes += infos[i].size();
+        }
+
+        DWORD ringBytes = kMinRingBytes;
+        while (ringBytes < options.ringBytes && ringBytes < kMaxRingBytes) {
+            ringBytes <<= 1;
+        }
+        DWORD slotCount = static_cast<DWORD>((std::max)(1u, (std::min)(options.workerCount,
+                                                                     static_cast<unsigned>(MAXIMUM_WAIT_OBJECTS))));
+        slotCount = (std::min)(slotCount, static_cast<DWORD>((std::max)(queue.size(), static_cast<size_t>(1))));
+
+        DWORD hangTimeoutMs = options.hangTimeoutMs;
+        if (hangTimeoutMs == 0) {
+            hangTimeoutMs = sweep.scan.timeoutMs > 0 ? sweep.scan.timeoutMs * 2 + kDefaultHangGraceMs
+                                                     : kUnlimitedHangTimeoutMs;
+        }
+
+        size_t queueOffset = AlignUp(sizeof(SharedHeader), kCacheLine);
+        size_t infosOffset = queueOffset + queue.size() * sizeof(QueueEntry);
+        size_t slotsOffset = AlignUp(infosOffset + infoBytes, kCacheLine);
+        size_t slotStride = AlignUp(sizeof(WorkerSlot), kCacheLine) + ringBytes;
+        ULONGLONG totalBytes = static_cast<ULONGLONG>(slotsOffset) + static_cast<ULONGLONG>(slotStride) * slotCount;
+
+        std::vector<ScanResult> results(queue.size());
+        std::vector<bool> resolved(queue.size(), false);
+        std::vector<bool> skipped(queue.size(), false);
+        std::vector<bool> reported(queue.size(), false);
+        std::vector<Worker> workers(slotCount);
+
+        auto report = [&](size_t position) {
+            size_t index = queue[position];
+            ScanResult& result = results[position];
+            reported[position] = true;
+            if (skipped[position]) {
+                lineages[index] = tree.GetLineage(index, lineages, ownScores);
+                partitioner.RecordSkip(index);
+                return;
+            }
+            summary.totalCount++;
+            if (callbacks.onProcessStart) {
+                callbacks.onProcessStart(processes[index]);
+            }
+
+            // Workers score without lineage, fleet clusters or baselines; all are only known here
+            lineages[index] = tree.GetLineage(index, lineages, ownScores);
+            if (result.success) {
+                ImageBaseline baseline;
+                if (sweep.scan.baselines) {
+                    baseline = sweep.scan.baselines->Find(BaselineStore::ImageKey(result.processInfo, backend_.Images()));
+                }
+                result.riskAssessment = riskScorer_.CalculateRiskScore(
+                    result.processInfo, result.modules, result.threads, result.memoryRegions, backend_.Images(),
+                    &lineages[index], sweep.fingerprints, sweep.scan.baselines ? &baseline : nullptr,
+                    sweep.scan.allowlist);
+                summary.successCount++;
+                if (sweep.fingerprints) {
+                    ProcessScanner::RecordFingerprints(result, *sweep.fingerprints);
+                }
+                if (sweep.similarity) {
+                    ProcessScanner::RecordDigests(result, *sweep.similarity);
+                }
+                if (result.truncated) {
+                    summary.truncatedCount++;
+                }
+            }
+            ownScores[index] = result.riskAssessment.score - result.riskAssessment.lineageScore;
+            partitioner.RecordResult(index, result.riskAssessment, result.success);
+            if (result.success && result.riskAssessment.level == RiskLevel::High && summary.firstHighMs < 0) {
+                summary.firstHighMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sweepStart).count();
+                summary.firstHighPid = result.processInfo.pid;
+            }
+            if (options.metrics) {
+                options.metrics->RecordScan(result);
+            }
+            if (callbacks.onResult) {
+                callbacks.onResult(result);
+            }
+            result = ScanResult();
+        };
+        // First unreported position; everything before it has been reported
+        size_t cursor = 0;
+        auto reportReady = [&]() {
+            for (size_t position = cursor; position < queue.size(); position++) {
+                if (reported[position] || !resolved[position]) {
+                    continue;
+                }
+                size_t index = queue[position];
+                if (tree.HasParent(index) && positionOf[tree.Parent(index)] != SIZE_MAX &&
+                    !reported[positionOf[tree.Parent(index)]]) {
+                    continue;
+                }
+                report(position);
+            }
+            while (cursor < queue.size() && reported[cursor]) {
+                cursor++;
+            }
+        };
+
+        std::wstring executable = GetExecutablePath();
+        SECURITY_ATTRIBUTES inherit = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+        Handle mapping(CreateFileMappingW(INVALID_HANDLE_VALUE, &inherit, PAGE_READWRITE,
+                                          static_cast<DWORD>(totalBytes >> 32), static_cast<DWORD>(totalBytes), nullptr));
+        BYTE* base = mapping ? static_cast<BYTE*>(MapViewOfFile(mapping.get(), FILE_MAP_ALL_ACCESS, 0, 0, 0)) : nullptr;
+        if (!base || executable.empty()) {
+            // Without shared memory nothing can be scanned; report every process as failed
+            std::string error = "Failed to set up worker shared memory: " + GetLastErrorString();
+            for (size_t i = 0; i < queue.size(); i++) {
+                results[i].processInfo = processes[queue[i]];
+                results[i].errorMessage = error;
+                resolved[i] = true;
+            }
+        } else {
+            SharedHeader* header = reinterpret_cast<SharedHeader*>(base);
+            header->magic = kSharedMagic;
+            header->version = kSharedVersion;
+            header->supervisorPid = GetCurrentProcessId();
+            header->slotCount = slotCount;
+            header->ringBytes = ringBytes;
+            header->entryCount = static_cast<DWORD>(queue.size());
+            header->timeoutMs = sweep.scan.timeoutMs;
+            header->sampleBudget = sweep.scan.sampling.byteBudget;
+            header->sampleSeed = sweep.scan.sampling.seed;
+            header->stringCount = static_cast<DWORD>(sweep.scan.strings.maxStrings);
+            header->stringMinLength = static_cast<DWORD>(sweep.scan.strings.minLength);
+            header->stringBudget = sweep.scan.strings.byteBudget;
+            header->threadSampleRounds = sweep.scan.threadSampling.rounds;
+            header->threadSampleIntervalMs = sweep.scan.threadSampling.intervalMs;
+            header->queueOffset = queueOffset;
+            header->slotsOffset = slotsOffset;
+            header->slotStride = slotStride;
+            header->totalBytes = totalBytes;
+            header->firstOpen = 0;
+            header->stop = 0;
+
+            QueueEntry* entries = reinterpret_cast<QueueEntry*>(base + queueOffset);
+            size_t infoOffset = infosOffset;
+            for (size_t i = 0; i < queue.size(); i++) {
+                entries[i].infoOffset = infoOffset;
+                entries[i].infoSize = static_cast<DWORD>(infos[i].size());
+                entries[i].pid = processes[queue[i]].pid;
+                entries[i].state = kEntryBlocked;
+                entries[i].reserved = 0;
+                memcpy(base + infoOffset, infos[i].data(), infos[i].size());
+                infoOffset += infos[i].size();
+            }
+            infos.clear();
+
+            // Each partition has its entries released in queue order, at most maxConcurrent at a
+            // time, until its scan time reaches the budget; what is left then is skipped
+            std::vector<std::vector<size_t>> members(partitioner.PartitionCount());
+            for (size_t i = 0; i < queue.size(); i++) {
+                members[partitioner.PartitionOf(queue[i])].push_back(i);
+            }
+            std::vector<size_t> released(members.size(), 0);
+            std::vector<size_t> inFlight(members.size(), 0);
+            auto release = [&](size_t partition) {
+                const unsigned limit = partitioner.MaxConcurrent();
+                while (released[partition] < members[partition].size() && (limit == 0 || inFlight[partition] < limit)) {
+                    InterlockedExchange(&entries[members[partition][released[partition]++]].state, kEntryReady);
+                    inFlight[partition]++;
+                }
+            };
+            auto skipRemaining = [&](size_t partition) {
+                for (size_t position : members[partition]) {
+                    if (InterlockedCompareExchange(&entries[position].state, kEntrySkipped, kEntryBlocked) == kEntryBlocked ||
+                        InterlockedCompareExchange(&entries[position].state, kEntrySkipped, kEntryReady) == kEntryReady) {
+                        results[position].processInfo = processes[queue[position]];
+                        resolved[position] = true;
+                        skipped[position] = true;
+                    }
+                }
+                released[partition] = members[partition].size();
+            };
+            auto resolve = [&](size_t position) {
+                resolved[position] = true;
+                size_t partition = partitioner.PartitionOf(queue[position]);
+                inFlight[partition]--;
+                partitioner.Charge(partition, results[position].timings.totalMs);
+                if (partitioner.IsExhausted(partition)) {
+                    skipRemaining(partition);
+                } else {
+                    release(partition);
+                }
+            };
+            // Moves the first-open hint past claimed and skipped entries; false once nothing is left to claim
+            size_t firstOpen = 0;
+            auto anyOpen = [&]() {
+                while (firstOpen < queue.size()) {
+                    LONG state = LoadShared(&entries[firstOpen].state);
+                    if (state == kEntryBlocked || state == kEntryReady) {
+                        break;
+                    }
+                    firstOpen++;
+                }
+                InterlockedExchange(&header->firstOpen, static_cast<LONG>(firstOpen));
+                return firstOpen < queue.size();
+            };
+            for (size_t partition = 0; partition < members.size(); partition++) {
+                release(partition);
+            }
+
+            for (DWORD slot = 0; slot < slotCount && !queue.empty(); slot++) {
+                ResetSlot(SlotAt(base, header, slot));
+                if (LaunchWorker(executable, mapping.get(), slot, workers[slot])) {
+                    lastStats_.workers++;
+                }
+            }
+
+            auto drain = [&](DWORD slotIndex) {
+                WorkerSlot* slot = SlotAt(base, header, slotIndex);
+                Worker& worker = workers[slotIndex];
+                BYTE* ring = RingAt(slot);
+                LONG64 head = LoadShared(&slot->head);
+                LONG64 tail = slot->tail;
+                while (tail < head) {
+                    size_t offset = static_cast<size_t>(tail) & (ringBytes - 1);
+                    size_t chunk = (std::min)(static_cast<size_t>(head - tail), static_cast<size_t>(ringBytes) - offset);
+                    worker.pending.insert(worker.pending.end(), ring + offset, ring + offset + chunk);
+                    tail += chunk;
+                }
+                InterlockedExchange64(&slot->tail, tail);
+
+                size_t consumed = 0;
+                while (worker.pending.size() - consumed >= sizeof(RecordHeader)) {
+                    RecordHeader record;
+                    memcpy(&record, worker.pending.data() + consumed, sizeof(record));
+                    if (record.length > kMaxRecordBytes || record.entry >= queue.size()) {
+                        // Garbage in the ring: drop the worker, it will be restarted on a clean one
+                        TerminateProcess(worker.process.get(), 1);
+                        consumed = worker.pending.size();
+                        break;
+                    }
+                    if (worker.pending.size() - consumed - sizeof(record) < record.length) {
+                        break;
+                    }
+                    const BYTE* payload = worker.pending.data() + consumed + sizeof(record);
+                    ScanResult& result = results[record.entry];
+                    if (!DecodeScanResult(payload, record.length, result)) {
+                        result = ScanResult();
+                        result.processInfo = processes[queue[record.entry]];
+                        result.errorMessage = "Worker sent an undecodable result";
+                    }
+                    if (!resolved[record.entry]) {
+                        resolve(record.entry);
+                    }
+                    consumed += sizeof(record) + record.length;
+                }
+                worker.pending.erase(worker.pending.begin(), worker.pending.begin() + consumed);
+            };
+
+            bool stopping = false;
+            std::vector<HANDLE> waitHandles;
+            for (;;) {
+                for (DWORD slot = 0; slot < slotCount; slot++) {
+                    drain(slot);
+                }
+
+                bool anyRunning = false;
+                for (DWORD slotIndex = 0; slotIndex < slotCount; slotIndex++) {
+                    Worker& worker = workers[slotIndex];
+                    if (!worker.running) {
+                        continue;
+                    }
+                    WorkerSlot* slot = SlotAt(base, header, slotIndex);
+
+                    if (WaitForSingleObject(worker.process.get(), 0) != WAIT_OBJECT_0) {
+                        anyRunning = true;
+                        LONG entry = LoadShared(&slot->currentEntry);
+                        ULONGLONG started = static_cast<ULONGLONG>(LoadShared(&slot->scanStartTick));
+                        if (entry >= 0 && !worker.killedForHang && GetTickCount64() - started > hangTimeoutMs) {
+                            worker.killedForHang = true;
+                            TerminateProcess(worker.process.get(), kHungExitCode);
+                        }
+                        continue;
+                    }
+
+                    // Exited: pick up anything written before it went
+                    drain(slotIndex);
+                    worker.running = false;
+                    if (LoadShared(&slot->finished)) {
+                        continue;
+                    }
+
+                    // Killed while sampling: the target thread would otherwise stay suspended
+                    DWORD suspendedTid = static_cast<DWORD>(LoadShared(&slot->suspendedThread));
+                    if (suspendedTid != 0) {
+                        Handle thread(OpenThread(THREAD_SUSPEND_RESUME, FALSE, suspendedTid));
+                        if (thread && ResumeThread(thread.get()) != static_cast<DWORD>(-1)) {
+                            lastStats_.threadsResumed++;
+                        }
+                    }
+
+                    DWORD exitCode = 0;
+                    GetExitCodeProcess(worker.process.get(), &exitCode);
+                    LONG entry = LoadShared(&slot->currentEntry);
+
+                    // Claimed by this worker, which died before saying it had taken the entry
+                    const LONG owned = kEntryClaimed + static_cast<LONG>(slotIndex);
+                    for (size_t i = cursor; i < queue.size(); i++) {
+                        if (!resolved[i] && static_cast<LONG>(i) != entry && LoadShared(&entries[i].state) == owned) {
+                            results[i].processInfo = processes[queue[i]];
+                            results[i].errorMessage = "Worker exited without reporting a result";
+                            resolve(i);
+                            lastStats_.lost++;
+                        }
+                    }
+                    if (entry >= 0 && !resolved[entry]) {
+                        ScanResult& result = results[entry];
+                        result = ScanResult();
+                        result.processInfo = processes[queue[entry]];
+                        char code[16];
+                        snprintf(code, sizeof(code), "0x%08lX", static_cast<unsigned long>(exitCode));
+                        result.errorMessage = worker.killedForHang
+                            ? "Worker hung for over " + std::to_string(hangTimeoutMs / 1000) + " s scanning this process; PID blacklisted"
+                            : "Worker crashed (exit code " + std::string(code) + ") scanning this process; PID blacklisted";
+                        resolve(entry);
+                        blacklist_.insert(result.processInfo.pid);
+                        lastStats_.blacklisted.push_back(result.processInfo.pid);
+                    }
+                    if (worker.killedForHang) {
+                        lastStats_.hangs++;
+                    } else {
+                        lastStats_.crashes++;
+                    }
+                    worker.startFailures = entry >= 0 ? 0 : worker.startFailures + 1;
+
+                    // The dead worker cannot touch its slot any more, so it is safe to reset
+                    ResetSlot(slot);
+                    worker.pending.clear();
+                    if (!stopping && anyOpen() &&
+                        worker.startFailures < kMaxStartFailures &&
+                        LaunchWorker(executable, mapping.get(), slotIndex, worker)) {
+                        lastStats_.workers++;
+                        anyRunning = true;
+                    }
+                }
+
+                if (!stopping && sweep.scan.cancellation && sweep.scan.cancellation->IsCancelled()) {
+                    InterlockedExchange(&header->stop, 1);
+                    stopping = true;
+                    summary.cancelled = true;
+                }
+
+                anyOpen();
+
+                // Parents come before children in the queue, so one pass reports whole chains and
+                // lineage sees every ancestor's final score first
+                reportReady();
+
+                if (!anyRunning) {
+                    break;
+                }
+
+                waitHandles.clear();
+                for (const Worker& worker : workers) {
+                    if (worker.running) {
+                        waitHandles.push_back(worker.process.get());
+                    }
+                }
+                WaitForMultipleObjects(static_cast<DWORD>(waitHandles.size()), waitHandles.data(), FALSE, kPollIntervalMs);
+            }
+
+            // Entries claimed by a worker that died before publishing which one it held
+            for (size_t i = cursor; i < queue.size(); i++) {
+                if (!resolved[i] && LoadShared(&entries[i].state) >= kEntryClaimed) {
+                    results[i].processInfo = processes[queue[i]];
+                    results[i].errorMessage = "Worker exited without reporting a result";
+                    resolved[i] = true;
+                    lastStats_.lost++;
+                }
+            }
+
+            // Workers that could not be started, or stopped restarting, leave entries nobody claimed
+            if (!stopping) {
+                for (size_t i = cursor; i < queue.size(); i++) {
+                    LONG state = LoadShared(&entries[i].state);
+                    if (!resolved[i] && (state == kEntryReady || state == kEntryBlocked)) {
+                        results[i].processInfo = processes[queue[i]];
+                        results[i].errorMessage = "No worker available to scan this process";
+                        resolved[i] = true;
+                        lastStats_.unscanned++;
+                    }
+                }
+            }
+            UnmapViewOfFile(base);
+        }
+
+        // Whatever is left after the workers are gone: failures and results queued behind them
+        for (; cursor < queue.size(); cursor++) {
+            if (resolved[cursor] && !reported[cursor]) {
+                report(cursor);
+            }
+        }
+
+        summary.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sweepStart).count();
+        return summary;
+    }
+
+} // namespace ProcessScope
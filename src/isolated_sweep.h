@@ -0,0 +1,72 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include <unordered_set>
+#include <vector>
+
+namespace ProcessScope {
+
+    class MetricsShard;
+
+    // Settings for a sweep split across worker processes
+    struct IsolatedSweepOptions {
+        SweepOptions sweep;         // Triage is not supported
+        unsigned workerCount;
+        DWORD ringBytes;            // Result ring per worker, rounded up to a power of two
+        DWORD hangTimeoutMs;        // A scan running longer is treated as hung; 0 = twice the scan timeout plus 10 s
+        MetricsShard* metrics;      // Receives every result; may be null
+
+        IsolatedSweepOptions() : workerCount(4), ringBytes(4u << 20), hangTimeoutMs(0), metrics(nullptr) {}
+    };
+
+    struct IsolationStats {
+        size_t workers;             // Worker processes started, restarts included
+        size_t crashes;
+        size_t hangs;
+        size_t lost;                // Claimed by a worker that died before saying which process it had taken
+        size_t skipped;             // Blacklisted by an earlier run
+        size_t threadsResumed;      // Target threads left suspended by a worker that died sampling them
+        size_t unscanned;           // Never claimed because no worker could be started or restarted
+        std::vector<DWORD> blacklisted;
+
+        IsolationStats() : workers(0), crashes(0), hangs(0), lost(0), skipped(0), threadsResumed(0), unscanned(0) {}
+    };
+
+    // Runs a sweep in a pool of worker processes, so a scan that crashes or wedges takes down one
+    // worker instead of the whole sweep. Workers are copies of this executable started with
+    // --worker and share one anonymous file mapping with the supervisor:
+    //   [header]   counts, scan timeout, a hint to the first unclaimed queue entry and a stop flag
+    //   [queue]    one entry per process in parent-first order, each with a state that workers
+    //              claim with a compare-exchange and the supervisor sets to release or skip it
+    //   [infos]    the enumerated ProcessInfo of each entry, encoded with EncodeProcessInfo
+    //   [slots]    per worker: claimed entry, scan start tick, the thread it holds suspended while
+    //              sampling, and a single-producer byte ring
+    // A worker streams each result into its ring as [entry][length][EncodeScanResult bytes]. The
+    // supervisor decodes, re-scores with lineage and fleet clusters and reports each result as soon
+    // as its parent has been reported, so the order is parent-first like ProcessScanner::Sweep. A worker that exits while holding an entry,
+    // or whose scan outlives the hang timeout (and is terminated), has its PID blacklisted, a
+    // failed result reported in its place, and is restarted on a fresh ring. With partition limits,
+    // entries of each session are released as earlier ones finish, and skipped once its budget is spent.
+    class SweepSupervisor {
+    private:
+        LiveBackend backend_;                   // Enumeration, and the images results are scored against
+        RiskScorer riskScorer_;
+        std::unordered_set<DWORD> blacklist_;   // Kept across runs
+        IsolationStats lastStats_;
+
+    public:
+        SweepSupervisor() {}
+        SweepSupervisor(const SweepSupervisor&) = delete;
+        SweepSupervisor& operator=(const SweepSupervisor&) = delete;
+
+        SweepSummary Run(const IsolatedSweepOptions& options, const SweepCallbacks& callbacks);
+        const IsolationStats& LastStats() const { return lastStats_; }
+        bool IsBlacklisted(DWORD pid) const { return blacklist_.count(pid) != 0; }
+    };
+
+    // Body of a worker process: scans queue entries until the queue is drained, the supervisor
+    // asks it to stop or the supervisor exits. Returns the process exit code.
+    int RunSweepWorker(HANDLE mapping, DWORD slot);
+
+} // namespace ProcessScope
@@ -1,18 +1,49 @@
 #include "memory_scan.h"
+#include <algorithm>
+#include <cstring>
 
 namespace ProcessScope {
 
-    std::vector<MemoryRegion> MemoryScanner::ScanMemoryRegions(HANDLE hProcess) {
-        std::vector<MemoryRegion> regions;
-        
-        if (!hProcess) {
-            return regions;
+    // Executable private regions above this size are flagged as suspicious
+    static const size_t kLargePrivateExecutableSize = 1024 * 1024;
+
+    static bool IsExecutableProtection(DWORD protect) {
+        return (protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+    }
+
+    // Stratum of a region that is not flagged; flagged regions are decided after the prefix probe
+    static SampleStratumKind ClassifyRegion(const MemoryRegion& region, DWORD type) {
+        if (region.isImage) {
+            return region.isExecutable ? SampleStratumKind::ImageCode : SampleStratumKind::ImageData;
+        }
+        if (type == MEM_MAPPED) {
+            return SampleStratumKind::Mapped;
+        }
+        if (region.isExecutable) {
+            return SampleStratumKind::Flagged;
         }
+        return region.isWritable ? SampleStratumKind::PrivateWritable : SampleStratumKind::PrivateReadOnly;
+    }
+
+    std::vector<MemoryRegion> MemoryScanner::ScanMemoryRegions(MemorySource& source, const ScanContext& context,
+                                                               const ContentSampleOptions* sampling) {
+        std::vector<MemoryRegion> regions;
+        std::vector<size_t> probeRegions;
+        std::vector<size_t> pageRegions;
+        std::vector<SampleRange> sampleRanges;
+        bool sample = sampling && sampling->byteBudget > 0;
+        lastPageStats_ = PageAnalysisStats();
+        lastSample_ = ContentSample();
 
         uintptr_t currentAddress = 0;
         MEMORY_BASIC_INFORMATION mbi;
         
-        while (VirtualQueryEx(hProcess, (LPCVOID)currentAddress, &mbi, sizeof(mbi)) == sizeof(mbi)) {
+        while (source.Query(currentAddress, mbi)) {
+            // Huge address spaces can take a long time to walk; honour the scan budget
+            if (context.ShouldStop()) {
+                break;
+            }
+            
             // Only process committed regions
             if (mbi.State == MEM_COMMIT) {
                 MemoryRegion region;
@@ -21,10 +52,10 @@ namespace ProcessScope {
                 region.state = GetStateString(mbi.State);
                 region.type = GetTypeString(mbi.Type);
                 region.protection = GetProtectionString(mbi.Protect);
+                region.isImage = mbi.Type == MEM_IMAGE;
                 
                 // Check execution and write permissions
-                region.isExecutable = (mbi.Protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | 
-                                                      PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+                region.isExecutable = IsExecutableProtection(mbi.Protect);
                 region.isWritable = (mbi.Protect & (PAGE_READWRITE | PAGE_EXECUTE_READWRITE | 
                                                      PAGE_WRITECOPY | PAGE_EXECUTE_WRITECOPY)) != 0;
                 
@@ -37,10 +68,21 @@ namespace ProcessScope {
                 }
                 
                 // Executable private regions only suspicious if very large (>1MB)
-                if (region.isExecutable && mbi.Type == MEM_PRIVATE && region.size > 1024*1024) {
+                if (region.isExecutable && mbi.Type == MEM_PRIVATE && region.size > kLargePrivateExecutableSize) {
                     region.isSuspicious = true;
                 }
                 
+                if (!region.isImage && ((region.isExecutable && mbi.Type == MEM_PRIVATE) || region.isSuspicious)) {
+                    probeRegions.push_back(regions.size());
+                }
+                if (region.isSuspicious || (region.isExecutable && region.isImage)) {
+                    pageRegions.push_back(regions.size());
+                }
+                if (sample && !(mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS))) {
+                    sampleRanges.emplace_back(region.baseAddress, region.size,
+                                              region.isSuspicious ? SampleStratumKind::Flagged : ClassifyRegion(region, mbi.Type));
+                }
+                
                 regions.push_back(region);
             }
             
@@ -53,7 +95,102 @@ namespace ProcessScope {
             }
         }
 
+        // Read the prefix of each executable private or suspicious region once: check for a DOS header,
+        // fingerprint the normalized bytes for cross-process clustering, and digest in-memory images
+        // and suspicious regions for near-duplicate matching
+        if (!probeRegions.empty()) {
+            std::vector<BYTE> prefix(kFingerprintBytes);
+            for (size_t index : probeRegions) {
+                if (context.ShouldStop()) {
+                    break;
+                }
+                MemoryRegion& region = regions[index];
+                size_t length = (std::min)(region.size, kFingerprintBytes);
+                size_t bytesRead = source.Read(region.baseAddress, prefix.data(), length);
+                if (bytesRead == 0) {
+                    continue;
+                }
+                WORD magic = 0;
+                if (bytesRead >= sizeof(WORD)) {
+                    memcpy(&magic, prefix.data(), sizeof(WORD));
+                }
+                region.hasPeHeader = magic == IMAGE_DOS_SIGNATURE;
+                region.fingerprint = FingerprintRegion(prefix.data(), bytesRead, region.baseAddress, region.size);
+                if (region.isSuspicious || region.hasPeHeader) {
+                    region.similarity = ComputeSimilarityDigest(prefix.data(), bytesRead);
+                }
+            }
+        }
+
+        // Residency and copy-on-write state for all selected regions in a few bulk queries
+        if (!pageRegions.empty()) {
+            std::vector<PageRange> ranges;
+            ranges.reserve(pageRegions.size());
+            for (size_t index : pageRegions) {
+                ranges.emplace_back(regions[index].baseAddress, regions[index].size, &regions[index].pages);
+            }
+            lastPageStats_ = source.AnalyzePages(ranges, context);
+        }
+
+        // Regions found to hold a PE header are covered in full along with the other flagged ones
+        if (!sampleRanges.empty() && !context.ShouldStop()) {
+            size_t next = 0;
+            for (const MemoryRegion& region : regions) {
+                while (next < sampleRanges.size() && sampleRanges[next].baseAddress < region.baseAddress) {
+                    next++;
+                }
+                if (region.hasPeHeader && next < sampleRanges.size() && sampleRanges[next].baseAddress == region.baseAddress) {
+                    sampleRanges[next].stratum = SampleStratumKind::Flagged;
+                }
+            }
+            lastSample_ = sampler_.Sample(source, sampleRanges, *sampling, context);
+        }
+
         return regions;
     }
 
+    RegionSummary MemoryScanner::SummarizeMemoryRegions(MemorySource& source, const ScanContext& context) {
+        RegionSummary summary;
+
+        // Same walk as ScanMemoryRegions, but only counts: no strings, no region vector
+        uintptr_t currentAddress = 0;
+        MEMORY_BASIC_INFORMATION mbi;
+        
+        while (source.Query(currentAddress, mbi)) {
+            if (context.ShouldStop()) {
+                break;
+            }
+            
+            summary.totalRegions++;
+            if (mbi.State == MEM_COMMIT) {
+                summary.committedRegions++;
+                summary.committedBytes += mbi.RegionSize;
+                
+                bool isRwx = (mbi.Protect & PAGE_EXECUTE_READWRITE) != 0;
+                bool isPrivateExecutable = IsExecutableProtection(mbi.Protect) && mbi.Type == MEM_PRIVATE;
+                bool isLarge = mbi.RegionSize > kLargePrivateExecutableSize;
+                
+                if (isRwx) {
+                    summary.rwxRegions++;
+                }
+                if (isPrivateExecutable) {
+                    summary.executablePrivateRegions++;
+                    if (isLarge) {
+                        summary.largeExecutablePrivateRegions++;
+                    }
+                }
+                if (isRwx || (isPrivateExecutable && isLarge)) {
+                    summary.suspiciousRegions++;
+                }
+            }
+            
+            currentAddress = reinterpret_cast<uintptr_t>(mbi.BaseAddress) + mbi.RegionSize;
+            if (currentAddress < reinterpret_cast<uintptr_t>(mbi.BaseAddress)) {
+                break;
+            }
+        }
+
+        return summary;
+    }
+
 } // namespace ProcessScope
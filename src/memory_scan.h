@@ -1,6 +1,11 @@
 #pragma once
 
 #include "util.h"
+#include "scan_context.h"
+#include "scan_backend.h"
+#include "fingerprint.h"
+#include "similarity.h"
+#include "content_sample.h"
 #include <vector>
 #include <string>
 
@@ -14,12 +19,48 @@ struct MemoryRegion {
     bool isExecutable;
     bool isWritable;
     bool isSuspicious;
+    bool hasPeHeader;   // Non-image region starting with an MZ header (manually mapped image)
+    bool isImage;
+    ULONGLONG fingerprint;  // Normalized content hash of executable private and suspicious regions, 0 if not computed
+    ProcessScope::SimilarityDigest similarity;  // Only computed for suspicious regions and in-memory images
+    ProcessScope::PageAnalysis pages;   // Only filled for suspicious and executable image regions
     
-    MemoryRegion() : baseAddress(0), size(0), isExecutable(false), isWritable(false), isSuspicious(false) {}
+    MemoryRegion() : baseAddress(0), size(0), isExecutable(false), isWritable(false), isSuspicious(false), hasPeHeader(false), isImage(false), fingerprint(0) {}
 };
 
-// Virtual memory scanner with suspicious region detection
-class MemoryScanner {
-    public:
-        std::vector<MemoryRegion> ScanMemoryRegions(HANDLE hProcess);
+// Allocation-free counts from a region walk, used for tier-1 triage
+struct RegionSummary {
+    size_t totalRegions;
+    size_t committedRegions;
+    size_t committedBytes;
+    size_t rwxRegions;
+    size_t executablePrivateRegions;  // Executable private regions of any size
+    size_t largeExecutablePrivateRegions; // Executable private regions over the suspicious size threshold
+    size_t suspiciousRegions;
+    
+    RegionSummary() : totalRegions(0), committedRegions(0), committedBytes(0), rwxRegions(0),
+                      executablePrivateRegions(0), largeExecutablePrivateRegions(0), suspiciousRegions(0) {}
 };
+
+namespace ProcessScope {
+
+    // Virtual memory scanner with suspicious region detection
+    class MemoryScanner {
+    private:
+        ProcessScope::PageAnalysisStats lastPageStats_;
+        ProcessScope::ContentSample lastSample_;
+        ProcessScope::ContentSampler sampler_;
+        
+    public:
+        // When the source can read, the first bytes of each executable private or suspicious region are
+        // probed for a PE header and fingerprinted; suspicious regions and in-memory images also get a
+        // similarity digest. Suspicious and executable image regions get page residency and private-copy analysis.
+        // With a sampling budget, page contents of the whole address space are sampled as well.
+        std::vector<MemoryRegion> ScanMemoryRegions(ProcessScope::MemorySource& source, const ProcessScope::ScanContext& context,
+                                                    const ProcessScope::ContentSampleOptions* sampling = nullptr);
+        const ProcessScope::PageAnalysisStats& LastPageStats() const { return lastPageStats_; }
+        const ProcessScope::ContentSample& LastSample() const { return lastSample_; }
+        RegionSummary SummarizeMemoryRegions(ProcessScope::MemorySource& source, const ProcessScope::ScanContext& context);
+    };
+
+} // namespace ProcessScope
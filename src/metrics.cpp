@@ -0,0 +1,231 @@
+#include "metrics.h"
+#include <algorithm>
+#include <sstream>
+
+namespace ProcessScope {
+
+    static const char* const kPhaseNames[] = { "modules", "threads", "memory", "risk", "total" };
+
+    // Cumulative buckets exported for each phase, in microseconds
+    static const ULONGLONG kExportBoundsMicros[] = {
+        500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+        1000000, 2500000, 5000000, 10000000, 30000000, 60000000
+    };
+
+    static const double kExportQuantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    // Single-writer increment: a plain load and store, no locked read-modify-write
+    static void Add(std::atomic<ULONGLONG>& cell, ULONGLONG value) {
+        cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static ULONGLONG Read(const std::atomic<ULONGLONG>& cell) {
+        return cell.load(std::memory_order_relaxed);
+    }
+
+    static ULONGLONG MsToMicros(double ms) {
+        return ms > 0 ? static_cast<ULONGLONG>(ms * 1000.0 + 0.5) : 0;
+    }
+
+    static std::string Seconds(ULONGLONG micros) {
+        std::ostringstream ss;
+        ss << std::setprecision(9) << static_cast<double>(micros) / 1000000.0;
+        return ss.str();
+    }
+
+    LatencyHistogram::LatencyHistogram() : total_(0), sumMicros_(0), maxMicros_(0) {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t LatencyHistogram::BucketIndex(ULONGLONG micros) {
+        if (micros < 32) {
+            return static_cast<size_t>(micros);
+        }
+        micros = (std::min)(micros, static_cast<ULONGLONG>((1ULL << kMaxMagnitude) - 1));
+        int magnitude = 5;
+        while ((micros >> (magnitude + 1)) != 0) {
+            magnitude++;
+        }
+        // The top five bits select one of 16 linear buckets within the power of two
+        ULONGLONG subBucket = micros >> (magnitude - 4);
+        return 32 + static_cast<size_t>(magnitude - 5) * 16 + static_cast<size_t>(subBucket - 16);
+    }
+
+    ULONGLONG LatencyHistogram::BucketLowerBound(size_t index) {
+        if (index < 32) {
+            return index;
+        }
+        int magnitude = 5 + static_cast<int>((index - 32) / 16);
+        ULONGLONG subBucket = 16 + (index - 32) % 16;
+        return subBucket << (magnitude - 4);
+    }
+
+    ULONGLONG LatencyHistogram::BucketUpperBound(size_t index) {
+        if (index < 32) {
+            return index;
+        }
+        int magnitude = 5 + static_cast<int>((index - 32) / 16);
+        ULONGLONG subBucket = 16 + (index - 32) % 16;
+        return ((subBucket + 1) << (magnitude - 4)) - 1;
+    }
+
+    void LatencyHistogram::Record(ULONGLONG micros) {
+        Add(counts_[BucketIndex(micros)], 1);
+        Add(total_, 1);
+        Add(sumMicros_, micros);
+        if (micros > Read(maxMicros_)) {
+            maxMicros_.store(micros, std::memory_order_relaxed);
+        }
+    }
+
+    void HistogramSnapshot::Merge(const LatencyHistogram& histogram) {
+        for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+            counts[i] += Read(histogram.counts_[i]);
+        }
+        total += Read(histogram.total_);
+        sumMicros += Read(histogram.sumMicros_);
+        maxMicros = (std::max)(maxMicros, Read(histogram.maxMicros_));
+    }
+
+    ULONGLONG HistogramSnapshot::CountAtOrBelow(ULONGLONG micros) const {
+        // A bucket counts once its lowest value is within the bound; the error is one bucket width
+        ULONGLONG count = 0;
+        for (size_t i = 0; i < counts.size() && LatencyHistogram::BucketLowerBound(i) <= micros; i++) {
+            count += counts[i];
+        }
+        return count;
+    }
+
+    ULONGLONG HistogramSnapshot::ValueAtQuantile(double quantile) const {
+        // Counts are summed rather than taken from total, which may be a few records ahead
+        ULONGLONG recorded = 0;
+        for (ULONGLONG count : counts) {
+            recorded += count;
+        }
+        if (recorded == 0) {
+            return 0;
+        }
+        ULONGLONG rank = static_cast<ULONGLONG>(quantile * recorded + 0.5);
+        rank = (std::max)(rank, static_cast<ULONGLONG>(1));
+        ULONGLONG seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return (std::min)(LatencyHistogram::BucketUpperBound(i), maxMicros);
+            }
+        }
+        return maxMicros;
+    }
+
+    MetricsShard::MetricsShard()
+        : scanned_(0), accessDenied_(0), failed_(0), truncated_(0), modulesVerified_(0), regionsScanned_(0),
+          bytesRead_(0), readSyscalls_(0) {}
+
+    void MetricsShard::RecordScan(const ScanResult& result) {
+        if (!result.success) {
+            Add(result.accessDenied ? accessDenied_ : failed_, 1);
+            return;
+        }
+
+        Add(scanned_, 1);
+        if (result.truncated) {
+            Add(truncated_, 1);
+        }
+        Add(modulesVerified_, result.modules.size());
+        Add(regionsScanned_, result.memoryRegions.size());
+        Add(bytesRead_, result.memoryReads.bytesTransferred);
+        Add(readSyscalls_, result.memoryReads.syscalls);
+
+        phases_[static_cast<size_t>(ScanPhase::Modules)].Record(MsToMicros(result.timings.modulesMs));
+        phases_[static_cast<size_t>(ScanPhase::Threads)].Record(MsToMicros(result.timings.threadsMs));
+        phases_[static_cast<size_t>(ScanPhase::Memory)].Record(MsToMicros(result.timings.memoryMs));
+        phases_[static_cast<size_t>(ScanPhase::Risk)].Record(MsToMicros(result.timings.riskMs));
+        phases_[static_cast<size_t>(ScanPhase::Total)].Record(MsToMicros(result.timings.totalMs));
+    }
+
+    MetricsShard* ScanMetrics::CreateShard() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.emplace_back(new MetricsShard());
+        return shards_.back().get();
+    }
+
+    std::string ScanMetrics::FormatPrometheus() const {
+        const size_t phaseCount = static_cast<size_t>(ScanPhase::Count);
+        std::vector<HistogramSnapshot> phases(phaseCount);
+        ULONGLONG scanned = 0, accessDenied = 0, failed = 0, truncated = 0;
+        ULONGLONG modules = 0, regions = 0, bytes = 0, syscalls = 0;
+        size_t shardCount;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shardCount = shards_.size();
+            for (const auto& shard : shards_) {
+                for (size_t phase = 0; phase < phaseCount; phase++) {
+                    phases[phase].Merge(shard->phases_[phase]);
+                }
+                scanned += Read(shard->scanned_);
+                accessDenied += Read(shard->accessDenied_);
+                failed += Read(shard->failed_);
+                truncated += Read(shard->truncated_);
+                modules += Read(shard->modulesVerified_);
+                regions += Read(shard->regionsScanned_);
+                bytes += Read(shard->bytesRead_);
+                syscalls += Read(shard->readSyscalls_);
+            }
+        }
+
+        std::ostringstream out;
+        out << "# HELP processscope_scan_phase_seconds Time spent in each phase of a process scan.\n";
+        out << "# TYPE processscope_scan_phase_seconds histogram\n";
+        for (size_t phase = 0; phase < phaseCount; phase++) {
+            const HistogramSnapshot& histogram = phases[phase];
+            std::string label = std::string("phase=\"") + kPhaseNames[phase] + "\"";
+            for (ULONGLONG bound : kExportBoundsMicros) {
+                out << "processscope_scan_phase_seconds_bucket{" << label << ",le=\"" << Seconds(bound) << "\"} "
+                    << histogram.CountAtOrBelow(bound) << "\n";
+            }
+            ULONGLONG count = histogram.CountAtOrBelow(MAXULONGLONG);
+            out << "processscope_scan_phase_seconds_bucket{" << label << ",le=\"+Inf\"} " << count << "\n";
+            out << "processscope_scan_phase_seconds_sum{" << label << "} " << Seconds(histogram.sumMicros) << "\n";
+            out << "processscope_scan_phase_seconds_count{" << label << "} " << count << "\n";
+        }
+
+        out << "# HELP processscope_scan_phase_quantile_seconds Phase latency quantiles from the full-resolution histogram.\n";
+        out << "# TYPE processscope_scan_phase_quantile_seconds gauge\n";
+        for (size_t phase = 0; phase < phaseCount; phase++) {
+            for (double quantile : kExportQuantiles) {
+                out << "processscope_scan_phase_quantile_seconds{phase=\"" << kPhaseNames[phase] << "\",quantile=\""
+                    << quantile << "\"} " << Seconds(phases[phase].ValueAtQuantile(quantile)) << "\n";
+            }
+            out << "processscope_scan_phase_quantile_seconds{phase=\"" << kPhaseNames[phase] << "\",quantile=\"1\"} "
+                << Seconds(phases[phase].maxMicros) << "\n";
+        }
+
+        auto counter = [&out](const char* name, const char* help, ULONGLONG value) {
+            out << "# HELP " << name << " " << help << "\n";
+            out << "# TYPE " << name << " counter\n";
+            out << name << " " << value << "\n";
+        };
+        counter("processscope_processes_scanned_total", "Processes scanned successfully.", scanned);
+        out << "# HELP processscope_scan_failures_total Scans that could not be completed.\n";
+        out << "# TYPE processscope_scan_failures_total counter\n";
+        out << "processscope_scan_failures_total{reason=\"access_denied\"} " << accessDenied << "\n";
+        out << "processscope_scan_failures_total{reason=\"other\"} " << failed << "\n";
+        counter("processscope_scans_truncated_total", "Scans that exceeded their budget and returned partial results.", truncated);
+        counter("processscope_modules_verified_total", "Modules enumerated and signature-checked.", modules);
+        counter("processscope_memory_regions_scanned_total", "Memory regions examined.", regions);
+        counter("processscope_memory_read_bytes_total", "Bytes read from target processes.", bytes);
+        counter("processscope_memory_read_syscalls_total", "ReadProcessMemory calls issued.", syscalls);
+
+        out << "# HELP processscope_workers Scanner threads recording metrics.\n";
+        out << "# TYPE processscope_workers gauge\n";
+        out << "processscope_workers " << shardCount << "\n";
+        out << "# HELP processscope_uptime_seconds Time since metrics collection started.\n";
+        out << "# TYPE processscope_uptime_seconds gauge\n";
+        out << "processscope_uptime_seconds "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count() << "\n";
+        return out.str();
+    }
+
+} // namespace ProcessScope
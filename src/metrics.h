@@ -0,0 +1,137 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Log-linear latency histogram in the style of HdrHistogram. Values are microseconds; below 32
+    // every value has its own bucket, above that each power of two is split into 16 linear buckets,
+    // so a value is reproduced to within about 6% up to 2^40 us (12 days). Larger values are clamped.
+    // One thread records; any thread may read at the same time. Every cell is an atomic written with
+    // relaxed load-add-store, which needs no lock prefix because there is a single writer.
+    class LatencyHistogram {
+    public:
+        static const int kMaxMagnitude = 40;
+        static const size_t kBucketCount = 32 + (kMaxMagnitude - 5) * 16;
+
+        LatencyHistogram();
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void Record(ULONGLONG micros);
+
+        static size_t BucketIndex(ULONGLONG micros);
+        static ULONGLONG BucketLowerBound(size_t index);
+        static ULONGLONG BucketUpperBound(size_t index);
+
+    private:
+        friend struct HistogramSnapshot;
+
+        std::atomic<ULONGLONG> counts_[kBucketCount];
+        std::atomic<ULONGLONG> total_;
+        std::atomic<ULONGLONG> sumMicros_;
+        std::atomic<ULONGLONG> maxMicros_;
+    };
+
+    // Plain copy of one or more histograms, merged for export
+    struct HistogramSnapshot {
+        std::vector<ULONGLONG> counts;
+        ULONGLONG total;
+        ULONGLONG sumMicros;
+        ULONGLONG maxMicros;
+
+        HistogramSnapshot() : counts(LatencyHistogram::kBucketCount, 0), total(0), sumMicros(0), maxMicros(0) {}
+
+        void Merge(const LatencyHistogram& histogram);
+        ULONGLONG CountAtOrBelow(ULONGLONG micros) const;
+        ULONGLONG ValueAtQuantile(double quantile) const;   // Upper bound of the bucket holding the quantile
+    };
+
+    enum class ScanPhase { Modules, Threads, Memory, Risk, Total, Count };
+
+    // Metrics of one ProcessScanner. Only the scanner's thread records into it.
+    class MetricsShard {
+    public:
+        MetricsShard();
+        MetricsShard(const MetricsShard&) = delete;
+        MetricsShard& operator=(const MetricsShard&) = delete;
+
+        void RecordScan(const ScanResult& result);
+
+    private:
+        friend class ScanMetrics;
+
+        LatencyHistogram phases_[static_cast<size_t>(ScanPhase::Count)];
+        std::atomic<ULONGLONG> scanned_;
+        std::atomic<ULONGLONG> accessDenied_;
+        std::atomic<ULONGLONG> failed_;            // Failures other than access denied
+        std::atomic<ULONGLONG> truncated_;
+        std::atomic<ULONGLONG> modulesVerified_;
+        std::atomic<ULONGLONG> regionsScanned_;
+        std::atomic<ULONGLONG> bytesRead_;
+        std::atomic<ULONGLONG> readSyscalls_;
+    };
+
+    // Registry of per-worker shards. Shards are created once per worker and live as long as the
+    // registry, so the exporter can merge them at any time without coordinating with the workers.
+    class ScanMetrics {
+    private:
+        mutable std::mutex mutex_;      // Guards the shard list only, never the recording path
+        std::vector<std::unique_ptr<MetricsShard>> shards_;
+        std::chrono::steady_clock::time_point start_;
+
+    public:
+        ScanMetrics() : start_(std::chrono::steady_clock::now()) {}
+        ScanMetrics(const ScanMetrics&) = delete;
+        ScanMetrics& operator=(const ScanMetrics&) = delete;
+
+        MetricsShard* CreateShard();
+
+        // Prometheus text exposition format, version 0.0.4
+        std::string FormatPrometheus() const;
+    };
+
+    struct MetricsExportOptions {
+        std::string filePath;       // Rewritten every interval (for a node_exporter textfile collector); empty = off
+        unsigned short port;        // Serves GET /metrics on 127.0.0.1; 0 = off
+        DWORD intervalMs;
+
+        MetricsExportOptions() : port(0), intervalMs(10000) {}
+    };
+
+    // Publishes a ScanMetrics registry from a background thread until stopped. The file is
+    // written beside its final name and renamed over it, so readers never see a partial file.
+    class MetricsExporter {
+    private:
+        const ScanMetrics* metrics_;
+        MetricsExportOptions options_;
+        std::thread thread_;
+        std::atomic<bool> stopping_;
+        UINT_PTR listener_;     // SOCKET; kept opaque so the header does not pull in Winsock
+        bool winsockStarted_;
+
+        void Run();
+        bool WriteMetricsFile(std::string& error);
+        void ServeClient(UINT_PTR client);
+
+    public:
+        MetricsExporter();
+        ~MetricsExporter();
+        MetricsExporter(const MetricsExporter&) = delete;
+        MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+        bool Start(const ScanMetrics& metrics, const MetricsExportOptions& options, std::string& error);
+
+        // Writes the file one last time so it holds the final totals
+        void Stop();
+        bool IsRunning() const { return thread_.joinable(); }
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,186 @@
+// Winsock 2 must be included before windows.h, which would otherwise pull in the old winsock.h
+#include <winsock2.h>
+#include "metrics.h"
+#include <algorithm>
+#include <fstream>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace ProcessScope {
+
+    static const size_t kMaxRequestBytes = 8192;
+
+    MetricsExporter::MetricsExporter() : metrics_(nullptr), stopping_(false), listener_(INVALID_SOCKET), winsockStarted_(false) {}
+
+    MetricsExporter::~MetricsExporter() {
+        Stop();
+    }
+
+    bool MetricsExporter::Start(const ScanMetrics& metrics, const MetricsExportOptions& options, std::string& error) {
+        if (IsRunning()) {
+            error = "Metrics exporter already started";
+            return false;
+        }
+        metrics_ = &metrics;
+        options_ = options;
+        options_.intervalMs = (std::max)(options_.intervalMs, static_cast<DWORD>(100));
+        stopping_ = false;
+
+        if (!options_.filePath.empty() && !WriteMetricsFile(error)) {
+            return false;
+        }
+
+        if (options_.port != 0) {
+            WSADATA wsaData;
+            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+                error = "Winsock initialization failed";
+                return false;
+            }
+            winsockStarted_ = true;
+
+            SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(options_.port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // Never reachable from other hosts
+            if (listener == INVALID_SOCKET ||
+                bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+                listen(listener, SOMAXCONN) == SOCKET_ERROR) {
+                error = "Failed to listen on 127.0.0.1:" + std::to_string(options_.port) + ": Winsock error " +
+                        std::to_string(WSAGetLastError());
+                if (listener != INVALID_SOCKET) {
+                    closesocket(listener);
+                }
+                WSACleanup();
+                winsockStarted_ = false;
+                return false;
+            }
+            listener_ = listener;
+        }
+
+        thread_ = std::thread(&MetricsExporter::Run, this);
+        return true;
+    }
+
+    void MetricsExporter::Stop() {
+        if (!IsRunning()) {
+            return;
+        }
+        stopping_ = true;
+        thread_.join();
+
+        if (listener_ != INVALID_SOCKET) {
+            closesocket(static_cast<SOCKET>(listener_));
+            listener_ = INVALID_SOCKET;
+        }
+        if (winsockStarted_) {
+            WSACleanup();
+            winsockStarted_ = false;
+        }
+        if (!options_.filePath.empty()) {
+            std::string error;
+            WriteMetricsFile(error);
+        }
+    }
+
+    void MetricsExporter::Run() {
+        auto interval = std::chrono::milliseconds(options_.intervalMs);
+        auto nextWrite = std::chrono::steady_clock::now() + interval;
+
+        while (!stopping_) {
+            // Wake at least every 200 ms to notice Stop()
+            auto now = std::chrono::steady_clock::now();
+            long long waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(nextWrite - now).count();
+            waitMs = (std::max)(0LL, (std::min)(waitMs, 200LL));
+
+            if (listener_ != INVALID_SOCKET) {
+                SOCKET listener = static_cast<SOCKET>(listener_);
+                fd_set readable;
+                FD_ZERO(&readable);
+                FD_SET(listener, &readable);
+                timeval timeout;
+                timeout.tv_sec = 0;
+                timeout.tv_usec = static_cast<long>(waitMs * 1000);
+                if (select(0, &readable, nullptr, nullptr, &timeout) > 0) {
+                    SOCKET client = accept(listener, nullptr, nullptr);
+                    if (client != INVALID_SOCKET) {
+                        ServeClient(client);
+                    }
+                }
+            } else {
+                Sleep(static_cast<DWORD>(waitMs));
+            }
+
+            if (!options_.filePath.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+                std::string error;
+                WriteMetricsFile(error);
+                nextWrite = std::chrono::steady_clock::now() + interval;
+            }
+        }
+    }
+
+    bool MetricsExporter::WriteMetricsFile(std::string& error) {
+        std::string temporaryPath = options_.filePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                error = "Failed to create " + temporaryPath;
+                return false;
+            }
+            file << metrics_->FormatPrometheus();
+            if (!file) {
+                error = "Failed to write " + temporaryPath;
+                return false;
+            }
+        }
+        if (!MoveFileExW(StringToWString(temporaryPath).c_str(), StringToWString(options_.filePath).c_str(),
+                         MOVEFILE_REPLACE_EXISTING)) {
+            error = "Failed to replace " + options_.filePath + ": " + GetLastErrorString();
+            return false;
+        }
+        return true;
+    }
+
+    void MetricsExporter::ServeClient(UINT_PTR clientHandle) {
+        SOCKET client = static_cast<SOCKET>(clientHandle);
+        DWORD receiveTimeoutMs = 1000;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&receiveTimeoutMs), sizeof(receiveTimeoutMs));
+
+        // Only the request line matters; read until the end of the headers
+        std::string request;
+        char buffer[1024];
+        while (request.size() < kMaxRequestBytes && request.find("\r\n\r\n") == std::string::npos) {
+            int received = recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            request.append(buffer, received);
+        }
+
+        std::string status;
+        std::string body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+            status = "200 OK";
+            body = metrics_->FormatPrometheus();
+        } else {
+            status = "404 Not Found";
+            body = "Not found\n";
+        }
+        std::string response = "HTTP/1.0 " + status + "\r\n"
+                               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n" + body;
+
+        size_t sent = 0;
+        while (sent < response.size()) {
+            int written = send(client, response.data() + sent, static_cast<int>(response.size() - sent), 0);
+            if (written <= 0) {
+                break;
+            }
+            sent += written;
+        }
+        shutdown(client, SD_SEND);
+        closesocket(client);
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,314 @@
+#include "module_allowlist.h"
+#include "scan_backend.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace ProcessScope {
+
+    // The trusted locations the scorer has always skipped, now anchored at the start of the path
+    static const char* const kBuiltInRules[] = {
+        "path %SystemRoot%\\System32\\",
+        "path %SystemRoot%\\SysWOW64\\",
+        "path %ProgramFiles%\\",
+        "path %ProgramFiles(x86)%\\",
+        "path %ProgramData%\\"
+    };
+
+    // ASCII case folding with '/' read as '\', applied byte by byte so matching never copies the path
+    static std::array<unsigned char, 256> BuildFoldTable() {
+        std::array<unsigned char, 256> table;
+        for (size_t i = 0; i < table.size(); i++) {
+            table[i] = static_cast<unsigned char>(i >= 'A' && i <= 'Z' ? i - 'A' + 'a' : i);
+        }
+        table['/'] = '\\';
+        return table;
+    }
+
+    static const std::array<unsigned char, 256> kFold = BuildFoldTable();
+
+    static std::string Fold(const std::string& text) {
+        std::string folded(text);
+        for (auto& c : folded) {
+            c = static_cast<char>(kFold[static_cast<unsigned char>(c)]);
+        }
+        return folded;
+    }
+
+    static bool HasExtendedPrefix(const char* path, size_t length) {
+        return length >= 4 && path[0] == '\\' && path[1] == '\\' && path[2] == '?' && path[3] == '\\';
+    }
+
+    // Expanded and folded, without a \\?\ prefix, so it compares like a module path
+    static std::string NormalizePathRule(const std::string& value) {
+        std::string folded = Fold(ExpandEnvironmentVariables(value));
+        if (HasExtendedPrefix(folded.data(), folded.size())) {
+            folded.erase(0, 4);
+        }
+        return folded;
+    }
+
+    static int HexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool ImageDigest::operator==(const ImageDigest& other) const {
+        return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+    }
+
+    size_t ImageDigestHasher::operator()(const ImageDigest& digest) const {
+        size_t value;
+        memcpy(&value, digest.bytes, sizeof(value));
+        return value;
+    }
+
+    size_t FoldedStringHasher::operator()(const std::string& text) const {
+        // FNV-1a over folded bytes
+        ULONGLONG hash = 14695981039346656037ULL;
+        for (char c : text) {
+            hash = (hash ^ kFold[static_cast<unsigned char>(c)]) * 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+    bool FoldedStringEqual::operator()(const std::string& left, const std::string& right) const {
+        if (left.size() != right.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < left.size(); i++) {
+            if (kFold[static_cast<unsigned char>(left[i])] != kFold[static_cast<unsigned char>(right[i])]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const ModuleAllowlist& ModuleAllowlist::BuiltIn() {
+        static const ModuleAllowlist builtIn = [] {
+            ModuleAllowlist allowlist;
+            std::string error;
+            for (const char* rule : kBuiltInRules) {
+                allowlist.AddRule(rule, error);
+            }
+            allowlist.Compile();
+            return allowlist;
+        }();
+        return builtIn;
+    }
+
+    bool ModuleAllowlist::AddRule(const std::string& rule, std::string& error) {
+        size_t kindEnd = rule.find_first_of(" \t");
+        std::string kind = rule.substr(0, kindEnd);
+        size_t valueStart = kindEnd == std::string::npos ? std::string::npos : rule.find_first_not_of(" \t", kindEnd);
+        if (valueStart == std::string::npos) {
+            error = "Missing value for '" + kind + "'";
+            return false;
+        }
+        size_t valueEnd = rule.find_last_not_of(" \t\r");
+        std::string value = rule.substr(valueStart, valueEnd - valueStart + 1);
+
+        if (kind == "path") {
+            if (value.find_first_of("*?") != std::string::npos) {
+                error = "Wildcards need a glob rule";
+                return false;
+            }
+            std::string prefix = NormalizePathRule(value);
+            // A directory, so C:\Program Files does not also cover C:\Program Files Extra
+            if (prefix.back() != '\\') {
+                prefix += '\\';
+            }
+            pathRules_.push_back(prefix);
+        } else if (kind == "glob") {
+            std::string pattern = NormalizePathRule(value);
+            pattern.erase(std::unique(pattern.begin(), pattern.end(),
+                                      [](char left, char right) { return left == '*' && right == '*'; }),
+                          pattern.end());
+            globRules_.push_back(pattern);
+        } else if (kind == "signer") {
+            signers_.insert(value);
+        } else if (kind == "sha256") {
+            ImageDigest digest;
+            if (value.size() != sizeof(digest.bytes) * 2) {
+                error = "SHA-256 digest must be 64 hex digits";
+                return false;
+            }
+            for (size_t i = 0; i < sizeof(digest.bytes); i++) {
+                int high = HexValue(value[i * 2]);
+                int low = HexValue(value[i * 2 + 1]);
+                if (high < 0 || low < 0) {
+                    error = "SHA-256 digest must be 64 hex digits";
+                    return false;
+                }
+                digest.bytes[i] = static_cast<BYTE>((high << 4) | low);
+            }
+            digests_.insert(digest);
+        } else {
+            error = "Unknown rule '" + kind + "' (expected path, glob, signer or sha256)";
+            return false;
+        }
+        return true;
+    }
+
+    void ModuleAllowlist::Compile() {
+        // Built with ordered child maps, then laid out breadth-first so each node's children are
+        // contiguous in nodes_ and labels_
+        struct BuildNode {
+            std::map<unsigned char, size_t> children;
+            bool terminal;
+            bool accepting;
+
+            BuildNode() : terminal(false), accepting(false) {}
+        };
+        std::vector<BuildNode> build(1);
+        auto insert = [&build](const std::string& key) {
+            size_t node = 0;
+            for (char c : key) {
+                unsigned char label = static_cast<unsigned char>(c);
+                auto it = build[node].children.find(label);
+                if (it != build[node].children.end()) {
+                    node = it->second;
+                    continue;
+                }
+                build.push_back(BuildNode());
+                build[node].children[label] = build.size() - 1;
+                node = build.size() - 1;
+            }
+            return node;
+        };
+
+        for (const auto& prefix : pathRules_) {
+            build[insert(prefix)].terminal = true;
+        }
+        for (const auto& glob : globRules_) {
+            build[insert(glob)].accepting = true;
+        }
+
+        nodes_.assign(1, TrieNode());
+        labels_.assign(1, 0);
+        std::vector<size_t> source(1, 0);
+        for (size_t i = 0; i < source.size(); i++) {
+            const BuildNode& node = build[source[i]];
+            nodes_[i].terminal = node.terminal;
+            nodes_[i].accepting = node.accepting;
+            nodes_[i].firstChild = static_cast<uint32_t>(nodes_.size());
+            nodes_[i].childCount = static_cast<uint32_t>(node.children.size());
+            for (const auto& child : node.children) {
+                nodes_[i].wildcardChild = nodes_[i].wildcardChild || child.first == '*' || child.first == '?';
+                nodes_.push_back(TrieNode());
+                labels_.push_back(child.first);
+                source.push_back(child.second);
+            }
+        }
+    }
+
+    bool ModuleAllowlist::Load(const std::string& path, std::string& error) {
+        std::ifstream file(path);
+        if (!file) {
+            error = "Failed to open " + path;
+            return false;
+        }
+
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            std::string ruleError;
+            if (!AddRule(line.substr(start), ruleError)) {
+                error = path + ":" + std::to_string(lineNumber) + ": " + ruleError;
+                return false;
+            }
+        }
+        Compile();
+        return true;
+    }
+
+    bool ModuleAllowlist::MatchesPath(const char* path, size_t length) const {
+        if (nodes_.empty()) {
+            return false;
+        }
+        if (HasExtendedPrefix(path, length)) {
+            path += 4;
+            length -= 4;
+        }
+        return MatchFrom(0, path, length, 0);
+    }
+
+    // Follows literal edges iteratively and recurses only into wildcard edges: '?' takes one
+    // character, '*' every possible run. Recursion depth is bounded by the wildcards in one glob.
+    bool ModuleAllowlist::MatchFrom(uint32_t node, const char* path, size_t length, size_t position) const {
+        for (;;) {
+            const TrieNode& current = nodes_[node];
+            if (current.terminal || (current.accepting && position == length)) {
+                return true;
+            }
+
+            const unsigned char* first = labels_.data() + current.firstChild;
+            const unsigned char* last = first + current.childCount;
+            if (current.wildcardChild) {
+                for (const unsigned char* label = first; label != last; ++label) {
+                    uint32_t child = current.firstChild + static_cast<uint32_t>(label - first);
+                    if (*label == '?') {
+                        if (position < length && MatchFrom(child, path, length, position + 1)) {
+                            return true;
+                        }
+                    } else if (*label == '*') {
+                        // A trailing '*' takes the rest of the path
+                        if (nodes_[child].accepting && nodes_[child].childCount == 0) {
+                            return true;
+                        }
+                        for (size_t next = position; next <= length; next++) {
+                            if (MatchFrom(child, path, length, next)) {
+                                return true;
+                            }
+                        }
+                    }
+                }
+            }
+            if (position == length) {
+                return false;
+            }
+
+            unsigned char label = kFold[static_cast<unsigned char>(path[position])];
+            const unsigned char* found = std::find(first, last, label);
+            if (found == last) {
+                return false;
+            }
+            node = current.firstChild + static_cast<uint32_t>(found - first);
+            position++;
+        }
+    }
+
+    bool ModuleAllowlist::MatchesSigner(const std::string& signerName) const {
+        return !signerName.empty() && signers_.count(signerName) > 0;
+    }
+
+    bool ModuleAllowlist::MatchesDigest(const ImageDigest& digest) const {
+        return digests_.count(digest) > 0;
+    }
+
+    bool ModuleAllowlist::Matches(const ModuleInfo& module, ImageSource& images) const {
+        if (MatchesPath(module.fullPath)) {
+            return true;
+        }
+        if (module.isSigned && MatchesSigner(module.signerName)) {
+            return true;
+        }
+        if (!digests_.empty()) {
+            ImageDigest digest;
+            if (images.GetDigest(module.fullPath, digest) && MatchesDigest(digest)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "util.h"
+#include "module_enum.h"
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace ProcessScope {
+
+    class ImageSource;
+
+    // SHA-256 of an image file
+    struct ImageDigest {
+        BYTE bytes[32];
+        bool operator==(const ImageDigest& other) const;
+    };
+
+    struct ImageDigestHasher {
+        size_t operator()(const ImageDigest& digest) const;
+    };
+
+    // Signer names compare case-insensitively without lowercasing a copy
+    struct FoldedStringHasher {
+        size_t operator()(const std::string& text) const;
+    };
+
+    struct FoldedStringEqual {
+        bool operator()(const std::string& left, const std::string& right) const;
+    };
+
+    // Modules trusted by the scorer. Rules, one per line with '#' comments:
+    //   path <directory>     everything under the directory
+    //   glob <pattern>       full path, '*' and '?' wildcards ('*' crosses '\')
+    //   signer <name>        signed by this subject (exact, case-insensitive)
+    //   sha256 <hex>         the module file has this digest
+    // Paths and globs expand %VARIABLES% and compare case-insensitively, with '/' equal to '\'.
+    // Both are compiled into one prefix trie in which a glob's '*' and '?' are edges of their own
+    // (neither can occur in a file name). Globs sharing a prefix share nodes, so a lookup walks
+    // the path once, branching only at wildcards, however many rules there are.
+    class ModuleAllowlist {
+    private:
+        // Children of a node are contiguous, so a step scans a short run of labels
+        struct TrieNode {
+            uint32_t firstChild;
+            uint32_t childCount;
+            bool terminal;          // A path rule ends here; anything may follow
+            bool accepting;         // A glob ends here; the path must end too
+            bool wildcardChild;     // Some child is '*' or '?'
+
+            TrieNode() : firstChild(0), childCount(0), terminal(false), accepting(false), wildcardChild(false) {}
+        };
+
+        std::vector<std::string> pathRules_;    // Folded, ending in '\'
+        std::vector<std::string> globRules_;    // Folded, runs of '*' collapsed
+        std::vector<TrieNode> nodes_;
+        std::vector<unsigned char> labels_;     // labels_[i] leads into nodes_[i]
+        std::unordered_set<std::string, FoldedStringHasher, FoldedStringEqual> signers_;
+        std::unordered_set<ImageDigest, ImageDigestHasher> digests_;
+
+        bool MatchFrom(uint32_t node, const char* path, size_t length, size_t position) const;
+
+    public:
+        // Windows\System32, Windows\SysWOW64, Program Files (both) and ProgramData
+        static const ModuleAllowlist& BuiltIn();
+
+        // Rules take effect once compiled; Load compiles on success
+        bool AddRule(const std::string& rule, std::string& error);
+        void Compile();
+        bool Load(const std::string& path, std::string& error);
+
+        bool MatchesPath(const char* path, size_t length) const;
+        bool MatchesPath(const std::string& path) const { return MatchesPath(path.data(), path.size()); }
+        bool MatchesSigner(const std::string& signerName) const;
+        bool MatchesDigest(const ImageDigest& digest) const;
+
+        // Path rules first, then the signer of a signed module, then the file digest from images
+        // when there are digest rules
+        bool Matches(const ModuleInfo& module, ImageSource& images) const;
+
+        size_t PathRuleCount() const { return pathRules_.size(); }
+        size_t GlobRuleCount() const { return globRules_.size(); }
+        size_t SignerRuleCount() const { return signers_.size(); }
+        size_t DigestRuleCount() const { return digests_.size(); }
+    };
+
+#ifdef _WIN32
+    // SHA-256 of a file on disk, cached by path while its size and last write time are unchanged.
+    // The cache holds the most recently used 4096 images.
+    bool ComputeImageDigest(const std::string& path, ImageDigest& digest);
+#endif
+
+} // namespace ProcessScope
@@ -0,0 +1,125 @@
+#include "module_allowlist.h"
+#include <bcrypt.h>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#pragma comment(lib, "bcrypt.lib")
+
+namespace ProcessScope {
+
+    static const size_t kDigestReadSize = 1 << 20;
+
+    // Image digests kept before the least recently used is dropped; a sweep sees far fewer images
+    static const size_t kMaxCachedDigests = 4096;
+
+    // Opened once; algorithm handles may be shared between threads
+    static BCRYPT_ALG_HANDLE Sha256Provider() {
+        static BCRYPT_ALG_HANDLE provider = [] {
+            BCRYPT_ALG_HANDLE handle = nullptr;
+            if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&handle, BCRYPT_SHA256_ALGORITHM, nullptr, 0))) {
+                handle = nullptr;
+            }
+            return handle;
+        }();
+        return provider;
+    }
+
+    static bool ComputeImageDigestUncached(const std::string& path, ImageDigest& digest) {
+        BCRYPT_ALG_HANDLE provider = Sha256Provider();
+        if (!provider) {
+            return false;
+        }
+        Handle file(CreateFileW(StringToWString(path).c_str(), GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+        if (!file) {
+            return false;
+        }
+
+        BCRYPT_HASH_HANDLE hashHandle = nullptr;
+        if (!BCRYPT_SUCCESS(BCryptCreateHash(provider, &hashHandle, nullptr, 0, nullptr, 0, 0))) {
+            return false;
+        }
+        std::vector<BYTE> buffer(kDigestReadSize);
+        bool ok = true;
+        for (;;) {
+            DWORD bytesRead = 0;
+            if (!ReadFile(file.get(), buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr)) {
+                ok = false;
+                break;
+            }
+            if (bytesRead == 0) {
+                break;
+            }
+            if (!BCRYPT_SUCCESS(BCryptHashData(hashHandle, buffer.data(), bytesRead, 0))) {
+                ok = false;
+                break;
+            }
+        }
+        ok = ok && BCRYPT_SUCCESS(BCryptFinishHash(hashHandle, digest.bytes, sizeof(digest.bytes), 0));
+        BCryptDestroyHash(hashHandle);
+        return ok;
+    }
+
+    struct DigestCacheEntry {
+        std::string path;
+        ULONGLONG lastWriteTime;
+        ULONGLONG fileSize;
+        bool valid;
+        ImageDigest digest;
+    };
+
+    typedef std::list<DigestCacheEntry> DigestCacheList;
+
+    static std::mutex g_digestCacheMutex;
+    static DigestCacheList g_digestLru;     // Most recently used at the front
+    static std::unordered_map<std::string, DigestCacheList::iterator> g_digestCache;
+
+    bool ComputeImageDigest(const std::string& path, ImageDigest& digest) {
+        // Same revalidation as the signature cache: a cached digest holds while size and last
+        // write time are unchanged
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (path.empty() || !GetFileAttributesExW(StringToWString(path).c_str(), GetFileExInfoStandard, &attributes)) {
+            return false;
+        }
+        ULONGLONG lastWriteTime = (static_cast<ULONGLONG>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                                  attributes.ftLastWriteTime.dwLowDateTime;
+        ULONGLONG fileSize = (static_cast<ULONGLONG>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+
+        {
+            std::lock_guard<std::mutex> lock(g_digestCacheMutex);
+            auto it = g_digestCache.find(path);
+            if (it != g_digestCache.end() &&
+                it->second->lastWriteTime == lastWriteTime && it->second->fileSize == fileSize) {
+                g_digestLru.splice(g_digestLru.begin(), g_digestLru, it->second);
+                digest = it->second->digest;
+                return it->second->valid;
+            }
+        }
+
+        // Hashed outside the lock; two threads missing on the same image both hash it
+        DigestCacheEntry entry = {};
+        entry.path = path;
+        entry.lastWriteTime = lastWriteTime;
+        entry.fileSize = fileSize;
+        entry.valid = ComputeImageDigestUncached(path, entry.digest);
+        digest = entry.digest;
+        bool valid = entry.valid;
+
+        std::lock_guard<std::mutex> lock(g_digestCacheMutex);
+        auto existing = g_digestCache.find(path);
+        if (existing != g_digestCache.end()) {
+            g_digestLru.erase(existing->second);
+            g_digestCache.erase(existing);
+        }
+        g_digestLru.push_front(std::move(entry));
+        g_digestCache[g_digestLru.front().path] = g_digestLru.begin();
+        while (g_digestLru.size() > kMaxCachedDigests) {
+            g_digestCache.erase(g_digestLru.back().path);
+            g_digestLru.pop_back();
+        }
+        return valid;
+    }
+
+} // namespace ProcessScope
@@ -1,87 +1,292 @@
 #include "module_enum.h"
 #include <psapi.h>
 #include <tlhelp32.h>
+#include <winternl.h>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 #pragma comment(lib, "psapi.lib")
 
 namespace ProcessScope {
 
-    std::vector<ModuleInfo> ModuleEnumerator::EnumerateModules(HANDLE hProcess) {
+    typedef NTSTATUS (NTAPI *NtQueryInformationProcessFunc)(
+        HANDLE ProcessHandle,
+        PROCESSINFOCLASS ProcessInformationClass,
+        PVOID ProcessInformation,
+        ULONG ProcessInformationLength,
+        PULONG ReturnLength
+    );
+
+    // Loader structures as laid out in a target of the scanner's own bitness.
+    // Only the leading fields that are read are declared; natural alignment gives the
+    // documented offsets for both x86 and x64.
+    struct RemoteListEntry {
+        uintptr_t flink;
+        uintptr_t blink;
+    };
+
+    struct RemoteUnicodeString {
+        USHORT length;          // Bytes, excluding the terminator
+        USHORT maximumLength;
+        uintptr_t buffer;
+    };
+
+    struct RemotePebHead {
+        BYTE reserved[4];
+        uintptr_t mutant;
+        uintptr_t imageBaseAddress;
+        uintptr_t ldr;
+    };
+
+    struct RemoteLdrData {
+        ULONG length;
+        BOOLEAN initialized;
+        uintptr_t ssHandle;
+        RemoteListEntry inLoadOrderModuleList;
+    };
+
+    struct RemoteLdrEntry {
+        RemoteListEntry inLoadOrderLinks;
+        RemoteListEntry inMemoryOrderLinks;
+        RemoteListEntry inInitializationOrderLinks;
+        uintptr_t dllBase;
+        uintptr_t entryPoint;
+        ULONG sizeOfImage;
+        RemoteUnicodeString fullDllName;
+        RemoteUnicodeString baseDllName;
+    };
+
+    static std::string FileNameFromPath(const std::string& path) {
+        size_t lastSlash = path.find_last_of("\\/");
+        return lastSlash != std::string::npos ? path.substr(lastSlash + 1) : path;
+    }
+
+    ModuleEnumerator::ModuleEnumerator() {}
+
+    std::vector<ModuleInfo> ModuleEnumerator::EnumerateModules(HANDLE hProcess, const ScanContext& context,
+                                                               RemoteMemoryReader* reader) {
         std::vector<ModuleInfo> modules;
-        
+
         if (!hProcess) {
             return modules;
         }
 
-        // First try using EnumProcessModules (more reliable for 64-bit processes)
-        HMODULE hMods[1024];
-        DWORD cbNeeded;
-        
-        if (EnumProcessModules(hProcess, hMods, sizeof(hMods), &cbNeeded)) {
-            DWORD moduleCount = cbNeeded / sizeof(HMODULE);
-            
-            for (DWORD i = 0; i < moduleCount; i++) {
-                ModuleInfo info;
-                
-                // Get module full path
-                WCHAR szModName[MAX_PATH * 2];
-                if (GetModuleFileNameExW(hProcess, hMods[i], szModName, sizeof(szModName) / sizeof(WCHAR))) {
-                    info.fullPath = WStringToString(std::wstring(szModName));
-                    
-                    // Extract just the filename
-                    size_t lastSlash = info.fullPath.find_last_of("\\/");
-                    if (lastSlash != std::string::npos) {
-                        info.name = info.fullPath.substr(lastSlash + 1);
-                    } else {
-                        info.name = info.fullPath;
-                    }
-                }
-                
-                // Get module base address and size
-                MODULEINFO modInfo;
-                if (GetModuleInformation(hProcess, hMods[i], &modInfo, sizeof(modInfo))) {
-                    info.baseAddress = reinterpret_cast<uintptr_t>(modInfo.lpBaseOfDll);
-                    info.size = modInfo.SizeOfImage;
+        // Loader list first, then EnumProcessModules, then Toolhelp32 for processes neither can read
+        bool listed = reader && ReadLoaderModules(hProcess, *reader, context, modules);
+#ifdef _DEBUG
+        // A module loading or unloading between the two walks also shows up here, so a difference
+        // is reported rather than asserted
+        if (listed && !context.ShouldStop()) {
+            std::vector<ModuleInfo> psapiModules;
+            if (QueryPsapiModules(hProcess, context, psapiModules)) {
+                std::string difference = DiffModules(psapiModules, modules);
+                if (!difference.empty()) {
+                    OutputDebugStringA(("ProcessScope: loader list differs from PSAPI for PID " +
+                                        std::to_string(GetProcessId(hProcess)) + ": " + difference + "\n").c_str());
                 }
-                
-                // Verify signature
-                if (!info.fullPath.empty()) {
-                    SignatureInfo sigInfo = verifier_.VerifySignature(info.fullPath);
-                    info.isSigned = sigInfo.isSigned;
-                    info.signerName = sigInfo.signerName;
+            }
+        }
+#endif
+        if (!listed) {
+            modules.clear();
+            listed = QueryPsapiModules(hProcess, context, modules);
+        }
+        if (!listed) {
+            modules.clear();
+            QueryToolhelpModules(hProcess, context, modules);
+        }
+
+        VerifySignatures(modules, context);
+        return modules;
+    }
+
+    bool ModuleEnumerator::ReadLoaderModules(HANDLE hProcess, RemoteMemoryReader& reader,
+                                             const ScanContext& context, std::vector<ModuleInfo>& modules) {
+        // A WOW64 boundary means the target's loader structures use the other pointer size
+        BOOL selfWow64 = FALSE;
+        BOOL targetWow64 = FALSE;
+        if (!IsWow64Process(GetCurrentProcess(), &selfWow64) || !IsWow64Process(hProcess, &targetWow64) ||
+            selfWow64 != targetWow64) {
+            return false;
+        }
+
+        HMODULE hNtdll = GetModuleHandleW(L"ntdll.dll");
+        if (!hNtdll) {
+            return false;
+        }
+        NtQueryInformationProcessFunc NtQueryInformationProcessPtr =
+            (NtQueryInformationProcessFunc)GetProcAddress(hNtdll, "NtQueryInformationProcess");
+        if (!NtQueryInformationProcessPtr) {
+            return false;
+        }
+
+        PROCESS_BASIC_INFORMATION basicInfo;
+        if (NtQueryInformationProcessPtr(hProcess, ProcessBasicInformation, &basicInfo, sizeof(basicInfo), nullptr) < 0 ||
+            !basicInfo.PebBaseAddress) {
+            return false;
+        }
+
+        RemotePebHead peb;
+        RemoteLdrData ldr;
+        if (!reader.ReadValue(reinterpret_cast<uintptr_t>(basicInfo.PebBaseAddress), peb) || !peb.ldr ||
+            !reader.ReadValue(peb.ldr, ldr)) {
+            return false;
+        }
+
+        // Chase the list through the page cache; entries are heap neighbours, so most reads hit
+        uintptr_t head = peb.ldr + offsetof(RemoteLdrData, inLoadOrderModuleList);
+        std::vector<RemoteLdrEntry> entries;
+        std::unordered_set<uintptr_t> visited;
+        for (uintptr_t link = ldr.inLoadOrderModuleList.flink; link != head; ) {
+            if (context.ShouldStop()) {
+                break;
+            }
+            RemoteLdrEntry entry;
+            if (!link || !visited.insert(link).second || !reader.ReadValue(link, entry)) {
+                // Torn or corrupted list (e.g. a module loading mid-walk); let the slow path answer
+                return false;
+            }
+            entries.push_back(entry);
+            link = entry.inLoadOrderLinks.flink;
+        }
+
+        // Fetch every path in one coalesced batch
+        std::vector<std::wstring> paths(entries.size());
+        std::vector<ReadRequest> requests;
+        requests.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            paths[i].resize(entries[i].fullDllName.length / sizeof(WCHAR));
+            requests.emplace_back(entries[i].fullDllName.buffer, paths[i].size() * sizeof(WCHAR), &paths[i][0]);
+        }
+        reader.ReadBatch(requests);
+
+        modules.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            ModuleInfo info;
+            paths[i].resize(requests[i].bytesRead / sizeof(WCHAR));
+            info.fullPath = WStringToString(paths[i]);
+            info.name = FileNameFromPath(info.fullPath);
+            info.baseAddress = entries[i].dllBase;
+            info.size = entries[i].sizeOfImage;
+            modules.push_back(info);
+        }
+        return !modules.empty();
+    }
+
+    bool ModuleEnumerator::QueryPsapiModules(HANDLE hProcess, const ScanContext& context, std::vector<ModuleInfo>& modules) {
+        // Grow the handle buffer until it holds every module
+        std::vector<HMODULE> hMods(256);
+        DWORD cbNeeded = 0;
+        for (;;) {
+            DWORD cb = static_cast<DWORD>(hMods.size() * sizeof(HMODULE));
+            if (!EnumProcessModules(hProcess, hMods.data(), cb, &cbNeeded)) {
+                return false;
+            }
+            if (cbNeeded <= cb) {
+                hMods.resize(cbNeeded / sizeof(HMODULE));
+                break;
+            }
+            hMods.resize(cbNeeded / sizeof(HMODULE) + 16);
+        }
+
+        for (HMODULE hMod : hMods) {
+            if (context.ShouldStop()) {
+                break;
+            }
+
+            ModuleInfo info;
+
+            // Get module full path
+            WCHAR szModName[MAX_PATH * 2];
+            if (GetModuleFileNameExW(hProcess, hMod, szModName, sizeof(szModName) / sizeof(WCHAR))) {
+                info.fullPath = WStringToString(std::wstring(szModName));
+                info.name = FileNameFromPath(info.fullPath);
+            }
+
+            // Get module base address and size
+            MODULEINFO modInfo;
+            if (GetModuleInformation(hProcess, hMod, &modInfo, sizeof(modInfo))) {
+                info.baseAddress = reinterpret_cast<uintptr_t>(modInfo.lpBaseOfDll);
+                info.size = modInfo.SizeOfImage;
+            }
+
+            modules.push_back(info);
+        }
+        return true;
+    }
+
+    bool ModuleEnumerator::QueryToolhelpModules(HANDLE hProcess, const ScanContext& context, std::vector<ModuleInfo>& modules) {
+        Handle hSnapshot(CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, GetProcessId(hProcess)));
+        if (!hSnapshot) {
+            return false;
+        }
+
+        MODULEENTRY32 me32;
+        me32.dwSize = sizeof(MODULEENTRY32);
+
+        if (Module32First(hSnapshot.get(), &me32)) {
+            do {
+                if (context.ShouldStop()) {
+                    break;
                 }
-                
+
+                ModuleInfo info;
+                info.name = WStringToString(me32.szModule);
+                info.fullPath = WStringToString(me32.szExePath);
+                info.baseAddress = reinterpret_cast<uintptr_t>(me32.modBaseAddr);
+                info.size = me32.modBaseSize;
                 modules.push_back(info);
+            } while (Module32Next(hSnapshot.get(), &me32));
+        }
+        return true;
+    }
+
+    static bool EqualsIgnoreCase(const std::string& left, const std::string& right) {
+        return left.size() == right.size() &&
+               std::equal(left.begin(), left.end(), right.begin(), [](char a, char b) {
+                   return ::tolower(static_cast<unsigned char>(a)) == ::tolower(static_cast<unsigned char>(b));
+               });
+    }
+
+    std::string ModuleEnumerator::DiffModules(const std::vector<ModuleInfo>& expected, const std::vector<ModuleInfo>& actual) {
+        std::unordered_map<uintptr_t, const ModuleInfo*> byBase;
+        for (const auto& module : actual) {
+            byBase[module.baseAddress] = &module;
+        }
+        for (const auto& module : expected) {
+            auto it = byBase.find(module.baseAddress);
+            if (it == byBase.end()) {
+                return "missing " + module.fullPath + " at 0x" + std::to_string(module.baseAddress);
             }
-        } else {
-            // Fallback to Toolhelp32 for processes we can't query with EnumProcessModules
-            Handle hSnapshot(CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, GetProcessId(hProcess)));
-            if (hSnapshot) {
-                MODULEENTRY32 me32;
-                me32.dwSize = sizeof(MODULEENTRY32);
-                
-                if (Module32First(hSnapshot.get(), &me32)) {
-                    do {
-                        ModuleInfo info;
-                        info.name = WStringToString(me32.szModule);
-                        info.fullPath = WStringToString(me32.szExePath);
-                        info.baseAddress = reinterpret_cast<uintptr_t>(me32.modBaseAddr);
-                        info.size = me32.modBaseSize;
-                        
-                        // Verify signature
-                        if (!info.fullPath.empty()) {
-                            SignatureInfo sigInfo = verifier_.VerifySignature(info.fullPath);
-                            info.isSigned = sigInfo.isSigned;
-                            info.signerName = sigInfo.signerName;
-                        }
-                        
-                        modules.push_back(info);
-                    } while (Module32Next(hSnapshot.get(), &me32));
-                }
+            if (it->second->size != module.size) {
+                return "size of " + module.fullPath + " is " + std::to_string(it->second->size) + ", expected " +
+                       std::to_string(module.size);
+            }
+            if (!EqualsIgnoreCase(it->second->fullPath, module.fullPath)) {
+                return "path at 0x" + std::to_string(module.baseAddress) + " is " + it->second->fullPath + ", expected " +
+                       module.fullPath;
+            }
+        }
+        if (byBase.size() != expected.size()) {
+            return std::to_string(byBase.size()) + " modules, expected " + std::to_string(expected.size());
+        }
+        return std::string();
+    }
+
+    void ModuleEnumerator::VerifySignatures(std::vector<ModuleInfo>& modules, const ScanContext& context) {
+        for (size_t i = 0; i < modules.size(); i++) {
+            if (context.ShouldStop()) {
+                modules.resize(i);
+                break;
+            }
+
+            if (!modules[i].fullPath.empty()) {
+                SignatureInfo sigInfo = verifier_.VerifySignature(modules[i].fullPath);
+                modules[i].isSigned = sigInfo.isSigned;
+                modules[i].signerName = sigInfo.signerName;
             }
         }
-        
-        return modules;
     }
 
 } // namespace ProcessScope
@@ -2,6 +2,8 @@
 
 #include "util.h"
 #include "signer_verify.h"
+#include "scan_context.h"
+#include "remote_memory.h"
 #include <vector>
 #include <string>
 
@@ -22,7 +24,27 @@ class ModuleEnumerator {
     private:
         SignatureVerifier verifier_;
         
+        // Signature verification dominates; modules past the budget are dropped rather than reported unsigned
+        void VerifySignatures(std::vector<ModuleInfo>& modules, const ProcessScope::ScanContext& context);
+        
     public:
         explicit ModuleEnumerator();
-        std::vector<ModuleInfo> EnumerateModules(HANDLE hProcess);
+        
+        // Uses the loader list when a reader is given, falling back to the PSAPI and Toolhelp paths
+        std::vector<ModuleInfo> EnumerateModules(HANDLE hProcess, const ProcessScope::ScanContext& context,
+                                                 ProcessScope::RemoteMemoryReader* reader = nullptr);
+        
+        // Fast path: walk PEB->Ldr->InLoadOrderModuleList through the reader, names fetched in one batch.
+        // Only for targets of the same bitness as the scanner; returns false so the caller can fall back.
+        bool ReadLoaderModules(HANDLE hProcess, ProcessScope::RemoteMemoryReader& reader,
+                               const ProcessScope::ScanContext& context, std::vector<ModuleInfo>& modules);
+        
+        // Slow path: EnumProcessModules plus two queries per module, with no module cap
+        bool QueryPsapiModules(HANDLE hProcess, const ProcessScope::ScanContext& context, std::vector<ModuleInfo>& modules);
+        bool QueryToolhelpModules(HANDLE hProcess, const ProcessScope::ScanContext& context, std::vector<ModuleInfo>& modules);
+        
+        // First difference between two module lists, matched by base address with size and path
+        // (case-insensitive) compared too; empty when both hold the same modules in any order.
+        // Debug builds check the loader-list fast path against the PSAPI path with it.
+        static std::string DiffModules(const std::vector<ModuleInfo>& expected, const std::vector<ModuleInfo>& actual);
 };
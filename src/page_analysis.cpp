@@ -0,0 +1,16 @@
+#include "page_analysis.h"
+
+namespace ProcessScope {
+
+    std::string PageAnalysis::ToHex(const std::vector<BYTE>& bitmap) {
+        static const char kDigits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(bitmap.size() * 2);
+        for (BYTE value : bitmap) {
+            hex.push_back(kDigits[value >> 4]);
+            hex.push_back(kDigits[value & 0x0F]);
+        }
+        return hex;
+    }
+
+} // namespace ProcessScope
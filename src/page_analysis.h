@@ -0,0 +1,50 @@
+#pragma once
+
+#include "util.h"
+#include "scan_context.h"
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Per-page working-set state of one region. Bit i of a bitmap is page i (LSB first).
+    struct PageAnalysis {
+        size_t pageCount;
+        size_t residentPages;
+        size_t sharedPages;     // Resident and shared with other processes
+        size_t privatePages;    // Resident and private; in an image region, a copy-on-write (modified) page
+        std::vector<BYTE> residentBitmap;
+        std::vector<BYTE> privateBitmap;
+        bool analyzed;
+
+        PageAnalysis() : pageCount(0), residentPages(0), sharedPages(0), privatePages(0), analyzed(false) {}
+
+        // Lowercase hex of a bitmap, two digits per byte
+        static std::string ToHex(const std::vector<BYTE>& bitmap);
+    };
+
+    // Address range to analyze; results are written to *result
+    struct PageRange {
+        uintptr_t baseAddress;
+        size_t size;
+        PageAnalysis* result;
+
+        PageRange(uintptr_t base, size_t length, PageAnalysis* out) : baseAddress(base), size(length), result(out) {}
+    };
+
+    struct PageAnalysisStats {
+        size_t pagesQueried;
+        size_t queries;         // QueryWorkingSetEx calls
+
+        PageAnalysisStats() : pagesQueried(0), queries(0) {}
+    };
+
+    // Residency and private-copy status for many ranges at once. Every page of every range is
+    // packed into one PSAPI_WORKING_SET_EX_INFORMATION array and queried in large chunks, so a
+    // whole scan costs a handful of QueryWorkingSetEx calls rather than one per region.
+    class PageAnalyzer {
+    public:
+        PageAnalysisStats Analyze(HANDLE hProcess, const std::vector<PageRange>& ranges, const ScanContext& context);
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,86 @@
+#include "page_analysis.h"
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+
+namespace ProcessScope {
+
+    // Entries per QueryWorkingSetEx call; bounds the query buffer to about 1 MB
+    static const size_t kQueryChunkPages = 65536;
+
+    PageAnalysisStats PageAnalyzer::Analyze(HANDLE hProcess, const std::vector<PageRange>& ranges, const ScanContext& context) {
+        PageAnalysisStats stats;
+        const size_t pageSize = GetSystemPageSize();
+
+        std::vector<PSAPI_WORKING_SET_EX_INFORMATION> entries;
+        entries.reserve(kQueryChunkPages);
+
+        for (const PageRange& range : ranges) {
+            PageAnalysis& result = *range.result;
+            result = PageAnalysis();
+            result.pageCount = (range.size + pageSize - 1) / pageSize;
+            result.residentBitmap.assign((result.pageCount + 7) / 8, 0);
+            result.privateBitmap.assign((result.pageCount + 7) / 8, 0);
+        }
+
+        // Ranges are consumed in order; a chunk may end part-way through a range
+        size_t rangeIndex = 0;
+        size_t pageIndex = 0;
+        while (rangeIndex < ranges.size()) {
+            if (context.ShouldStop()) {
+                break;
+            }
+
+            // Fill one chunk, remembering where each entry came from
+            entries.clear();
+            std::vector<std::pair<size_t, size_t>> origins;
+            origins.reserve(kQueryChunkPages);
+            while (rangeIndex < ranges.size() && entries.size() < kQueryChunkPages) {
+                const PageRange& range = ranges[rangeIndex];
+                if (pageIndex >= range.result->pageCount) {
+                    rangeIndex++;
+                    pageIndex = 0;
+                    continue;
+                }
+                PSAPI_WORKING_SET_EX_INFORMATION entry;
+                entry.VirtualAddress = reinterpret_cast<PVOID>(range.baseAddress + pageIndex * pageSize);
+                entry.VirtualAttributes.Flags = 0;
+                entries.push_back(entry);
+                origins.emplace_back(rangeIndex, pageIndex);
+                pageIndex++;
+            }
+            if (entries.empty()) {
+                break;
+            }
+
+            stats.queries++;
+            if (!QueryWorkingSetEx(hProcess, entries.data(),
+                                   static_cast<DWORD>(entries.size() * sizeof(PSAPI_WORKING_SET_EX_INFORMATION)))) {
+                break;
+            }
+            stats.pagesQueried += entries.size();
+
+            for (size_t i = 0; i < entries.size(); i++) {
+                PageAnalysis& result = *ranges[origins[i].first].result;
+                size_t page = origins[i].second;
+                result.analyzed = true;
+
+                const PSAPI_WORKING_SET_EX_BLOCK& block = entries[i].VirtualAttributes;
+                if (!block.Valid) {
+                    continue;
+                }
+                result.residentPages++;
+                result.residentBitmap[page / 8] |= static_cast<BYTE>(1 << (page % 8));
+                if (block.Shared) {
+                    result.sharedPages++;
+                } else {
+                    result.privatePages++;
+                    result.privateBitmap[page / 8] |= static_cast<BYTE>(1 << (page % 8));
+                }
+            }
+        }
+
+        return stats;
+    }
+
+} // namespace ProcessScope
@@ -1,4 +1,5 @@
 #include "process_enum.h"
+#include "process_filter.h"
 #include <tlhelp32.h>
 #include <psapi.h>
 
@@ -6,8 +7,13 @@
 
 namespace ProcessScope {
 
-    std::vector<ProcessInfo> ProcessEnumerator::EnumerateProcesses() {
+    std::vector<ProcessInfo> ProcessEnumerator::EnumerateProcesses(const ProcessFilter* filter) {
         std::vector<ProcessInfo> processes;
+        auto startTime = std::chrono::steady_clock::now();
+        lastStats_ = EnumerationStats();
+        if (filter && filter->IsEmpty()) {
+            filter = nullptr;
+        }
         
         Handle hSnapshot(CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
         if (!hSnapshot) {
@@ -24,8 +30,16 @@ namespace ProcessScope {
                 info.ppid = pe32.th32ParentProcessID;
                 info.name = WStringToString(pe32.szExeFile);
                 info.sessionId = 0; // Will be filled later if accessible
+                lastStats_.snapshotCount++;
+
+                // Reject on snapshot fields first so filtered-out processes cost nothing
+                if (filter && filter->Evaluate(info, false) == ProcessFilter::Match::No) {
+                    lastStats_.rejectedEarly++;
+                    continue;
+                }
 
                 // Try to get additional information for accessible processes
+                lastStats_.opened++;
                 Handle hProcess(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pe32.th32ProcessID));
                 if (hProcess) {
                     // Get full path
@@ -43,14 +57,32 @@ namespace ProcessScope {
                     if (ProcessIdToSessionId(pe32.th32ProcessID, &sessionId)) {
                         info.sessionId = sessionId;
                     }
+
+                    // Get creation time for PID reuse detection
+                    info.creationTime = GetProcessCreationTime(hProcess.get());
+
+                    // Get private commit, a cheap estimate of how long the process takes to scan
+                    info.privateBytes = GetProcessPrivateBytes(hProcess.get());
+
+                    // Account lookups are comparatively slow, so only pay for them when filtering on user
+                    if (filter && filter->NeedsUser()) {
+                        info.user = GetProcessUser(hProcess.get());
+                    }
                 } else {
                     info.architecture = "Unknown";
                 }
 
+                if (filter && filter->Evaluate(info, true) != ProcessFilter::Match::Yes) {
+                    continue;
+                }
+
                 processes.push_back(info);
             } while (Process32Next(hSnapshot.get(), &pe32));
         }
 
+        lastStats_.matched = processes.size();
+        lastStats_.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startTime).count();
         return processes;
     }
 
@@ -86,6 +118,12 @@ namespace ProcessScope {
             info.sessionId = sessionId;
         }
 
+        // Get creation time
+        info.creationTime = GetProcessCreationTime(hProcess.get());
+
+        // Get private commit
+        info.privateBytes = GetProcessPrivateBytes(hProcess.get());
+
         // Get parent PID
         Handle hSnapshot(CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
         if (hSnapshot) {
@@ -4,6 +4,10 @@
 #include <vector>
 #include <string>
 
+namespace ProcessScope {
+    class ProcessFilter;
+}
+
 // Process information for enumeration and analysis
 struct ProcessInfo {
     DWORD pid;
@@ -11,15 +15,34 @@ struct ProcessInfo {
     std::string name;
     std::string fullPath;
     std::string architecture;
+    std::string user;       // DOMAIN\user, only resolved when a filter needs it
     DWORD sessionId;
+    ULONGLONG creationTime; // FILETIME ticks, 0 when the process could not be opened
+    ULONGLONG privateBytes; // Committed private memory, 0 when the process could not be opened
+    
+    ProcessInfo() : pid(0), ppid(0), sessionId(0), creationTime(0), privateBytes(0) {}
+};
+
+// Work done by the last enumeration, to show how much a filter saved
+struct EnumerationStats {
+    size_t snapshotCount;       // Entries in the Toolhelp snapshot
+    size_t rejectedEarly;       // Filtered out before OpenProcess
+    size_t opened;              // Processes opened for detail queries
+    size_t matched;             // Processes returned
+    double elapsedMs;
     
-    ProcessInfo() : pid(0), ppid(0), sessionId(0) {}
+    EnumerationStats() : snapshotCount(0), rejectedEarly(0), opened(0), matched(0), elapsedMs(0) {}
 };
 
 // Process enumeration with detailed information gathering
 class ProcessEnumerator {
+    private:
+        EnumerationStats lastStats_;
+        
     public:
-        std::vector<ProcessInfo> EnumerateProcesses();
+        // Filter predicates on pid/ppid/name are applied straight from the snapshot, before any handle is opened
+        std::vector<ProcessInfo> EnumerateProcesses(const ProcessScope::ProcessFilter* filter = nullptr);
+        const EnumerationStats& LastStats() const { return lastStats_; }
         ProcessInfo GetProcessInfo(DWORD pid);
         bool IsProcessAccessible(DWORD pid);
 };
@@ -0,0 +1,323 @@
+#include "process_filter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace ProcessScope {
+
+    static bool IsOperatorChar(char c) {
+        return c == '(' || c == ')' || c == '!' || c == '&' || c == '|' ||
+               c == '=' || c == '<' || c == '>' || c == '~';
+    }
+
+    bool GlobMatchLower(const std::string& pattern, const std::string& text) {
+        // Iterative wildcard match with single-star backtracking; no allocation
+        size_t p = 0, t = 0;
+        size_t starPattern = std::string::npos, starText = 0;
+        while (t < text.size()) {
+            char c = static_cast<char>(::tolower(static_cast<unsigned char>(text[t])));
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == c)) {
+                p++;
+                t++;
+            } else if (p < pattern.size() && pattern[p] == '*') {
+                starPattern = p++;
+                starText = t;
+            } else if (starPattern != std::string::npos) {
+                p = starPattern + 1;
+                t = ++starText;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') {
+            p++;
+        }
+        return p == pattern.size();
+    }
+
+    bool ProcessFilter::Compile(const std::string& expression, std::string& error) {
+        nodes_.clear();
+        tokens_.clear();
+        root_ = -1;
+        needsDetails_ = false;
+        needsUser_ = false;
+        position_ = 0;
+        error_.clear();
+
+        if (!Tokenize(expression)) {
+            error = error_;
+            return false;
+        }
+        if (tokens_.empty()) {
+            error = "Empty filter expression";
+            return false;
+        }
+
+        int root = ParseOr();
+        if (root >= 0 && position_ != tokens_.size()) {
+            error_ = "Unexpected '" + tokens_[position_].text + "'";
+            root = -1;
+        }
+        tokens_.clear();
+
+        if (root < 0) {
+            nodes_.clear();
+            error = error_;
+            return false;
+        }
+
+        root_ = root;
+        return true;
+    }
+
+    bool ProcessFilter::Tokenize(const std::string& expression) {
+        size_t i = 0;
+        while (i < expression.size()) {
+            char c = expression[i];
+            if (isspace(static_cast<unsigned char>(c))) {
+                i++;
+            } else if (c == '"' || c == '\'') {
+                size_t end = expression.find(c, i + 1);
+                if (end == std::string::npos) {
+                    error_ = "Unterminated quoted string";
+                    return false;
+                }
+                tokens_.push_back({ expression.substr(i + 1, end - i - 1), true });
+                i = end + 1;
+            } else if (IsOperatorChar(c)) {
+                static const char* const twoCharOps[] = { "==", "!=", "!~", "<=", ">=", "&&", "||" };
+                std::string op(1, c);
+                for (const char* candidate : twoCharOps) {
+                    if (expression.compare(i, 2, candidate) == 0) {
+                        op = candidate;
+                        break;
+                    }
+                }
+                tokens_.push_back({ op, false });
+                i += op.size();
+            } else {
+                size_t start = i;
+                while (i < expression.size() && !isspace(static_cast<unsigned char>(expression[i])) &&
+                       !IsOperatorChar(expression[i]) && expression[i] != '"' && expression[i] != '\'') {
+                    i++;
+                }
+                tokens_.push_back({ expression.substr(start, i - start), true });
+            }
+        }
+        return true;
+    }
+
+    int ProcessFilter::AddNode(const Node& node) {
+        nodes_.push_back(node);
+        return static_cast<int>(nodes_.size() - 1);
+    }
+
+    int ProcessFilter::ParseOr() {
+        int left = ParseAnd();
+        while (left >= 0 && position_ < tokens_.size() && !tokens_[position_].word && tokens_[position_].text == "||") {
+            position_++;
+            int right = ParseAnd();
+            if (right < 0) {
+                return -1;
+            }
+            left = AddNode({ NodeKind::Or, Field::Name, Op::Equal, std::string(), 0, left, right });
+        }
+        return left;
+    }
+
+    int ProcessFilter::ParseAnd() {
+        int left = ParseUnary();
+        while (left >= 0 && position_ < tokens_.size() && !tokens_[position_].word && tokens_[position_].text == "&&") {
+            position_++;
+            int right = ParseUnary();
+            if (right < 0) {
+                return -1;
+            }
+            left = AddNode({ NodeKind::And, Field::Name, Op::Equal, std::string(), 0, left, right });
+        }
+        return left;
+    }
+
+    int ProcessFilter::ParseUnary() {
+        if (position_ >= tokens_.size()) {
+            error_ = "Unexpected end of filter expression";
+            return -1;
+        }
+
+        const Token& token = tokens_[position_];
+        if (!token.word && token.text == "!") {
+            position_++;
+            int operand = ParseUnary();
+            if (operand < 0) {
+                return -1;
+            }
+            return AddNode({ NodeKind::Not, Field::Name, Op::Equal, std::string(), 0, operand, -1 });
+        }
+        if (!token.word && token.text == "(") {
+            position_++;
+            int inner = ParseOr();
+            if (inner < 0) {
+                return -1;
+            }
+            if (position_ >= tokens_.size() || tokens_[position_].text != ")") {
+                error_ = "Missing ')'";
+                return -1;
+            }
+            position_++;
+            return inner;
+        }
+        return ParseCompare();
+    }
+
+    int ProcessFilter::ParseCompare() {
+        if (position_ + 3 > tokens_.size()) {
+            error_ = "Incomplete comparison";
+            return -1;
+        }
+
+        const Token& fieldToken = tokens_[position_];
+        const Token& opToken = tokens_[position_ + 1];
+        const Token& valueToken = tokens_[position_ + 2];
+
+        Node node = { NodeKind::Compare, Field::Name, Op::Equal, std::string(), 0, -1, -1 };
+
+        std::string fieldName = ToLower(fieldToken.text);
+        bool numeric = false;
+        if (fieldName == "name")          node.field = Field::Name;
+        else if (fieldName == "path")     node.field = Field::Path;
+        else if (fieldName == "user")     node.field = Field::User;
+        else if (fieldName == "arch")     node.field = Field::Arch;
+        else if (fieldName == "pid")      { node.field = Field::Pid; numeric = true; }
+        else if (fieldName == "ppid")     { node.field = Field::Ppid; numeric = true; }
+        else if (fieldName == "session")  { node.field = Field::Session; numeric = true; }
+        else {
+            error_ = "Unknown filter field '" + fieldToken.text + "'";
+            return -1;
+        }
+
+        if (opToken.word) {
+            error_ = "Expected operator after '" + fieldToken.text + "'";
+            return -1;
+        }
+        const std::string& op = opToken.text;
+        if (op == "==")      node.op = Op::Equal;
+        else if (op == "!=") node.op = Op::NotEqual;
+        else if (op == "~")  node.op = Op::Glob;
+        else if (op == "!~") node.op = Op::NotGlob;
+        else if (op == "<")  node.op = Op::Less;
+        else if (op == "<=") node.op = Op::LessEqual;
+        else if (op == ">")  node.op = Op::Greater;
+        else if (op == ">=") node.op = Op::GreaterEqual;
+        else {
+            error_ = "Unknown operator '" + op + "'";
+            return -1;
+        }
+
+        bool isGlob = node.op == Op::Glob || node.op == Op::NotGlob;
+        bool isOrdering = !isGlob && node.op != Op::Equal && node.op != Op::NotEqual;
+        if ((numeric && isGlob) || (!numeric && isOrdering)) {
+            error_ = "Operator '" + op + "' is not valid for field '" + fieldToken.text + "'";
+            return -1;
+        }
+
+        if (!valueToken.word) {
+            error_ = "Expected value after '" + op + "'";
+            return -1;
+        }
+        if (numeric) {
+            char* end = nullptr;
+            node.number = strtoull(valueToken.text.c_str(), &end, 0);
+            if (valueToken.text.empty() || *end != '\0') {
+                error_ = "Expected a number for field '" + fieldToken.text + "'";
+                return -1;
+            }
+        } else {
+            node.text = ToLower(valueToken.text);
+        }
+
+        if (node.field != Field::Name && node.field != Field::Pid && node.field != Field::Ppid) {
+            needsDetails_ = true;
+        }
+        if (node.field == Field::User) {
+            needsUser_ = true;
+        }
+
+        position_ += 3;
+        return AddNode(node);
+    }
+
+    ProcessFilter::Match ProcessFilter::Evaluate(const ProcessInfo& info, bool detailsAvailable) const {
+        if (root_ < 0) {
+            return Match::Yes;
+        }
+        return EvaluateNode(root_, info, detailsAvailable);
+    }
+
+    ProcessFilter::Match ProcessFilter::EvaluateNode(int index, const ProcessInfo& info, bool detailsAvailable) const {
+        const Node& node = nodes_[index];
+        switch (node.kind) {
+            case NodeKind::And: {
+                Match left = EvaluateNode(node.left, info, detailsAvailable);
+                if (left == Match::No) return Match::No;
+                Match right = EvaluateNode(node.right, info, detailsAvailable);
+                if (right == Match::No) return Match::No;
+                return (left == Match::Yes && right == Match::Yes) ? Match::Yes : Match::Unknown;
+            }
+            case NodeKind::Or: {
+                Match left = EvaluateNode(node.left, info, detailsAvailable);
+                if (left == Match::Yes) return Match::Yes;
+                Match right = EvaluateNode(node.right, info, detailsAvailable);
+                if (right == Match::Yes) return Match::Yes;
+                return (left == Match::No && right == Match::No) ? Match::No : Match::Unknown;
+            }
+            case NodeKind::Not: {
+                Match operand = EvaluateNode(node.left, info, detailsAvailable);
+                if (operand == Match::Unknown) return Match::Unknown;
+                return operand == Match::Yes ? Match::No : Match::Yes;
+            }
+            case NodeKind::Compare:
+            default:
+                if (!detailsAvailable && node.field != Field::Name && node.field != Field::Pid && node.field != Field::Ppid) {
+                    return Match::Unknown;
+                }
+                return EvaluateCompare(node, info) ? Match::Yes : Match::No;
+        }
+    }
+
+    bool ProcessFilter::EvaluateCompare(const Node& node, const ProcessInfo& info) const {
+        ULONGLONG number = 0;
+        const std::string* text = nullptr;
+        switch (node.field) {
+            case Field::Name:    text = &info.name; break;
+            case Field::Path:    text = &info.fullPath; break;
+            case Field::User:    text = &info.user; break;
+            case Field::Arch:    text = &info.architecture; break;
+            case Field::Pid:     number = info.pid; break;
+            case Field::Ppid:    number = info.ppid; break;
+            case Field::Session: number = info.sessionId; break;
+        }
+
+        if (text) {
+            bool equal;
+            if (node.op == Op::Glob || node.op == Op::NotGlob) {
+                equal = GlobMatchLower(node.text, *text);
+                return node.op == Op::Glob ? equal : !equal;
+            }
+            equal = text->size() == node.text.size() &&
+                    std::equal(text->begin(), text->end(), node.text.begin(),
+                               [](char a, char b) { return ::tolower(static_cast<unsigned char>(a)) == b; });
+            return node.op == Op::Equal ? equal : !equal;
+        }
+
+        switch (node.op) {
+            case Op::Equal:        return number == node.number;
+            case Op::NotEqual:     return number != node.number;
+            case Op::Less:         return number < node.number;
+            case Op::LessEqual:    return number <= node.number;
+            case Op::Greater:      return number > node.number;
+            case Op::GreaterEqual: return number >= node.number;
+            default:               return false;
+        }
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Compiled filter expression over ProcessInfo fields, e.g.
+    //   session==1 && path~"C:\Program Files\*" && !(name~svchost*)
+    // Fields: name, path, user, arch (==, !=, ~ glob, !~) and pid, ppid, session (==, !=, <, <=, >, >=).
+    // String comparisons are case-insensitive. The expression is parsed once into a flat node array.
+    class ProcessFilter {
+    public:
+        enum class Match {
+            No,
+            Yes,
+            Unknown
+        };
+
+        ProcessFilter() : root_(-1), needsDetails_(false), needsUser_(false) {}
+
+        bool Compile(const std::string& expression, std::string& error);
+        bool IsEmpty() const { return root_ < 0; }
+
+        // Fields beyond pid/ppid/name need an OpenProcess; user additionally needs a token lookup
+        bool NeedsDetails() const { return needsDetails_; }
+        bool NeedsUser() const { return needsUser_; }
+
+        // Evaluate against a snapshot-only ProcessInfo (detailsAvailable = false) or a fully
+        // populated one. Predicates on unavailable fields yield Unknown, so a No here means the
+        // process can be discarded before any handle is opened.
+        Match Evaluate(const ProcessInfo& info, bool detailsAvailable) const;
+
+    private:
+        enum class NodeKind { And, Or, Not, Compare };
+        enum class Field { Name, Path, User, Arch, Pid, Ppid, Session };
+        enum class Op { Equal, NotEqual, Glob, NotGlob, Less, LessEqual, Greater, GreaterEqual };
+
+        struct Node {
+            NodeKind kind;
+            Field field;
+            Op op;
+            std::string text;
+            ULONGLONG number;
+            int left;
+            int right;
+        };
+
+        struct Token {
+            std::string text;
+            bool word; // Field name or value rather than an operator
+        };
+
+        std::vector<Node> nodes_;
+        int root_;
+        bool needsDetails_;
+        bool needsUser_;
+
+        // Parser state, only used during Compile
+        std::vector<Token> tokens_;
+        size_t position_;
+        std::string error_;
+
+        bool Tokenize(const std::string& expression);
+        int ParseOr();
+        int ParseAnd();
+        int ParseUnary();
+        int ParseCompare();
+        int AddNode(const Node& node);
+
+        Match EvaluateNode(int index, const ProcessInfo& info, bool detailsAvailable) const;
+        bool EvaluateCompare(const Node& node, const ProcessInfo& info) const;
+    };
+
+    // Case-insensitive glob match supporting '*' and '?'; pattern must already be lowercase
+    bool GlobMatchLower(const std::string& pattern, const std::string& text);
+
+} // namespace ProcessScope
@@ -0,0 +1,133 @@
+#include "process_tree.h"
+#include <unordered_map>
+
+namespace ProcessScope {
+
+    void ProcessTree::Build(const std::vector<ProcessInfo>& processes) {
+        const size_t count = processes.size();
+        processes_ = &processes;
+        reusedPidCount_ = 0;
+        parent_.assign(count, kNoParent);
+        depth_.assign(count, 0);
+        subtreeSize_.assign(count, 0);
+        childStart_.assign(count + 1, 0);
+        children_.assign(count, 0);
+        preOrder_.clear();
+        preOrder_.reserve(count);
+
+        std::unordered_map<DWORD, size_t> indexByPid;
+        indexByPid.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            indexByPid.emplace(processes[i].pid, i);
+        }
+
+        // Resolve parents, rejecting PIDs that were reused after the real parent exited
+        for (size_t i = 0; i < count; i++) {
+            const ProcessInfo& child = processes[i];
+            if (child.ppid == child.pid) {
+                continue;
+            }
+            auto it = indexByPid.find(child.ppid);
+            if (it == indexByPid.end()) {
+                continue;
+            }
+            const ProcessInfo& candidate = processes[it->second];
+            if (candidate.creationTime != 0 && child.creationTime != 0 &&
+                candidate.creationTime > child.creationTime) {
+                reusedPidCount_++;
+                continue;
+            }
+            parent_[i] = it->second;
+        }
+
+        // Flatten children into one array indexed by per-parent offsets
+        for (size_t i = 0; i < count; i++) {
+            if (parent_[i] != kNoParent) {
+                childStart_[parent_[i] + 1]++;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            childStart_[i + 1] += childStart_[i];
+        }
+        std::vector<size_t> fill(childStart_.begin(), childStart_.end() - 1);
+        for (size_t i = 0; i < count; i++) {
+            if (parent_[i] != kNoParent) {
+                children_[fill[parent_[i]]++] = i;
+            }
+        }
+
+        // Iterative pre-order from every root; nodes left unvisited sit on a parent cycle
+        // (possible when creation times are unknown), so the first one reached becomes a root
+        std::vector<bool> visited(count, false);
+        std::vector<size_t> stack;
+        auto walk = [&](size_t root) {
+            stack.push_back(root);
+            visited[root] = true;
+            while (!stack.empty()) {
+                size_t node = stack.back();
+                stack.pop_back();
+                preOrder_.push_back(node);
+                for (size_t c = childStart_[node + 1]; c > childStart_[node]; c--) {
+                    size_t child = children_[c - 1];
+                    if (!visited[child]) {
+                        visited[child] = true;
+                        depth_[child] = depth_[node] + 1;
+                        stack.push_back(child);
+                    }
+                }
+            }
+        };
+        for (size_t i = 0; i < count; i++) {
+            if (parent_[i] == kNoParent) {
+                walk(i);
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (!visited[i]) {
+                parent_[i] = kNoParent;
+                depth_[i] = 0;
+                walk(i);
+            }
+        }
+
+        // Bottom-up: accumulate subtree sizes in reverse pre-order
+        for (size_t n = preOrder_.size(); n > 0; n--) {
+            size_t node = preOrder_[n - 1];
+            subtreeSize_[node] += 1;
+            if (parent_[node] != kNoParent) {
+                subtreeSize_[parent_[node]] += subtreeSize_[node];
+            }
+        }
+    }
+
+    LineageInfo ProcessTree::GetLineage(size_t index, const std::vector<LineageInfo>& lineages, const std::vector<int>& ownScores) const {
+        LineageInfo info;
+        if (parent_[index] == kNoParent) {
+            return info;
+        }
+
+        size_t parent = parent_[index];
+        info.parentKnown = true;
+        info.parentName = (*processes_)[parent].name;
+        info.maxAncestorScore = lineages[parent].maxAncestorScore;
+        info.maxAncestorPid = lineages[parent].maxAncestorPid;
+        if (ownScores[parent] > info.maxAncestorScore) {
+            info.maxAncestorScore = ownScores[parent];
+            info.maxAncestorPid = (*processes_)[parent].pid;
+        }
+        return info;
+    }
+
+    void ProcessTree::Print(std::ostream& out) const {
+        for (size_t index : preOrder_) {
+            const ProcessInfo& process = (*processes_)[index];
+            out << std::string(depth_[index] * 2, ' ')
+                << process.pid << "  " << process.name;
+            if (subtreeSize_[index] > 1) {
+                out << "  [" << (subtreeSize_[index] - 1) << " descendants]";
+            }
+            out << "\n";
+        }
+    }
+
+} // namespace ProcessScope
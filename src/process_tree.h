@@ -0,0 +1,56 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Lineage facts for one process, filled by a top-down walk of the process tree
+    struct LineageInfo {
+        std::string parentName;
+        bool parentKnown;
+        int maxAncestorScore;       // Highest own (non-inherited) risk score among scanned ancestors
+        DWORD maxAncestorPid;
+
+        LineageInfo() : parentKnown(false), maxAncestorScore(0), maxAncestorPid(0) {}
+    };
+
+    // Parent/child forest built once per sweep from a process snapshot.
+    // Children are stored in a flat adjacency array and a pre-order is computed up front,
+    // so lineage propagation is a single linear walk instead of per-process lookups.
+    class ProcessTree {
+    private:
+        static constexpr size_t kNoParent = static_cast<size_t>(-1);
+
+        const std::vector<ProcessInfo>* processes_;
+        std::vector<size_t> parent_;
+        std::vector<size_t> childStart_;
+        std::vector<size_t> children_;
+        std::vector<size_t> preOrder_;
+        std::vector<size_t> depth_;
+        std::vector<size_t> subtreeSize_;
+        size_t reusedPidCount_;
+
+    public:
+        ProcessTree() : processes_(nullptr), reusedPidCount_(0) {}
+
+        // Build the forest in O(n); a parent created after its child is a reused PID and is ignored
+        void Build(const std::vector<ProcessInfo>& processes);
+
+        bool HasParent(size_t index) const { return parent_[index] != kNoParent; }
+        size_t Parent(size_t index) const { return parent_[index]; }
+        size_t Depth(size_t index) const { return depth_[index]; }
+        size_t SubtreeSize(size_t index) const { return subtreeSize_[index]; }
+        size_t ReusedPidCount() const { return reusedPidCount_; }
+        const std::vector<size_t>& PreOrder() const { return preOrder_; }
+
+        // Top-down step: derive a node's lineage from its parent's lineage and own score
+        LineageInfo GetLineage(size_t index, const std::vector<LineageInfo>& lineages, const std::vector<int>& ownScores) const;
+
+        void Print(std::ostream& out) const;
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,324 @@
+#include "process_watcher.h"
+#include <evntrace.h>
+#include <evntcons.h>
+#include <tdh.h>
+#include <tlhelp32.h>
+#include <climits>
+#include <cstring>
+
+#pragma comment(lib, "advapi32.lib")
+#pragma comment(lib, "tdh.lib")
+
+namespace ProcessScope {
+
+    static const WCHAR kSessionName[] = L"ProcessScopeWatch";
+
+    // Microsoft-Windows-Kernel-Process
+    static const GUID kKernelProcessProvider = { 0x22fb2cd6, 0x0e7b, 0x422b, { 0xa0, 0xc7, 0x2f, 0xad, 0x1f, 0xd0, 0xe7, 0x16 } };
+    static const ULONGLONG kProcessKeyword = 0x10;      // WINEVENT_KEYWORD_PROCESS
+    static const USHORT kProcessStartEventId = 1;
+    static const USHORT kProcessStopEventId = 2;
+
+    // Names kept for parent lookups. Stop events prune them; if some are lost and the map grows
+    // past this, it is rebuilt from a snapshot of the processes still running.
+    static const size_t kMaxWatchedNames = 65536;
+
+    // Real-time buffers are delivered when full or flushed; small buffers and an explicit flush
+    // every poll interval keep delivery latency close to the interval even when starts are rare
+    static const ULONG kEtwBufferKb = 4;
+
+    static std::string BaseName(const std::wstring& path) {
+        size_t slash = path.find_last_of(L"\\/");
+        return WStringToString(slash == std::wstring::npos ? path : path.substr(slash + 1));
+    }
+
+    static void InitSessionProperties(std::vector<BYTE>& buffer) {
+        buffer.assign(sizeof(EVENT_TRACE_PROPERTIES) + sizeof(kSessionName), 0);
+        EVENT_TRACE_PROPERTIES* properties = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(buffer.data());
+        properties->Wnode.BufferSize = static_cast<ULONG>(buffer.size());
+        properties->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+        properties->Wnode.ClientContext = 2;   // System time stamps
+        properties->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+        properties->BufferSize = kEtwBufferKb;
+        properties->MinimumBuffers = 2;
+        properties->FlushTimer = 1;
+        properties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+    }
+
+    // A top-level event property by name, decoded with the provider's manifest. The payload layout
+    // changes between event versions (v3 adds sequence numbers, token elevation and a mandatory
+    // label SID ahead of ImageName), so nothing is read at fixed offsets.
+    static bool GetEventProperty(PEVENT_RECORD record, const wchar_t* name, std::vector<BYTE>& value) {
+        PROPERTY_DATA_DESCRIPTOR descriptor = {};
+        descriptor.PropertyName = reinterpret_cast<ULONGLONG>(name);
+        descriptor.ArrayIndex = ULONG_MAX;
+        ULONG size = 0;
+        if (TdhGetPropertySize(record, 0, nullptr, 1, &descriptor, &size) != ERROR_SUCCESS || size == 0) {
+            return false;
+        }
+        value.resize(size);
+        return TdhGetProperty(record, 0, nullptr, 1, &descriptor, size, value.data()) == ERROR_SUCCESS;
+    }
+
+    template <typename T>
+    static bool GetEventProperty(PEVENT_RECORD record, const wchar_t* name, T& value) {
+        std::vector<BYTE> bytes;
+        if (!GetEventProperty(record, name, bytes) || bytes.size() != sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, bytes.data(), sizeof(T));
+        return true;
+    }
+
+    static void WINAPI OnEventRecord(PEVENT_RECORD record) {
+        const EVENT_HEADER& header = record->EventHeader;
+        USHORT id = header.EventDescriptor.Id;
+        if ((id != kProcessStartEventId && id != kProcessStopEventId) ||
+            memcmp(&header.ProviderId, &kKernelProcessProvider, sizeof(GUID)) != 0) {
+            return;
+        }
+        ProcessWatcher* watcher = static_cast<ProcessWatcher*>(record->UserContext);
+
+        DWORD pid = 0;
+        if (!GetEventProperty(record, L"ProcessID", pid)) {
+            return;
+        }
+        if (id == kProcessStopEventId) {
+            watcher->OnEtwProcessStop(pid);
+            return;
+        }
+
+        DWORD ppid = 0;
+        ULONGLONG createTime = 0;
+        std::vector<BYTE> name;
+        if (!GetEventProperty(record, L"ParentProcessID", ppid) || !GetEventProperty(record, L"CreateTime", createTime)) {
+            return;
+        }
+        std::wstring imagePath;
+        if (GetEventProperty(record, L"ImageName", name)) {
+            const WCHAR* text = reinterpret_cast<const WCHAR*>(name.data());
+            size_t length = name.size() / sizeof(WCHAR);
+            while (length > 0 && text[length - 1] == 0) {
+                length--;
+            }
+            imagePath.assign(text, length);
+        }
+        watcher->OnEtwProcessStart(pid, ppid, createTime, imagePath);
+    }
+
+    ULONGLONG GetPreciseFileTime() {
+        // Windows 8+; on Windows 7 the coarse clock is used and latencies are only tick-accurate
+        typedef void (WINAPI *GetTimeFunction)(LPFILETIME);
+        static const GetTimeFunction getTime = []() {
+            FARPROC precise = GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetSystemTimePreciseAsFileTime");
+            return precise ? reinterpret_cast<GetTimeFunction>(precise) : &GetSystemTimeAsFileTime;
+        }();
+        FILETIME now;
+        getTime(&now);
+        return (static_cast<ULONGLONG>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    }
+
+    ProcessWatcher::ProcessWatcher()
+        : pollIntervalMs_(0), source_(Source::None), stopping_(false), sessionHandle_(0), traceHandle_(0) {}
+
+    ProcessWatcher::~ProcessWatcher() {
+        Stop();
+    }
+
+    const char* ProcessWatcher::SourceName(Source source) {
+        switch (source) {
+            case Source::Etw: return "ETW";
+            case Source::Poll: return "snapshot polling";
+            default: return "none";
+        }
+    }
+
+    bool ProcessWatcher::Start(const Callback& callback, DWORD pollIntervalMs, bool preferEtw, std::string& error) {
+        if (source_ != Source::None) {
+            error = "Watcher already started";
+            return false;
+        }
+        callback_ = callback;
+        pollIntervalMs_ = pollIntervalMs > 0 ? pollIntervalMs : 1;
+        stopping_ = false;
+        SeedNames();
+
+        etwError_.clear();
+        if (preferEtw && StartEtw(etwError_)) {
+            source_ = Source::Etw;
+            return true;
+        }
+
+        source_ = Source::Poll;
+        thread_ = std::thread(&ProcessWatcher::PollLoop, this);
+        return true;
+    }
+
+    void ProcessWatcher::Stop() {
+        if (source_ == Source::None) {
+            return;
+        }
+        stopping_ = true;
+        if (source_ == Source::Etw) {
+            StopEtw();
+        } else if (thread_.joinable()) {
+            thread_.join();
+        }
+        source_ = Source::None;
+    }
+
+    void ProcessWatcher::SeedNames() {
+        names_.clear();
+        Handle snapshot(CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
+        if (!snapshot) {
+            return;
+        }
+        PROCESSENTRY32 entry;
+        entry.dwSize = sizeof(entry);
+        if (Process32First(snapshot.get(), &entry)) {
+            do {
+                names_[entry.th32ProcessID] = WStringToString(entry.szExeFile);
+            } while (Process32Next(snapshot.get(), &entry));
+        }
+    }
+
+    void ProcessWatcher::Deliver(ProcessEvent& event) {
+        event.observedTime = GetPreciseFileTime();
+        callback_(event);
+    }
+
+    bool ProcessWatcher::StartEtw(std::string& error) {
+        // A session left behind by a run that did not shut down cleanly would make StartTrace fail
+        InitSessionProperties(sessionProperties_);
+        ControlTraceW(0, kSessionName, reinterpret_cast<EVENT_TRACE_PROPERTIES*>(sessionProperties_.data()),
+                      EVENT_TRACE_CONTROL_STOP);
+
+        InitSessionProperties(sessionProperties_);
+        TRACEHANDLE session = 0;
+        ULONG status = StartTraceW(&session, kSessionName, reinterpret_cast<EVENT_TRACE_PROPERTIES*>(sessionProperties_.data()));
+        if (status != ERROR_SUCCESS) {
+            error = "StartTrace failed with status " + std::to_string(status);
+            return false;
+        }
+        sessionHandle_ = session;
+
+        status = EnableTraceEx2(session, &kKernelProcessProvider, EVENT_CONTROL_CODE_ENABLE_PROVIDER,
+                                TRACE_LEVEL_INFORMATION, kProcessKeyword, 0, 0, nullptr);
+        if (status == ERROR_SUCCESS) {
+            EVENT_TRACE_LOGFILEW logFile = {};
+            logFile.LoggerName = const_cast<LPWSTR>(kSessionName);
+            logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+            logFile.EventRecordCallback = OnEventRecord;
+            logFile.Context = this;
+            TRACEHANDLE trace = OpenTraceW(&logFile);
+            if (trace != INVALID_PROCESSTRACE_HANDLE) {
+                traceHandle_ = trace;
+                thread_ = std::thread([trace]() {
+                    TRACEHANDLE handle = trace;
+                    ProcessTrace(&handle, 1, nullptr, nullptr);
+                });
+                flushThread_ = std::thread([this]() {
+                    std::vector<BYTE> properties;
+                    while (!stopping_) {
+                        Sleep(pollIntervalMs_);
+                        InitSessionProperties(properties);
+                        ControlTraceW(sessionHandle_, nullptr, reinterpret_cast<EVENT_TRACE_PROPERTIES*>(properties.data()),
+                                      EVENT_TRACE_CONTROL_FLUSH);
+                    }
+                });
+                return true;
+            }
+            status = GetLastError();
+        }
+
+        error = "Failed to enable the kernel process provider: status " + std::to_string(status);
+        ControlTraceW(session, nullptr, reinterpret_cast<EVENT_TRACE_PROPERTIES*>(sessionProperties_.data()),
+                      EVENT_TRACE_CONTROL_STOP);
+        sessionHandle_ = 0;
+        return false;
+    }
+
+    void ProcessWatcher::StopEtw() {
+        if (flushThread_.joinable()) {
+            flushThread_.join();
+        }
+        InitSessionProperties(sessionProperties_);
+        ControlTraceW(sessionHandle_, nullptr, reinterpret_cast<EVENT_TRACE_PROPERTIES*>(sessionProperties_.data()),
+                      EVENT_TRACE_CONTROL_STOP);
+        CloseTrace(traceHandle_);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        sessionHandle_ = 0;
+        traceHandle_ = 0;
+    }
+
+    void ProcessWatcher::OnEtwProcessStart(DWORD pid, DWORD ppid, ULONGLONG createTime, const std::wstring& imagePath) {
+        ProcessEvent event;
+        event.pid = pid;
+        event.ppid = ppid;
+        event.name = BaseName(imagePath);
+        event.createTime = createTime;
+        auto parent = names_.find(ppid);
+        if (parent != names_.end()) {
+            event.parentName = parent->second;
+        }
+        names_[pid] = event.name;
+        if (names_.size() > kMaxWatchedNames) {
+            SeedNames();
+        }
+        Deliver(event);
+    }
+
+    void ProcessWatcher::OnEtwProcessStop(DWORD pid) {
+        names_.erase(pid);
+    }
+
+    void ProcessWatcher::PollLoop() {
+        std::unordered_map<DWORD, std::string> current;
+        std::vector<ProcessEvent> fresh;
+
+        while (!stopping_) {
+            Sleep(pollIntervalMs_);
+
+            Handle snapshot(CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
+            if (!snapshot) {
+                continue;
+            }
+
+            // A PID missing from the previous snapshot is a new process. A PID reused within one
+            // interval is not noticed; checking creation times would cost an OpenProcess per process per tick.
+            current.clear();
+            fresh.clear();
+            PROCESSENTRY32 entry;
+            entry.dwSize = sizeof(entry);
+            if (Process32First(snapshot.get(), &entry)) {
+                do {
+                    std::string name = WStringToString(entry.szExeFile);
+                    if (names_.find(entry.th32ProcessID) == names_.end()) {
+                        ProcessEvent event;
+                        event.pid = entry.th32ProcessID;
+                        event.ppid = entry.th32ParentProcessID;
+                        event.name = name;
+                        fresh.push_back(event);
+                    }
+                    current[entry.th32ProcessID] = std::move(name);
+                } while (Process32Next(snapshot.get(), &entry));
+            }
+            names_.swap(current);
+
+            for (ProcessEvent& event : fresh) {
+                auto parent = names_.find(event.ppid);
+                if (parent != names_.end()) {
+                    event.parentName = parent->second;
+                }
+                Handle process(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, event.pid));
+                if (process) {
+                    event.createTime = GetProcessCreationTime(process.get());
+                }
+                Deliver(event);
+            }
+        }
+    }
+
+} // namespace ProcessScope
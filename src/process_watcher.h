@@ -0,0 +1,76 @@
+#pragma once
+
+#include "util.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // A process start seen by the watcher. Times are FILETIME ticks (100 ns, UTC).
+    struct ProcessEvent {
+        DWORD pid;
+        DWORD ppid;
+        std::string name;           // Image file name, without the directory
+        std::string parentName;     // Empty when the parent was not known to the watcher
+        ULONGLONG createTime;       // 0 when the process exited before it could be queried
+        ULONGLONG observedTime;     // When the watcher delivered the event
+
+        ProcessEvent() : pid(0), ppid(0), createTime(0), observedTime(0) {}
+    };
+
+    // Current time in FILETIME ticks, from the precise system clock where available
+    ULONGLONG GetPreciseFileTime();
+
+    // Reports process starts as they happen. The preferred source is a real-time ETW session on the
+    // Microsoft-Windows-Kernel-Process provider, which sees every start including processes that exit
+    // immediately; it needs administrator rights. Otherwise Toolhelp snapshots are diffed at a short
+    // interval, which is unprivileged but can miss processes that live for less than one interval.
+    class ProcessWatcher {
+    public:
+        enum class Source { None, Etw, Poll };
+        typedef std::function<void(const ProcessEvent&)> Callback;
+
+    private:
+        Callback callback_;
+        DWORD pollIntervalMs_;
+        Source source_;
+        std::atomic<bool> stopping_;
+        std::thread thread_;
+        std::thread flushThread_;
+        std::unordered_map<DWORD, std::string> names_;  // pid -> image name of running processes, for parent lookups
+        ULONGLONG sessionHandle_;
+        ULONGLONG traceHandle_;
+        std::vector<BYTE> sessionProperties_;
+        std::string etwError_;
+
+        bool StartEtw(std::string& error);
+        void StopEtw();
+        void PollLoop();
+        void SeedNames();
+        void Deliver(ProcessEvent& event);
+
+    public:
+        ProcessWatcher();
+        ~ProcessWatcher();
+        ProcessWatcher(const ProcessWatcher&) = delete;
+        ProcessWatcher& operator=(const ProcessWatcher&) = delete;
+
+        // Processes running at Start() are not reported. The callback runs on the watcher thread
+        // and should only queue work. preferEtw=false forces the polling source.
+        bool Start(const Callback& callback, DWORD pollIntervalMs, bool preferEtw, std::string& error);
+        void Stop();
+
+        Source ActiveSource() const { return source_; }
+        const std::string& EtwError() const { return etwError_; }  // Why polling was used instead of ETW
+        static const char* SourceName(Source source);
+
+        // Called from the ETW consumer thread
+        void OnEtwProcessStart(DWORD pid, DWORD ppid, ULONGLONG createTime, const std::wstring& imagePath);
+        void OnEtwProcessStop(DWORD pid);
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,329 @@
+#include "processscope.h"
+#include "scanner.h"
+#include <cstddef>
+#include <cstring>
+
+// Opaque handle behind the C API: one warm scanner plus the state a batch needs
+struct ps_scanner {
+    ProcessScope::ProcessScanner scanner;
+    ProcessScope::CancellationToken cancellation;
+    std::string lastError;
+};
+
+namespace ProcessScope {
+
+    template <size_t N>
+    static void CopyString(char (&dest)[N], const std::string& source) {
+        size_t length = source.size() < N - 1 ? source.size() : N - 1;
+        memcpy(dest, source.data(), length);
+        dest[length] = '\0';
+    }
+
+    // Smallest caller-allocated elements accepted: the API version 2 layouts. Fields appended
+    // later are only written to callers whose struct_size covers them.
+    static const size_t kMinProcessSize = offsetof(ps_process, architecture) + sizeof(ps_process().architecture);
+    static const size_t kMinSummarySize = offsetof(ps_scan_summary, total_ms) + sizeof(double);
+
+    static ps_status Fail(ps_scanner* scanner, ps_status status, const std::string& message) {
+        scanner->lastError = message;
+        return status;
+    }
+
+    // Writes element index of a caller array whose elements are stride bytes apart, copying only
+    // the fields both the caller's and the library's struct have
+    template <typename T>
+    static void StoreElement(T* array, size_t stride, size_t index, T& value) {
+        size_t size = stride < sizeof(T) ? stride : sizeof(T);
+        value.struct_size = static_cast<uint32_t>(size);
+        memcpy(reinterpret_cast<char*>(array) + index * stride, &value, size);
+    }
+
+    // A cancel stays pending until the batch it stops returns, so one issued before or during a
+    // call is never dropped by the call starting
+    class BatchCancellation {
+    private:
+        CancellationToken& token_;
+    public:
+        explicit BatchCancellation(CancellationToken& token) : token_(token) {}
+        ~BatchCancellation() { token_.Reset(); }
+        BatchCancellation(const BatchCancellation&) = delete;
+        BatchCancellation& operator=(const BatchCancellation&) = delete;
+    };
+
+    static ScanOptions ToScanOptions(ps_scanner* scanner, const ps_scan_options* options) {
+        ScanOptions scanOptions;
+        if (options && options->struct_size >= sizeof(ps_scan_options)) {
+            scanOptions.timeoutMs = options->timeout_ms;
+        }
+        scanOptions.cancellation = &scanner->cancellation;
+        return scanOptions;
+    }
+
+    static void ToProcess(const ProcessInfo& info, ps_process& process) {
+        memset(&process, 0, sizeof(process));
+        process.struct_size = sizeof(ps_process);
+        process.pid = info.pid;
+        process.ppid = info.ppid;
+        process.session_id = info.sessionId;
+        process.creation_time = info.creationTime;
+        CopyString(process.name, info.name);
+        CopyString(process.path, info.fullPath);
+        CopyString(process.architecture, info.architecture);
+    }
+
+    static ps_status ToStatus(const ScanResult& result, bool cancelled) {
+        if (!result.success) {
+            if (result.processInfo.pid == 0) {
+                return PS_E_NOT_FOUND;
+            }
+            return result.accessDenied ? PS_E_ACCESS_DENIED : PS_E_SCAN_FAILED;
+        }
+        if (result.truncated) {
+            return cancelled ? PS_E_CANCELLED : PS_E_TIMEOUT;
+        }
+        return PS_OK;
+    }
+
+    // Partial results of a truncated scan are filled in like complete ones
+    static void ToSummary(DWORD pid, const ScanResult& result, bool cancelled, ps_scan_summary& summary) {
+        memset(&summary, 0, sizeof(summary));
+        summary.struct_size = sizeof(ps_scan_summary);
+        summary.pid = pid;
+        summary.status = ToStatus(result, cancelled);
+        if (!result.success) {
+            return;
+        }
+
+        summary.risk_score = result.riskAssessment.score;
+        summary.lineage_score = result.riskAssessment.lineageScore;
+        summary.risk_level = static_cast<int32_t>(result.riskAssessment.level);
+        summary.truncated = result.truncated ? 1 : 0;
+        summary.module_count = static_cast<uint32_t>(result.modules.size());
+        summary.thread_count = static_cast<uint32_t>(result.threads.size());
+        summary.region_count = static_cast<uint32_t>(result.memoryRegions.size());
+        summary.total_ms = result.timings.totalMs;
+        for (const auto& module : result.modules) {
+            if (!module.isSigned) {
+                summary.unsigned_module_count++;
+            }
+        }
+        for (const auto& thread : result.threads) {
+            if (thread.anomalousStart) {
+                summary.anomalous_thread_count++;
+            }
+        }
+        for (const auto& region : result.memoryRegions) {
+            if (region.isSuspicious) {
+                summary.suspicious_region_count++;
+            }
+        }
+    }
+
+    // Flattened copy of a ScanResult; the buffers are reused across a batch to avoid reallocating
+    class ResultView {
+    private:
+        ps_scan_summary summary_;
+        ps_process process_;
+        std::vector<ps_module> modules_;
+        std::vector<ps_thread> threads_;
+        std::vector<ps_region> regions_;
+
+    public:
+        ps_scan_result Build(DWORD pid, const ScanResult& result, bool cancelled) {
+            ToSummary(pid, result, cancelled, summary_);
+            ToProcess(result.processInfo, process_);
+            process_.pid = pid;
+
+            modules_.resize(result.modules.size());
+            for (size_t i = 0; i < result.modules.size(); i++) {
+                const ModuleInfo& source = result.modules[i];
+                ps_module& module = modules_[i];
+                memset(&module, 0, sizeof(module));
+                module.struct_size = sizeof(ps_module);
+                module.base_address = source.baseAddress;
+                module.size = source.size;
+                module.is_signed = source.isSigned ? 1 : 0;
+                CopyString(module.name, source.name);
+                CopyString(module.path, source.fullPath);
+                CopyString(module.signer, source.signerName);
+            }
+
+            threads_.resize(result.threads.size());
+            for (size_t i = 0; i < result.threads.size(); i++) {
+                const ThreadInfo& source = result.threads[i];
+                ps_thread& thread = threads_[i];
+                memset(&thread, 0, sizeof(thread));
+                thread.struct_size = sizeof(ps_thread);
+                thread.tid = source.tid;
+                thread.anomalous_start = source.anomalousStart ? 1 : 0;
+                thread.start_address = source.startAddress;
+                CopyString(thread.start_symbol, source.startSymbol);
+            }
+
+            regions_.resize(result.memoryRegions.size());
+            for (size_t i = 0; i < result.memoryRegions.size(); i++) {
+                const MemoryRegion& source = result.memoryRegions[i];
+                ps_region& region = regions_[i];
+                memset(&region, 0, sizeof(region));
+                region.struct_size = sizeof(ps_region);
+                region.base_address = source.baseAddress;
+                region.size = source.size;
+                region.is_executable = source.isExecutable ? 1 : 0;
+                region.is_writable = source.isWritable ? 1 : 0;
+                region.is_suspicious = source.isSuspicious ? 1 : 0;
+                CopyString(region.state, source.state);
+                CopyString(region.type, source.type);
+                CopyString(region.protection, source.protection);
+            }
+
+            ps_scan_result view;
+            view.struct_size = sizeof(ps_scan_result);
+            view.summary = &summary_;
+            view.process = &process_;
+            view.modules = modules_.data();
+            view.module_count = modules_.size();
+            view.threads = threads_.data();
+            view.thread_count = threads_.size();
+            view.regions = regions_.data();
+            view.region_count = regions_.size();
+            view.details = result.riskAssessment.details.c_str();
+            view.error = result.errorMessage.c_str();
+            return view;
+        }
+    };
+
+} // namespace ProcessScope
+
+using namespace ProcessScope;
+
+extern "C" {
+
+PS_API uint32_t PS_CALL ps_api_version(void) {
+    return PS_API_VERSION;
+}
+
+PS_API ps_status PS_CALL ps_scanner_create(ps_scanner** scanner) {
+    if (!scanner) {
+        return PS_E_INVALID_ARG;
+    }
+    try {
+        *scanner = new ps_scanner();
+        return PS_OK;
+    } catch (...) {
+        *scanner = nullptr;
+        return PS_E_INTERNAL;
+    }
+}
+
+PS_API void PS_CALL ps_scanner_destroy(ps_scanner* scanner) {
+    delete scanner;
+}
+
+PS_API void PS_CALL ps_scanner_cancel(ps_scanner* scanner) {
+    if (scanner) {
+        scanner->cancellation.Cancel();
+    }
+}
+
+PS_API ps_status PS_CALL ps_enumerate_processes(ps_scanner* scanner, const char* filter,
+                                                ps_process* processes, size_t capacity, size_t* count) {
+    if (!scanner || !count || (capacity > 0 && !processes)) {
+        return PS_E_INVALID_ARG;
+    }
+    scanner->lastError.clear();
+    size_t stride = capacity > 0 ? processes[0].struct_size : sizeof(ps_process);
+    if (stride < kMinProcessSize) {
+        return Fail(scanner, PS_E_INVALID_ARG, "processes[0].struct_size must be set to sizeof(ps_process)");
+    }
+    try {
+        ProcessFilter compiled;
+        if (filter && *filter) {
+            std::string error;
+            if (!compiled.Compile(filter, error)) {
+                return Fail(scanner, PS_E_INVALID_ARG, "Invalid filter: " + error);
+            }
+        }
+
+        std::vector<ProcessInfo> found = scanner->scanner.Backend().EnumerateProcesses(&compiled);
+        *count = found.size();
+        size_t copied = found.size() < capacity ? found.size() : capacity;
+        ps_process process;
+        for (size_t i = 0; i < copied; i++) {
+            ToProcess(found[i], process);
+            StoreElement(processes, stride, i, process);
+        }
+        if (found.size() > capacity) {
+            return Fail(scanner, PS_E_BUFFER_TOO_SMALL, "Process buffer too small");
+        }
+        return PS_OK;
+    } catch (const std::exception& e) {
+        return Fail(scanner, PS_E_INTERNAL, e.what());
+    }
+}
+
+PS_API ps_status PS_CALL ps_scan_pids(ps_scanner* scanner, const uint32_t* pids, size_t count,
+                                      const ps_scan_options* options, ps_scan_summary* results) {
+    if (!scanner || (count > 0 && (!pids || !results))) {
+        return PS_E_INVALID_ARG;
+    }
+    scanner->lastError.clear();
+    size_t stride = count > 0 ? results[0].struct_size : sizeof(ps_scan_summary);
+    if (stride < kMinSummarySize) {
+        return Fail(scanner, PS_E_INVALID_ARG, "results[0].struct_size must be set to sizeof(ps_scan_summary)");
+    }
+    try {
+        BatchCancellation batch(scanner->cancellation);
+        ScanOptions scanOptions = ToScanOptions(scanner, options);
+        ps_scan_summary summary;
+        for (size_t i = 0; i < count; i++) {
+            if (scanner->cancellation.IsCancelled()) {
+                for (; i < count; i++) {
+                    memset(&summary, 0, sizeof(summary));
+                    summary.pid = pids[i];
+                    summary.status = PS_E_CANCELLED;
+                    StoreElement(results, stride, i, summary);
+                }
+                return Fail(scanner, PS_E_CANCELLED, "Batch cancelled");
+            }
+            ScanResult result = scanner->scanner.ScanProcess(pids[i], scanOptions);
+            ToSummary(pids[i], result, scanner->cancellation.IsCancelled(), summary);
+            StoreElement(results, stride, i, summary);
+        }
+        return PS_OK;
+    } catch (const std::exception& e) {
+        return Fail(scanner, PS_E_INTERNAL, e.what());
+    }
+}
+
+PS_API ps_status PS_CALL ps_scan_pids_cb(ps_scanner* scanner, const uint32_t* pids, size_t count,
+                                         const ps_scan_options* options,
+                                         ps_result_callback callback, void* user_data) {
+    if (!scanner || !callback || (count > 0 && !pids)) {
+        return PS_E_INVALID_ARG;
+    }
+    scanner->lastError.clear();
+    try {
+        BatchCancellation batch(scanner->cancellation);
+        ScanOptions scanOptions = ToScanOptions(scanner, options);
+        ResultView view;
+        for (size_t i = 0; i < count; i++) {
+            if (scanner->cancellation.IsCancelled()) {
+                return Fail(scanner, PS_E_CANCELLED, "Batch cancelled");
+            }
+            ScanResult result = scanner->scanner.ScanProcess(pids[i], scanOptions);
+            ps_scan_result flat = view.Build(pids[i], result, scanner->cancellation.IsCancelled());
+            if (callback(&flat, user_data) != 0) {
+                break;
+            }
+        }
+        return PS_OK;
+    } catch (const std::exception& e) {
+        return Fail(scanner, PS_E_INTERNAL, e.what());
+    }
+}
+
+PS_API const char* PS_CALL ps_last_error(const ps_scanner* scanner) {
+    return scanner ? scanner->lastError.c_str() : "";
+}
+
+} // extern "C"
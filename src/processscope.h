@@ -0,0 +1,187 @@
+/*
+ * ProcessScope C API
+ *
+ * Stable, JSON-free batch interface to the scanning core for embedding in other agents.
+ * All strings are NUL-terminated UTF-8 and are truncated to fit their fixed-size fields.
+ * Structs begin with struct_size so fields can be appended in later versions without
+ * breaking the ABI; enum values travel in int32_t fields for the same reason.
+ *  - Caller-allocated arrays: set struct_size of the first element to sizeof(struct). The
+ *    library steps through the array by that size, copies only the fields both sides know,
+ *    and sets each element's struct_size to the number of bytes it wrote.
+ *  - Library-owned arrays: elements are struct_size bytes apart, which may exceed the
+ *    caller's sizeof(struct); step through them with PS_ELEMENT.
+ *
+ * A ps_scanner is not thread-safe: use one per thread. ps_scanner_cancel() is the exception
+ * and may be called from any thread to stop an in-flight batch.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(PROCESSSCOPE_SHARED)
+#  if defined(PROCESSSCOPE_BUILDING)
+#    define PS_API __declspec(dllexport)
+#  else
+#    define PS_API __declspec(dllimport)
+#  endif
+#else
+#  define PS_API
+#endif
+
+#define PS_CALL __cdecl
+
+#define PS_API_VERSION 2
+#define PS_MAX_NAME 260
+#define PS_MAX_PATH 520
+
+/* Element i of a library-owned array */
+#define PS_ELEMENT(type, array, i) \
+    ((const type*)((const char*)(array) + (size_t)(i) * (array)->struct_size))
+
+typedef struct ps_scanner ps_scanner;
+
+typedef enum ps_status {
+    PS_OK = 0,
+    PS_E_INVALID_ARG = 1,
+    PS_E_NOT_FOUND = 2,         /* Process does not exist or its details could not be read */
+    PS_E_BUFFER_TOO_SMALL = 3,  /* Required count is returned through the count out-parameter */
+    PS_E_CANCELLED = 4,         /* Per process: cancelled mid-scan, the summary holds partial results */
+    PS_E_INTERNAL = 5,
+    PS_E_ACCESS_DENIED = 6,     /* The process refused to be opened for scanning */
+    PS_E_TIMEOUT = 7,           /* The scan ran out of budget; the summary holds partial results */
+    PS_E_SCAN_FAILED = 8        /* Opened or scanned unsuccessfully for another reason; see the error */
+} ps_status;
+
+typedef enum ps_risk_level {
+    PS_RISK_LOW = 0,
+    PS_RISK_MEDIUM = 1,
+    PS_RISK_HIGH = 2
+} ps_risk_level;
+
+typedef struct ps_scan_options {
+    uint32_t struct_size;
+    uint32_t timeout_ms;        /* Per-process budget, 0 = unlimited */
+} ps_scan_options;
+
+typedef struct ps_process {
+    uint32_t struct_size;
+    uint32_t pid;
+    uint32_t ppid;
+    uint32_t session_id;
+    uint64_t creation_time;     /* FILETIME ticks */
+    char name[PS_MAX_NAME];
+    char path[PS_MAX_PATH];
+    char architecture[16];
+} ps_process;
+
+typedef struct ps_module {
+    uint32_t struct_size;
+    int32_t is_signed;
+    uint64_t base_address;
+    uint64_t size;
+    char name[PS_MAX_NAME];
+    char path[PS_MAX_PATH];
+    char signer[PS_MAX_NAME];
+} ps_module;
+
+typedef struct ps_thread {
+    uint32_t struct_size;
+    uint32_t tid;
+    int32_t anomalous_start;
+    uint32_t reserved;
+    uint64_t start_address;
+    char start_symbol[PS_MAX_NAME];
+} ps_thread;
+
+typedef struct ps_region {
+    uint32_t struct_size;
+    int32_t is_executable;
+    uint64_t base_address;
+    uint64_t size;
+    int32_t is_writable;
+    int32_t is_suspicious;
+    char state[16];
+    char type[16];
+    char protection[32];
+} ps_region;
+
+/* Fixed-size per-process summary, suitable for caller-allocated result arrays */
+typedef struct ps_scan_summary {
+    uint32_t struct_size;
+    uint32_t pid;
+    int32_t status;             /* ps_status */
+    int32_t risk_score;
+    int32_t lineage_score;
+    int32_t risk_level;         /* ps_risk_level */
+    int32_t truncated;
+    uint32_t module_count;
+    uint32_t unsigned_module_count;
+    uint32_t thread_count;
+    uint32_t anomalous_thread_count;
+    uint32_t region_count;
+    uint32_t suspicious_region_count;
+    double total_ms;
+} ps_scan_summary;
+
+/* Full result passed to callbacks. Arrays are owned by the library and valid only during the call. */
+typedef struct ps_scan_result {
+    uint32_t struct_size;
+    const ps_scan_summary* summary;
+    const ps_process* process;
+    const ps_module* modules;
+    size_t module_count;
+    const ps_thread* threads;
+    size_t thread_count;
+    const ps_region* regions;
+    size_t region_count;
+    const char* details;        /* Risk scoring explanation */
+    const char* error;          /* Empty on success */
+} ps_scan_result;
+
+/* Return non-zero to stop the batch after this result */
+typedef int (PS_CALL *ps_result_callback)(const ps_scan_result* result, void* user_data);
+
+PS_API uint32_t PS_CALL ps_api_version(void);
+
+PS_API ps_status PS_CALL ps_scanner_create(ps_scanner** scanner);
+PS_API void PS_CALL ps_scanner_destroy(ps_scanner* scanner);
+
+/*
+ * Thread-safe; stops the current batch after the in-flight scan returns partial results.
+ * Called between batches, it stops the next one before its first scan. Either way the
+ * cancel is spent once that batch returns.
+ */
+PS_API void PS_CALL ps_scanner_cancel(ps_scanner* scanner);
+
+/*
+ * Fill processes with up to capacity entries. *count receives the number of running
+ * processes; PS_E_BUFFER_TOO_SMALL is returned when it exceeds capacity.
+ * filter is an optional --filter expression and may be NULL.
+ */
+PS_API ps_status PS_CALL ps_enumerate_processes(ps_scanner* scanner, const char* filter,
+                                                ps_process* processes, size_t capacity, size_t* count);
+
+/*
+ * Scan pids into a caller-allocated array of count summaries. options may be NULL.
+ * Each summary's status says how its scan went; the call itself returns PS_OK unless
+ * the batch as a whole failed or was cancelled.
+ */
+PS_API ps_status PS_CALL ps_scan_pids(ps_scanner* scanner, const uint32_t* pids, size_t count,
+                                      const ps_scan_options* options, ps_scan_summary* results);
+
+/* Scan pids, delivering each full result to callback as soon as it completes */
+PS_API ps_status PS_CALL ps_scan_pids_cb(ps_scanner* scanner, const uint32_t* pids, size_t count,
+                                         const ps_scan_options* options,
+                                         ps_result_callback callback, void* user_data);
+
+/* Message for a non-OK status returned by the last call on this scanner; empty after a call succeeds */
+PS_API const char* PS_CALL ps_last_error(const ps_scanner* scanner);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,222 @@
+#include "remote_memory.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace ProcessScope {
+
+    // Longest run fetched with one ReadProcessMemory call
+    static const size_t kMaxRunPages = 16;
+
+    // Unrequested pages bridged to join two runs; one extra page is cheaper than another syscall
+    static const size_t kMaxGapPages = 1;
+
+    // Requests larger than this bypass the cache so a bulk read cannot flush it
+    static const size_t kMaxCachedRequestPages = 16;
+
+    RemoteMemoryReader::RemoteMemoryReader(HANDLE process, size_t capacityPages)
+        : process_(process), pageSize_(GetSystemPageSize()), capacity_(capacityPages) {}
+
+    size_t RemoteMemoryReader::Read(uintptr_t address, void* buffer, size_t size) {
+        std::vector<ReadRequest> requests(1, ReadRequest(address, size, buffer));
+        ReadBatch(requests);
+        return requests[0].bytesRead;
+    }
+
+    size_t RemoteMemoryReader::ReadPrefix(uintptr_t address, BYTE* buffer, size_t size) {
+        // Find the readable prefix by halving on failure: O(log n) calls instead of one per page
+        uintptr_t end = address + size;
+        size_t total = 0;
+
+        while (size > 0) {
+            SIZE_T bytesRead = 0;
+            stats_.syscalls++;
+            BOOL ok = ReadProcessMemory(process_, reinterpret_cast<LPCVOID>(address), buffer, size, &bytesRead);
+            stats_.bytesTransferred += bytesRead;
+
+            if (ok || bytesRead > 0) {
+                size_t advanced = ok ? size : bytesRead;
+                total += advanced;
+                address += advanced;
+                buffer += advanced;
+                size = static_cast<size_t>(end - address);
+                continue;
+            }
+
+            size_t firstPage = pageSize_ - (address & (pageSize_ - 1));
+            if (size <= firstPage) {
+                stats_.unreadablePages++;
+                break;
+            }
+            size_t half = ((address + size / 2) & ~static_cast<uintptr_t>(pageSize_ - 1)) - address;
+            size = half < firstPage ? firstPage : half;
+        }
+
+        return total;
+    }
+
+    void RemoteMemoryReader::FetchRun(uintptr_t base, size_t pageCount, PageIndex& fetched, PageList& staging) {
+        std::vector<BYTE> buffer(pageCount * pageSize_);
+        SIZE_T bytesRead = 0;
+        stats_.syscalls++;
+        BOOL ok = ReadProcessMemory(process_, reinterpret_cast<LPCVOID>(base), buffer.data(), buffer.size(), &bytesRead);
+        stats_.bytesTransferred += bytesRead;
+        size_t readablePages = ok ? pageCount : bytesRead / pageSize_;
+
+        for (size_t i = 0; i < pageCount; i++) {
+            CachedPage page;
+            page.base = base + i * pageSize_;
+            page.readable = true;
+
+            if (i < readablePages) {
+                page.data.assign(buffer.begin() + i * pageSize_, buffer.begin() + (i + 1) * pageSize_);
+            } else {
+                // The run hit an unmapped or guard page; fetch the rest one page at a time
+                page.data.resize(pageSize_);
+                SIZE_T pageRead = 0;
+                stats_.syscalls++;
+                page.readable = ReadProcessMemory(process_, reinterpret_cast<LPCVOID>(page.base),
+                                                  page.data.data(), pageSize_, &pageRead) != FALSE;
+                stats_.bytesTransferred += pageRead;
+                if (!page.readable) {
+                    page.data.clear();
+                    stats_.unreadablePages++;
+                }
+            }
+
+            stats_.cacheMisses++;
+            staging.push_back(std::move(page));
+            fetched[staging.back().base] = std::prev(staging.end());
+        }
+    }
+
+    const RemoteMemoryReader::CachedPage* RemoteMemoryReader::FindPage(uintptr_t base, const PageIndex& fetched) {
+        auto fresh = fetched.find(base);
+        if (fresh != fetched.end()) {
+            return &*fresh->second;
+        }
+
+        auto cached = index_.find(base);
+        if (cached == index_.end()) {
+            return nullptr;
+        }
+        stats_.cacheHits++;
+        lru_.splice(lru_.begin(), lru_, cached->second);
+        return &*cached->second;
+    }
+
+    void RemoteMemoryReader::InsertPages(PageList& staging) {
+        if (capacity_ == 0) {
+            return;
+        }
+
+        while (!staging.empty()) {
+            auto page = staging.begin();
+            auto existing = index_.find(page->base);
+            if (existing != index_.end()) {
+                lru_.erase(existing->second);
+            }
+            lru_.splice(lru_.begin(), staging, page);
+            index_[page->base] = lru_.begin();
+        }
+
+        while (lru_.size() > capacity_) {
+            index_.erase(lru_.back().base);
+            lru_.pop_back();
+        }
+    }
+
+    void RemoteMemoryReader::ReadBatch(std::vector<ReadRequest>& requests) {
+        std::vector<size_t> order(requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&requests](size_t a, size_t b) {
+            return requests[a].address < requests[b].address;
+        });
+
+        const uintptr_t pageMask = ~static_cast<uintptr_t>(pageSize_ - 1);
+        std::vector<bool> direct(requests.size(), false);
+        std::vector<uintptr_t> missing;
+
+        for (size_t index : order) {
+            ReadRequest& request = requests[index];
+            request.bytesRead = 0;
+            stats_.requests++;
+            stats_.bytesRequested += request.size;
+            if (request.size == 0) {
+                continue;
+            }
+
+            if (request.size > kMaxCachedRequestPages * pageSize_) {
+                BYTE* out = static_cast<BYTE*>(request.buffer);
+                request.bytesRead = ReadPrefix(request.address, out, request.size);
+                memset(out + request.bytesRead, 0, request.size - request.bytesRead);
+                direct[index] = true;
+                continue;
+            }
+
+            uintptr_t last = (request.address + request.size - 1) & pageMask;
+            for (uintptr_t page = request.address & pageMask; page <= last; page += pageSize_) {
+                if (index_.find(page) == index_.end()) {
+                    missing.push_back(page);
+                }
+            }
+        }
+
+        std::sort(missing.begin(), missing.end());
+        missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+        // Coalesce missing pages into runs, bridging small gaps
+        PageIndex fetched;
+        PageList staging;
+        size_t i = 0;
+        while (i < missing.size()) {
+            uintptr_t runStart = missing[i];
+            size_t runPages = 1;
+            size_t j = i + 1;
+            while (j < missing.size()) {
+                size_t gap = (missing[j] - (runStart + runPages * pageSize_)) / pageSize_;
+                if (gap > kMaxGapPages || runPages + gap + 1 > kMaxRunPages) {
+                    break;
+                }
+                runPages += gap + 1;
+                j++;
+            }
+            FetchRun(runStart, runPages, fetched, staging);
+            i = j;
+        }
+
+        // Serve every request from the fetched and cached pages, stopping at the first unreadable page
+        for (size_t index : order) {
+            ReadRequest& request = requests[index];
+            if (direct[index] || request.size == 0) {
+                continue;
+            }
+
+            BYTE* out = static_cast<BYTE*>(request.buffer);
+            size_t done = 0;
+            while (done < request.size) {
+                uintptr_t address = request.address + done;
+                uintptr_t pageBase = address & pageMask;
+                size_t offset = static_cast<size_t>(address - pageBase);
+                size_t chunk = std::min(pageSize_ - offset, request.size - done);
+
+                const CachedPage* page = FindPage(pageBase, fetched);
+                if (!page || !page->readable) {
+                    break;
+                }
+                memcpy(out + done, page->data.data() + offset, chunk);
+                done += chunk;
+            }
+            request.bytesRead = done;
+            memset(out + done, 0, request.size - done);
+        }
+
+        InsertPages(staging);
+    }
+
+    void RemoteMemoryReader::Invalidate() {
+        lru_.clear();
+        index_.clear();
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "util.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // One range to read from the target; bytesRead is filled in by ReadBatch
+    struct ReadRequest {
+        uintptr_t address;
+        size_t size;
+        void* buffer;
+        size_t bytesRead;   // Contiguous readable prefix; the rest of buffer is zeroed
+
+        ReadRequest() : address(0), size(0), buffer(nullptr), bytesRead(0) {}
+        ReadRequest(uintptr_t addr, size_t length, void* dest) : address(addr), size(length), buffer(dest), bytesRead(0) {}
+    };
+
+    // Counters for tuning how much work the reader saves
+    struct RemoteReaderStats {
+        size_t requests;        // Ranges asked for by callers
+        size_t syscalls;        // ReadProcessMemory calls issued
+        size_t bytesRequested;
+        size_t bytesTransferred;
+        size_t cacheHits;       // Pages served from the cache
+        size_t cacheMisses;     // Pages fetched from the target
+        size_t unreadablePages; // Pages that failed to read (unmapped or guard)
+
+        RemoteReaderStats() : requests(0), syscalls(0), bytesRequested(0), bytesTransferred(0),
+                              cacheHits(0), cacheMisses(0), unreadablePages(0) {}
+    };
+
+    // Page-granular reader for one target process. Requests in a batch are sorted, the pages
+    // they touch are coalesced into runs and each run costs one ReadProcessMemory call.
+    // Fetched pages are kept in a small LRU cache, including negative entries for unreadable
+    // pages, so repeated header and pointer reads stay in-process. Not thread-safe.
+    class RemoteMemoryReader {
+    private:
+        struct CachedPage {
+            uintptr_t base;
+            bool readable;
+            std::vector<BYTE> data;
+        };
+
+        typedef std::list<CachedPage> PageList;
+        typedef std::unordered_map<uintptr_t, PageList::iterator> PageIndex;
+
+        HANDLE process_;
+        size_t pageSize_;
+        size_t capacity_;
+        PageList lru_;          // Most recently used at the front
+        PageIndex index_;
+        RemoteReaderStats stats_;
+
+        size_t ReadPrefix(uintptr_t address, BYTE* buffer, size_t size);
+        void FetchRun(uintptr_t base, size_t pageCount, PageIndex& fetched, PageList& staging);
+        const CachedPage* FindPage(uintptr_t base, const PageIndex& fetched);
+        void InsertPages(PageList& staging);
+
+    public:
+        // capacityPages bounds the cache; 0 disables caching
+        explicit RemoteMemoryReader(HANDLE process, size_t capacityPages = 64);
+        RemoteMemoryReader(const RemoteMemoryReader&) = delete;
+        RemoteMemoryReader& operator=(const RemoteMemoryReader&) = delete;
+
+        // Returns the number of bytes read before the first unreadable page
+        size_t Read(uintptr_t address, void* buffer, size_t size);
+
+        template <typename T>
+        bool ReadValue(uintptr_t address, T& value) {
+            return Read(address, &value, sizeof(T)) == sizeof(T);
+        }
+
+        void ReadBatch(std::vector<ReadRequest>& requests);
+
+        // Drop cached pages, e.g. after the target may have written to them
+        void Invalidate();
+
+        size_t PageSize() const { return pageSize_; }
+        const RemoteReaderStats& Stats() const { return stats_; }
+    };
+
+} // namespace ProcessScope
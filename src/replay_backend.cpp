@@ -0,0 +1,620 @@
+#include "replay_backend.h"
+#include "process_filter.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using json = nlohmann::json;
+
+namespace ProcessScope {
+
+    static const int kSnapshotVersion = 1;
+
+    static std::string ToHexString(const BYTE* data, size_t size) {
+        static const char kDigits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(size * 2);
+        for (size_t i = 0; i < size; i++) {
+            hex.push_back(kDigits[data[i] >> 4]);
+            hex.push_back(kDigits[data[i] & 0x0F]);
+        }
+        return hex;
+    }
+
+    static int HexNibble(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static bool FromHexString(const std::string& hex, std::vector<BYTE>& data) {
+        if (hex.size() % 2 != 0) {
+            return false;
+        }
+        data.resize(hex.size() / 2);
+        for (size_t i = 0; i < data.size(); i++) {
+            int high = HexNibble(hex[i * 2]);
+            int low = HexNibble(hex[i * 2 + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            data[i] = static_cast<BYTE>((high << 4) | low);
+        }
+        return true;
+    }
+
+    static json ProcessToJson(const ProcessInfo& info) {
+        json p;
+        p["pid"] = info.pid;
+        p["ppid"] = info.ppid;
+        p["name"] = info.name;
+        p["full_path"] = info.fullPath;
+        p["architecture"] = info.architecture;
+        p["user"] = info.user;
+        p["session_id"] = info.sessionId;
+        p["creation_time"] = info.creationTime;
+        p["private_bytes"] = info.privateBytes;
+        return p;
+    }
+
+    static ProcessInfo ProcessFromJson(const json& p) {
+        ProcessInfo info;
+        info.pid = p.at("pid").get<DWORD>();
+        info.ppid = p.at("ppid").get<DWORD>();
+        info.name = p.at("name").get<std::string>();
+        info.fullPath = p.at("full_path").get<std::string>();
+        info.architecture = p.at("architecture").get<std::string>();
+        info.user = p.at("user").get<std::string>();
+        info.sessionId = p.at("session_id").get<DWORD>();
+        info.creationTime = p.at("creation_time").get<ULONGLONG>();
+        info.privateBytes = p.value("private_bytes", 0ULL);     // Absent from older snapshots
+        return info;
+    }
+
+    // Replays one recorded address space
+    class ReplayMemorySource : public MemorySource {
+    private:
+        const TargetSnapshot& target_;
+        bool readable_;
+        RemoteReaderStats stats_;
+
+    public:
+        ReplayMemorySource(const TargetSnapshot& target, bool readable) : target_(target), readable_(readable) {}
+
+        // Like VirtualQueryEx, an address between recorded regions lies in free space that ends
+        // at the next one, so a walk from 0 reaches every region of a snapshot that left it out
+        bool Query(uintptr_t address, MEMORY_BASIC_INFORMATION& mbi) override {
+            auto next = target_.regions.upper_bound(address);
+            if (next != target_.regions.begin()) {
+                auto it = std::prev(next);
+                if (address - it->first < it->second.RegionSize) {
+                    mbi = it->second;
+                    return true;
+                }
+            }
+            if (next == target_.regions.end()) {
+                return false;
+            }
+            mbi = MEMORY_BASIC_INFORMATION();
+            mbi.BaseAddress = reinterpret_cast<PVOID>(address);
+            mbi.RegionSize = next->first - address;
+            mbi.State = MEM_FREE;
+            mbi.Protect = PAGE_NOACCESS;
+            return true;
+        }
+
+        size_t Read(uintptr_t address, void* buffer, size_t size) override {
+            stats_.requests++;
+            stats_.bytesRequested += size;
+            if (!readable_) {
+                return 0;
+            }
+            auto it = target_.reads.upper_bound(address);
+            if (it == target_.reads.begin()) {
+                return 0;
+            }
+            --it;
+            size_t offset = address - it->first;
+            if (offset >= it->second.size()) {
+                return 0;
+            }
+            size_t length = (std::min)(size, it->second.size() - offset);
+            memcpy(buffer, it->second.data() + offset, length);
+            stats_.bytesTransferred += length;
+            return length;
+        }
+
+        PageAnalysisStats AnalyzePages(const std::vector<PageRange>& ranges, const ScanContext&) override {
+            PageAnalysisStats stats;
+            for (const PageRange& range : ranges) {
+                auto it = target_.pages.find(range.baseAddress);
+                *range.result = it != target_.pages.end() ? it->second : PageAnalysis();
+                stats.pagesQueried += range.result->pageCount;
+            }
+            stats.queries = ranges.empty() ? 0 : 1;
+            return stats;
+        }
+
+        const RemoteReaderStats& Stats() const { return stats_; }
+    };
+
+    class ReplayTarget : public ScanTarget {
+    private:
+        const TargetSnapshot& target_;
+        ReplayMemorySource memory_;
+
+    public:
+        ReplayTarget(const TargetSnapshot& target, bool readMemory)
+            : target_(target), memory_(target, readMemory && target.readable) {}
+
+        std::vector<ModuleInfo> EnumerateModules(const ScanContext&) override {
+            return target_.modules;
+        }
+
+        std::vector<ThreadInfo> EnumerateThreads(const ScanContext&) override {
+            return target_.threads;
+        }
+
+        MemorySource& Memory() override {
+            return memory_;
+        }
+
+        RemoteReaderStats ReaderStats() const override {
+            return memory_.Stats();
+        }
+
+        // Thread activity is not recorded; a snapshot only holds what a scan read
+        std::vector<ThreadSamples> SampleThreads(const std::vector<ThreadInfo>&, const ThreadSampleOptions&,
+                                                 const ScanContext&, ThreadSamplingStats& stats) override {
+            stats = ThreadSamplingStats();
+            return std::vector<ThreadSamples>();
+        }
+    };
+
+    // Wraps a live address space and keeps a copy of every answer
+    class RecordingMemorySource : public MemorySource {
+    private:
+        MemorySource& inner_;
+        TargetSnapshot& target_;
+
+    public:
+        RecordingMemorySource(MemorySource& inner, TargetSnapshot& target) : inner_(inner), target_(target) {}
+
+        bool Query(uintptr_t address, MEMORY_BASIC_INFORMATION& mbi) override {
+            if (!inner_.Query(address, mbi)) {
+                return false;
+            }
+            target_.regions[reinterpret_cast<uintptr_t>(mbi.BaseAddress)] = mbi;
+            return true;
+        }
+
+        size_t Read(uintptr_t address, void* buffer, size_t size) override {
+            size_t bytesRead = inner_.Read(address, buffer, size);
+            if (bytesRead > 0) {
+                std::vector<BYTE>& stored = target_.reads[address];
+                if (stored.size() < bytesRead) {
+                    stored.assign(static_cast<const BYTE*>(buffer), static_cast<const BYTE*>(buffer) + bytesRead);
+                }
+            }
+            return bytesRead;
+        }
+
+        PageAnalysisStats AnalyzePages(const std::vector<PageRange>& ranges, const ScanContext& context) override {
+            PageAnalysisStats stats = inner_.AnalyzePages(ranges, context);
+            for (const PageRange& range : ranges) {
+                if (range.result->analyzed) {
+                    target_.pages[range.baseAddress] = *range.result;
+                }
+            }
+            return stats;
+        }
+    };
+
+    class RecordingTarget : public ScanTarget {
+    private:
+        std::unique_ptr<ScanTarget> inner_;
+        TargetSnapshot& target_;
+        RecordingMemorySource memory_;
+
+    public:
+        RecordingTarget(std::unique_ptr<ScanTarget> inner, TargetSnapshot& target)
+            : inner_(std::move(inner)), target_(target), memory_(inner_->Memory(), target) {}
+
+        std::vector<ModuleInfo> EnumerateModules(const ScanContext& context) override {
+            std::vector<ModuleInfo> modules = inner_->EnumerateModules(context);
+            target_.modules = modules;
+            return modules;
+        }
+
+        std::vector<ThreadInfo> EnumerateThreads(const ScanContext& context) override {
+            std::vector<ThreadInfo> threads = inner_->EnumerateThreads(context);
+            target_.threads = threads;
+            return threads;
+        }
+
+        MemorySource& Memory() override {
+            return memory_;
+        }
+
+        RemoteReaderStats ReaderStats() const override {
+            return inner_->ReaderStats();
+        }
+
+        std::vector<ThreadSamples> SampleThreads(const std::vector<ThreadInfo>& threads, const ThreadSampleOptions& options,
+                                                 const ScanContext& context, ThreadSamplingStats& stats) override {
+            return inner_->SampleThreads(threads, options, context, stats);
+        }
+    };
+
+    bool HostSnapshot::Save(const std::string& path, std::string& error) const {
+        json j;
+        j["version"] = kSnapshotVersion;
+        j["timestamp"] = GetTimestamp();
+        j["processes"] = json::array();
+        for (const auto& process : processes) {
+            j["processes"].push_back(ProcessToJson(process));
+        }
+
+        j["targets"] = json::array();
+        for (const auto& entry : targets) {
+            const TargetSnapshot& target = entry.second;
+            json t;
+            t["pid"] = entry.first;
+            t["readable"] = target.readable;
+
+            t["modules"] = json::array();
+            for (const auto& module : target.modules) {
+                json m;
+                m["name"] = module.name;
+                m["full_path"] = module.fullPath;
+                m["base_address"] = static_cast<ULONGLONG>(module.baseAddress);
+                m["size"] = module.size;
+                m["is_signed"] = module.isSigned;
+                m["signer_name"] = module.signerName;
+                t["modules"].push_back(m);
+            }
+
+            t["threads"] = json::array();
+            for (const auto& thread : target.threads) {
+                json th;
+                th["tid"] = thread.tid;
+                th["start_address"] = static_cast<ULONGLONG>(thread.startAddress);
+                t["threads"].push_back(th);
+            }
+
+            t["regions"] = json::array();
+            for (const auto& region : target.regions) {
+                const MEMORY_BASIC_INFORMATION& mbi = region.second;
+                json r;
+                r["base_address"] = static_cast<ULONGLONG>(region.first);
+                r["allocation_base"] = static_cast<ULONGLONG>(reinterpret_cast<uintptr_t>(mbi.AllocationBase));
+                r["allocation_protect"] = mbi.AllocationProtect;
+                r["size"] = static_cast<ULONGLONG>(mbi.RegionSize);
+                r["state"] = mbi.State;
+                r["protect"] = mbi.Protect;
+                r["type"] = mbi.Type;
+                t["regions"].push_back(r);
+            }
+
+            t["reads"] = json::array();
+            for (const auto& read : target.reads) {
+                json r;
+                r["address"] = static_cast<ULONGLONG>(read.first);
+                r["data"] = ToHexString(read.second.data(), read.second.size());
+                t["reads"].push_back(r);
+            }
+
+            t["pages"] = json::array();
+            for (const auto& range : target.pages) {
+                const PageAnalysis& analysis = range.second;
+                json p;
+                p["address"] = static_cast<ULONGLONG>(range.first);
+                p["page_count"] = analysis.pageCount;
+                p["resident"] = analysis.residentPages;
+                p["shared"] = analysis.sharedPages;
+                p["private"] = analysis.privatePages;
+                p["resident_bitmap"] = PageAnalysis::ToHex(analysis.residentBitmap);
+                p["private_bitmap"] = PageAnalysis::ToHex(analysis.privateBitmap);
+                t["pages"].push_back(p);
+            }
+
+            j["targets"].push_back(t);
+        }
+
+        j["images"] = json::array();
+        for (const auto& entry : images) {
+            const ImageSnapshot& image = entry.second;
+            json i;
+            i["path"] = entry.first;
+            i["exports"] = json::array();
+            for (const auto& symbol : image.exports) {
+                json e;
+                e["rva"] = symbol.rva;
+                e["name"] = symbol.name;
+                i["exports"].push_back(e);
+            }
+            if (image.hasDigest) {
+                i["sha256"] = ToHexString(image.digest.bytes, sizeof(image.digest.bytes));
+            }
+            if (image.hasAttributes) {
+                i["size"] = image.attributes.fileSize;
+                i["last_write_time"] = image.attributes.lastWriteTime;
+            }
+            j["images"].push_back(i);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            error = "Failed to create " + path;
+            return false;
+        }
+        file << j.dump();
+        if (!file) {
+            error = "Failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool HostSnapshot::Load(const std::string& path, std::string& error) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            error = "Failed to open " + path;
+            return false;
+        }
+
+        HostSnapshot loaded;
+        try {
+            json j = json::parse(file);
+            if (j.at("version").get<int>() != kSnapshotVersion) {
+                error = path + ": unsupported snapshot version";
+                return false;
+            }
+
+            for (const auto& p : j.at("processes")) {
+                loaded.processes.push_back(ProcessFromJson(p));
+            }
+
+            for (const auto& t : j.at("targets")) {
+                TargetSnapshot& target = loaded.targets[t.at("pid").get<DWORD>()];
+                target.readable = t.at("readable").get<bool>();
+
+                for (const auto& m : t.at("modules")) {
+                    ModuleInfo module;
+                    module.name = m.at("name").get<std::string>();
+                    module.fullPath = m.at("full_path").get<std::string>();
+                    module.baseAddress = static_cast<uintptr_t>(m.at("base_address").get<ULONGLONG>());
+                    module.size = m.at("size").get<size_t>();
+                    module.isSigned = m.at("is_signed").get<bool>();
+                    module.signerName = m.at("signer_name").get<std::string>();
+                    target.modules.push_back(module);
+                }
+
+                for (const auto& th : t.at("threads")) {
+                    ThreadInfo thread;
+                    thread.tid = th.at("tid").get<DWORD>();
+                    thread.startAddress = static_cast<uintptr_t>(th.at("start_address").get<ULONGLONG>());
+                    target.threads.push_back(thread);
+                }
+
+                for (const auto& r : t.at("regions")) {
+                    MEMORY_BASIC_INFORMATION mbi = {};
+                    uintptr_t base = static_cast<uintptr_t>(r.at("base_address").get<ULONGLONG>());
+                    mbi.BaseAddress = reinterpret_cast<PVOID>(base);
+                    mbi.AllocationBase = reinterpret_cast<PVOID>(static_cast<uintptr_t>(r.at("allocation_base").get<ULONGLONG>()));
+                    mbi.AllocationProtect = r.at("allocation_protect").get<DWORD>();
+                    mbi.RegionSize = static_cast<SIZE_T>(r.at("size").get<ULONGLONG>());
+                    mbi.State = r.at("state").get<DWORD>();
+                    mbi.Protect = r.at("protect").get<DWORD>();
+                    mbi.Type = r.at("type").get<DWORD>();
+                    target.regions[base] = mbi;
+                }
+
+                for (const auto& r : t.at("reads")) {
+                    uintptr_t address = static_cast<uintptr_t>(r.at("address").get<ULONGLONG>());
+                    if (!FromHexString(r.at("data").get<std::string>(), target.reads[address])) {
+                        error = path + ": invalid read data";
+                        return false;
+                    }
+                }
+
+                for (const auto& p : t.at("pages")) {
+                    PageAnalysis analysis;
+                    analysis.pageCount = p.at("page_count").get<size_t>();
+                    analysis.residentPages = p.at("resident").get<size_t>();
+                    analysis.sharedPages = p.at("shared").get<size_t>();
+                    analysis.privatePages = p.at("private").get<size_t>();
+                    if (!FromHexString(p.at("resident_bitmap").get<std::string>(), analysis.residentBitmap) ||
+                        !FromHexString(p.at("private_bitmap").get<std::string>(), analysis.privateBitmap)) {
+                        error = path + ": invalid page bitmap";
+                        return false;
+                    }
+                    analysis.analyzed = true;
+                    target.pages[static_cast<uintptr_t>(p.at("address").get<ULONGLONG>())] = analysis;
+                }
+            }
+
+            // Absent from older snapshots, whose image lookups all fail as unreadable
+            for (const auto& i : j.value("images", json::array())) {
+                ImageSnapshot& image = loaded.images[i.at("path").get<std::string>()];
+                for (const auto& e : i.at("exports")) {
+                    ExportSymbol symbol;
+                    symbol.rva = e.at("rva").get<DWORD>();
+                    symbol.name = e.at("name").get<std::string>();
+                    image.exports.push_back(symbol);
+                }
+                if (i.contains("sha256")) {
+                    std::vector<BYTE> digest;
+                    if (!FromHexString(i.at("sha256").get<std::string>(), digest) || digest.size() != sizeof(image.digest.bytes)) {
+                        error = path + ": invalid image digest";
+                        return false;
+                    }
+                    memcpy(image.digest.bytes, digest.data(), digest.size());
+                    image.hasDigest = true;
+                }
+                if (i.contains("size")) {
+                    image.attributes.fileSize = i.at("size").get<ULONGLONG>();
+                    image.attributes.lastWriteTime = i.at("last_write_time").get<ULONGLONG>();
+                    image.hasAttributes = true;
+                }
+            }
+        } catch (const std::exception& e) {
+            error = path + ": " + e.what();
+            return false;
+        }
+
+        *this = std::move(loaded);
+        return true;
+    }
+
+    std::shared_ptr<const ExportTable> ReplayImageSource::GetExports(const std::string& path) {
+        std::shared_ptr<const ExportTable>& table = exports_[path];
+        if (!table) {
+            auto it = snapshot_.images.find(path);
+            table = it != snapshot_.images.end() ? ExportTable::FromSymbols(it->second.exports)
+                                                 : std::make_shared<ExportTable>();
+        }
+        return table;
+    }
+
+    bool ReplayImageSource::GetDigest(const std::string& path, ImageDigest& digest) {
+        auto it = snapshot_.images.find(path);
+        if (it == snapshot_.images.end() || !it->second.hasDigest) {
+            return false;
+        }
+        digest = it->second.digest;
+        return true;
+    }
+
+    bool ReplayImageSource::GetAttributes(const std::string& path, ImageAttributes& attributes) {
+        auto it = snapshot_.images.find(path);
+        if (it == snapshot_.images.end() || !it->second.hasAttributes) {
+            return false;
+        }
+        attributes = it->second.attributes;
+        return true;
+    }
+
+    std::shared_ptr<const ExportTable> RecordingImageSource::GetExports(const std::string& path) {
+        std::shared_ptr<const ExportTable> table = inner_.GetExports(path);
+        // Each scan asks once per module; the first non-empty answer is kept rather than copied again
+        ImageSnapshot& image = snapshot_.images[path];
+        if (image.exports.empty()) {
+            image.exports = table->Symbols();
+        }
+        return table;
+    }
+
+    bool RecordingImageSource::GetDigest(const std::string& path, ImageDigest& digest) {
+        if (!inner_.GetDigest(path, digest)) {
+            return false;
+        }
+        ImageSnapshot& image = snapshot_.images[path];
+        image.digest = digest;
+        image.hasDigest = true;
+        return true;
+    }
+
+    bool RecordingImageSource::GetAttributes(const std::string& path, ImageAttributes& attributes) {
+        if (!inner_.GetAttributes(path, attributes)) {
+            return false;
+        }
+        ImageSnapshot& image = snapshot_.images[path];
+        image.attributes = attributes;
+        image.hasAttributes = true;
+        return true;
+    }
+
+    std::vector<ProcessInfo> ReplayBackend::EnumerateProcesses(const ProcessFilter* filter) {
+        std::vector<ProcessInfo> processes;
+        auto startTime = std::chrono::steady_clock::now();
+        lastStats_ = EnumerationStats();
+        if (filter && filter->IsEmpty()) {
+            filter = nullptr;
+        }
+
+        for (const auto& info : snapshot_.processes) {
+            lastStats_.snapshotCount++;
+            if (filter && filter->Evaluate(info, false) == ProcessFilter::Match::No) {
+                lastStats_.rejectedEarly++;
+                continue;
+            }
+            if (filter && filter->Evaluate(info, true) != ProcessFilter::Match::Yes) {
+                continue;
+            }
+            processes.push_back(info);
+        }
+
+        lastStats_.matched = processes.size();
+        lastStats_.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startTime).count();
+        return processes;
+    }
+
+    EnumerationStats ReplayBackend::LastEnumerationStats() const {
+        return lastStats_;
+    }
+
+    ProcessInfo ReplayBackend::GetProcessInfo(DWORD pid) {
+        for (const auto& info : snapshot_.processes) {
+            if (info.pid == pid) {
+                return info;
+            }
+        }
+        return ProcessInfo();
+    }
+
+    std::unique_ptr<ScanTarget> ReplayBackend::OpenTarget(DWORD pid, bool readMemory, std::string& error) {
+        auto it = snapshot_.targets.find(pid);
+        if (it == snapshot_.targets.end() || (readMemory && !it->second.readable)) {
+            error = "Failed to open process: not in the recorded snapshot";
+            SetLastError(ERROR_NOT_FOUND);
+            return nullptr;
+        }
+        return std::unique_ptr<ScanTarget>(new ReplayTarget(it->second, readMemory));
+    }
+
+    void RecordingBackend::RecordProcess(const ProcessInfo& info) {
+        for (auto& existing : snapshot_.processes) {
+            if (existing.pid == info.pid) {
+                existing = info;
+                return;
+            }
+        }
+        snapshot_.processes.push_back(info);
+    }
+
+    std::vector<ProcessInfo> RecordingBackend::EnumerateProcesses(const ProcessFilter* filter) {
+        std::vector<ProcessInfo> processes = inner_.EnumerateProcesses(filter);
+        for (const auto& info : processes) {
+            RecordProcess(info);
+        }
+        return processes;
+    }
+
+    EnumerationStats RecordingBackend::LastEnumerationStats() const {
+        return inner_.LastEnumerationStats();
+    }
+
+    ProcessInfo RecordingBackend::GetProcessInfo(DWORD pid) {
+        ProcessInfo info = inner_.GetProcessInfo(pid);
+        if (info.pid != 0) {
+            RecordProcess(info);
+        }
+        return info;
+    }
+
+    std::unique_ptr<ScanTarget> RecordingBackend::OpenTarget(DWORD pid, bool readMemory, std::string& error) {
+        std::unique_ptr<ScanTarget> inner = inner_.OpenTarget(pid, readMemory, error);
+        if (!inner) {
+            return nullptr;
+        }
+        TargetSnapshot& target = snapshot_.targets[pid];
+        target.readable = target.readable || readMemory;
+        return std::unique_ptr<ScanTarget>(new RecordingTarget(std::move(inner), target));
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "util.h"
+#include "scan_backend.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Everything recorded from one opened process. Region bytes are only those the scan actually read.
+    struct TargetSnapshot {
+        std::vector<ModuleInfo> modules;
+        std::vector<ThreadInfo> threads;
+        std::map<uintptr_t, MEMORY_BASIC_INFORMATION> regions;  // By base address
+        std::map<uintptr_t, std::vector<BYTE>> reads;           // Readable bytes by start address
+        std::map<uintptr_t, PageAnalysis> pages;                // Page analysis by range base
+        bool readable;      // Opened with read access at least once
+
+        TargetSnapshot() : readable(false) {}
+    };
+
+    // What the scan looked up about one image file. A lookup that was not recorded fails the way
+    // an unreadable file does, so replay never falls back to the replaying machine's disk.
+    struct ImageSnapshot {
+        std::vector<ExportSymbol> exports;
+        ImageDigest digest;
+        ImageAttributes attributes;
+        bool hasDigest;
+        bool hasAttributes;
+
+        ImageSnapshot() : digest(), hasDigest(false), hasAttributes(false) {}
+    };
+
+    // Recorded host state, stored as one JSON file (bytes and bitmaps as hex)
+    struct HostSnapshot {
+        std::vector<ProcessInfo> processes;
+        std::map<DWORD, TargetSnapshot> targets;
+        std::map<std::string, ImageSnapshot> images;            // By path, as the scan asked for it
+
+        bool Save(const std::string& path, std::string& error) const;
+        bool Load(const std::string& path, std::string& error);
+    };
+
+    // Serves the images of a recorded snapshot
+    class ReplayImageSource : public ImageSource {
+    private:
+        const HostSnapshot& snapshot_;
+        std::map<std::string, std::shared_ptr<const ExportTable>> exports_;    // Rebuilt once per image
+
+    public:
+        explicit ReplayImageSource(const HostSnapshot& snapshot) : snapshot_(snapshot) {}
+
+        std::shared_ptr<const ExportTable> GetExports(const std::string& path) override;
+        bool GetDigest(const std::string& path, ImageDigest& digest) override;
+        bool GetAttributes(const std::string& path, ImageAttributes& attributes) override;
+    };
+
+    // Passes every lookup through to another source and records what it returned
+    class RecordingImageSource : public ImageSource {
+    private:
+        ImageSource& inner_;
+        HostSnapshot& snapshot_;
+
+    public:
+        RecordingImageSource(ImageSource& inner, HostSnapshot& snapshot) : inner_(inner), snapshot_(snapshot) {}
+
+        std::shared_ptr<const ExportTable> GetExports(const std::string& path) override;
+        bool GetDigest(const std::string& path, ImageDigest& digest) override;
+        bool GetAttributes(const std::string& path, ImageAttributes& attributes) override;
+    };
+
+    // Serves a recorded snapshot. Enumeration applies the filter to the recorded process details;
+    // opening a process that was never recorded fails the way an inaccessible live process does.
+    class ReplayBackend : public ScanBackend {
+    private:
+        const HostSnapshot& snapshot_;
+        EnumerationStats lastStats_;
+        ReplayImageSource images_;
+
+    public:
+        explicit ReplayBackend(const HostSnapshot& snapshot) : snapshot_(snapshot), images_(snapshot) {}
+
+        std::vector<ProcessInfo> EnumerateProcesses(const ProcessFilter* filter) override;
+        EnumerationStats LastEnumerationStats() const override;
+        ProcessInfo GetProcessInfo(DWORD pid) override;
+        std::unique_ptr<ScanTarget> OpenTarget(DWORD pid, bool readMemory, std::string& error) override;
+        ImageSource& Images() override { return images_; }
+    };
+
+    // Passes every call through to another backend and records what it returned
+    class RecordingBackend : public ScanBackend {
+    private:
+        ScanBackend& inner_;
+        HostSnapshot& snapshot_;
+        RecordingImageSource images_;
+
+        void RecordProcess(const ProcessInfo& info);
+
+    public:
+        RecordingBackend(ScanBackend& inner, HostSnapshot& snapshot)
+            : inner_(inner), snapshot_(snapshot), images_(inner.Images(), snapshot) {}
+
+        std::vector<ProcessInfo> EnumerateProcesses(const ProcessFilter* filter) override;
+        EnumerationStats LastEnumerationStats() const override;
+        ProcessInfo GetProcessInfo(DWORD pid) override;
+        std::unique_ptr<ScanTarget> OpenTarget(DWORD pid, bool readMemory, std::string& error) override;
+        ImageSource& Images() override { return images_; }
+    };
+
+} // namespace ProcessScope
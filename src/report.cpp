@@ -0,0 +1,290 @@
+#include "report.h"
+#include "json.hpp"
+#include <cstdlib>
+#include <fstream>
+
+using json = nlohmann::json;
+
+namespace ProcessScope {
+
+    std::string GetRiskLevelName(RiskLevel level) {
+        switch (level) {
+            case RiskLevel::Low:    return "Low";
+            case RiskLevel::Medium: return "Medium";
+            case RiskLevel::High:   return "High";
+            default:                return "Unknown";
+        }
+    }
+
+    std::string SerializeScanResult(const ScanResult& result, int indent) {
+        json j;
+        
+        j["tool_info"]["name"] = "ProcessScope";
+        j["tool_info"]["version"] = "1.0.0";
+        j["tool_info"]["timestamp"] = GetTimestamp();
+        
+        auto environmentOr = [](const char* name) -> std::string {
+            std::string value = GetEnvironmentValue(name);
+            return value.empty() ? "Unknown" : value;
+        };
+        j["host_info"]["computer_name"] = environmentOr("COMPUTERNAME");
+        j["host_info"]["username"] = environmentOr("USERNAME");
+        
+        j["process"]["pid"] = result.processInfo.pid;
+        j["process"]["ppid"] = result.processInfo.ppid;
+        j["process"]["name"] = result.processInfo.name;
+        j["process"]["full_path"] = result.processInfo.fullPath;
+        j["process"]["architecture"] = result.processInfo.architecture;
+        j["process"]["session_id"] = result.processInfo.sessionId;
+        if (!result.processInfo.user.empty()) {
+            j["process"]["user"] = result.processInfo.user;
+        }
+        
+        j["modules"] = json::array();
+        for (const auto& module : result.modules) {
+            json m;
+            m["name"] = module.name;
+            m["full_path"] = module.fullPath;
+            m["base_address"] = "0x" + std::to_string(module.baseAddress);
+            m["size"] = module.size;
+            m["signed"] = module.isSigned;
+            m["signer_name"] = module.signerName;
+            j["modules"].push_back(m);
+        }
+        
+        j["threads"] = json::array();
+        for (const auto& thread : result.threads) {
+            json t;
+            t["tid"] = thread.tid;
+            if (thread.startAddress != 0) {
+                t["start_address"] = "0x" + std::to_string(thread.startAddress);
+            } else {
+                t["start_address"] = nullptr;
+            }
+            t["start_symbol"] = thread.startSymbol.empty() ? json(nullptr) : json(thread.startSymbol);
+            t["anomalous_start"] = thread.anomalousStart;
+            if (thread.samples > 0) {
+                t["samples"] = thread.samples;
+                t["unbacked_samples"] = thread.unbackedSamples;
+                t["cpu_time_ms"] = thread.cpuTime / 10000.0;
+                t["sampled_address"] = "0x" + std::to_string(thread.sampledAddress);
+                t["sampled_symbol"] = thread.sampledSymbol.empty() ? json(nullptr) : json(thread.sampledSymbol);
+            }
+            j["threads"].push_back(t);
+        }
+        
+        j["memory_regions"] = json::array();
+        for (const auto& region : result.memoryRegions) {
+            json r;
+            r["base_address"] = "0x" + std::to_string(region.baseAddress);
+            r["size"] = region.size;
+            r["state"] = region.state;
+            r["type"] = region.type;
+            r["protection"] = region.protection;
+            r["is_executable"] = region.isExecutable;
+            r["is_writable"] = region.isWritable;
+            r["is_suspicious"] = region.isSuspicious;
+            r["has_pe_header"] = region.hasPeHeader;
+            r["fingerprint"] = region.fingerprint != 0 ? json(FingerprintToString(region.fingerprint)) : json(nullptr);
+            r["similarity_digest"] = region.similarity.valid ? json(region.similarity.ToString()) : json(nullptr);
+            if (region.pages.analyzed) {
+                r["pages"]["count"] = region.pages.pageCount;
+                r["pages"]["resident"] = region.pages.residentPages;
+                r["pages"]["shared"] = region.pages.sharedPages;
+                r["pages"]["private"] = region.pages.privatePages;
+                r["pages"]["resident_bitmap"] = PageAnalysis::ToHex(region.pages.residentBitmap);
+                r["pages"]["private_bitmap"] = PageAnalysis::ToHex(region.pages.privateBitmap);
+            }
+            j["memory_regions"].push_back(r);
+        }
+        
+        j["risk_assessment"]["score"] = result.riskAssessment.score;
+        j["risk_assessment"]["lineage_score"] = result.riskAssessment.lineageScore;
+        j["risk_assessment"]["level"] = GetRiskLevelName(result.riskAssessment.level);
+        j["risk_assessment"]["details"] = result.riskAssessment.details;
+        
+        j["scan_info"]["truncated"] = result.truncated;
+        j["scan_info"]["truncated_phase"] = result.truncated ? json(result.truncatedPhase) : json(nullptr);
+        j["scan_info"]["timings_ms"]["modules"] = result.timings.modulesMs;
+        j["scan_info"]["timings_ms"]["threads"] = result.timings.threadsMs;
+        j["scan_info"]["timings_ms"]["memory"] = result.timings.memoryMs;
+        j["scan_info"]["timings_ms"]["risk"] = result.timings.riskMs;
+        j["scan_info"]["timings_ms"]["total"] = result.timings.totalMs;
+        j["scan_info"]["memory_reads"]["requests"] = result.memoryReads.requests;
+        j["scan_info"]["memory_reads"]["syscalls"] = result.memoryReads.syscalls;
+        j["scan_info"]["memory_reads"]["bytes_requested"] = result.memoryReads.bytesRequested;
+        j["scan_info"]["memory_reads"]["bytes_transferred"] = result.memoryReads.bytesTransferred;
+        j["scan_info"]["memory_reads"]["cache_hits"] = result.memoryReads.cacheHits;
+        j["scan_info"]["memory_reads"]["cache_misses"] = result.memoryReads.cacheMisses;
+        j["scan_info"]["memory_reads"]["unreadable_pages"] = result.memoryReads.unreadablePages;
+        j["scan_info"]["page_queries"]["pages"] = result.pageQueries.pagesQueried;
+        j["scan_info"]["page_queries"]["calls"] = result.pageQueries.queries;
+        
+        const ContentSample& sample = result.contentSample;
+        if (sample.sampled) {
+            auto estimateJson = [](const SampleEstimate& estimate) {
+                json e;
+                e["estimate"] = estimate.estimate;
+                e["lower"] = estimate.lower;
+                e["upper"] = estimate.upper;
+                return e;
+            };
+            json c;
+            c["budget_bytes"] = sample.budgetBytes;
+            c["bytes_read"] = sample.bytesRead;
+            c["flagged_complete"] = sample.flaggedComplete;
+            c["elapsed_ms"] = sample.elapsedMs;
+            for (size_t s = 0; s < kSampleStrata; s++) {
+                const SampleStratum& stratum = sample.strata[s];
+                json st;
+                st["regions"] = stratum.regions;
+                st["pages"] = stratum.pages;
+                st["sampled_pages"] = stratum.sampledPages;
+                st["unreadable_pages"] = stratum.unreadablePages;
+                st["pe_header_pages"] = stratum.peHeaderPages;
+                st["high_entropy_pages"] = stratum.highEntropyPages;
+                st["pe_headers"] = estimateJson(stratum.peHeaders);
+                st["high_entropy"] = estimateJson(stratum.highEntropy);
+                c["strata"][ContentSample::StratumName(static_cast<SampleStratumKind>(s))] = st;
+            }
+            c["pe_headers"] = estimateJson(sample.peHeaders);
+            c["high_entropy"] = estimateJson(sample.highEntropy);
+            c["hits"] = json::array();
+            for (const auto& hit : sample.hits) {
+                json h;
+                h["address"] = "0x" + std::to_string(hit.address);
+                h["pe_header"] = (hit.indicators & kIndicatorPeHeader) != 0;
+                h["high_entropy"] = (hit.indicators & kIndicatorHighEntropy) != 0;
+                c["hits"].push_back(h);
+            }
+            j["content_sample"] = c;
+        }
+        
+        const StringExtraction& strings = result.strings;
+        if (strings.extracted) {
+            json s;
+            s["regions"] = strings.regions;
+            s["bytes_scanned"] = strings.bytesScanned;
+            s["total"] = strings.totalStrings;
+            s["unique"] = strings.uniqueStrings;
+            s["complete"] = strings.complete;
+            s["elapsed_ms"] = strings.elapsedMs;
+            s["strings"] = json::array();
+            for (const auto& extracted : strings.strings) {
+                json e;
+                e["address"] = "0x" + std::to_string(extracted.address);
+                e["encoding"] = extracted.wide ? "utf-16le" : "ascii";
+                e["occurrences"] = extracted.occurrences;
+                e["text"] = extracted.text;
+                s["strings"].push_back(e);
+            }
+            j["strings"] = s;
+        }
+        
+        const ThreadSamplingStats& sampling = result.threadSampling;
+        if (sampling.sampled) {
+            json ts;
+            ts["rounds"] = sampling.rounds;
+            ts["threads"] = sampling.threads;
+            ts["inaccessible"] = sampling.inaccessible;
+            ts["suspensions"] = sampling.suspensions;
+            ts["idle_skips"] = sampling.idleSkips;
+            ts["samples"] = sampling.samples;
+            ts["unbacked_samples"] = sampling.unbackedSamples;
+            ts["region_queries"] = sampling.regionQueries;
+            ts["window_ms"] = sampling.windowMs;
+            ts["suspended_ms"] = sampling.suspendedMs;
+            ts["max_suspend_us"] = sampling.maxSuspendUs;
+            ts["overhead_percent"] = sampling.overheadPercent;
+            ts["sampler_cpu_ms"] = sampling.samplerCpuMs;
+            j["thread_sampling"] = ts;
+        }
+        
+        return j.dump(indent);
+    }
+
+    std::string SerializeProcessList(const std::vector<ProcessInfo>& processes, int indent) {
+        json j = json::array();
+        for (const auto& process : processes) {
+            json p;
+            p["pid"] = process.pid;
+            p["ppid"] = process.ppid;
+            p["name"] = process.name;
+            p["full_path"] = process.fullPath;
+            p["architecture"] = process.architecture;
+            p["session_id"] = process.sessionId;
+            if (!process.user.empty()) {
+                p["user"] = process.user;
+            }
+            j.push_back(p);
+        }
+        return j.dump(indent);
+    }
+
+    static bool WriteTextFile(const std::string& text, const std::string& filename) {
+        try {
+            // Create directory if it doesn't exist
+            size_t lastSlash = filename.find_last_of("\\/");
+            if (lastSlash != std::string::npos) {
+                std::string directory = filename.substr(0, lastSlash);
+                CreateDirectoryRecursive(directory);
+            }
+            
+            std::ofstream file(filename);
+            if (!file.is_open()) {
+                return false;
+            }
+            
+            file << text;
+            file.close();
+            
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    bool WriteReportFile(const ScanResult& result, const std::string& filename) {
+        try {
+            return WriteTextFile(SerializeScanResult(result, 4), filename);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    std::string SerializeClusters(const std::vector<RegionCluster>& clusters, int indent) {
+        json j;
+        j["tool_info"]["name"] = "ProcessScope";
+        j["tool_info"]["version"] = "1.0.0";
+        j["tool_info"]["timestamp"] = GetTimestamp();
+        
+        j["clusters"] = json::array();
+        for (const auto& cluster : clusters) {
+            json c;
+            c["fingerprint"] = FingerprintToString(cluster.fingerprint);
+            c["size"] = cluster.size;
+            c["protection"] = cluster.protection;
+            c["is_suspicious"] = cluster.isSuspicious;
+            c["process_count"] = cluster.processCount;
+            c["members"] = json::array();
+            for (const auto& member : cluster.members) {
+                json m;
+                m["pid"] = member.pid;
+                m["name"] = member.processName;
+                m["base_address"] = "0x" + std::to_string(member.baseAddress);
+                c["members"].push_back(m);
+            }
+            j["clusters"].push_back(c);
+        }
+        return j.dump(indent);
+    }
+
+    bool WriteClusterReport(const std::vector<RegionCluster>& clusters, const std::string& filename) {
+        try {
+            return WriteTextFile(SerializeClusters(clusters, 4), filename);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+} // namespace ProcessScope
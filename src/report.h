@@ -0,0 +1,22 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    // JSON report serialization shared by the CLI and the daemon
+    std::string GetRiskLevelName(RiskLevel level);
+
+    // indent < 0 produces compact single-line JSON
+    std::string SerializeScanResult(const ScanResult& result, int indent);
+    std::string SerializeProcessList(const std::vector<ProcessInfo>& processes, int indent);
+    bool WriteReportFile(const ScanResult& result, const std::string& filename);
+    
+    // Each unique region once, with every process that holds a copy
+    std::string SerializeClusters(const std::vector<RegionCluster>& clusters, int indent);
+    bool WriteClusterReport(const std::vector<RegionCluster>& clusters, const std::string& filename);
+
+} // namespace ProcessScope
@@ -0,0 +1,725 @@
+#include "report_index.h"
+#include "process_filter.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+using json = nlohmann::json;
+
+namespace ProcessScope {
+
+    static const char kIndexMagic[8] = { 'P', 'S', 'I', 'N', 'D', 'E', 'X', '1' };
+    static const DWORD kIndexVersion = 1;
+
+    static const char* const kFieldNames[ReportIndex::FieldCount] = {
+        "process", "module", "name", "unsigned", "signer", "risk", "protection"
+    };
+
+    struct IndexHeader {
+        char magic[8];
+        DWORD version;
+        DWORD documentCount;
+        DWORD termCount;
+        DWORD reserved;
+        ULONGLONG documentsOffset;
+        ULONGLONG termsOffset;
+        ULONGLONG stringsOffset;
+        ULONGLONG stringsSize;
+        ULONGLONG postingsOffset;
+        ULONGLONG postingsSize;
+    };
+
+    // String fields are offsets into the string section
+    struct DocumentRecord {
+        DWORD pid;
+        DWORD fileName;
+        DWORD processName;
+        DWORD timestamp;
+        DWORD riskLevel;
+        DWORD reserved;
+        ULONGLONG fileSize;
+        ULONGLONG lastWriteTime;
+    };
+
+    struct TermRecord {
+        DWORD field;
+        DWORD term;
+        DWORD documentCount;
+        DWORD postingsSize;
+        ULONGLONG postingsOffset;   // Relative to the postings section
+    };
+
+    typedef std::pair<DWORD, std::string> TermKey;
+
+    // In-memory form of a document while the index is rebuilt
+    struct DocumentEntry {
+        DWORD pid;
+        std::string fileName;
+        std::string processName;
+        std::string timestamp;
+        std::string riskLevel;
+        ULONGLONG fileSize;
+        ULONGLONG lastWriteTime;
+
+        DocumentEntry() : pid(0), fileSize(0), lastWriteTime(0) {}
+    };
+
+    // Bounds-checked access to a mapped index file
+    class IndexView {
+    private:
+        const BYTE* data_;
+        size_t size_;
+        const IndexHeader* header_;
+
+    public:
+        IndexView(const MappedFile& file) : data_(file.data()), size_(file.size()), header_(nullptr) {}
+
+        bool Validate(std::string& error) {
+            if (!data_ || size_ < sizeof(IndexHeader)) {
+                error = "Index file is truncated";
+                return false;
+            }
+            header_ = reinterpret_cast<const IndexHeader*>(data_);
+            if (memcmp(header_->magic, kIndexMagic, sizeof(kIndexMagic)) != 0 || header_->version != kIndexVersion) {
+                error = "Not a ProcessScope report index, or an unsupported version";
+                return false;
+            }
+            auto fits = [this](ULONGLONG offset, ULONGLONG length) {
+                return offset <= size_ && length <= size_ - offset;
+            };
+            if (!fits(header_->documentsOffset, static_cast<ULONGLONG>(header_->documentCount) * sizeof(DocumentRecord)) ||
+                !fits(header_->termsOffset, static_cast<ULONGLONG>(header_->termCount) * sizeof(TermRecord)) ||
+                !fits(header_->stringsOffset, header_->stringsSize) ||
+                !fits(header_->postingsOffset, header_->postingsSize)) {
+                error = "Index file is corrupt";
+                return false;
+            }
+            return true;
+        }
+
+        DWORD DocumentCount() const { return header_->documentCount; }
+        DWORD TermCount() const { return header_->termCount; }
+
+        const DocumentRecord& Document(DWORD index) const {
+            return reinterpret_cast<const DocumentRecord*>(data_ + header_->documentsOffset)[index];
+        }
+
+        const TermRecord& Term(DWORD index) const {
+            return reinterpret_cast<const TermRecord*>(data_ + header_->termsOffset)[index];
+        }
+
+        std::string_view String(DWORD offset) const {
+            DWORD length = 0;
+            if (static_cast<ULONGLONG>(offset) + sizeof(length) > header_->stringsSize) {
+                return std::string_view();
+            }
+            const BYTE* base = data_ + header_->stringsOffset + offset;
+            memcpy(&length, base, sizeof(length));
+            if (length > header_->stringsSize - offset - sizeof(length)) {
+                return std::string_view();
+            }
+            return std::string_view(reinterpret_cast<const char*>(base + sizeof(length)), length);
+        }
+
+        // Appends the term's document numbers; stops early on a malformed list
+        void DecodePostings(const TermRecord& term, std::vector<DWORD>& documents) const {
+            if (term.postingsOffset > header_->postingsSize || term.postingsSize > header_->postingsSize - term.postingsOffset) {
+                return;
+            }
+            const BYTE* p = data_ + header_->postingsOffset + term.postingsOffset;
+            const BYTE* end = p + term.postingsSize;
+            DWORD document = 0;
+            while (p < end) {
+                DWORD gap = 0;
+                int shift = 0;
+                while (p < end && shift < 35) {
+                    BYTE b = *p++;
+                    gap |= static_cast<DWORD>(b & 0x7F) << shift;
+                    shift += 7;
+                    if ((b & 0x80) == 0) {
+                        break;
+                    }
+                }
+                document += gap;
+                if (document >= header_->documentCount) {
+                    return;
+                }
+                documents.push_back(document);
+            }
+        }
+
+        // First term record not ordered before (field, prefix)
+        DWORD LowerBound(DWORD field, std::string_view prefix) const {
+            DWORD low = 0;
+            DWORD high = header_->termCount;
+            while (low < high) {
+                DWORD middle = low + (high - low) / 2;
+                const TermRecord& term = Term(middle);
+                if (term.field < field || (term.field == field && String(term.term) < prefix)) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return low;
+        }
+    };
+
+    // Scan reports are named <pid>_<timestamp>.json; cluster reports and anything else are skipped
+    static bool ParseReportFileName(const std::string& name, DWORD& pid, std::string& timestamp) {
+        static const std::string kExtension = ".json";
+        size_t underscore = name.find('_');
+        if (underscore == 0 || underscore == std::string::npos || name.size() <= underscore + 1 + kExtension.size() ||
+            name.compare(name.size() - kExtension.size(), kExtension.size(), kExtension) != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < underscore; i++) {
+            if (!isdigit(static_cast<unsigned char>(name[i]))) {
+                return false;
+            }
+        }
+        pid = static_cast<DWORD>(strtoul(name.c_str(), nullptr, 10));
+        timestamp = name.substr(underscore + 1, name.size() - underscore - 1 - kExtension.size());
+        return true;
+    }
+
+    static bool ParseReport(const std::string& path, DocumentEntry& document, std::set<TermKey>& terms) {
+        try {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                return false;
+            }
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            json j = json::parse(text, nullptr, false);
+            if (j.is_discarded() || !j.is_object() || !j.contains("process") || !j.contains("risk_assessment")) {
+                return false;
+            }
+
+            document.processName = j["process"].value("name", std::string());
+            document.riskLevel = j["risk_assessment"].value("level", std::string("Unknown"));
+            terms.insert(TermKey(ReportIndex::Process, ToLower(document.processName)));
+            terms.insert(TermKey(ReportIndex::Risk, ToLower(document.riskLevel)));
+
+            if (j.contains("modules") && j["modules"].is_array()) {
+                for (const auto& module : j["modules"]) {
+                    std::string modulePath = ToLower(module.value("full_path", std::string()));
+                    std::string name = ToLower(module.value("name", std::string()));
+                    std::string signer = ToLower(module.value("signer_name", std::string()));
+                    if (!modulePath.empty()) {
+                        terms.insert(TermKey(ReportIndex::Module, modulePath));
+                        if (!module.value("signed", false)) {
+                            terms.insert(TermKey(ReportIndex::Unsigned, modulePath));
+                        }
+                    }
+                    if (!name.empty()) {
+                        terms.insert(TermKey(ReportIndex::ModuleName, name));
+                    }
+                    if (!signer.empty()) {
+                        terms.insert(TermKey(ReportIndex::Signer, signer));
+                    }
+                }
+            }
+
+            if (j.contains("memory_regions") && j["memory_regions"].is_array()) {
+                for (const auto& region : j["memory_regions"]) {
+                    std::string protection = ToLower(region.value("protection", std::string()));
+                    if (!protection.empty()) {
+                        terms.insert(TermKey(ReportIndex::Protection, protection));
+                    }
+                }
+            }
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    static void AppendVarint(std::vector<BYTE>& out, DWORD value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<BYTE>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<BYTE>(value));
+    }
+
+    template <typename T>
+    static void AppendRecord(std::vector<BYTE>& out, const T& record) {
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(&record);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    static bool WriteIndex(const std::string& indexPath, const std::vector<DocumentEntry>& documents,
+                           const std::map<TermKey, std::vector<DWORD>>& terms, ULONGLONG& bytesWritten, std::string& error) {
+        std::vector<BYTE> strings;
+        std::unordered_map<std::string, DWORD> interned;
+        auto addString = [&](const std::string& value) -> DWORD {
+            auto existing = interned.find(value);
+            if (existing != interned.end()) {
+                return existing->second;
+            }
+            DWORD offset = static_cast<DWORD>(strings.size());
+            DWORD length = static_cast<DWORD>(value.size());
+            const BYTE* lengthBytes = reinterpret_cast<const BYTE*>(&length);
+            strings.insert(strings.end(), lengthBytes, lengthBytes + sizeof(length));
+            strings.insert(strings.end(), value.begin(), value.end());
+            interned[value] = offset;
+            return offset;
+        };
+
+        std::vector<BYTE> documentSection;
+        documentSection.reserve(documents.size() * sizeof(DocumentRecord));
+        for (const auto& document : documents) {
+            DocumentRecord record = {};
+            record.pid = document.pid;
+            record.fileName = addString(document.fileName);
+            record.processName = addString(document.processName);
+            record.timestamp = addString(document.timestamp);
+            record.riskLevel = addString(document.riskLevel);
+            record.fileSize = document.fileSize;
+            record.lastWriteTime = document.lastWriteTime;
+            AppendRecord(documentSection, record);
+        }
+
+        std::vector<BYTE> termSection;
+        std::vector<BYTE> postings;
+        termSection.reserve(terms.size() * sizeof(TermRecord));
+        for (const auto& term : terms) {
+            TermRecord record = {};
+            record.field = term.first.first;
+            record.term = addString(term.first.second);
+            record.documentCount = static_cast<DWORD>(term.second.size());
+            record.postingsOffset = postings.size();
+            DWORD previous = 0;
+            for (DWORD document : term.second) {
+                AppendVarint(postings, document - previous);
+                previous = document;
+            }
+            record.postingsSize = static_cast<DWORD>(postings.size() - record.postingsOffset);
+            AppendRecord(termSection, record);
+        }
+
+        IndexHeader header = {};
+        memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+        header.version = kIndexVersion;
+        header.documentCount = static_cast<DWORD>(documents.size());
+        header.termCount = static_cast<DWORD>(terms.size());
+        header.documentsOffset = sizeof(IndexHeader);
+        header.termsOffset = header.documentsOffset + documentSection.size();
+        header.stringsOffset = header.termsOffset + termSection.size();
+        header.stringsSize = strings.size();
+        header.postingsOffset = header.stringsOffset + strings.size();
+        header.postingsSize = postings.size();
+
+        std::string temporaryPath = indexPath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                error = "Failed to create " + temporaryPath;
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(documentSection.data()), documentSection.size());
+            file.write(reinterpret_cast<const char*>(termSection.data()), termSection.size());
+            file.write(reinterpret_cast<const char*>(strings.data()), strings.size());
+            file.write(reinterpret_cast<const char*>(postings.data()), postings.size());
+            if (!file) {
+                error = "Failed to write " + temporaryPath;
+                return false;
+            }
+        }
+
+        if (!MoveFileExW(StringToWString(temporaryPath).c_str(), StringToWString(indexPath).c_str(),
+                         MOVEFILE_REPLACE_EXISTING)) {
+            error = "Failed to replace " + indexPath + ": " + GetLastErrorString();
+            DeleteFileW(StringToWString(temporaryPath).c_str());
+            return false;
+        }
+        bytesWritten = header.postingsOffset + header.postingsSize;
+        return true;
+    }
+
+    bool ReportIndex::Update(const std::string& reportsDirectory, const std::string& indexPath,
+                             IndexUpdateStats& stats, std::string& error) {
+        auto start = std::chrono::steady_clock::now();
+        stats = IndexUpdateStats();
+
+        std::vector<DocumentEntry> documents;
+        std::map<TermKey, std::vector<DWORD>> terms;
+        std::unordered_map<std::string, DWORD> documentsByName;
+        bool existingValid = false;
+
+        // A missing or corrupt index is rebuilt from scratch. Postings are only decoded once a
+        // change is found, so a pass over an unchanged directory reads just the document table.
+        ReportIndex existing;
+        std::string openError;
+        if (existing.Open(indexPath, openError)) {
+            IndexView view(existing.file_);
+            view.Validate(openError);
+            existingValid = true;
+            documents.resize(view.DocumentCount());
+            for (DWORD i = 0; i < view.DocumentCount(); i++) {
+                const DocumentRecord& record = view.Document(i);
+                DocumentEntry& document = documents[i];
+                document.pid = record.pid;
+                document.fileName = std::string(view.String(record.fileName));
+                document.processName = std::string(view.String(record.processName));
+                document.timestamp = std::string(view.String(record.timestamp));
+                document.riskLevel = std::string(view.String(record.riskLevel));
+                document.fileSize = record.fileSize;
+                document.lastWriteTime = record.lastWriteTime;
+                documentsByName[document.fileName] = i;
+            }
+        }
+
+        const size_t existingCount = documents.size();
+        std::vector<bool> keep(existingCount, false);
+        std::vector<std::set<TermKey>> pendingTerms;
+
+        WIN32_FIND_DATAW findData;
+        HANDLE find = FindFirstFileW(StringToWString(reportsDirectory + "\\*.json").c_str(), &findData);
+        if (find == INVALID_HANDLE_VALUE) {
+            DWORD lastError = GetLastError();
+            if (lastError != ERROR_FILE_NOT_FOUND && lastError != ERROR_PATH_NOT_FOUND) {
+                error = "Failed to list " + reportsDirectory + ": " + GetLastErrorString();
+                return false;
+            }
+        } else {
+            do {
+                if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                    continue;
+                }
+                DocumentEntry document;
+                document.fileName = WStringToString(findData.cFileName);
+                if (!ParseReportFileName(document.fileName, document.pid, document.timestamp)) {
+                    continue;
+                }
+                stats.files++;
+                document.fileSize = (static_cast<ULONGLONG>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+                document.lastWriteTime = (static_cast<ULONGLONG>(findData.ftLastWriteTime.dwHighDateTime) << 32) |
+                                         findData.ftLastWriteTime.dwLowDateTime;
+
+                auto known = documentsByName.find(document.fileName);
+                bool changed = known != documentsByName.end();
+                if (changed) {
+                    const DocumentEntry& indexed = documents[known->second];
+                    if (indexed.fileSize == document.fileSize && indexed.lastWriteTime == document.lastWriteTime) {
+                        keep[known->second] = true;
+                        continue;
+                    }
+                }
+
+                std::set<TermKey> documentTerms;
+                if (!ParseReport(reportsDirectory + "\\" + document.fileName, document, documentTerms)) {
+                    stats.failed++;
+                    continue;
+                }
+                if (changed) {
+                    stats.replaced++;
+                } else {
+                    stats.added++;
+                }
+                documents.push_back(document);
+                pendingTerms.push_back(std::move(documentTerms));
+            } while (FindNextFileW(find, &findData));
+            FindClose(find);
+        }
+
+        for (size_t i = 0; i < existingCount; i++) {
+            if (!keep[i]) {
+                stats.removed++;
+            }
+        }
+        // Replaced documents were counted as removed as well
+        stats.removed -= stats.replaced;
+
+        if (existingValid && stats.added == 0 && stats.replaced == 0 && stats.removed == 0) {
+            IndexView view(existing.file_);
+            view.Validate(openError);
+            stats.documents = documents.size();
+            stats.terms = view.TermCount();
+            stats.indexBytes = existing.file_.size();
+            stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return true;
+        }
+
+        if (existingValid) {
+            IndexView view(existing.file_);
+            view.Validate(openError);
+            for (DWORD i = 0; i < view.TermCount(); i++) {
+                const TermRecord& record = view.Term(i);
+                std::vector<DWORD>& postings = terms[TermKey(record.field, std::string(view.String(record.term)))];
+                postings.reserve(record.documentCount);
+                view.DecodePostings(record, postings);
+            }
+            existing.Close();
+        }
+        // New documents are numbered after every existing one, so postings stay ascending
+        for (size_t i = 0; i < pendingTerms.size(); i++) {
+            for (const auto& term : pendingTerms[i]) {
+                terms[term].push_back(static_cast<DWORD>(existingCount + i));
+            }
+        }
+
+        // Compact: drop stale documents and renumber the rest, preserving order
+        std::vector<DWORD> renumber(documents.size(), MAXDWORD);
+        std::vector<DocumentEntry> compacted;
+        compacted.reserve(documents.size());
+        for (size_t i = 0; i < documents.size(); i++) {
+            if (i >= existingCount || keep[i]) {
+                renumber[i] = static_cast<DWORD>(compacted.size());
+                compacted.push_back(std::move(documents[i]));
+            }
+        }
+        for (auto term = terms.begin(); term != terms.end();) {
+            std::vector<DWORD>& postings = term->second;
+            size_t kept = 0;
+            for (DWORD document : postings) {
+                if (renumber[document] != MAXDWORD) {
+                    postings[kept++] = renumber[document];
+                }
+            }
+            postings.resize(kept);
+            term = postings.empty() ? terms.erase(term) : std::next(term);
+        }
+
+        CreateDirectoryRecursive(reportsDirectory);
+        if (!WriteIndex(indexPath, compacted, terms, stats.indexBytes, error)) {
+            return false;
+        }
+        stats.rewritten = true;
+        stats.documents = compacted.size();
+        stats.terms = terms.size();
+        stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    bool ReportIndex::Open(const std::string& indexPath, std::string& error) {
+        if (!file_.Open(indexPath)) {
+            error = "Failed to open report index " + indexPath;
+            return false;
+        }
+        IndexView view(file_);
+        if (!view.Validate(error)) {
+            file_.Close();
+            return false;
+        }
+        return true;
+    }
+
+    size_t ReportIndex::DocumentCount() const {
+        return file_ ? reinterpret_cast<const IndexHeader*>(file_.data())->documentCount : 0;
+    }
+
+    struct QueryClause {
+        DWORD field;
+        std::string pattern;
+        bool exclude;
+    };
+
+    static bool SplitQuery(const std::string& expression, std::vector<std::string>& words, std::string& error) {
+        std::string current;
+        bool inWord = false;
+        bool quoted = false;
+        for (char c : expression) {
+            if (c == '"') {
+                quoted = !quoted;
+                inWord = true;
+            } else if (!quoted && isspace(static_cast<unsigned char>(c))) {
+                if (inWord) {
+                    words.push_back(current);
+                    current.clear();
+                    inWord = false;
+                }
+            } else {
+                current.push_back(c);
+                inWord = true;
+            }
+        }
+        if (quoted) {
+            error = "Unterminated quote in query";
+            return false;
+        }
+        if (inWord) {
+            words.push_back(current);
+        }
+        return true;
+    }
+
+    // Accepts YYYYMMDD[_HHMMSS[_mmm]] as is; Nd becomes the local date N days ago
+    static bool ParseTimeBound(const std::string& value, std::string& bound) {
+        if (value.size() >= 2 && value.back() == 'd' &&
+            std::all_of(value.begin(), value.end() - 1, [](char c) { return isdigit(static_cast<unsigned char>(c)) != 0; })) {
+            time_t then = time(nullptr) - static_cast<time_t>(strtoul(value.c_str(), nullptr, 10)) * 24 * 60 * 60;
+            struct tm timeinfo;
+            localtime_s(&timeinfo, &then);
+            char buffer[16];
+            strftime(buffer, sizeof(buffer), "%Y%m%d", &timeinfo);
+            bound = buffer;
+            return true;
+        }
+        if (value.size() < 8 || !std::all_of(value.begin(), value.end(), [](char c) {
+                return isdigit(static_cast<unsigned char>(c)) != 0 || c == '_';
+            })) {
+            return false;
+        }
+        bound = value;
+        return true;
+    }
+
+    bool ReportIndex::Query(const std::string& expression, std::vector<ReportHit>& hits, QueryStats& stats,
+                            std::string& error) const {
+        auto start = std::chrono::steady_clock::now();
+        hits.clear();
+        stats = QueryStats();
+        if (!file_) {
+            error = "Report index is not open";
+            return false;
+        }
+
+        std::vector<std::string> words;
+        if (!SplitQuery(expression, words, error)) {
+            return false;
+        }
+        if (words.empty()) {
+            error = "Empty query";
+            return false;
+        }
+
+        std::vector<QueryClause> clauses;
+        std::string since;
+        std::string until;
+        for (const auto& word : words) {
+            QueryClause clause;
+            clause.exclude = word[0] == '-';
+            size_t colon = word.find(':');
+            if (colon == std::string::npos) {
+                error = "Expected field:value in query, got '" + word + "'";
+                return false;
+            }
+            std::string fieldName = ToLower(word.substr(clause.exclude ? 1 : 0, colon - (clause.exclude ? 1 : 0)));
+            clause.pattern = ToLower(word.substr(colon + 1));
+            if (clause.pattern.empty()) {
+                error = "Missing value for '" + fieldName + "'";
+                return false;
+            }
+
+            if (fieldName == "since" || fieldName == "until") {
+                if (clause.exclude || !ParseTimeBound(clause.pattern, fieldName == "since" ? since : until)) {
+                    error = "Invalid " + fieldName + " value '" + clause.pattern + "' (expected YYYYMMDD[_HHMMSS] or Nd)";
+                    return false;
+                }
+                continue;
+            }
+            auto name = std::find_if(std::begin(kFieldNames), std::end(kFieldNames),
+                                     [&fieldName](const char* candidate) { return fieldName == candidate; });
+            if (name == std::end(kFieldNames)) {
+                error = "Unknown query field '" + fieldName + "'";
+                return false;
+            }
+            clause.field = static_cast<DWORD>(name - std::begin(kFieldNames));
+            clauses.push_back(clause);
+        }
+
+        IndexView view(file_);
+        view.Validate(error);
+        stats.documents = view.DocumentCount();
+
+        // Each clause resolves to the sorted union of the postings of its matching terms. The
+        // literal prefix before the first wildcard narrows the dictionary range that is scanned.
+        auto resolve = [&](const QueryClause& clause) {
+            std::vector<DWORD> matched;
+            size_t wildcard = clause.pattern.find_first_of("*?");
+            std::string_view prefix(clause.pattern.data(), wildcard == std::string::npos ? clause.pattern.size() : wildcard);
+            size_t termsMatched = 0;
+            for (DWORD i = view.LowerBound(clause.field, prefix); i < view.TermCount(); i++) {
+                const TermRecord& term = view.Term(i);
+                std::string_view text = view.String(term.term);
+                if (term.field != clause.field || text.compare(0, prefix.size(), prefix) != 0) {
+                    break;
+                }
+                if (wildcard == std::string::npos ? text.size() != prefix.size()
+                                                  : !GlobMatchLower(clause.pattern, std::string(text))) {
+                    continue;
+                }
+                termsMatched++;
+                view.DecodePostings(term, matched);
+                if (wildcard == std::string::npos) {
+                    break;
+                }
+            }
+            stats.termsMatched += termsMatched;
+            stats.postingsDecoded += matched.size();
+            if (termsMatched > 1) {
+                std::sort(matched.begin(), matched.end());
+                matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+            }
+            return matched;
+        };
+
+        std::vector<DWORD> result;
+        bool anyInclude = false;
+        for (const auto& clause : clauses) {
+            if (clause.exclude) {
+                continue;
+            }
+            std::vector<DWORD> matched = resolve(clause);
+            if (!anyInclude) {
+                result.swap(matched);
+                anyInclude = true;
+            } else {
+                std::vector<DWORD> both;
+                std::set_intersection(result.begin(), result.end(), matched.begin(), matched.end(), std::back_inserter(both));
+                result.swap(both);
+            }
+            if (result.empty()) {
+                break;
+            }
+        }
+        if (!anyInclude) {
+            result.resize(view.DocumentCount());
+            for (DWORD i = 0; i < view.DocumentCount(); i++) {
+                result[i] = i;
+            }
+        }
+        for (const auto& clause : clauses) {
+            if (!clause.exclude || result.empty()) {
+                continue;
+            }
+            std::vector<DWORD> matched = resolve(clause);
+            std::vector<DWORD> remaining;
+            std::set_difference(result.begin(), result.end(), matched.begin(), matched.end(), std::back_inserter(remaining));
+            result.swap(remaining);
+        }
+
+        for (DWORD number : result) {
+            const DocumentRecord& record = view.Document(number);
+            std::string_view timestamp = view.String(record.timestamp);
+            if ((!since.empty() && timestamp < since) ||
+                (!until.empty() && timestamp.substr(0, until.size()) > until)) {
+                continue;
+            }
+            ReportHit hit;
+            hit.fileName = std::string(view.String(record.fileName));
+            hit.pid = record.pid;
+            hit.processName = std::string(view.String(record.processName));
+            hit.timestamp = std::string(timestamp);
+            hit.riskLevel = std::string(view.String(record.riskLevel));
+            hits.push_back(std::move(hit));
+        }
+        std::sort(hits.begin(), hits.end(), [](const ReportHit& a, const ReportHit& b) { return a.timestamp > b.timestamp; });
+
+        stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "util.h"
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Work done by one incremental ingestion pass
+    struct IndexUpdateStats {
+        size_t files;           // Report files found in the directory
+        size_t added;
+        size_t replaced;        // Indexed before but changed on disk since
+        size_t removed;         // Indexed before but deleted since
+        size_t failed;          // Unreadable or not a scan report; retried on the next pass
+        size_t documents;       // Reports in the index after the pass
+        size_t terms;
+        ULONGLONG indexBytes;
+        bool rewritten;         // False when nothing changed and the index was left alone
+        double elapsedMs;
+
+        IndexUpdateStats() : files(0), added(0), replaced(0), removed(0), failed(0), documents(0), terms(0),
+                             indexBytes(0), rewritten(false), elapsedMs(0) {}
+    };
+
+    // One report matched by a query
+    struct ReportHit {
+        std::string fileName;   // Relative to the reports directory
+        DWORD pid;
+        std::string processName;
+        std::string timestamp;  // GetTimestamp() format, taken from the file name
+        std::string riskLevel;
+
+        ReportHit() : pid(0) {}
+    };
+
+    struct QueryStats {
+        size_t documents;       // Reports in the index
+        size_t termsMatched;
+        size_t postingsDecoded;
+        double elapsedMs;
+
+        QueryStats() : documents(0), termsMatched(0), postingsDecoded(0), elapsedMs(0) {}
+    };
+
+    // Inverted index over the JSON reports in a directory, kept in one file that queries map read-only.
+    // File layout (little-endian):
+    //   [header]     magic "PSINDEX1", version, counts, and offset/size of each section below
+    //   [documents]  fixed-size records: pid, file name, process name, timestamp, risk level, file size and write time
+    //   [terms]      fixed-size records sorted by (field, term): postings offset, size and document count
+    //   [strings]    uint32 length + bytes, referenced by offset from documents and terms
+    //   [postings]   ascending document numbers, delta- and varint-encoded
+    // Terms are lowercased. Fields: process, module (full path), name (module file name), unsigned
+    // (full path of an unsigned module), signer, risk and protection (of any region).
+    class ReportIndex {
+    public:
+        enum Field : DWORD { Process, Module, ModuleName, Unsigned, Signer, Risk, Protection, FieldCount };
+
+        ReportIndex() {}
+        ReportIndex(const ReportIndex&) = delete;
+        ReportIndex& operator=(const ReportIndex&) = delete;
+
+        // Ingests reports added or changed since the last pass and drops deleted ones. Unchanged
+        // files are recognized by name, size and write time without being opened. The new index is
+        // written beside the old one and renamed over it, so concurrent queries never see a partial file.
+        static bool Update(const std::string& reportsDirectory, const std::string& indexPath,
+                           IndexUpdateStats& stats, std::string& error);
+
+        bool Open(const std::string& indexPath, std::string& error);
+        void Close() { file_.Close(); }
+        size_t DocumentCount() const;
+
+        // Space-separated field:value clauses, all of which must match, e.g.
+        //   unsigned:*\temp\* risk:high since:7d
+        // A value may contain '*' and '?' wildcards, and a leading '-' excludes matches. since: and
+        // until: take YYYYMMDD[_HHMMSS] or Nd (N days ago). Quote values that contain spaces.
+        // Hits are newest first.
+        bool Query(const std::string& expression, std::vector<ReportHit>& hits, QueryStats& stats,
+                   std::string& error) const;
+
+    private:
+        MappedFile file_;
+    };
+
+} // namespace ProcessScope
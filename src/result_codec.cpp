@@ -0,0 +1,363 @@
+#include "result_codec.h"
+#include <cstring>
+#include <type_traits>
+
+namespace ProcessScope {
+
+    // Upper bound on any one element count, so a corrupt length cannot trigger a huge allocation
+    static const DWORD kMaxElements = 1u << 24;
+
+    class RecordWriter {
+    private:
+        std::vector<BYTE>& out_;
+
+    public:
+        explicit RecordWriter(std::vector<BYTE>& out) : out_(out) {}
+
+        template <typename T>
+        void Put(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "Put takes plain values only");
+            const BYTE* bytes = reinterpret_cast<const BYTE*>(&value);
+            out_.insert(out_.end(), bytes, bytes + sizeof(T));
+        }
+
+        void PutBool(bool value) { Put(static_cast<BYTE>(value ? 1 : 0)); }
+
+        void PutBytes(const BYTE* data, size_t size) {
+            Put(static_cast<DWORD>(size));
+            out_.insert(out_.end(), data, data + size);
+        }
+
+        void PutString(const std::string& value) {
+            PutBytes(reinterpret_cast<const BYTE*>(value.data()), value.size());
+        }
+    };
+
+    // Bounds-checked counterpart of RecordWriter; once a read fails every later read fails too
+    class RecordReader {
+    private:
+        const BYTE* data_;
+        size_t size_;
+        size_t offset_;
+        bool ok_;
+
+    public:
+        RecordReader(const BYTE* data, size_t size) : data_(data), size_(size), offset_(0), ok_(true) {}
+
+        bool ok() const { return ok_; }
+        bool AtEnd() const { return offset_ == size_; }
+
+        template <typename T>
+        T Get() {
+            T value = T();
+            if (!ok_ || size_ - offset_ < sizeof(T)) {
+                ok_ = false;
+                return value;
+            }
+            memcpy(&value, data_ + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            return value;
+        }
+
+        bool GetBool() { return Get<BYTE>() != 0; }
+
+        DWORD GetCount() {
+            DWORD count = Get<DWORD>();
+            if (count > kMaxElements || count > size_ - offset_) {
+                ok_ = false;
+                return 0;
+            }
+            return count;
+        }
+
+        void GetBytes(std::vector<BYTE>& value) {
+            DWORD length = GetCount();
+            if (ok_) {
+                value.assign(data_ + offset_, data_ + offset_ + length);
+                offset_ += length;
+            }
+        }
+
+        std::string GetString() {
+            DWORD length = GetCount();
+            if (!ok_) {
+                return std::string();
+            }
+            std::string value(reinterpret_cast<const char*>(data_ + offset_), length);
+            offset_ += length;
+            return value;
+        }
+    };
+
+    static void WriteProcessInfo(RecordWriter& writer, const ProcessInfo& info) {
+        writer.Put(info.pid);
+        writer.Put(info.ppid);
+        writer.PutString(info.name);
+        writer.PutString(info.fullPath);
+        writer.PutString(info.architecture);
+        writer.PutString(info.user);
+        writer.Put(info.sessionId);
+        writer.Put(info.creationTime);
+        writer.Put(info.privateBytes);
+    }
+
+    static void ReadProcessInfo(RecordReader& reader, ProcessInfo& info) {
+        info.pid = reader.Get<DWORD>();
+        info.ppid = reader.Get<DWORD>();
+        info.name = reader.GetString();
+        info.fullPath = reader.GetString();
+        info.architecture = reader.GetString();
+        info.user = reader.GetString();
+        info.sessionId = reader.Get<DWORD>();
+        info.creationTime = reader.Get<ULONGLONG>();
+        info.privateBytes = reader.Get<ULONGLONG>();
+    }
+
+    static void WriteRegion(RecordWriter& writer, const MemoryRegion& region) {
+        writer.Put(region.baseAddress);
+        writer.Put(region.size);
+        writer.PutString(region.state);
+        writer.PutString(region.type);
+        writer.PutString(region.protection);
+        BYTE flags = (region.isExecutable ? 0x01 : 0) | (region.isWritable ? 0x02 : 0) |
+                     (region.isSuspicious ? 0x04 : 0) | (region.hasPeHeader ? 0x08 : 0) |
+                     (region.isImage ? 0x10 : 0) | (region.similarity.valid ? 0x20 : 0) |
+                     (region.pages.analyzed ? 0x40 : 0);
+        writer.Put(flags);
+        writer.Put(region.fingerprint);
+
+        if (region.similarity.valid) {
+            const SimilarityDigest& digest = region.similarity;
+            writer.Put(digest.checksum);
+            writer.Put(digest.lengthCode);
+            writer.Put(digest.quartileRatios);
+            writer.Put(digest.body);
+        }
+
+        if (region.pages.analyzed) {
+            const PageAnalysis& pages = region.pages;
+            writer.Put(pages.pageCount);
+            writer.Put(pages.residentPages);
+            writer.Put(pages.sharedPages);
+            writer.Put(pages.privatePages);
+            writer.PutBytes(pages.residentBitmap.data(), pages.residentBitmap.size());
+            writer.PutBytes(pages.privateBitmap.data(), pages.privateBitmap.size());
+        }
+    }
+
+    static void ReadRegion(RecordReader& reader, MemoryRegion& region) {
+        region.baseAddress = reader.Get<uintptr_t>();
+        region.size = reader.Get<size_t>();
+        region.state = reader.GetString();
+        region.type = reader.GetString();
+        region.protection = reader.GetString();
+        BYTE flags = reader.Get<BYTE>();
+        region.isExecutable = (flags & 0x01) != 0;
+        region.isWritable = (flags & 0x02) != 0;
+        region.isSuspicious = (flags & 0x04) != 0;
+        region.hasPeHeader = (flags & 0x08) != 0;
+        region.isImage = (flags & 0x10) != 0;
+        region.fingerprint = reader.Get<ULONGLONG>();
+
+        if (flags & 0x20) {
+            SimilarityDigest& digest = region.similarity;
+            digest.checksum = reader.Get<BYTE>();
+            digest.lengthCode = reader.Get<BYTE>();
+            digest.quartileRatios = reader.Get<BYTE>();
+            for (size_t i = 0; i < SimilarityDigest::kBodyBytes; i++) {
+                digest.body[i] = reader.Get<BYTE>();
+            }
+            digest.valid = reader.ok();
+        }
+
+        if (flags & 0x40) {
+            PageAnalysis& pages = region.pages;
+            pages.pageCount = reader.Get<size_t>();
+            pages.residentPages = reader.Get<size_t>();
+            pages.sharedPages = reader.Get<size_t>();
+            pages.privatePages = reader.Get<size_t>();
+            reader.GetBytes(pages.residentBitmap);
+            reader.GetBytes(pages.privateBitmap);
+            pages.analyzed = reader.ok();
+        }
+    }
+
+    void EncodeProcessInfo(const ProcessInfo& info, std::vector<BYTE>& out) {
+        RecordWriter writer(out);
+        WriteProcessInfo(writer, info);
+    }
+
+    bool DecodeProcessInfo(const BYTE* data, size_t size, ProcessInfo& info) {
+        RecordReader reader(data, size);
+        ReadProcessInfo(reader, info);
+        return reader.ok() && reader.AtEnd();
+    }
+
+    void EncodeScanResult(const ScanResult& result, std::vector<BYTE>& out) {
+        RecordWriter writer(out);
+        WriteProcessInfo(writer, result.processInfo);
+
+        writer.Put(static_cast<DWORD>(result.modules.size()));
+        for (const auto& module : result.modules) {
+            writer.PutString(module.name);
+            writer.PutString(module.fullPath);
+            writer.Put(module.baseAddress);
+            writer.Put(module.size);
+            writer.PutBool(module.isSigned);
+            writer.PutString(module.signerName);
+        }
+
+        writer.Put(static_cast<DWORD>(result.threads.size()));
+        for (const auto& thread : result.threads) {
+            writer.Put(thread.tid);
+            writer.Put(thread.startAddress);
+            writer.PutString(thread.startSymbol);
+            writer.PutBool(thread.anomalousStart);
+            writer.Put(thread.samples);
+            writer.Put(thread.unbackedSamples);
+            writer.Put(thread.cpuTime);
+            writer.Put(thread.sampledAddress);
+            writer.PutString(thread.sampledSymbol);
+        }
+
+        writer.Put(static_cast<DWORD>(result.memoryRegions.size()));
+        for (const auto& region : result.memoryRegions) {
+            WriteRegion(writer, region);
+        }
+
+        writer.Put(result.riskAssessment.score);
+        writer.Put(result.riskAssessment.lineageScore);
+        writer.Put(static_cast<int>(result.riskAssessment.level));
+        writer.PutString(result.riskAssessment.details);
+
+        writer.Put(result.timings);
+        writer.Put(result.memoryReads);
+        writer.Put(result.pageQueries);
+        const ContentSample& sample = result.contentSample;
+        writer.PutBool(sample.sampled);
+        if (sample.sampled) {
+            writer.Put(sample.budgetBytes);
+            writer.Put(sample.bytesRead);
+            writer.PutBool(sample.flaggedComplete);
+            writer.Put(sample.strata);
+            writer.Put(sample.peHeaders);
+            writer.Put(sample.highEntropy);
+            writer.Put(static_cast<DWORD>(sample.hits.size()));
+            for (const auto& hit : sample.hits) {
+                writer.Put(hit);
+            }
+            writer.Put(sample.elapsedMs);
+        }
+        const StringExtraction& strings = result.strings;
+        writer.PutBool(strings.extracted);
+        if (strings.extracted) {
+            writer.Put(strings.regions);
+            writer.Put(strings.bytesScanned);
+            writer.Put(strings.totalStrings);
+            writer.Put(strings.uniqueStrings);
+            writer.PutBool(strings.complete);
+            writer.Put(static_cast<DWORD>(strings.strings.size()));
+            for (const auto& extracted : strings.strings) {
+                writer.Put(extracted.address);
+                writer.PutString(extracted.text);
+                writer.PutBool(extracted.wide);
+                writer.Put(extracted.occurrences);
+            }
+            writer.Put(strings.elapsedMs);
+        }
+        writer.Put(result.threadSampling);
+        writer.PutString(result.truncatedPhase);
+        writer.PutString(result.errorMessage);
+        writer.PutBool(result.success);
+        writer.PutBool(result.truncated);
+        writer.PutBool(result.accessDenied);
+    }
+
+    bool DecodeScanResult(const BYTE* data, size_t size, ScanResult& result) {
+        RecordReader reader(data, size);
+        ReadProcessInfo(reader, result.processInfo);
+
+        result.modules.resize(reader.GetCount());
+        for (auto& module : result.modules) {
+            module.name = reader.GetString();
+            module.fullPath = reader.GetString();
+            module.baseAddress = reader.Get<uintptr_t>();
+            module.size = reader.Get<size_t>();
+            module.isSigned = reader.GetBool();
+            module.signerName = reader.GetString();
+        }
+
+        result.threads.resize(reader.GetCount());
+        for (auto& thread : result.threads) {
+            thread.tid = reader.Get<DWORD>();
+            thread.startAddress = reader.Get<uintptr_t>();
+            thread.startSymbol = reader.GetString();
+            thread.anomalousStart = reader.GetBool();
+            thread.samples = reader.Get<DWORD>();
+            thread.unbackedSamples = reader.Get<DWORD>();
+            thread.cpuTime = reader.Get<ULONGLONG>();
+            thread.sampledAddress = reader.Get<uintptr_t>();
+            thread.sampledSymbol = reader.GetString();
+        }
+
+        result.memoryRegions.resize(reader.GetCount());
+        for (auto& region : result.memoryRegions) {
+            ReadRegion(reader, region);
+        }
+
+        result.riskAssessment.score = reader.Get<int>();
+        result.riskAssessment.lineageScore = reader.Get<int>();
+        int level = reader.Get<int>();
+        if (level < static_cast<int>(RiskLevel::Low) || level > static_cast<int>(RiskLevel::High)) {
+            return false;
+        }
+        result.riskAssessment.level = static_cast<RiskLevel>(level);
+        result.riskAssessment.details = reader.GetString();
+
+        result.timings = reader.Get<ScanTimings>();
+        result.memoryReads = reader.Get<RemoteReaderStats>();
+        result.pageQueries = reader.Get<PageAnalysisStats>();
+        ContentSample& sample = result.contentSample;
+        sample.sampled = reader.GetBool();
+        if (sample.sampled) {
+            sample.budgetBytes = reader.Get<ULONGLONG>();
+            sample.bytesRead = reader.Get<ULONGLONG>();
+            sample.flaggedComplete = reader.GetBool();
+            for (auto& stratum : sample.strata) {
+                stratum = reader.Get<SampleStratum>();
+            }
+            sample.peHeaders = reader.Get<SampleEstimate>();
+            sample.highEntropy = reader.Get<SampleEstimate>();
+            sample.hits.resize(reader.GetCount());
+            for (auto& hit : sample.hits) {
+                hit = reader.Get<SampleHit>();
+            }
+            sample.elapsedMs = reader.Get<double>();
+        }
+        StringExtraction& strings = result.strings;
+        strings.extracted = reader.GetBool();
+        if (strings.extracted) {
+            strings.regions = reader.Get<size_t>();
+            strings.bytesScanned = reader.Get<ULONGLONG>();
+            strings.totalStrings = reader.Get<size_t>();
+            strings.uniqueStrings = reader.Get<size_t>();
+            strings.complete = reader.GetBool();
+            strings.strings.resize(reader.GetCount());
+            for (auto& extracted : strings.strings) {
+                extracted.address = reader.Get<uintptr_t>();
+                extracted.text = reader.GetString();
+                extracted.wide = reader.GetBool();
+                extracted.occurrences = reader.Get<DWORD>();
+            }
+            strings.elapsedMs = reader.Get<double>();
+        }
+        result.threadSampling = reader.Get<ThreadSamplingStats>();
+        result.truncatedPhase = reader.GetString();
+        result.errorMessage = reader.GetString();
+        result.success = reader.GetBool();
+        result.truncated = reader.GetBool();
+        result.accessDenied = reader.GetBool();
+        return reader.ok() && reader.AtEnd();
+    }
+
+} // namespace ProcessScope
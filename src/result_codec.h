@@ -0,0 +1,19 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include <vector>
+
+namespace ProcessScope {
+
+    // Flat binary encoding of scan results for passing them between processes of the same
+    // build. Scalars are copied in native layout and strings and arrays are length-prefixed, so
+    // encoding is a sequence of appends and decoding a bounds-checked walk with no parsing.
+    // Appends to out; decoding fails on truncated or oversized input.
+    void EncodeProcessInfo(const ProcessInfo& info, std::vector<BYTE>& out);
+    bool DecodeProcessInfo(const BYTE* data, size_t size, ProcessInfo& info);
+
+    void EncodeScanResult(const ScanResult& result, std::vector<BYTE>& out);
+    bool DecodeScanResult(const BYTE* data, size_t size, ScanResult& result);
+
+} // namespace ProcessScope
@@ -5,36 +5,157 @@
 
 namespace ProcessScope {
 
+    // Parents that should never spawn script hosts or shells
+    static const char* const kDocumentHosts[] = {
+        "winword.exe", "excel.exe", "powerpnt.exe", "outlook.exe", "msaccess.exe",
+        "acrord32.exe", "acrobat.exe", "wmplayer.exe"
+    };
+    static const char* const kShellChildren[] = {
+        "cmd.exe", "powershell.exe", "pwsh.exe", "wscript.exe", "cscript.exe",
+        "mshta.exe", "rundll32.exe", "regsvr32.exe", "certutil.exe", "bitsadmin.exe"
+    };
+
+    // System processes with a single legitimate parent
+    struct ExpectedParent {
+        const char* child;
+        const char* parent;
+    };
+    static const ExpectedParent kExpectedParents[] = {
+        { "svchost.exe",  "services.exe" },
+        { "services.exe", "wininit.exe" },
+        { "lsass.exe",    "wininit.exe" },
+        { "lsaiso.exe",   "wininit.exe" },
+        { "taskhostw.exe", "svchost.exe" }
+    };
+
+    // Private pages in one executable image region at or above this count look like an overwrite
+    // rather than an inline hook
+    static const size_t kModifiedImagePagesThreshold = 4;
+
+    // Suspicious regions whose fingerprint is already held by this many other processes are
+    // treated as fleet-common (JIT trampolines, security product hook pages) and down-weighted
+    static const size_t kFleetCommonProcesses = 5;
+
+    // Ancestors at or above this own score make their descendants inherit risk
+    static const int kInheritedRiskThreshold = 6;
+
     RiskAssessment RiskScorer::CalculateRiskScore(
-        const ProcessInfo& /*processInfo*/,
+        const ProcessInfo& processInfo,
         const std::vector<ModuleInfo>& modules,
         const std::vector<ThreadInfo>& threads,
-        const std::vector<MemoryRegion>& memoryRegions) {
+        const std::vector<MemoryRegion>& memoryRegions,
+        ImageSource& images,
+        const LineageInfo* lineage,
+        const FingerprintIndex* fleet,
+        const ImageBaseline* baseline,
+        const ModuleAllowlist* allowlist) {
         
         RiskAssessment assessment;
         std::stringstream details;
+        const ModuleAllowlist& trusted = allowlist ? *allowlist : ModuleAllowlist::BuiltIn();
+        
+        // Too few observations to tell what is typical for this image yet
+        if (baseline && !baseline->IsEstablished()) {
+            baseline = nullptr;
+        }
         
-        // Check for unsigned modules (excluding legitimate locations)
-        int unsignedScore = ScoreUnsignedModules(modules);
+        // Check for unsigned modules (excluding allowlisted ones)
+        int unsignedScore = ScoreUnsignedModules(modules, baseline, trusted, images);
         assessment.score += unsignedScore;
         if (unsignedScore > 0) {
             details << "Unsigned modules: +" << unsignedScore << "; ";
         }
         
         // Check for anomalous thread start addresses
-        int anomalousScore = ScoreAnomalousThreads(threads, modules);
+        int anomalousScore = ScoreAnomalousThreads(threads, modules, baseline);
         assessment.score += anomalousScore;
         if (anomalousScore > 0) {
             details << "Anomalous thread starts: +" << anomalousScore << "; ";
         }
         
+        // Check for threads sampled while executing outside any module or image
+        int unbackedScore = ScoreUnbackedExecution(threads, baseline);
+        assessment.score += unbackedScore;
+        if (unbackedScore > 0) {
+            details << "Executing in unbacked memory: +" << unbackedScore << "; ";
+        }
+        
         // Check for suspicious memory regions
-        int memoryScore = ScoreSuspiciousMemory(memoryRegions);
+        size_t fleetCommonRegions = 0;
+        size_t baselineTypicalRegions = 0;
+        int memoryScore = ScoreSuspiciousMemory(memoryRegions, fleet, baseline, fleetCommonRegions, baselineTypicalRegions);
         assessment.score += memoryScore;
         if (memoryScore > 0) {
             details << "Suspicious memory: +" << memoryScore << "; ";
         }
+        if (fleetCommonRegions > 0) {
+            details << "Fleet-common regions down-weighted: " << fleetCommonRegions << "; ";
+        }
+        if (baselineTypicalRegions > 0) {
+            details << "Baseline-typical regions down-weighted: " << baselineTypicalRegions << "; ";
+        }
+        
+        // Check for copy-on-write pages in image-backed code (patching, stomping, hollowing)
+        int modifiedImageScore = ScoreModifiedImageCode(memoryRegions, baseline);
+        assessment.score += modifiedImageScore;
+        if (modifiedImageScore > 0) {
+            details << "Modified image code: +" << modifiedImageScore << "; ";
+        }
         
+        // Check for modules and thread start modules never seen in this image before
+        if (baseline) {
+            int deviationScore = ScoreBaselineDeviation(modules, threads, *baseline, allowlist, images);
+            assessment.score += deviationScore;
+            if (deviationScore > 0) {
+                details << "Baseline deviation: +" << deviationScore << "; ";
+            }
+        }
+        
+        // Check lineage: unusual parent/child pairs and risk inherited from ancestors
+        if (lineage) {
+            ApplyLineage(assessment, processInfo, *lineage, details);
+        }
+        
+        AssignRiskLevel(assessment);
+        
+        assessment.details = details.str();
+        if (assessment.details.empty()) {
+            assessment.details = "No risk factors detected";
+        }
+        
+        return assessment;
+    }
+
+    RiskAssessment RiskScorer::CalculateTriageScore(
+        const ProcessInfo& processInfo,
+        const RegionSummary& summary,
+        const LineageInfo* lineage) {
+        
+        RiskAssessment assessment;
+        std::stringstream details;
+        
+        // Mirrors ScoreSuspiciousMemory: +3 per RWX region, +1 per other large executable private region
+        int memoryScore = static_cast<int>(summary.rwxRegions * 3 + (summary.suspiciousRegions - summary.rwxRegions));
+        assessment.score += memoryScore;
+        if (memoryScore > 0) {
+            details << "Suspicious memory: +" << memoryScore << "; ";
+        }
+        
+        if (lineage) {
+            ApplyLineage(assessment, processInfo, *lineage, details);
+        }
+        
+        AssignRiskLevel(assessment);
+        
+        assessment.details = details.str();
+        if (assessment.details.empty()) {
+            assessment.details = "No tier-1 risk factors detected";
+        }
+        
+        return assessment;
+    }
+
+    void RiskScorer::AssignRiskLevel(RiskAssessment& assessment) {
         // Determine risk level based on total score
         if (assessment.score <= 2) {
             assessment.level = RiskLevel::Low;
@@ -43,13 +164,22 @@ namespace ProcessScope {
         } else {
             assessment.level = RiskLevel::High;
         }
+    }
+
+    void RiskScorer::ApplyLineage(RiskAssessment& assessment, const ProcessInfo& processInfo,
+                                  const LineageInfo& lineage, std::stringstream& details) {
+        int parentScore = ScoreUnusualParent(processInfo, lineage);
+        if (parentScore > 0) {
+            details << "Unusual parent (" << lineage.parentName << "): +" << parentScore << "; ";
+        }
         
-        assessment.details = details.str();
-        if (assessment.details.empty()) {
-            assessment.details = "No risk factors detected";
+        int inheritedScore = ScoreInheritedRisk(lineage);
+        if (inheritedScore > 0) {
+            details << "Descendant of high-risk PID " << lineage.maxAncestorPid << ": +" << inheritedScore << "; ";
         }
         
-        return assessment;
+        assessment.lineageScore = parentScore + inheritedScore;
+        assessment.score += assessment.lineageScore;
     }
 
     std::string RiskScorer::GetRiskLevelString(RiskLevel level) {
@@ -61,23 +191,14 @@ namespace ProcessScope {
         }
     }
 
-    int RiskScorer::ScoreUnsignedModules(const std::vector<ModuleInfo>& modules) {
+    int RiskScorer::ScoreUnsignedModules(const std::vector<ModuleInfo>& modules, const ImageBaseline* baseline,
+                                         const ModuleAllowlist& allowlist, ImageSource& images) {
         int unsignedCount = 0;
         for (const auto& module : modules) {
-            if (!module.isSigned) {
+            // Unsigned modules this image has always loaded are part of the product
+            if (!module.isSigned && !(baseline && baseline->HasModule(BaselineHash(module.fullPath)))) {
                 // Skip unsigned modules from trusted locations
-                bool isLegitimateLocation = false;
-                std::string lowerPath = module.fullPath;
-                std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), ::tolower);
-                
-                if (lowerPath.find("windows\\system32") != std::string::npos ||
-                    lowerPath.find("windows\\syswow64") != std::string::npos ||
-                    lowerPath.find("program files") != std::string::npos ||
-                    lowerPath.find("programdata") != std::string::npos) {
-                    isLegitimateLocation = true;
-                }
-                
-                if (!isLegitimateLocation) {
+                if (!allowlist.Matches(module, images)) {
                     unsignedCount++;
                 }
             }
@@ -86,9 +207,10 @@ namespace ProcessScope {
         return (std::min)(unsignedCount, 3);
     }
 
-    int RiskScorer::ScoreAnomalousThreads(const std::vector<ThreadInfo>& threads, const std::vector<ModuleInfo>& modules) {
+    int RiskScorer::ScoreAnomalousThreads(const std::vector<ThreadInfo>& threads, const std::vector<ModuleInfo>& modules,
+                                          const ImageBaseline* baseline) {
         ThreadEnumerator enumerator;
-        int anomalousCount = 0;
+        size_t anomalousCount = 0;
         
         for (const auto& thread : threads) {
             if (thread.startAddress != 0 && 
@@ -97,18 +219,113 @@ namespace ProcessScope {
             }
         }
         
-        return anomalousCount * 2; // +2 per anomalous thread
+        // JIT runtimes start threads in private code as a matter of course; only the excess counts
+        if (baseline) {
+            anomalousCount -= (std::min)(anomalousCount, baseline->TypicalCount(BaselineCounter::AnomalousThreads));
+        }
+        
+        return static_cast<int>(anomalousCount) * 2; // +2 per anomalous thread
+    }
+
+    int RiskScorer::ScoreUnbackedExecution(const std::vector<ThreadInfo>& threads, const ImageBaseline* baseline) {
+        // Only an established baseline says whether this image normally runs such code. JIT
+        // runtimes run private code all the time; an image whose baseline has executable private
+        // regions is one of them.
+        if (!baseline || !baseline->IsEstablished() ||
+            baseline->TypicalCount(BaselineCounter::ExecutablePrivateRegions) > 0) {
+            return 0;
+        }
+        
+        int threadCount = 0;
+        for (const auto& thread : threads) {
+            if (thread.unbackedSamples > 0) {
+                threadCount++;
+            }
+        }
+        return (std::min)(threadCount * 3, 6); // +3 per thread, max +6
+    }
+
+    int RiskScorer::ScoreUnusualParent(const ProcessInfo& processInfo, const LineageInfo& lineage) {
+        if (!lineage.parentKnown) {
+            return 0;
+        }
+        
+        std::string child = ToLower(processInfo.name);
+        std::string parent = ToLower(lineage.parentName);
+        
+        for (const auto& expected : kExpectedParents) {
+            if (child == expected.child) {
+                return parent == expected.parent ? 0 : 3;
+            }
+        }
+        
+        bool parentIsDocumentHost = std::find(std::begin(kDocumentHosts), std::end(kDocumentHosts), parent) != std::end(kDocumentHosts);
+        if (parentIsDocumentHost &&
+            std::find(std::begin(kShellChildren), std::end(kShellChildren), child) != std::end(kShellChildren)) {
+            return 3; // Document host spawning a shell or script host
+        }
+        
+        return 0;
+    }
+
+    int RiskScorer::ScoreInheritedRisk(const LineageInfo& lineage) {
+        return lineage.maxAncestorScore >= kInheritedRiskThreshold ? 2 : 0;
+    }
+
+    int RiskScorer::ScoreModifiedImageCode(const std::vector<MemoryRegion>& regions, const ImageBaseline* baseline) {
+        int score = 0;
+        size_t typicalHooks = baseline ? baseline->TypicalCount(BaselineCounter::ModifiedImageRegions) : 0;
+        
+        for (const auto& region : regions) {
+            if (region.isImage && region.isExecutable && region.pages.privatePages > 0) {
+                // Hooked regions up to the count usual for this image are expected; overwrites still score
+                if (typicalHooks > 0 && region.pages.privatePages < kModifiedImagePagesThreshold) {
+                    typicalHooks--;
+                    continue;
+                }
+                // A few pages is typical of hooks; many pages suggests the image was overwritten
+                score += region.pages.privatePages >= kModifiedImagePagesThreshold ? 3 : 1;
+            }
+        }
+        
+        // Cap at +3 points; security products hook image code in every process
+        return (std::min)(score, 3);
     }
 
-    int RiskScorer::ScoreSuspiciousMemory(const std::vector<MemoryRegion>& regions) {
+    int RiskScorer::ScoreSuspiciousMemory(const std::vector<MemoryRegion>& regions, const FingerprintIndex* fleet,
+                                          const ImageBaseline* baseline, size_t& fleetCommonRegions,
+                                          size_t& baselineTypicalRegions) {
         int score = 0;
+        size_t typicalRwx = baseline ? baseline->TypicalCount(BaselineCounter::RwxRegions) : 0;
+        size_t typicalPrivate = baseline ? baseline->TypicalCount(BaselineCounter::ExecutablePrivateRegions) : 0;
         
         for (const auto& region : regions) {
             if (region.isSuspicious) {
+                // Identical copies across many processes: keep RWX at +1, drop the size-only flag
+                if (fleet && region.fingerprint != 0 && fleet->ProcessCount(region.fingerprint) >= kFleetCommonProcesses) {
+                    fleetCommonRegions++;
+                    if (region.protection.find("RWX") != std::string::npos) {
+                        score += 1;
+                    }
+                    continue;
+                }
+                
+                // Up to the count usual for this image: RWX at +1, executable private not at all
                 if (region.protection.find("RWX") != std::string::npos) {
-                    score += 3; // RWX regions are most dangerous
+                    if (typicalRwx > 0) {
+                        typicalRwx--;
+                        baselineTypicalRegions++;
+                        score += 1;
+                    } else {
+                        score += 3; // RWX regions are most dangerous
+                    }
                 } else if (region.isExecutable && region.type == "PRIVATE") {
-                    score += 1; // Large executable private regions
+                    if (typicalPrivate > 0) {
+                        typicalPrivate--;
+                        baselineTypicalRegions++;
+                    } else {
+                        score += 1; // Large executable private regions
+                    }
                 }
             }
         }
@@ -116,4 +333,31 @@ namespace ProcessScope {
         return score;
     }
 
+    int RiskScorer::ScoreBaselineDeviation(const std::vector<ModuleInfo>& modules, const std::vector<ThreadInfo>& threads,
+                                           const ImageBaseline& baseline, const ModuleAllowlist* allowlist,
+                                           ImageSource& images) {
+        BaselineObservation observation = BaselineObservation::FromScan(modules, threads, std::vector<MemoryRegion>());
+        int novelCount = 0;
+        
+        // One hash per module, in order. A new module a configured allowlist trusts is not a novelty;
+        // the built-in locations are not enough, since System32 holds dumping and credential DLLs too.
+        for (size_t i = 0; i < observation.modules.size(); i++) {
+            if (!baseline.HasModule(observation.modules[i]) && !(allowlist && allowlist->Matches(modules[i], images))) {
+                novelCount++;
+            }
+        }
+        
+        std::sort(observation.startModules.begin(), observation.startModules.end());
+        observation.startModules.erase(std::unique(observation.startModules.begin(), observation.startModules.end()),
+                                       observation.startModules.end());
+        for (ULONGLONG startModule : observation.startModules) {
+            if (!baseline.HasStartModule(startModule)) {
+                novelCount++;
+            }
+        }
+        
+        // +1 per novelty, capped at +3; plugins and updates add modules legitimately
+        return (std::min)(novelCount, 3);
+    }
+
 } // namespace ProcessScope
@@ -5,6 +5,11 @@
 #include "module_enum.h"
 #include "thread_enum.h"
 #include "memory_scan.h"
+#include "process_tree.h"
+#include "fingerprint.h"
+#include "baseline_store.h"
+#include "module_allowlist.h"
+#include <sstream>
 #include <string>
 
 // Risk assessment levels for process analysis
@@ -17,26 +22,64 @@ enum class RiskLevel {
 // Risk assessment results with scoring details
 struct RiskAssessment {
     int score;
+    int lineageScore; // Portion of score contributed by process lineage
     RiskLevel level;
     std::string details;
     
-    RiskAssessment() : score(0), level(RiskLevel::Low) {}
+    RiskAssessment() : score(0), lineageScore(0), level(RiskLevel::Low) {}
 };
 
-// Risk scoring calculator with defensive heuristics
-class RiskScorer {
+namespace ProcessScope {
+
+    // Risk scoring calculator with defensive heuristics
+    class RiskScorer {
     public:
-        // Calculate comprehensive risk score based on modules, threads, and memory analysis
+        // Calculate comprehensive risk score based on modules, threads, and memory analysis,
+        // plus parent/child and inherited-ancestor factors when lineage is available. An established
+        // baseline for the process image discounts what is typical for it and scores novelties.
+        // Unsigned modules matching the allowlist (the built-in trusted locations when null) are not
+        // scored, and neither are new modules it matches when it is given. Digest rules are checked
+        // against the scanned host's images.
         RiskAssessment CalculateRiskScore(
             const ProcessInfo& processInfo,
             const std::vector<ModuleInfo>& modules,
             const std::vector<ThreadInfo>& threads,
-            const std::vector<MemoryRegion>& memoryRegions
+            const std::vector<MemoryRegion>& memoryRegions,
+            ProcessScope::ImageSource& images,
+            const ProcessScope::LineageInfo* lineage = nullptr,
+            const ProcessScope::FingerprintIndex* fleet = nullptr,
+            const ProcessScope::ImageBaseline* baseline = nullptr,
+            const ProcessScope::ModuleAllowlist* allowlist = nullptr
         );
         
+        // Cheap tier-1 score from a region summary and lineage only; no modules or threads required
+        RiskAssessment CalculateTriageScore(
+            const ProcessInfo& processInfo,
+            const RegionSummary& summary,
+            const ProcessScope::LineageInfo* lineage = nullptr
+        );
+
+        // Parent/child rule check only; sweep ordering also uses it before any process is opened
+        static int ScoreUnusualParent(const ProcessInfo& processInfo, const ProcessScope::LineageInfo& lineage);
+        
     private:
         std::string GetRiskLevelString(RiskLevel level);
-        int ScoreUnsignedModules(const std::vector<ModuleInfo>& modules);
-        int ScoreAnomalousThreads(const std::vector<ThreadInfo>& threads, const std::vector<ModuleInfo>& modules);
-        int ScoreSuspiciousMemory(const std::vector<MemoryRegion>& regions);
-};
+        void AssignRiskLevel(RiskAssessment& assessment);
+        void ApplyLineage(RiskAssessment& assessment, const ProcessInfo& processInfo,
+                          const ProcessScope::LineageInfo& lineage, std::stringstream& details);
+        int ScoreUnsignedModules(const std::vector<ModuleInfo>& modules, const ProcessScope::ImageBaseline* baseline,
+                                 const ProcessScope::ModuleAllowlist& allowlist, ProcessScope::ImageSource& images);
+        int ScoreAnomalousThreads(const std::vector<ThreadInfo>& threads, const std::vector<ModuleInfo>& modules,
+                                  const ProcessScope::ImageBaseline* baseline);
+        int ScoreUnbackedExecution(const std::vector<ThreadInfo>& threads, const ProcessScope::ImageBaseline* baseline);
+        int ScoreSuspiciousMemory(const std::vector<MemoryRegion>& regions, const ProcessScope::FingerprintIndex* fleet,
+                                  const ProcessScope::ImageBaseline* baseline, size_t& fleetCommonRegions,
+                                  size_t& baselineTypicalRegions);
+        int ScoreModifiedImageCode(const std::vector<MemoryRegion>& regions, const ProcessScope::ImageBaseline* baseline);
+        int ScoreBaselineDeviation(const std::vector<ModuleInfo>& modules, const std::vector<ThreadInfo>& threads,
+                                   const ProcessScope::ImageBaseline& baseline, const ProcessScope::ModuleAllowlist* allowlist,
+                                   ProcessScope::ImageSource& images);
+        int ScoreInheritedRisk(const ProcessScope::LineageInfo& lineage);
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,106 @@
+#include "scan_backend.h"
+
+namespace ProcessScope {
+
+    class LiveTarget : public ScanTarget {
+    private:
+        Handle process_;
+        DWORD pid_;
+        ModuleEnumerator& moduleEnumerator_;
+        ThreadEnumerator& threadEnumerator_;
+        std::unique_ptr<RemoteMemoryReader> reader_;
+        LiveMemorySource memory_;
+
+    public:
+        LiveTarget(Handle process, DWORD pid, bool readMemory, ModuleEnumerator& modules, ThreadEnumerator& threads)
+            : process_(std::move(process)), pid_(pid), moduleEnumerator_(modules), threadEnumerator_(threads),
+              // One page cache per target, shared by the loader walk and the region probes
+              reader_(readMemory ? new RemoteMemoryReader(process_.get()) : nullptr),
+              memory_(process_.get(), reader_.get()) {}
+
+        std::vector<ModuleInfo> EnumerateModules(const ScanContext& context) override {
+            return moduleEnumerator_.EnumerateModules(process_.get(), context, reader_.get());
+        }
+
+        std::vector<ThreadInfo> EnumerateThreads(const ScanContext& context) override {
+            return threadEnumerator_.EnumerateThreads(pid_, context);
+        }
+
+        MemorySource& Memory() override {
+            return memory_;
+        }
+
+        RemoteReaderStats ReaderStats() const override {
+            return reader_ ? reader_->Stats() : RemoteReaderStats();
+        }
+
+        std::vector<ThreadSamples> SampleThreads(const std::vector<ThreadInfo>& threads, const ThreadSampleOptions& options,
+                                                 const ScanContext& context, ThreadSamplingStats& stats) override {
+            ThreadSampler sampler;
+            std::vector<ThreadSamples> samples = sampler.Sample(process_.get(), threads, options, context);
+            stats = sampler.LastStats();
+            return samples;
+        }
+    };
+
+    bool LiveMemorySource::Query(uintptr_t address, MEMORY_BASIC_INFORMATION& mbi) {
+        return VirtualQueryEx(process_, reinterpret_cast<LPCVOID>(address), &mbi, sizeof(mbi)) == sizeof(mbi);
+    }
+
+    size_t LiveMemorySource::Read(uintptr_t address, void* buffer, size_t size) {
+        return reader_ ? reader_->Read(address, buffer, size) : 0;
+    }
+
+    PageAnalysisStats LiveMemorySource::AnalyzePages(const std::vector<PageRange>& ranges, const ScanContext& context) {
+        return PageAnalyzer().Analyze(process_, ranges, context);
+    }
+
+    std::shared_ptr<const ExportTable> LiveImageSource::GetExports(const std::string& path) {
+        return SymbolCache::Instance().GetExports(path);
+    }
+
+    bool LiveImageSource::GetDigest(const std::string& path, ImageDigest& digest) {
+        return ComputeImageDigest(path, digest);
+    }
+
+    bool LiveImageSource::GetAttributes(const std::string& path, ImageAttributes& attributes) {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (path.empty() || !GetFileAttributesExW(StringToWString(path).c_str(), GetFileExInfoStandard, &data)) {
+            return false;
+        }
+        attributes.fileSize = (static_cast<ULONGLONG>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        attributes.lastWriteTime = (static_cast<ULONGLONG>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                                   data.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+
+    std::vector<ProcessInfo> LiveBackend::EnumerateProcesses(const ProcessFilter* filter) {
+        return processEnumerator_.EnumerateProcesses(filter);
+    }
+
+    EnumerationStats LiveBackend::LastEnumerationStats() const {
+        return processEnumerator_.LastStats();
+    }
+
+    ProcessInfo LiveBackend::GetProcessInfo(DWORD pid) {
+        return processEnumerator_.GetProcessInfo(pid);
+    }
+
+    std::unique_ptr<ScanTarget> LiveBackend::OpenTarget(DWORD pid, bool readMemory, std::string& error) {
+        DWORD access = readMemory ? PROCESS_QUERY_INFORMATION | PROCESS_VM_READ : PROCESS_QUERY_INFORMATION;
+        Handle process(OpenProcess(access, FALSE, pid));
+        if (!process) {
+            DWORD lastError = GetLastError();
+            error = "Failed to open process: " + GetLastErrorString();
+            SetLastError(lastError);
+            return nullptr;
+        }
+        return std::unique_ptr<ScanTarget>(
+            new LiveTarget(std::move(process), pid, readMemory, moduleEnumerator_, threadEnumerator_));
+    }
+
+    std::unique_ptr<ScanBackend> CreateLiveBackend() {
+        return std::unique_ptr<ScanBackend>(new LiveBackend());
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include "module_enum.h"
+#include "thread_enum.h"
+#include "scan_context.h"
+#include "remote_memory.h"
+#include "page_analysis.h"
+#include "thread_sampler.h"
+#include "symbolizer.h"
+#include "module_allowlist.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    class ProcessFilter;
+
+    // Address-space access used by MemoryScanner: the VirtualQueryEx, ReadProcessMemory and
+    // QueryWorkingSetEx calls of a region walk
+    class MemorySource {
+    public:
+        virtual ~MemorySource() {}
+
+        // Region containing address; false past the end of the address space
+        virtual bool Query(uintptr_t address, MEMORY_BASIC_INFORMATION& mbi) = 0;
+
+        // Returns the number of bytes read before the first unreadable page; 0 without read access
+        virtual size_t Read(uintptr_t address, void* buffer, size_t size) = 0;
+
+        virtual PageAnalysisStats AnalyzePages(const std::vector<PageRange>& ranges, const ScanContext& context) = 0;
+    };
+
+    // Size and last write time (FILETIME ticks) of a file
+    struct ImageAttributes {
+        ULONGLONG fileSize;
+        ULONGLONG lastWriteTime;
+
+        ImageAttributes() : fileSize(0), lastWriteTime(0) {}
+    };
+
+    // Image files on the scanned host's disk, by path: the export tables thread starts are
+    // symbolized against, and the digests and attributes behind baseline keys and sha256 rules
+    class ImageSource {
+    public:
+        virtual ~ImageSource() {}
+
+        // Empty table when the image cannot be read
+        virtual std::shared_ptr<const ExportTable> GetExports(const std::string& path) = 0;
+
+        // False when the file cannot be read
+        virtual bool GetDigest(const std::string& path, ImageDigest& digest) = 0;
+
+        // False when the file does not exist
+        virtual bool GetAttributes(const std::string& path, ImageAttributes& attributes) = 0;
+    };
+
+    // One opened process: everything ScanProcess and TriageProcess collect from it
+    class ScanTarget {
+    public:
+        virtual ~ScanTarget() {}
+
+        virtual std::vector<ModuleInfo> EnumerateModules(const ScanContext& context) = 0;
+        virtual std::vector<ThreadInfo> EnumerateThreads(const ScanContext& context) = 0;
+        virtual MemorySource& Memory() = 0;
+        virtual RemoteReaderStats ReaderStats() const = 0;
+
+        // Where each thread is executing over a sampling window; stats stay unsampled when the target cannot be sampled
+        virtual std::vector<ThreadSamples> SampleThreads(const std::vector<ThreadInfo>& threads, const ThreadSampleOptions& options,
+                                                         const ScanContext& context, ThreadSamplingStats& stats) = 0;
+    };
+
+    // Where ProcessScanner gets its data: the live host, or a recorded snapshot of one
+    class ScanBackend {
+    public:
+        virtual ~ScanBackend() {}
+
+        virtual std::vector<ProcessInfo> EnumerateProcesses(const ProcessFilter* filter) = 0;
+        virtual EnumerationStats LastEnumerationStats() const = 0;
+
+        // pid 0 in the result when the process is unknown
+        virtual ProcessInfo GetProcessInfo(DWORD pid) = 0;
+
+        // Without readMemory the target only supports region queries (tier-1 triage). On failure
+        // the thread's last error is left at the cause, e.g. ERROR_ACCESS_DENIED.
+        virtual std::unique_ptr<ScanTarget> OpenTarget(DWORD pid, bool readMemory, std::string& error) = 0;
+
+        virtual ImageSource& Images() = 0;
+    };
+
+    // The running host: a LiveBackend on Windows. Elsewhere the backend finds no processes and
+    // opens none, so only recorded snapshots can be scanned there.
+    std::unique_ptr<ScanBackend> CreateLiveBackend();
+
+#ifdef _WIN32
+    // Win32 calls against a process handle; reads go through the reader when one is given
+    class LiveMemorySource : public MemorySource {
+    private:
+        HANDLE process_;
+        RemoteMemoryReader* reader_;
+
+    public:
+        LiveMemorySource(HANDLE process, RemoteMemoryReader* reader) : process_(process), reader_(reader) {}
+
+        bool Query(uintptr_t address, MEMORY_BASIC_INFORMATION& mbi) override;
+        size_t Read(uintptr_t address, void* buffer, size_t size) override;
+        PageAnalysisStats AnalyzePages(const std::vector<PageRange>& ranges, const ScanContext& context) override;
+    };
+
+    // The local disk, through the process-wide export-table and digest caches
+    class LiveImageSource : public ImageSource {
+    public:
+        std::shared_ptr<const ExportTable> GetExports(const std::string& path) override;
+        bool GetDigest(const std::string& path, ImageDigest& digest) override;
+        bool GetAttributes(const std::string& path, ImageAttributes& attributes) override;
+    };
+
+    // The running host. Owns the enumerators, so signature and export caches live as long as the backend.
+    class LiveBackend : public ScanBackend {
+    private:
+        ProcessEnumerator processEnumerator_;
+        ModuleEnumerator moduleEnumerator_;
+        ThreadEnumerator threadEnumerator_;
+        LiveImageSource images_;
+
+    public:
+        std::vector<ProcessInfo> EnumerateProcesses(const ProcessFilter* filter) override;
+        EnumerationStats LastEnumerationStats() const override;
+        ProcessInfo GetProcessInfo(DWORD pid) override;
+        std::unique_ptr<ScanTarget> OpenTarget(DWORD pid, bool readMemory, std::string& error) override;
+        ImageSource& Images() override { return images_; }
+    };
+#endif
+
+} // namespace ProcessScope
@@ -0,0 +1,36 @@
+#include "scan_backend.h"
+
+namespace ProcessScope {
+
+    // Images of a host that cannot be scanned live: nothing is looked up on the local disk
+    class UnavailableImageSource : public ImageSource {
+    public:
+        std::shared_ptr<const ExportTable> GetExports(const std::string&) override { return nullptr; }
+        bool GetDigest(const std::string&, ImageDigest&) override { return false; }
+        bool GetAttributes(const std::string&, ImageAttributes&) override { return false; }
+    };
+
+    // Live scanning reads other processes through Win32; elsewhere there is nothing to enumerate
+    class UnavailableBackend : public ScanBackend {
+    private:
+        UnavailableImageSource images_;
+
+    public:
+        std::vector<ProcessInfo> EnumerateProcesses(const ProcessFilter*) override { return std::vector<ProcessInfo>(); }
+        EnumerationStats LastEnumerationStats() const override { return EnumerationStats(); }
+        ProcessInfo GetProcessInfo(DWORD) override { return ProcessInfo(); }
+
+        std::unique_ptr<ScanTarget> OpenTarget(DWORD, bool, std::string& error) override {
+            error = "Live scanning is only supported on Windows; replay a recorded snapshot instead";
+            SetLastError(ERROR_NOT_SUPPORTED);
+            return nullptr;
+        }
+
+        ImageSource& Images() override { return images_; }
+    };
+
+    std::unique_ptr<ScanBackend> CreateLiveBackend() {
+        return std::unique_ptr<ScanBackend>(new UnavailableBackend());
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,29 @@
+#include "scan_context.h"
+
+namespace ProcessScope {
+
+    ScanContext::ScanContext(DWORD budgetMs, const CancellationToken* token)
+        : start_(Clock::now()), hasDeadline_(budgetMs != 0), token_(token), truncated_(false) {
+        deadline_ = start_ + std::chrono::milliseconds(budgetMs);
+    }
+
+    bool ScanContext::ShouldStop() const {
+        if (truncated_) {
+            return true;
+        }
+
+        bool stop = (token_ && token_->IsCancelled()) ||
+                    (hasDeadline_ && Clock::now() >= deadline_);
+        if (stop) {
+            // Remember which phase ran out of budget for the report
+            truncated_ = true;
+            truncatedPhase_ = phase_;
+        }
+        return stop;
+    }
+
+    double ScanContext::ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "util.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace ProcessScope {
+
+    // Cooperative cancellation flag shared between a sweep and its scans.
+    // A child token also reports cancellation when its parent is cancelled.
+    class CancellationToken {
+    private:
+        std::atomic<bool> cancelled_;
+        const CancellationToken* parent_;
+    public:
+        explicit CancellationToken(const CancellationToken* parent = nullptr) : cancelled_(false), parent_(parent) {}
+        CancellationToken(const CancellationToken&) = delete;
+        CancellationToken& operator=(const CancellationToken&) = delete;
+        void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+        void Reset() { cancelled_.store(false, std::memory_order_relaxed); }
+        bool IsCancelled() const {
+            return cancelled_.load(std::memory_order_relaxed) || (parent_ && parent_->IsCancelled());
+        }
+    };
+
+    // Wall-clock time spent in each phase of a process scan
+    struct ScanTimings {
+        double modulesMs;
+        double threadsMs;
+        double memoryMs;
+        double riskMs;
+        double totalMs;
+
+        ScanTimings() : modulesMs(0), threadsMs(0), memoryMs(0), riskMs(0), totalMs(0) {}
+    };
+
+    // Deadline and cancellation state threaded through a single process scan.
+    // Enumerators poll ShouldStop() once per item and return what they have
+    // collected so far when it fires, so one pathological process cannot stall a sweep.
+    class ScanContext {
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Clock::time_point start_;
+        Clock::time_point deadline_;
+        bool hasDeadline_;
+        const CancellationToken* token_;
+        mutable bool truncated_;
+        mutable std::string truncatedPhase_;
+        std::string phase_;
+
+    public:
+        // A budget of zero means no deadline; token may be null
+        explicit ScanContext(DWORD budgetMs = 0, const CancellationToken* token = nullptr);
+
+        bool ShouldStop() const;
+        bool IsTruncated() const { return truncated_; }
+        const std::string& TruncatedPhase() const { return truncatedPhase_; }
+        void SetPhase(const std::string& phase) { phase_ = phase; }
+        double ElapsedMs() const;
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,252 @@
+#include "scanner.h"
+#include "metrics.h"
+
+namespace ProcessScope {
+
+    ScanResult ProcessScanner::ScanProcess(DWORD pid, const ScanOptions& options) {
+        // Get process information
+        ProcessInfo processInfo = backend_->GetProcessInfo(pid);
+        if (processInfo.pid == 0) {
+            ScanResult result;
+            result.errorMessage = "Process not found or access denied";
+            return FinishScan(result);
+        }
+
+        return ScanProcess(processInfo, nullptr, options);
+    }
+
+    ScanResult ProcessScanner::ScanProcess(const ProcessInfo& processInfo, const LineageInfo* lineage, const ScanOptions& options) {
+        ScanResult result;
+        ScanContext context(options.timeoutMs, options.cancellation);
+        DWORD pid = processInfo.pid;
+        result.processInfo = processInfo;
+
+        std::string error;
+        std::unique_ptr<ScanTarget> target = backend_->OpenTarget(pid, true, error);
+        if (!target) {
+            result.accessDenied = GetLastError() == ERROR_ACCESS_DENIED;
+            result.errorMessage = error;
+            return FinishScan(result);
+        }
+
+        try {
+            double phaseStart = context.ElapsedMs();
+
+            // Enumerate modules
+            context.SetPhase("modules");
+            result.modules = target->EnumerateModules(context);
+            result.timings.modulesMs = context.ElapsedMs() - phaseStart;
+
+            // Enumerate threads
+            phaseStart = context.ElapsedMs();
+            context.SetPhase("threads");
+            result.threads = target->EnumerateThreads(context);
+
+            // Check for anomalous thread starts and symbolize them against cached export tables
+            Symbolizer symbolizer(result.modules, backend_->Images());
+            for (auto& thread : result.threads) {
+                if (thread.startAddress != 0) {
+                    SymbolInfo symbol = symbolizer.Resolve(thread.startAddress);
+                    thread.anomalousStart = !symbol.inModule;
+                    thread.startSymbol = symbol.ToString();
+                }
+            }
+
+            result.timings.threadsMs = context.ElapsedMs() - phaseStart;
+
+            // Scan memory regions
+            phaseStart = context.ElapsedMs();
+            context.SetPhase("memory");
+            ContentSampleOptions sampling = options.sampling;
+            sampling.seed ^= (static_cast<ULONGLONG>(pid) << 32) ^ processInfo.creationTime;
+            result.memoryRegions = memoryScanner_.ScanMemoryRegions(target->Memory(), context, &sampling);
+            result.memoryReads = target->ReaderStats();
+            result.pageQueries = memoryScanner_.LastPageStats();
+            result.contentSample = memoryScanner_.LastSample();
+            result.timings.memoryMs = context.ElapsedMs() - phaseStart;
+
+            // Extract strings from flagged regions
+            if (options.strings.maxStrings > 0) {
+                context.SetPhase("strings");
+                result.strings = ExtractStrings(target->Memory(), result.memoryRegions, options.strings, context);
+            }
+
+            // Sample where threads are executing now, which can differ from where they started
+            if (options.threadSampling.rounds > 0) {
+                context.SetPhase("sampling");
+                std::vector<ThreadSamples> samples = target->SampleThreads(result.threads, options.threadSampling,
+                                                                           context, result.threadSampling);
+                ClassifySamples(samples, symbolizer, result.memoryRegions, &target->Memory(), result.threads,
+                                result.threadSampling);
+            }
+
+            // Calculate risk score over whatever was collected, even if truncated
+            phaseStart = context.ElapsedMs();
+            ImageBaseline baseline;
+            if (options.baselines) {
+                baseline = options.baselines->Find(BaselineStore::ImageKey(result.processInfo, backend_->Images()));
+            }
+            result.riskAssessment = riskScorer_.CalculateRiskScore(
+                result.processInfo, result.modules, result.threads, result.memoryRegions, backend_->Images(),
+                lineage, options.fleet, options.baselines ? &baseline : nullptr, options.allowlist);
+            result.timings.riskMs = context.ElapsedMs() - phaseStart;
+
+            result.truncated = context.IsTruncated();
+            result.truncatedPhase = context.TruncatedPhase();
+            result.timings.totalMs = context.ElapsedMs();
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.errorMessage = "Exception during scan: " + std::string(e.what());
+        }
+
+        return FinishScan(std::move(result));
+    }
+
+    ScanResult ProcessScanner::FinishScan(ScanResult result) {
+        if (metrics_) {
+            metrics_->RecordScan(result);
+        }
+        return result;
+    }
+
+    RiskAssessment ProcessScanner::TriageProcess(const ProcessInfo& processInfo, const LineageInfo* lineage,
+                                                 const ScanOptions& options, TriageStats& stats) {
+        auto tierStart = std::chrono::steady_clock::now();
+        ScanContext context(options.timeoutMs, options.cancellation);
+        context.SetPhase("triage");
+
+        RegionSummary summary;
+        std::string error;
+        std::unique_ptr<ScanTarget> target = backend_->OpenTarget(processInfo.pid, false, error);
+        if (target) {
+            summary = memoryScanner_.SummarizeMemoryRegions(target->Memory(), context);
+        }
+
+        stats.tier1Processes++;
+        stats.tier1Regions += summary.totalRegions;
+        stats.tier1Ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tierStart).count();
+
+        return riskScorer_.CalculateTriageScore(processInfo, summary, lineage);
+    }
+
+    void ProcessScanner::RecordFingerprints(const ScanResult& result, FingerprintIndex& index) {
+        for (const auto& region : result.memoryRegions) {
+            if (region.fingerprint != 0) {
+                index.Add(result.processInfo.pid, result.processInfo.name, region.baseAddress, region.size,
+                          region.protection, region.isSuspicious, region.fingerprint);
+            }
+        }
+    }
+
+    void ProcessScanner::RecordDigests(const ScanResult& result, SimilarityIndex& index) {
+        for (const auto& region : result.memoryRegions) {
+            if (region.similarity.valid) {
+                SimilarityEntry entry;
+                entry.digest = region.similarity;
+                entry.pid = result.processInfo.pid;
+                entry.processName = result.processInfo.name;
+                entry.baseAddress = region.baseAddress;
+                entry.size = region.size;
+                index.Add(entry);
+            }
+        }
+    }
+
+    SweepSummary ProcessScanner::Sweep(const SweepOptions& options, const SweepCallbacks& callbacks) {
+        SweepSummary summary;
+        auto sweepStart = std::chrono::steady_clock::now();
+
+        std::vector<ProcessInfo> processes = backend_->EnumerateProcesses(options.filter);
+        summary.enumeration = backend_->LastEnumerationStats();
+
+        // Scan parents before children so ancestor risk is known when each child is scored
+        ProcessTree tree;
+        tree.Build(processes);
+        PriorityOptions priority = options.priority;
+        if (priority.referenceTime == 0 && backend_ == liveBackend_.get()) {
+            priority.referenceTime = GetCurrentFileTime();
+        }
+        SweepPartitioner partitioner;
+        partitioner.Build(processes, tree, PrioritizedOrder(processes, tree, priority), options.partition);
+        std::vector<int> ownScores(processes.size(), 0);
+        std::vector<LineageInfo> lineages(processes.size());
+        
+        ScanOptions scanOptions = options.scan;
+        if (options.fingerprints) {
+            scanOptions.fleet = options.fingerprints;
+        }
+
+        for (size_t index : partitioner.Order()) {
+            const ProcessInfo& process = processes[index];
+            if (options.scan.cancellation && options.scan.cancellation->IsCancelled()) {
+                summary.cancelled = true;
+                break;
+            }
+
+            // Lineage still passes through skipped processes; they contribute no score of their own
+            lineages[index] = tree.GetLineage(index, lineages, ownScores);
+            size_t partition = partitioner.PartitionOf(index);
+            if (partitioner.IsExhausted(partition)) {
+                partitioner.RecordSkip(index);
+                continue;
+            }
+
+            summary.totalCount++;
+            if (callbacks.onProcessStart) {
+                callbacks.onProcessStart(process);
+            }
+            auto processStart = std::chrono::steady_clock::now();
+
+            // Tier 1: region summary and lineage only; escalate when the score crosses the threshold
+            if (options.triageEnabled) {
+                RiskAssessment triage = TriageProcess(process, &lineages[index], options.scan, summary.triage);
+                if (triage.score < options.triageThreshold) {
+                    ownScores[index] = triage.score - triage.lineageScore;
+                    partitioner.Charge(partition, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - processStart).count());
+                    partitioner.RecordResult(index, triage, true);
+                    continue;
+                }
+                if (callbacks.onEscalate) {
+                    callbacks.onEscalate(process, triage);
+                }
+            }
+
+            auto tierStart = std::chrono::steady_clock::now();
+            ScanResult result = ScanProcess(process, &lineages[index], scanOptions);
+            ownScores[index] = result.riskAssessment.score - result.riskAssessment.lineageScore;
+            if (result.success) {
+                summary.successCount++;
+                if (options.fingerprints) {
+                    RecordFingerprints(result, *options.fingerprints);
+                }
+                if (options.similarity) {
+                    RecordDigests(result, *options.similarity);
+                }
+                if (result.truncated) {
+                    summary.truncatedCount++;
+                }
+            }
+
+            auto tierEnd = std::chrono::steady_clock::now();
+            summary.triage.tier2Processes++;
+            summary.triage.tier2Modules += result.modules.size();
+            summary.triage.tier2Regions += result.memoryRegions.size();
+            summary.triage.tier2Ms += std::chrono::duration<double, std::milli>(tierEnd - tierStart).count();
+            partitioner.Charge(partition, std::chrono::duration<double, std::milli>(tierEnd - processStart).count());
+            partitioner.RecordResult(index, result.riskAssessment, result.success);
+            if (result.success && result.riskAssessment.level == RiskLevel::High && summary.firstHighMs < 0) {
+                summary.firstHighMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sweepStart).count();
+                summary.firstHighPid = process.pid;
+            }
+
+            if (callbacks.onResult) {
+                callbacks.onResult(result);
+            }
+        }
+
+        summary.partitions = partitioner.Stats();
+        summary.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sweepStart).count();
+        return summary;
+    }
+
+} // namespace ProcessScope
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include "module_enum.h"
+#include "thread_enum.h"
+#include "memory_scan.h"
+#include "risk_score.h"
+#include "scan_context.h"
+#include "scan_backend.h"
+#include "symbolizer.h"
+#include "process_tree.h"
+#include "process_filter.h"
+#include "fingerprint.h"
+#include "similarity.h"
+#include "baseline_store.h"
+#include "module_allowlist.h"
+#include "string_extract.h"
+#include "sweep_partition.h"
+#include "sweep_priority.h"
+#include <functional>
+#include <string>
+
+namespace ProcessScope {
+
+    class MetricsShard;
+
+    struct ScanResult {
+        ProcessInfo processInfo;
+        std::vector<ModuleInfo> modules;
+        std::vector<ThreadInfo> threads;
+        std::vector<MemoryRegion> memoryRegions;
+        RiskAssessment riskAssessment;
+        ScanTimings timings;
+        RemoteReaderStats memoryReads;
+        PageAnalysisStats pageQueries;
+        ContentSample contentSample;
+        StringExtraction strings;
+        ThreadSamplingStats threadSampling;
+        std::string truncatedPhase;
+        std::string errorMessage;
+        bool success;
+        bool truncated;
+        bool accessDenied;      // The failure was the target refusing access
+
+        ScanResult() : success(false), truncated(false), accessDenied(false) {}
+    };
+
+    // Per-process scan settings
+    struct ScanOptions {
+        DWORD timeoutMs;                        // 0 = unlimited
+        const CancellationToken* cancellation;  // May be null
+        const FingerprintIndex* fleet;          // Run-wide region clusters for down-weighting; may be null
+        ContentSampleOptions sampling;          // Page content sampling; off unless given a byte budget
+        const BaselineStore* baselines;         // Learned per-image profiles scored against; may be null
+        StringExtractOptions strings;           // Strings from flagged regions; off unless given a count
+        ThreadSampleOptions threadSampling;     // Instruction pointer sampling; off unless given a round count
+        const ModuleAllowlist* allowlist;       // Trusted modules; null for the built-in trusted locations
+
+        ScanOptions() : timeoutMs(0), cancellation(nullptr), fleet(nullptr), baselines(nullptr), allowlist(nullptr) {}
+    };
+
+    // Settings for a whole sweep
+    struct SweepOptions {
+        ScanOptions scan;
+        const ProcessFilter* filter;            // May be null
+        FingerprintIndex* fingerprints;         // Receives every scanned region fingerprint; may be null
+        SimilarityIndex* similarity;            // Receives every region similarity digest; may be null
+        bool triageEnabled;
+        int triageThreshold;
+        PartitionOptions partition;             // Per-session ordering, budgets and concurrency
+        PriorityOptions priority;               // Likely findings first instead of plain pre-order
+
+        SweepOptions() : filter(nullptr), fingerprints(nullptr), similarity(nullptr), triageEnabled(false), triageThreshold(0) {}
+    };
+
+    // Work done by each tier of a triaged sweep, for tuning the escalation threshold
+    struct TriageStats {
+        size_t tier1Processes;
+        size_t tier1Regions;
+        double tier1Ms;
+        size_t tier2Processes;
+        size_t tier2Modules;
+        size_t tier2Regions;
+        double tier2Ms;
+
+        TriageStats() : tier1Processes(0), tier1Regions(0), tier1Ms(0),
+                        tier2Processes(0), tier2Modules(0), tier2Regions(0), tier2Ms(0) {}
+    };
+
+    // Totals for a finished sweep
+    struct SweepSummary {
+        size_t totalCount;
+        size_t successCount;
+        size_t truncatedCount;
+        bool cancelled;
+        double elapsedMs;
+        EnumerationStats enumeration;
+        TriageStats triage;
+        std::vector<PartitionStats> partitions; // One per session, whether or not partitioning was asked for
+        double firstHighMs;                     // Sweep start to the first High result reported; < 0 if none
+        DWORD firstHighPid;
+
+        SweepSummary() : totalCount(0), successCount(0), truncatedCount(0), cancelled(false), elapsedMs(0),
+                         firstHighMs(-1), firstHighPid(0) {}
+    };
+
+    // Sweep progress notifications; any callback may be left empty
+    struct SweepCallbacks {
+        std::function<void(const ProcessInfo&)> onProcessStart;
+        std::function<void(const ProcessInfo&, const RiskAssessment&)> onEscalate;
+        std::function<void(const ScanResult&)> onResult;
+    };
+
+    // Scanning core: runs single scans, triage and sweeps against a backend, the live host by default.
+    // Not thread-safe; use one instance per worker thread. Export and signature caches are shared.
+    class ProcessScanner {
+    private:
+        std::unique_ptr<ScanBackend> liveBackend_;
+        ScanBackend* backend_;
+        MemoryScanner memoryScanner_;
+        RiskScorer riskScorer_;
+        MetricsShard* metrics_;
+
+        ScanResult FinishScan(ScanResult result);
+
+    public:
+        ProcessScanner() : liveBackend_(CreateLiveBackend()), backend_(liveBackend_.get()), metrics_(nullptr) {}
+        ProcessScanner(const ProcessScanner&) = delete;
+        ProcessScanner& operator=(const ProcessScanner&) = delete;
+
+        // Replay or recording backend; null restores the live host. The backend must outlive its use.
+        void SetBackend(ScanBackend* backend) { backend_ = backend ? backend : liveBackend_.get(); }
+        ScanBackend& Backend() { return *backend_; }
+
+        // Every ScanProcess is recorded into the shard, which must belong to this scanner alone; null disables
+        void SetMetrics(MetricsShard* shard) { metrics_ = shard; }
+
+        ScanResult ScanProcess(DWORD pid, const ScanOptions& options);
+        ScanResult ScanProcess(const ProcessInfo& processInfo, const LineageInfo* lineage, const ScanOptions& options);
+        RiskAssessment TriageProcess(const ProcessInfo& processInfo, const LineageInfo* lineage,
+                                     const ScanOptions& options, TriageStats& stats);
+
+        // Add the fingerprints and similarity digests of a successful scan to run-wide indexes
+        static void RecordFingerprints(const ScanResult& result, FingerprintIndex& index);
+        static void RecordDigests(const ScanResult& result, SimilarityIndex& index);
+
+        // Enumerate, build the process tree and scan parent-first, reporting each result as it completes.
+        // With priority enabled, likely findings go first among the processes whose parents are done.
+        // Processes of a session whose partition budget is spent are counted as skipped and not reported.
+        SweepSummary Sweep(const SweepOptions& options, const SweepCallbacks& callbacks);
+    };
+
+} // namespace ProcessScope
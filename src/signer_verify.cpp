@@ -2,13 +2,56 @@
 #include <wintrust.h>
 #include <softpub.h>
 #include <wincrypt.h>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 #pragma comment(lib, "wintrust.lib")
 #pragma comment(lib, "crypt32.lib")
 
 namespace ProcessScope {
 
+    struct SignatureCacheEntry {
+        ULONGLONG lastWriteTime;
+        ULONGLONG fileSize;
+        SignatureInfo info;
+    };
+
+    static std::shared_mutex g_signatureCacheMutex;
+    static std::unordered_map<std::string, SignatureCacheEntry> g_signatureCache;
+
     SignatureInfo SignatureVerifier::VerifySignature(const std::string& filePath) {
+        if (filePath.empty()) {
+            return VerifySignatureUncached(filePath);
+        }
+
+        // A cheap attribute query tells us whether a cached verdict is still for the same file
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        std::wstring widePath = StringToWString(filePath);
+        if (!GetFileAttributesExW(widePath.c_str(), GetFileExInfoStandard, &attributes)) {
+            return VerifySignatureUncached(filePath);
+        }
+        ULONGLONG lastWriteTime = (static_cast<ULONGLONG>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                                  attributes.ftLastWriteTime.dwLowDateTime;
+        ULONGLONG fileSize = (static_cast<ULONGLONG>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(g_signatureCacheMutex);
+            auto it = g_signatureCache.find(filePath);
+            if (it != g_signatureCache.end() &&
+                it->second.lastWriteTime == lastWriteTime && it->second.fileSize == fileSize) {
+                return it->second.info;
+            }
+        }
+
+        SignatureInfo info = VerifySignatureUncached(filePath);
+
+        std::unique_lock<std::shared_mutex> lock(g_signatureCacheMutex);
+        g_signatureCache[filePath] = { lastWriteTime, fileSize, info };
+        return info;
+    }
+
+    SignatureInfo SignatureVerifier::VerifySignatureUncached(const std::string& filePath) {
         SignatureInfo info;
         
         if (filePath.empty()) {
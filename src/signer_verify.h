@@ -12,8 +12,13 @@ struct SignatureInfo {
     SignatureInfo() : isSigned(false) {}
 };
 
-// Digital signature verification using Windows API
+// Digital signature verification using Windows API. Results are cached process-wide by path
+// and revalidated against the file's size and last-write time, so long-lived processes
+// (the daemon, large sweeps) only call WinVerifyTrust once per image.
 class SignatureVerifier {
     public:
         SignatureInfo VerifySignature(const std::string& filePath);
+        
+    private:
+        SignatureInfo VerifySignatureUncached(const std::string& filePath);
 };
@@ -0,0 +1,330 @@
+#include "similarity.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+namespace ProcessScope {
+
+    // Salts for the six triplets taken from each 5-byte window
+    static const BYTE kTripletSalts[6] = { 2, 3, 5, 7, 11, 13 };
+
+    // Body distance of a bucket whose codes are at opposite ends of the quartile range
+    static const int kMaxCodeDistance = 6;
+
+    // Header fields that differ by more than one step are weighted like this many body codes
+    static const int kHeaderStepWeight = 12;
+
+    // Pearson permutation, generated once from a fixed seed so digests are stable across builds
+    static const BYTE* PearsonTable() {
+        struct Table {
+            BYTE values[256];
+            Table() {
+                for (int i = 0; i < 256; i++) {
+                    values[i] = static_cast<BYTE>(i);
+                }
+                DWORD state = 0x9E3779B9;
+                for (int i = 255; i > 0; i--) {
+                    state = state * 1664525 + 1013904223;
+                    int j = static_cast<int>((state >> 8) % static_cast<DWORD>(i + 1));
+                    std::swap(values[i], values[j]);
+                }
+            }
+        };
+        static const Table table;
+        return table.values;
+    }
+
+    // Distance between two body bytes (four codes each), precomputed for the query loop
+    static const BYTE* ByteDistanceTable() {
+        struct Table {
+            BYTE values[256 * 256];
+            Table() {
+                for (int a = 0; a < 256; a++) {
+                    for (int b = 0; b < 256; b++) {
+                        int distance = 0;
+                        for (int shift = 0; shift < 8; shift += 2) {
+                            int delta = std::abs(((a >> shift) & 3) - ((b >> shift) & 3));
+                            distance += delta == 3 ? kMaxCodeDistance : delta;
+                        }
+                        values[a * 256 + b] = static_cast<BYTE>(distance);
+                    }
+                }
+            }
+        };
+        static const Table table;
+        return table.values;
+    }
+
+    static inline BYTE PearsonHash(const BYTE* table, BYTE salt, BYTE a, BYTE b, BYTE c) {
+        BYTE hash = table[salt];
+        hash = table[hash ^ a];
+        hash = table[hash ^ b];
+        return table[hash ^ c];
+    }
+
+    // Circular distance for header fields that wrap
+    static int WrappedDistance(int a, int b, int range) {
+        int delta = std::abs(a - b);
+        return (std::min)(delta, range - delta);
+    }
+
+    static int HeaderDistance(int delta) {
+        return delta <= 1 ? delta : (delta - 1) * kHeaderStepWeight;
+    }
+
+    static BYTE LengthCode(size_t size) {
+        double code = std::floor(std::log(static_cast<double>(size)) / std::log(1.5));
+        return static_cast<BYTE>((std::min)(code, 255.0));
+    }
+
+    SimilarityDigest::SimilarityDigest() : checksum(0), lengthCode(0), quartileRatios(0), valid(false) {
+        memset(body, 0, sizeof(body));
+    }
+
+    std::string SimilarityDigest::ToString() const {
+        static const char kDigits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve((3 + kBodyBytes) * 2);
+        BYTE header[3] = { checksum, lengthCode, quartileRatios };
+        for (BYTE value : header) {
+            hex.push_back(kDigits[value >> 4]);
+            hex.push_back(kDigits[value & 0x0F]);
+        }
+        for (BYTE value : body) {
+            hex.push_back(kDigits[value >> 4]);
+            hex.push_back(kDigits[value & 0x0F]);
+        }
+        return hex;
+    }
+
+    bool SimilarityDigest::FromString(const std::string& text, SimilarityDigest& digest) {
+        if (text.size() != (3 + kBodyBytes) * 2) {
+            return false;
+        }
+        BYTE bytes[3 + kBodyBytes];
+        for (size_t i = 0; i < sizeof(bytes); i++) {
+            int value = 0;
+            for (size_t j = 0; j < 2; j++) {
+                char c = text[i * 2 + j];
+                int nibble;
+                if (c >= '0' && c <= '9') {
+                    nibble = c - '0';
+                } else if (c >= 'a' && c <= 'f') {
+                    nibble = c - 'a' + 10;
+                } else if (c >= 'A' && c <= 'F') {
+                    nibble = c - 'A' + 10;
+                } else {
+                    return false;
+                }
+                value = value * 16 + nibble;
+            }
+            bytes[i] = static_cast<BYTE>(value);
+        }
+        digest.checksum = bytes[0];
+        digest.lengthCode = bytes[1];
+        digest.quartileRatios = bytes[2];
+        memcpy(digest.body, bytes + 3, kBodyBytes);
+        digest.valid = true;
+        return true;
+    }
+
+    SimilarityDigest ComputeSimilarityDigest(const BYTE* data, size_t size) {
+        SimilarityDigest digest;
+        if (size < kMinDigestInput) {
+            return digest;
+        }
+
+        // Each 5-byte window contributes six triplets that all include its newest byte.
+        // Pearson output is 0-255; only the lower half is kept, as in TLSH.
+        const BYTE* table = PearsonTable();
+        DWORD counts[256] = {};
+        BYTE checksum = 0;
+        for (size_t i = 4; i < size; i++) {
+            BYTE b0 = data[i];
+            BYTE b1 = data[i - 1];
+            BYTE b2 = data[i - 2];
+            BYTE b3 = data[i - 3];
+            BYTE b4 = data[i - 4];
+            checksum = PearsonHash(table, 0, b0, b1, checksum);
+            counts[PearsonHash(table, kTripletSalts[0], b0, b1, b2)]++;
+            counts[PearsonHash(table, kTripletSalts[1], b0, b1, b3)]++;
+            counts[PearsonHash(table, kTripletSalts[2], b0, b2, b3)]++;
+            counts[PearsonHash(table, kTripletSalts[3], b0, b2, b4)]++;
+            counts[PearsonHash(table, kTripletSalts[4], b0, b1, b4)]++;
+            counts[PearsonHash(table, kTripletSalts[5], b0, b3, b4)]++;
+        }
+
+        const size_t buckets = SimilarityDigest::kBuckets;
+        std::vector<DWORD> sorted(counts, counts + buckets);
+        std::nth_element(sorted.begin(), sorted.begin() + buckets / 4 - 1, sorted.end());
+        DWORD q1 = sorted[buckets / 4 - 1];
+        std::nth_element(sorted.begin(), sorted.begin() + buckets / 2 - 1, sorted.end());
+        DWORD q2 = sorted[buckets / 2 - 1];
+        std::nth_element(sorted.begin(), sorted.begin() + 3 * buckets / 4 - 1, sorted.end());
+        DWORD q3 = sorted[3 * buckets / 4 - 1];
+
+        // Too uniform (e.g. mostly zero fill) to say anything about similarity
+        size_t nonEmpty = std::count_if(counts, counts + buckets, [](DWORD count) { return count != 0; });
+        if (q3 == 0 || nonEmpty <= buckets / 2) {
+            return digest;
+        }
+
+        for (size_t bucket = 0; bucket < buckets; bucket++) {
+            DWORD count = counts[bucket];
+            BYTE code = count <= q1 ? 0 : count <= q2 ? 1 : count <= q3 ? 2 : 3;
+            digest.body[bucket / 4] |= static_cast<BYTE>(code << ((bucket % 4) * 2));
+        }
+        digest.checksum = checksum;
+        digest.lengthCode = LengthCode(size);
+        BYTE q1Ratio = static_cast<BYTE>((static_cast<ULONGLONG>(q1) * 100 / q3) % 16);
+        BYTE q2Ratio = static_cast<BYTE>((static_cast<ULONGLONG>(q2) * 100 / q3) % 16);
+        digest.quartileRatios = static_cast<BYTE>((q1Ratio << 4) | q2Ratio);
+        digest.valid = true;
+        return digest;
+    }
+
+    int DigestDistance(const SimilarityDigest& a, const SimilarityDigest& b) {
+        int distance = a.checksum != b.checksum ? 1 : 0;
+        distance += HeaderDistance(WrappedDistance(a.lengthCode, b.lengthCode, 256));
+        distance += HeaderDistance(WrappedDistance(a.quartileRatios >> 4, b.quartileRatios >> 4, 16));
+        distance += HeaderDistance(WrappedDistance(a.quartileRatios & 0x0F, b.quartileRatios & 0x0F, 16));
+
+        const BYTE* table = ByteDistanceTable();
+        for (size_t i = 0; i < SimilarityDigest::kBodyBytes; i++) {
+            distance += table[a.body[i] * 256 + b.body[i]];
+        }
+        return distance;
+    }
+
+    DWORD SimilarityIndex::BandKey(const SimilarityDigest& digest, size_t band) {
+        const BYTE* bytes = digest.body + band * kBandBytes;
+        return static_cast<DWORD>(band << 16) | (static_cast<DWORD>(bytes[0]) << 8) | bytes[1];
+    }
+
+    void SimilarityIndex::Add(const SimilarityEntry& entry) {
+        if (!entry.digest.valid) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        DWORD index = static_cast<DWORD>(entries_.size());
+        entries_.push_back(entry);
+        for (size_t band = 0; band < kBands; band++) {
+            bands_[BandKey(entry.digest, band)].push_back(index);
+        }
+    }
+
+    std::vector<SimilarityMatch> SimilarityIndex::Query(const SimilarityDigest& digest, int maxDistance) const {
+        std::vector<SimilarityMatch> matches;
+        if (!digest.valid) {
+            return matches;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto consider = [&](DWORD index) {
+            int distance = DigestDistance(digest, entries_[index].digest);
+            if (distance <= maxDistance) {
+                SimilarityMatch match;
+                match.entry = index;
+                match.distance = distance;
+                matches.push_back(match);
+            }
+        };
+
+        // Every differing body code adds at least 1 to the distance, so an entry within maxDistance
+        // differs in at most maxDistance codes. Below kBands one band is left equal; up to
+        // kMaxBandedDistance one band differs in at most one code, so probing each band's values
+        // one code away as well finds it. Beyond that, only comparing every entry is exact.
+        if (maxDistance > kMaxBandedDistance) {
+            for (DWORD index = 0; index < entries_.size(); index++) {
+                consider(index);
+            }
+        } else {
+            std::unordered_set<DWORD> candidates;
+            auto probe = [&](DWORD key) {
+                auto it = bands_.find(key);
+                if (it == bands_.end()) {
+                    return;
+                }
+                for (DWORD index : it->second) {
+                    if (candidates.insert(index).second) {
+                        consider(index);
+                    }
+                }
+            };
+
+            const DWORD codesPerBand = static_cast<DWORD>(kBandBytes * 4);
+            for (size_t band = 0; band < kBands; band++) {
+                DWORD key = BandKey(digest, band);
+                probe(key);
+                if (maxDistance < static_cast<int>(kBands)) {
+                    continue;
+                }
+                for (DWORD code = 0; code < codesPerBand; code++) {
+                    DWORD shift = code * 2;
+                    for (DWORD value = 0; value < 4; value++) {
+                        if (value != ((key >> shift) & 3)) {
+                            probe((key & ~(3u << shift)) | (value << shift));
+                        }
+                    }
+                }
+            }
+        }
+
+        std::sort(matches.begin(), matches.end(), [](const SimilarityMatch& a, const SimilarityMatch& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.entry < b.entry;
+        });
+        return matches;
+    }
+
+    SimilarityEntry SimilarityIndex::Entry(size_t index) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_[index];
+    }
+
+    size_t SimilarityIndex::Size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    bool LoadSimilarityCorpus(const std::string& path, std::vector<SimilarityEntry>& entries, std::string& error) {
+        std::ifstream file(path);
+        if (!file) {
+            error = "Failed to open " + path;
+            return false;
+        }
+
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            size_t end = line.find_first_of(" \t\r", start);
+            std::string text = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+            SimilarityEntry entry;
+            if (!SimilarityDigest::FromString(text, entry.digest)) {
+                error = path + ":" + std::to_string(lineNumber) + ": invalid digest";
+                return false;
+            }
+            if (end != std::string::npos) {
+                size_t labelStart = line.find_first_not_of(" \t", end);
+                size_t labelEnd = line.find_last_not_of(" \t\r");
+                if (labelStart != std::string::npos && labelEnd >= labelStart) {
+                    entry.label = line.substr(labelStart, labelEnd - labelStart + 1);
+                }
+            }
+            if (entry.label.empty()) {
+                entry.label = text;
+            }
+            entries.push_back(entry);
+        }
+        return true;
+    }
+
+} // namespace ProcessScope
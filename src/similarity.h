@@ -0,0 +1,97 @@
+#pragma once
+
+#include "util.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Shortest input that yields a digest; shorter inputs have too few triplets for stable quartiles
+    const size_t kMinDigestInput = 50;
+
+    // Distance at or below which two digests are reported as near-duplicates; within the range
+    // SimilarityIndex answers from its bands (kMaxBandedDistance)
+    const int kDefaultSimilarityThreshold = 30;
+
+    // TLSH-style locality-sensitive digest: 128 buckets of sliding-window triplet counts, each
+    // reduced to a 2-bit quartile code. Inputs that differ in a few bytes (relocations, patched
+    // config blobs) change only a few codes, so the distance between their digests stays small.
+    struct SimilarityDigest {
+        static const size_t kBuckets = 128;
+        static const size_t kBodyBytes = kBuckets / 4;
+
+        BYTE checksum;
+        BYTE lengthCode;        // Logarithmic input length
+        BYTE quartileRatios;    // q1/q3 and q2/q3 ratios, one nibble each
+        BYTE body[kBodyBytes];
+        bool valid;
+
+        SimilarityDigest();
+
+        std::string ToString() const;
+        static bool FromString(const std::string& text, SimilarityDigest& digest);
+    };
+
+    // Returns an invalid digest when the input is too short or too uniform
+    SimilarityDigest ComputeSimilarityDigest(const BYTE* data, size_t size);
+
+    // 0 for identical digests; grows with the number and size of differing codes
+    int DigestDistance(const SimilarityDigest& a, const SimilarityDigest& b);
+
+    // Where a digest came from: a scanned region, or a labelled corpus line
+    struct SimilarityEntry {
+        SimilarityDigest digest;
+        DWORD pid;
+        std::string processName;
+        uintptr_t baseAddress;
+        size_t size;
+        std::string label;
+
+        SimilarityEntry() : pid(0), baseAddress(0), size(0) {}
+    };
+
+    struct SimilarityMatch {
+        size_t entry;   // Index for SimilarityIndex::Entry()
+        int distance;
+    };
+
+    // Banded LSH index over digest bodies. The body is split into bands of two bytes (eight
+    // bucket codes); a query looks up its own band values and, for thresholds of kBands or more,
+    // every value one code away from them. Only the entries found there get an exact distance, so
+    // lookup cost follows the number of near neighbours rather than the index size. Every match up
+    // to kMaxBandedDistance is found that way; larger thresholds scan all entries.
+    // Thread-safe, like FingerprintIndex.
+    class SimilarityIndex {
+    private:
+        static const size_t kBandBytes = 2;
+        static const size_t kBands = SimilarityDigest::kBodyBytes / kBandBytes;
+
+    public:
+        // Pigeonhole bound: a match this close differs in fewer than two codes in at least one band
+        static const int kMaxBandedDistance = 2 * static_cast<int>(kBands) - 1;
+
+    private:
+
+        mutable std::mutex mutex_;
+        std::vector<SimilarityEntry> entries_;
+        std::unordered_map<DWORD, std::vector<DWORD>> bands_;   // (band << 16 | value) -> entry indices
+
+        static DWORD BandKey(const SimilarityDigest& digest, size_t band);
+
+    public:
+        // Ignores invalid digests
+        void Add(const SimilarityEntry& entry);
+
+        // Entries within maxDistance of the digest, nearest first
+        std::vector<SimilarityMatch> Query(const SimilarityDigest& digest, int maxDistance) const;
+
+        SimilarityEntry Entry(size_t index) const;
+        size_t Size() const;
+    };
+
+    // Reads "<digest> [label]" lines; blank lines and lines starting with '#' are skipped
+    bool LoadSimilarityCorpus(const std::string& path, std::vector<SimilarityEntry>& entries, std::string& error);
+
+} // namespace ProcessScope
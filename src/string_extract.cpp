@@ -0,0 +1,287 @@
+#include "string_extract.h"
+#include "scan_backend.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <emmintrin.h>
+#include <unordered_map>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ProcessScope {
+
+    static const size_t kChunkBytes = 1 << 20;
+
+    // Two bytes before each chunk tell whether a run at its start continues one from the previous chunk
+    static const size_t kLookbehindBytes = 2;
+
+    // Bytes read past each chunk so runs starting near its end are seen whole
+    static const size_t kLookaheadBytes = kMaxStringLength * 2;
+
+    // Distinct strings kept per process; later ones are still counted
+    static const size_t kMaxUniqueStrings = 1 << 16;
+
+    // Substrings that make a string worth an analyst's attention first, lowercase
+    static const char* const kIndicatorTokens[] = {
+        "http://", "https://", "ftp://", "\\\\.\\pipe\\", "\\pipe\\", "hkey_", "software\\microsoft\\windows\\currentversion\\run",
+        "cmd.exe", "cmd /c", "powershell", "-enc", "rundll32", "regsvr32", "mshta", "wscript", "certutil",
+        "user-agent", "mozilla/", ".exe", ".dll", ".ps1", ".bat", "\\temp\\", "\\appdata\\", "\\users\\public\\"
+    };
+
+    static unsigned CountTrailingZeros(ULONGLONG value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    // One bit per byte, 64 bytes per mask: printable ASCII or tab, and zero. Bits past size are clear.
+    static void ClassifyBytes(const BYTE* data, size_t size, std::vector<ULONGLONG>& printable, std::vector<ULONGLONG>& zero) {
+        size_t blocks = (size + 63) / 64;
+        printable.assign(blocks + 1, 0);
+        zero.assign(blocks + 1, 0);
+
+        const __m128i belowSpace = _mm_set1_epi8(0x1F);
+        const __m128i deleteChar = _mm_set1_epi8(0x7F);
+        const __m128i tab = _mm_set1_epi8(0x09);
+        const __m128i nul = _mm_setzero_si128();
+
+        // Four 16-byte compares per 64-byte block, combined into one store per mask
+        size_t whole = size / 64;
+        for (size_t k = 0; k < whole; k++) {
+            ULONGLONG textBits = 0;
+            ULONGLONG zeroBits = 0;
+            for (int part = 0; part < 4; part++) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + k * 64 + part * 16));
+                // Signed compares: 0x80-0xFF are negative, so they fail the lower bound
+                __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(bytes, belowSpace), _mm_cmplt_epi8(bytes, deleteChar));
+                __m128i text = _mm_or_si128(inRange, _mm_cmpeq_epi8(bytes, tab));
+                textBits |= static_cast<ULONGLONG>(static_cast<unsigned>(_mm_movemask_epi8(text))) << (part * 16);
+                zeroBits |= static_cast<ULONGLONG>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, nul)))) << (part * 16);
+            }
+            printable[k] = textBits;
+            zero[k] = zeroBits;
+        }
+        for (size_t i = whole * 64; i < size; i++) {
+            BYTE b = data[i];
+            if ((b >= 0x20 && b < 0x7F) || b == 0x09) {
+                printable[i / 64] |= 1ULL << (i % 64);
+            } else if (b == 0) {
+                zero[i / 64] |= 1ULL << (i % 64);
+            }
+        }
+    }
+
+    // Reports every run of set bits at least minBits long as (first bit, length); bits past the
+    // masks are clear. Run starts are found in the mask eroded by minBits - 1 (bit i set when bits
+    // i to i + minBits - 1 all are), so the many short runs in binary data are never visited.
+    template <typename Emit>
+    static void CollectRuns(const std::vector<ULONGLONG>& masks, size_t blocks, size_t minBits,
+                            std::vector<ULONGLONG>& eroded, Emit emit) {
+        eroded.assign(masks.begin(), masks.begin() + blocks);
+        eroded.push_back(0);
+        for (size_t span = 1; span < minBits;) {
+            size_t shift = (std::min)((std::min)(span, minBits - span), static_cast<size_t>(63));
+            for (size_t k = 0; k < blocks; k++) {
+                eroded[k] &= (eroded[k] >> shift) | (eroded[k + 1] << (64 - shift));
+            }
+            span += shift;
+        }
+
+        size_t total = blocks * 64;
+        size_t position = 0;
+        while (position < total) {
+            size_t k = position / 64;
+            ULONGLONG word = eroded[k] & (~0ULL << (position % 64));
+            while (word == 0 && ++k < blocks) {
+                word = eroded[k];
+            }
+            if (word == 0) {
+                break;
+            }
+            size_t start = k * 64 + CountTrailingZeros(word);
+
+            k = start / 64;
+            word = ~masks[k] & (~0ULL << (start % 64));
+            while (word == 0 && ++k < blocks) {
+                word = ~masks[k];
+            }
+            size_t end = word == 0 ? total : k * 64 + CountTrailingZeros(word);
+            emit(start, end - start);
+            position = end;
+        }
+    }
+
+    class StringCollector {
+    private:
+        std::unordered_map<std::string, size_t> index_;
+        StringExtraction& extraction_;
+
+    public:
+        explicit StringCollector(StringExtraction& extraction) : extraction_(extraction) {}
+
+        void Add(std::string text, uintptr_t address, bool wide) {
+            extraction_.totalStrings++;
+            auto found = index_.find(text);
+            if (found != index_.end()) {
+                extraction_.strings[found->second].occurrences++;
+                return;
+            }
+            if (index_.size() >= kMaxUniqueStrings) {
+                return;
+            }
+            ExtractedString extracted;
+            extracted.address = address;
+            extracted.wide = wide;
+            extracted.occurrences = 1;
+            extracted.text = text;
+            index_.emplace(std::move(text), extraction_.strings.size());
+            extraction_.strings.push_back(std::move(extracted));
+        }
+    };
+
+    // Finds the strings that start in [first, first + count) of a window read at windowBase
+    static void ScanWindow(const BYTE* data, size_t size, size_t first, size_t count, uintptr_t windowBase,
+                           size_t minLength, std::vector<ULONGLONG>& printable, std::vector<ULONGLONG>& zero,
+                           std::vector<ULONGLONG>& wide, std::vector<ULONGLONG>& eroded, StringCollector& collector) {
+        ClassifyBytes(data, size, printable, zero);
+
+        auto owned = [&](size_t start) { return start >= first && start < first + count; };
+        size_t blocks = (size + 63) / 64;
+
+        CollectRuns(printable, blocks, minLength, eroded, [&](size_t start, size_t length) {
+            if (owned(start)) {
+                length = (std::min)(length, kMaxStringLength);
+                collector.Add(std::string(reinterpret_cast<const char*>(data + start), length), windowBase + start, false);
+            }
+        });
+
+        // A UTF-16LE character is a printable byte followed by a zero byte. Runs of them are found
+        // separately for characters at even and odd offsets, each widened to cover both bytes.
+        wide.assign(blocks, 0);
+        for (int phase = 0; phase < 2; phase++) {
+            const ULONGLONG phaseBits = phase == 0 ? 0x5555555555555555ULL : 0xAAAAAAAAAAAAAAAAULL;
+            ULONGLONG carry = 0;
+            bool any = false;
+            for (size_t k = 0; k < blocks; k++) {
+                ULONGLONG characters = printable[k] & ((zero[k] >> 1) | (zero[k + 1] << 63)) & phaseBits;
+                wide[k] = characters | (characters << 1) | carry;
+                carry = characters >> 63;
+                any = any || characters != 0;
+            }
+            if (!any) {
+                continue;
+            }
+            CollectRuns(wide, blocks, minLength * 2, eroded, [&](size_t start, size_t length) {
+                if (owned(start)) {
+                    size_t characters = (std::min)(length / 2, kMaxStringLength);
+                    std::string text(characters, '\0');
+                    for (size_t i = 0; i < characters; i++) {
+                        text[i] = static_cast<char>(data[start + i * 2]);
+                    }
+                    collector.Add(std::move(text), windowBase + start, true);
+                }
+            });
+        }
+    }
+
+    static size_t IndicatorCount(const std::string& text) {
+        std::string lower = ToLower(text);
+        size_t count = 0;
+        for (const char* token : kIndicatorTokens) {
+            if (lower.find(token) != std::string::npos) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    StringExtraction ExtractStrings(MemorySource& source, const std::vector<MemoryRegion>& regions,
+                                    const StringExtractOptions& options, const ScanContext& context) {
+        auto start = std::chrono::steady_clock::now();
+        const size_t pageSize = GetSystemPageSize();
+        const size_t minLength = (std::max)(options.minLength, static_cast<size_t>(1));
+        StringExtraction extraction;
+        extraction.extracted = true;
+        StringCollector collector(extraction);
+
+        std::vector<BYTE> buffer(kLookbehindBytes + kChunkBytes + kLookaheadBytes);
+        std::vector<ULONGLONG> printable;
+        std::vector<ULONGLONG> zero;
+        std::vector<ULONGLONG> wide;
+        std::vector<ULONGLONG> eroded;
+
+        for (const auto& region : regions) {
+            bool flagged = region.isSuspicious || region.hasPeHeader || (region.isExecutable && region.type == "PRIVATE");
+            if (!flagged) {
+                continue;
+            }
+            extraction.regions++;
+
+            size_t offset = 0;
+            bool previousReadable = false;
+            while (offset < region.size) {
+                if (context.ShouldStop() || extraction.bytesScanned >= options.byteBudget) {
+                    extraction.complete = false;
+                    break;
+                }
+
+                size_t behind = previousReadable ? kLookbehindBytes : 0;
+                size_t ahead = (std::min)(kChunkBytes + kLookaheadBytes, region.size - offset);
+                uintptr_t windowBase = region.baseAddress + offset - behind;
+                size_t got = source.Read(windowBase, buffer.data(), behind + ahead);
+                if (got <= behind) {
+                    // Unreadable page: skip it and start the next read without lookbehind
+                    offset = (offset / pageSize + 1) * pageSize;
+                    previousReadable = false;
+                    continue;
+                }
+
+                size_t count = (std::min)(kChunkBytes, got - behind);
+                ScanWindow(buffer.data(), got, behind, count, windowBase, minLength, printable, zero, wide, eroded, collector);
+                extraction.bytesScanned += count;
+                offset += count;
+                previousReadable = true;
+            }
+            if (!extraction.complete) {
+                break;
+            }
+        }
+
+        extraction.uniqueStrings = extraction.strings.size();
+
+        // Indicator matches first, then longer strings, then address order
+        std::vector<std::pair<size_t, size_t>> ranked;
+        ranked.reserve(extraction.strings.size());
+        for (size_t i = 0; i < extraction.strings.size(); i++) {
+            ranked.emplace_back(IndicatorCount(extraction.strings[i].text), i);
+        }
+        size_t kept = (std::min)(options.maxStrings, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + kept, ranked.end(),
+            [&](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+                const ExtractedString& left = extraction.strings[a.second];
+                const ExtractedString& right = extraction.strings[b.second];
+                if (a.first != b.first) {
+                    return a.first > b.first;
+                }
+                if (left.text.size() != right.text.size()) {
+                    return left.text.size() > right.text.size();
+                }
+                return left.address < right.address;
+            });
+        std::vector<ExtractedString> top;
+        top.reserve(kept);
+        for (size_t i = 0; i < kept; i++) {
+            top.push_back(std::move(extraction.strings[ranked[i].second]));
+        }
+        extraction.strings.swap(top);
+
+        extraction.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return extraction;
+    }
+
+} // namespace ProcessScope
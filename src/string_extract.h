@@ -0,0 +1,59 @@
+#pragma once
+
+#include "util.h"
+#include "scan_context.h"
+#include "memory_scan.h"
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    class MemorySource;
+
+    const size_t kDefaultMinStringLength = 6;
+    const ULONGLONG kDefaultStringByteBudget = 64ULL << 20;
+
+    // Longer runs are cut at this many characters
+    const size_t kMaxStringLength = 512;
+
+    struct StringExtractOptions {
+        size_t maxStrings;      // Kept per process, most interesting first; 0 disables extraction
+        size_t minLength;       // Characters
+        ULONGLONG byteBudget;   // Flagged region bytes read per process
+
+        StringExtractOptions() : maxStrings(0), minLength(kDefaultMinStringLength), byteBudget(kDefaultStringByteBudget) {}
+    };
+
+    struct ExtractedString {
+        uintptr_t address;      // First occurrence
+        std::string text;       // Printable ASCII; UTF-16 strings are narrowed
+        bool wide;
+        DWORD occurrences;
+
+        ExtractedString() : address(0), wide(false), occurrences(0) {}
+    };
+
+    // Outcome of extracting strings from one process's flagged regions
+    struct StringExtraction {
+        bool extracted;
+        size_t regions;
+        ULONGLONG bytesScanned;
+        size_t totalStrings;    // Before deduplication
+        size_t uniqueStrings;
+        bool complete;          // Every flagged byte was read within the budget and deadline
+        std::vector<ExtractedString> strings;
+        double elapsedMs;
+
+        StringExtraction() : extracted(false), regions(0), bytesScanned(0), totalStrings(0), uniqueStrings(0),
+                             complete(true), elapsedMs(0) {}
+    };
+
+    // Finds runs of printable ASCII and UTF-16LE in suspicious, executable private and PE-header
+    // regions. Regions are read in 1 MB chunks, each classified 16 bytes at a time with SSE2 into
+    // printable and zero bitmasks; runs are then found with bit scans, so text-free stretches are
+    // skipped 64 bytes per step. Strings are deduplicated per process and ranked by indicators
+    // (URLs, pipe names, command lines, registry paths), then length.
+    StringExtraction ExtractStrings(MemorySource& source, const std::vector<MemoryRegion>& regions,
+                                    const StringExtractOptions& options, const ScanContext& context);
+
+} // namespace ProcessScope
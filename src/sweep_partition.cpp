@@ -0,0 +1,83 @@
+#include "sweep_partition.h"
+#include <map>
+
+namespace ProcessScope {
+
+    void SweepPartitioner::Build(const std::vector<ProcessInfo>& processes, const ProcessTree& tree,
+                                 const std::vector<size_t>& baseOrder, const PartitionOptions& options) {
+        options_ = options;
+        order_.clear();
+        partitions_.clear();
+        partitionOf_.assign(processes.size(), 0);
+        pids_.clear();
+
+        std::map<DWORD, size_t> bySession;
+        for (const auto& process : processes) {
+            bySession.emplace(process.sessionId, 0);
+            pids_.push_back(process.pid);
+        }
+        for (auto& entry : bySession) {
+            entry.second = partitions_.size();
+            PartitionStats stats;
+            stats.sessionId = entry.first;
+            partitions_.push_back(stats);
+        }
+
+        std::vector<std::vector<size_t>> sequences(partitions_.size());
+        for (size_t index : baseOrder) {
+            size_t partition = bySession[processes[index].sessionId];
+            partitionOf_[index] = partition;
+            partitions_[partition].processes++;
+            sequences[partition].push_back(index);
+        }
+
+        if (!options.interleave || partitions_.size() < 2) {
+            order_ = baseOrder;
+            return;
+        }
+
+        // The head earliest in the base order always has its parent placed, so every pass
+        // places at least one process and the loop ends after at most n passes
+        order_.reserve(processes.size());
+        std::vector<bool> placed(processes.size(), false);
+        std::vector<size_t> cursors(partitions_.size(), 0);
+        while (order_.size() < processes.size()) {
+            for (size_t partition = 0; partition < sequences.size(); partition++) {
+                if (cursors[partition] == sequences[partition].size()) {
+                    continue;
+                }
+                size_t index = sequences[partition][cursors[partition]];
+                if (tree.HasParent(index) && !placed[tree.Parent(index)]) {
+                    continue;
+                }
+                placed[index] = true;
+                order_.push_back(index);
+                cursors[partition]++;
+            }
+        }
+    }
+
+    bool SweepPartitioner::IsExhausted(size_t partition) const {
+        return options_.budgetMs > 0 && partitions_[partition].scanMs >= options_.budgetMs;
+    }
+
+    void SweepPartitioner::RecordResult(size_t index, const RiskAssessment& assessment, bool success) {
+        PartitionStats& stats = partitions_[partitionOf_[index]];
+        if (!success) {
+            stats.failed++;
+            return;
+        }
+        stats.scanned++;
+        if (assessment.level == RiskLevel::High) {
+            stats.highRisk++;
+        } else if (assessment.level == RiskLevel::Medium) {
+            stats.mediumRisk++;
+        }
+        stats.totalScore += assessment.score;
+        if (assessment.score > stats.maxScore) {
+            stats.maxScore = assessment.score;
+            stats.maxScorePid = pids_[index];
+        }
+    }
+
+} // namespace ProcessScope
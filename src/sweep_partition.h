@@ -0,0 +1,72 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include "process_tree.h"
+#include "risk_score.h"
+#include <vector>
+
+namespace ProcessScope {
+
+    // Sweeps are partitioned by terminal session. On Windows that is also the container boundary:
+    // the processes of each process-isolated container run in a session of their own on the host.
+    struct PartitionOptions {
+        bool interleave;            // Partitions take turns instead of the plain parent-first order
+        unsigned maxConcurrent;     // Scans of one partition in flight at once with --isolate; 0 = unlimited
+        DWORD budgetMs;             // Scan time per partition; once spent, its remaining processes are skipped. 0 = unlimited
+
+        PartitionOptions() : interleave(false), maxConcurrent(0), budgetMs(0) {}
+    };
+
+    // Totals for one partition, including the aggregate risk of what was scanned
+    struct PartitionStats {
+        DWORD sessionId;
+        size_t processes;
+        size_t scanned;             // Scans that succeeded, tier-1 only ones included
+        size_t failed;
+        size_t skipped;             // Left unscanned once the budget was spent
+        size_t mediumRisk;
+        size_t highRisk;
+        int maxScore;
+        DWORD maxScorePid;
+        long long totalScore;
+        double scanMs;
+
+        PartitionStats() : sessionId(0), processes(0), scanned(0), failed(0), skipped(0), mediumRisk(0), highRisk(0),
+                           maxScore(0), maxScorePid(0), totalScore(0), scanMs(0) {}
+    };
+
+    // Scan order and per-partition accounting for a sweep. With interleaving, partitions take turns:
+    // each step takes the next process of the next partition in the base order (pre-order or
+    // prioritized, parent-first either way), passing over a partition whose next process has a
+    // parent not placed yet. The order stays parent-first across partitions, so lineage still
+    // propagates in one pass, and a partition with hundreds of processes delays each of the others
+    // by at most one scan per turn.
+    class SweepPartitioner {
+    private:
+        std::vector<size_t> order_;
+        std::vector<size_t> partitionOf_;   // Per process index
+        std::vector<DWORD> pids_;
+        std::vector<PartitionStats> partitions_;
+        PartitionOptions options_;
+
+    public:
+        void Build(const std::vector<ProcessInfo>& processes, const ProcessTree& tree,
+                   const std::vector<size_t>& baseOrder, const PartitionOptions& options);
+
+        const std::vector<size_t>& Order() const { return order_; }
+        size_t PartitionOf(size_t index) const { return partitionOf_[index]; }
+        size_t PartitionCount() const { return partitions_.size(); }
+        unsigned MaxConcurrent() const { return options_.maxConcurrent; }
+
+        // Scan time is charged as results arrive; risk is recorded once the final score is known
+        void Charge(size_t partition, double scanMs) { partitions_[partition].scanMs += scanMs; }
+        bool IsExhausted(size_t partition) const;
+        void RecordResult(size_t index, const RiskAssessment& assessment, bool success);
+        void RecordSkip(size_t index) { partitions_[partitionOf_[index]].skipped++; }
+
+        // Ordered by session
+        const std::vector<PartitionStats>& Stats() const { return partitions_; }
+    };
+
+} // namespace ProcessScope
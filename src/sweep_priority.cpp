@@ -0,0 +1,146 @@
+#include "sweep_priority.h"
+#include <algorithm>
+#include <queue>
+
+namespace ProcessScope {
+
+    static const int kPriorHighPoints = 6;
+    static const int kPriorMediumPoints = 3;
+    static const int kUnusualParentPoints = 3;
+    static const int kUserWritablePoints = 2;
+    static const int kYoungProcessPoints = 2;
+    static const int kRecentProcessPoints = 1;
+
+    static const ULONGLONG kFileTimeTicksPerMinute = 600000000ULL;
+    static const ULONGLONG kYoungProcessTicks = 10 * kFileTimeTicksPerMinute;
+    static const ULONGLONG kRecentProcessTicks = 60 * kFileTimeTicksPerMinute;
+
+    // Directories any user can write to, lowercase
+    static const char* const kUserWritableDirectories[] = {
+        "\\users\\", "\\programdata\\", "\\temp\\", "\\perflogs\\", "\\$recycle.bin\\"
+    };
+
+    int TierZeroScore(const ProcessInfo& process, const PriorityOptions& options, const LineageInfo& lineage, ULONGLONG referenceTime) {
+        int points = 0;
+        if (options.priorRisk) {
+            auto prior = options.priorRisk->find(ToLower(process.name));
+            if (prior != options.priorRisk->end()) {
+                points += prior->second == RiskLevel::High ? kPriorHighPoints
+                        : prior->second == RiskLevel::Medium ? kPriorMediumPoints : 0;
+            }
+        }
+
+        if (!process.fullPath.empty()) {
+            std::string lowerPath = ToLower(process.fullPath);
+            for (const char* directory : kUserWritableDirectories) {
+                if (lowerPath.find(directory) != std::string::npos) {
+                    points += kUserWritablePoints;
+                    break;
+                }
+            }
+        }
+
+        if (RiskScorer::ScoreUnusualParent(process, lineage) > 0) {
+            points += kUnusualParentPoints;
+        }
+
+        if (process.creationTime != 0 && referenceTime >= process.creationTime) {
+            ULONGLONG age = referenceTime - process.creationTime;
+            if (age < kYoungProcessTicks) {
+                points += kYoungProcessPoints;
+            } else if (age < kRecentProcessTicks) {
+                points += kRecentProcessPoints;
+            }
+        }
+        return points;
+    }
+
+    std::vector<size_t> PrioritizedOrder(const std::vector<ProcessInfo>& processes, const ProcessTree& tree,
+                                         const PriorityOptions& options) {
+        const std::vector<size_t>& preOrder = tree.PreOrder();
+        if (!options.enabled) {
+            return preOrder;
+        }
+        const size_t count = processes.size();
+
+        ULONGLONG referenceTime = options.referenceTime;
+        if (referenceTime == 0) {
+            for (const auto& process : processes) {
+                referenceTime = (std::max)(referenceTime, process.creationTime);
+            }
+        }
+
+        std::vector<int> points(count);
+        std::vector<size_t> rank(count);
+        for (size_t i = 0; i < count; i++) {
+            LineageInfo lineage;
+            if (tree.HasParent(i)) {
+                lineage.parentKnown = true;
+                lineage.parentName = processes[tree.Parent(i)].name;
+            }
+            points[i] = TierZeroScore(processes[i], options, lineage, referenceTime);
+            rank[preOrder[i]] = i;
+        }
+
+        // Higher score first, then less private memory to scan, then the plain sweep order
+        auto ahead = [&](size_t a, size_t b) {
+            if (points[a] != points[b]) {
+                return points[a] > points[b];
+            }
+            if (processes[a].privateBytes != processes[b].privateBytes) {
+                return processes[a].privateBytes < processes[b].privateBytes;
+            }
+            return rank[a] < rank[b];
+        };
+
+        // Best process of each subtree; descendants come after a node in pre-order, so one
+        // reverse pass folds each finished subtree into its parent
+        std::vector<size_t> best(count);
+        std::vector<size_t> childStart(count + 1, 0);
+        for (size_t i = 0; i < count; i++) {
+            best[i] = i;
+            if (tree.HasParent(i)) {
+                childStart[tree.Parent(i) + 1]++;
+            }
+        }
+        for (size_t k = count; k-- > 0;) {
+            size_t index = preOrder[k];
+            if (tree.HasParent(index) && ahead(best[index], best[tree.Parent(index)])) {
+                best[tree.Parent(index)] = best[index];
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            childStart[i + 1] += childStart[i];
+        }
+        std::vector<size_t> children(childStart[count]);
+        std::vector<size_t> fill(childStart.begin(), childStart.end() - 1);
+        for (size_t i = 0; i < count; i++) {
+            if (tree.HasParent(i)) {
+                children[fill[tree.Parent(i)]++] = i;
+            }
+        }
+
+        // Processes whose parent is placed; no two of them share a subtree, so their bests differ
+        auto later = [&](size_t a, size_t b) { return ahead(best[b], best[a]); };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(later)> ready(later);
+        for (size_t i = 0; i < count; i++) {
+            if (!tree.HasParent(i)) {
+                ready.push(i);
+            }
+        }
+
+        std::vector<size_t> order;
+        order.reserve(count);
+        while (!ready.empty()) {
+            size_t index = ready.top();
+            ready.pop();
+            order.push_back(index);
+            for (size_t c = childStart[index]; c < childStart[index + 1]; c++) {
+                ready.push(children[c]);
+            }
+        }
+        return order;
+    }
+
+} // namespace ProcessScope
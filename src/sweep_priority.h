@@ -0,0 +1,36 @@
+#pragma once
+
+#include "util.h"
+#include "process_enum.h"
+#include "process_tree.h"
+#include "risk_score.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Highest level each image was reported at by recent runs, keyed by lowercase file name
+    typedef std::unordered_map<std::string, RiskLevel> PriorRiskMap;
+
+    struct PriorityOptions {
+        bool enabled;
+        const PriorRiskMap* priorRisk;  // May be null
+        ULONGLONG referenceTime;        // FILETIME ticks process ages are taken from; 0 = the newest process start
+
+        PriorityOptions() : enabled(false), priorRisk(nullptr), referenceTime(0) {}
+    };
+
+    // Points from signals known before any process is opened: an earlier Medium or High report for
+    // the image, an unusual parent, an image in a user-writable directory and a recent start.
+    // Nothing here reads the image file, so ordering costs no signature checks.
+    int TierZeroScore(const ProcessInfo& process, const PriorityOptions& options, const LineageInfo& lineage, ULONGLONG referenceTime);
+
+    // Scan order that reaches likely findings first while keeping every parent ahead of its
+    // children, so lineage scoring still works in one pass. Each process ranks by the best
+    // (score, then smallest private commit) in its subtree, which pulls the ancestors of a risky
+    // process forward with it; a max-heap of processes whose parent is placed yields the order.
+    std::vector<size_t> PrioritizedOrder(const std::vector<ProcessInfo>& processes, const ProcessTree& tree,
+                                         const PriorityOptions& options);
+
+} // namespace ProcessScope
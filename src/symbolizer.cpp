@@ -0,0 +1,233 @@
+#include "symbolizer.h"
+#include "scan_backend.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ProcessScope {
+
+    // Translate an RVA to a file offset using the section table; returns false when unmapped
+    static bool RvaToOffset(const IMAGE_SECTION_HEADER* sections, WORD sectionCount, DWORD rva, size_t& offset) {
+        for (WORD i = 0; i < sectionCount; i++) {
+            DWORD sectionSize = (std::max)(sections[i].Misc.VirtualSize, sections[i].SizeOfRawData);
+            if (rva >= sections[i].VirtualAddress && rva < sections[i].VirtualAddress + sectionSize) {
+                offset = static_cast<size_t>(rva - sections[i].VirtualAddress) + sections[i].PointerToRawData;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string SymbolInfo::ToString() const {
+        if (!inModule) {
+            return std::string();
+        }
+
+        std::stringstream ss;
+        ss << moduleName;
+        if (hasSymbol) {
+            ss << "!" << symbolName;
+            if (symbolOffset != 0) {
+                ss << "+0x" << std::hex << symbolOffset;
+            }
+        } else {
+            ss << "+0x" << std::hex << moduleOffset;
+        }
+        return ss.str();
+    }
+
+    std::shared_ptr<const ExportTable> ExportTable::Parse(const BYTE* image, size_t size) {
+        auto table = std::make_shared<ExportTable>();
+
+        if (!image || size < sizeof(IMAGE_DOS_HEADER)) {
+            return table;
+        }
+
+        const IMAGE_DOS_HEADER* dos = reinterpret_cast<const IMAGE_DOS_HEADER*>(image);
+        if (dos->e_magic != IMAGE_DOS_SIGNATURE || dos->e_lfanew <= 0 ||
+            static_cast<size_t>(dos->e_lfanew) + sizeof(IMAGE_NT_HEADERS32) > size) {
+            return table;
+        }
+
+        // The file and optional headers sit at the same offsets for PE32 and PE32+
+        const IMAGE_NT_HEADERS32* nt32 = reinterpret_cast<const IMAGE_NT_HEADERS32*>(image + dos->e_lfanew);
+        if (nt32->Signature != IMAGE_NT_SIGNATURE) {
+            return table;
+        }
+
+        IMAGE_DATA_DIRECTORY exportDir = {};
+        if (nt32->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+            if (static_cast<size_t>(dos->e_lfanew) + sizeof(IMAGE_NT_HEADERS64) > size) {
+                return table;
+            }
+            const IMAGE_NT_HEADERS64* nt64 = reinterpret_cast<const IMAGE_NT_HEADERS64*>(nt32);
+            if (nt64->OptionalHeader.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_EXPORT) {
+                exportDir = nt64->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+            }
+        } else if (nt32->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC) {
+            if (nt32->OptionalHeader.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_EXPORT) {
+                exportDir = nt32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+            }
+        } else {
+            return table;
+        }
+
+        if (exportDir.VirtualAddress == 0 || exportDir.Size == 0) {
+            return table;
+        }
+
+        const IMAGE_SECTION_HEADER* sections = IMAGE_FIRST_SECTION(nt32);
+        WORD sectionCount = nt32->FileHeader.NumberOfSections;
+        size_t sectionTableEnd = reinterpret_cast<const BYTE*>(sections + sectionCount) - image;
+        if (sectionTableEnd > size) {
+            return table;
+        }
+
+        size_t exportOffset = 0;
+        if (!RvaToOffset(sections, sectionCount, exportDir.VirtualAddress, exportOffset) ||
+            exportOffset + sizeof(IMAGE_EXPORT_DIRECTORY) > size) {
+            return table;
+        }
+        const IMAGE_EXPORT_DIRECTORY* exports = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY*>(image + exportOffset);
+
+        size_t functionsOffset = 0, namesOffset = 0, ordinalsOffset = 0;
+        if (!RvaToOffset(sections, sectionCount, exports->AddressOfFunctions, functionsOffset) ||
+            functionsOffset + static_cast<size_t>(exports->NumberOfFunctions) * sizeof(DWORD) > size) {
+            return table;
+        }
+        const DWORD* functions = reinterpret_cast<const DWORD*>(image + functionsOffset);
+
+        const DWORD* names = nullptr;
+        const WORD* ordinals = nullptr;
+        if (exports->NumberOfNames > 0 &&
+            RvaToOffset(sections, sectionCount, exports->AddressOfNames, namesOffset) &&
+            RvaToOffset(sections, sectionCount, exports->AddressOfNameOrdinals, ordinalsOffset) &&
+            namesOffset + static_cast<size_t>(exports->NumberOfNames) * sizeof(DWORD) <= size &&
+            ordinalsOffset + static_cast<size_t>(exports->NumberOfNames) * sizeof(WORD) <= size) {
+            names = reinterpret_cast<const DWORD*>(image + namesOffset);
+            ordinals = reinterpret_cast<const WORD*>(image + ordinalsOffset);
+        }
+
+        // Name every function slot that has a name; unnamed exports fall back to #ordinal
+        std::vector<DWORD> nameForFunction(exports->NumberOfFunctions, 0);
+        for (DWORD i = 0; names && i < exports->NumberOfNames; i++) {
+            if (ordinals[i] < exports->NumberOfFunctions) {
+                nameForFunction[ordinals[i]] = names[i];
+            }
+        }
+
+        table->entries_.reserve(exports->NumberOfFunctions);
+        for (DWORD i = 0; i < exports->NumberOfFunctions; i++) {
+            DWORD rva = functions[i];
+            // Skip empty slots and forwarders, which point back into the export directory
+            if (rva == 0 || (rva >= exportDir.VirtualAddress && rva < exportDir.VirtualAddress + exportDir.Size)) {
+                continue;
+            }
+
+            Entry entry;
+            entry.rva = rva;
+            entry.nameOffset = static_cast<DWORD>(table->names_.size());
+
+            size_t nameOffset = 0;
+            if (nameForFunction[i] != 0 && RvaToOffset(sections, sectionCount, nameForFunction[i], nameOffset) && nameOffset < size) {
+                const char* name = reinterpret_cast<const char*>(image + nameOffset);
+                size_t maxLength = (std::min)(size - nameOffset, static_cast<size_t>(512));
+                table->names_.append(name, strnlen(name, maxLength));
+            } else {
+                table->names_ += "#" + std::to_string(exports->Base + i);
+            }
+            table->names_.push_back('\0');
+            table->entries_.push_back(entry);
+        }
+
+        std::sort(table->entries_.begin(), table->entries_.end(),
+                  [](const Entry& a, const Entry& b) { return a.rva < b.rva; });
+        table->names_.shrink_to_fit();
+        return table;
+    }
+
+    std::shared_ptr<const ExportTable> ExportTable::FromSymbols(const std::vector<ExportSymbol>& symbols) {
+        auto table = std::make_shared<ExportTable>();
+        table->entries_.reserve(symbols.size());
+        for (const auto& symbol : symbols) {
+            Entry entry;
+            entry.rva = symbol.rva;
+            entry.nameOffset = static_cast<DWORD>(table->names_.size());
+            table->names_.append(symbol.name);
+            table->names_.push_back('\0');
+            table->entries_.push_back(entry);
+        }
+        std::sort(table->entries_.begin(), table->entries_.end(),
+                  [](const Entry& a, const Entry& b) { return a.rva < b.rva; });
+        return table;
+    }
+
+    std::vector<ExportSymbol> ExportTable::Symbols() const {
+        std::vector<ExportSymbol> symbols;
+        symbols.reserve(entries_.size());
+        for (const auto& entry : entries_) {
+            ExportSymbol symbol;
+            symbol.rva = entry.rva;
+            symbol.name = names_.c_str() + entry.nameOffset;
+            symbols.push_back(std::move(symbol));
+        }
+        return symbols;
+    }
+
+    const char* ExportTable::FindNearest(DWORD rva, DWORD& symbolRva) const {
+        auto it = std::upper_bound(entries_.begin(), entries_.end(), rva,
+                                   [](DWORD value, const Entry& entry) { return value < entry.rva; });
+        if (it == entries_.begin()) {
+            return nullptr;
+        }
+        --it;
+        symbolRva = it->rva;
+        return names_.c_str() + it->nameOffset;
+    }
+
+    Symbolizer::Symbolizer(const std::vector<ModuleInfo>& modules, ImageSource& images) : images_(images) {
+        ranges_.reserve(modules.size());
+        for (const auto& module : modules) {
+            if (module.size != 0) {
+                ranges_.push_back({module.baseAddress, module.baseAddress + module.size, &module, nullptr});
+            }
+        }
+        std::sort(ranges_.begin(), ranges_.end(),
+                  [](const ModuleRange& a, const ModuleRange& b) { return a.base < b.base; });
+    }
+
+    SymbolInfo Symbolizer::Resolve(uintptr_t address) const {
+        SymbolInfo info;
+
+        auto it = std::upper_bound(ranges_.begin(), ranges_.end(), address,
+                                   [](uintptr_t value, const ModuleRange& range) { return value < range.base; });
+        if (it == ranges_.begin()) {
+            return info;
+        }
+        --it;
+        if (address >= it->end) {
+            return info;
+        }
+
+        info.inModule = true;
+        info.moduleName = it->module->name;
+        info.moduleOffset = address - it->base;
+
+        if (it->module->fullPath.empty() || info.moduleOffset > 0xFFFFFFFF) {
+            return info;
+        }
+
+        if (!it->exports) {
+            it->exports = images_.GetExports(it->module->fullPath);
+        }
+        DWORD symbolRva = 0;
+        const char* name = it->exports->FindNearest(static_cast<DWORD>(info.moduleOffset), symbolRva);
+        if (name) {
+            info.hasSymbol = true;
+            info.symbolName = name;
+            info.symbolOffset = info.moduleOffset - symbolRva;
+        }
+
+        return info;
+    }
+
+} // namespace ProcessScope
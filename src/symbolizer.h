@@ -0,0 +1,128 @@
+#pragma once
+
+#include "util.h"
+#include "module_enum.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ProcessScope {
+
+    // Resolved location of an address inside a loaded module
+    struct SymbolInfo {
+        std::string moduleName;
+        uintptr_t moduleOffset;
+        std::string symbolName;
+        uintptr_t symbolOffset;
+        bool inModule;
+        bool hasSymbol;
+
+        SymbolInfo() : moduleOffset(0), symbolOffset(0), inModule(false), hasSymbol(false) {}
+        std::string ToString() const;
+    };
+
+    class ImageSource;
+
+    // One export: its RVA and name, or "#<ordinal>" when unnamed
+    struct ExportSymbol {
+        DWORD rva;
+        std::string name;
+    };
+
+    // Exported symbols of one on-disk image, sorted by RVA for binary search
+    class ExportTable {
+    private:
+        struct Entry {
+            DWORD rva;
+            DWORD nameOffset;
+        };
+        std::vector<Entry> entries_;
+        std::string names_;
+
+    public:
+        static std::shared_ptr<const ExportTable> Parse(const BYTE* image, size_t size);
+        // Rebuilds a table from Symbols(), e.g. one recorded in a host snapshot
+        static std::shared_ptr<const ExportTable> FromSymbols(const std::vector<ExportSymbol>& symbols);
+        // Nearest export at or below rva; returns nullptr when none precedes it
+        const char* FindNearest(DWORD rva, DWORD& symbolRva) const;
+        std::vector<ExportSymbol> Symbols() const;
+        size_t size() const { return entries_.size(); }
+    };
+
+#ifdef _WIN32
+    // Process-wide cache of export tables by path, bounded with least-recently-used eviction like
+    // the image digest cache. An entry holds while the file's size and last write time are
+    // unchanged, so an image updated in place is parsed again. Tables are also indexed by file
+    // identity (volume + file index), so one file reached through several paths is parsed once.
+    class SymbolCache {
+    private:
+        struct FileId {
+            DWORD volumeSerial;
+            ULONGLONG fileIndex;
+            bool operator==(const FileId& other) const {
+                return volumeSerial == other.volumeSerial && fileIndex == other.fileIndex;
+            }
+        };
+        struct FileIdHash {
+            size_t operator()(const FileId& id) const {
+                return std::hash<ULONGLONG>()(id.fileIndex ^ (static_cast<ULONGLONG>(id.volumeSerial) << 32));
+            }
+        };
+
+        // Size and last write time; both zero for a file that could not be read
+        struct FileStamp {
+            ULONGLONG lastWriteTime;
+            ULONGLONG fileSize;
+            bool operator==(const FileStamp& other) const {
+                return lastWriteTime == other.lastWriteTime && fileSize == other.fileSize;
+            }
+        };
+        struct PathEntry {
+            std::string path;
+            FileStamp stamp;
+            std::shared_ptr<const ExportTable> table;
+        };
+        // Weak, so the path entries alone decide what stays in memory
+        struct IdEntry {
+            FileStamp stamp;
+            std::weak_ptr<const ExportTable> table;
+        };
+        typedef std::list<PathEntry> PathList;
+
+        mutable std::mutex mutex_;
+        PathList lru_;                                              // Most recently used at the front
+        std::unordered_map<std::string, PathList::iterator> byPath_;
+        std::unordered_map<FileId, IdEntry, FileIdHash> byFileId_;
+
+        SymbolCache() {}
+
+    public:
+        static SymbolCache& Instance();
+        // Revalidates against the file on every call; Symbolizer asks once per module per scan
+        std::shared_ptr<const ExportTable> GetExports(const std::string& path);
+        size_t CachedImageCount() const;
+    };
+#endif
+
+    // Resolves addresses to module+offset and the nearest exported symbol for one scan. Each
+    // module's export table is fetched from the backend's images on first use and kept for the scan.
+    class Symbolizer {
+    private:
+        struct ModuleRange {
+            uintptr_t base;
+            uintptr_t end;
+            const ModuleInfo* module;
+            mutable std::shared_ptr<const ExportTable> exports;
+        };
+        std::vector<ModuleRange> ranges_;
+        ImageSource& images_;
+
+    public:
+        Symbolizer(const std::vector<ModuleInfo>& modules, ImageSource& images);
+        SymbolInfo Resolve(uintptr_t address) const;
+    };
+
+} // namespace ProcessScope
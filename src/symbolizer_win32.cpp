@@ -0,0 +1,94 @@
+#include "symbolizer.h"
+
+namespace ProcessScope {
+
+    // Export tables kept across scans; the daemon and watch mode see many images over time
+    static const size_t kMaxCachedExportTables = 2048;
+
+    SymbolCache& SymbolCache::Instance() {
+        static SymbolCache instance;
+        return instance;
+    }
+
+    std::shared_ptr<const ExportTable> SymbolCache::GetExports(const std::string& path) {
+        FileStamp stamp = {};
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (GetFileAttributesExW(StringToWString(path).c_str(), GetFileExInfoStandard, &attributes)) {
+            stamp.lastWriteTime = (static_cast<ULONGLONG>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                                  attributes.ftLastWriteTime.dwLowDateTime;
+            stamp.fileSize = (static_cast<ULONGLONG>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = byPath_.find(path);
+            if (it != byPath_.end() && it->second->stamp == stamp) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return it->second->table;
+            }
+        }
+
+        // Slow path: identify the file, then parse it unless another path already did
+        MappedFile image;
+        std::shared_ptr<const ExportTable> table;
+        FileId id = {};
+        bool haveId = false;
+
+        if (stamp.fileSize != 0 && image.Open(path)) {
+            BY_HANDLE_FILE_INFORMATION fileInfo;
+            if (GetFileInformationByHandle(image.file(), &fileInfo)) {
+                id.volumeSerial = fileInfo.dwVolumeSerialNumber;
+                id.fileIndex = (static_cast<ULONGLONG>(fileInfo.nFileIndexHigh) << 32) | fileInfo.nFileIndexLow;
+                haveId = true;
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = byFileId_.find(id);
+                if (it != byFileId_.end() && it->second.stamp == stamp) {
+                    table = it->second.table.lock();
+                }
+            }
+            if (!table) {
+                table = ExportTable::Parse(image.data(), image.size());
+            }
+        } else {
+            // Unreadable images are cached as empty so they are not retried on every thread
+            table = std::make_shared<ExportTable>();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (haveId) {
+            IdEntry& entry = byFileId_[id];
+            entry.stamp = stamp;
+            entry.table = table;
+        }
+        auto existing = byPath_.find(path);
+        if (existing != byPath_.end()) {
+            lru_.erase(existing->second);
+            byPath_.erase(existing);
+        }
+        PathEntry entry;
+        entry.path = path;
+        entry.stamp = stamp;
+        entry.table = table;
+        lru_.push_front(std::move(entry));
+        byPath_[lru_.front().path] = lru_.begin();
+        while (lru_.size() > kMaxCachedExportTables) {
+            byPath_.erase(lru_.back().path);
+            lru_.pop_back();
+        }
+
+        // Identity entries outlive their tables once the paths holding them are evicted
+        if (byFileId_.size() > 2 * kMaxCachedExportTables) {
+            for (auto it = byFileId_.begin(); it != byFileId_.end();) {
+                it = it->second.table.expired() ? byFileId_.erase(it) : std::next(it);
+            }
+        }
+        return table;
+    }
+
+    size_t SymbolCache::CachedImageCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lru_.size();
+    }
+
+} // namespace ProcessScope
@@ -2,6 +2,7 @@
 
 #include "util.h"
 #include "module_enum.h"
+#include "scan_context.h"
 #include <vector>
 #include <string>
 
@@ -9,14 +10,25 @@
 struct ThreadInfo {
     DWORD tid;
     uintptr_t startAddress;
+    std::string startSymbol;
     bool anomalousStart;
+    DWORD samples;              // Instruction pointers captured by activity sampling
+    DWORD unbackedSamples;      // Of those, outside every module in non-image or freed memory
+    ULONGLONG cpuTime;          // 100 ns units used while sampling
+    uintptr_t sampledAddress;   // First unbacked sample, else the most recent one
+    std::string sampledSymbol;
     
-    ThreadInfo() : tid(0), startAddress(0), anomalousStart(false) {}
+    ThreadInfo() : tid(0), startAddress(0), anomalousStart(false), samples(0), unbackedSamples(0), cpuTime(0),
+                   sampledAddress(0) {}
 };
 
-// Thread enumeration with start address validation
-class ThreadEnumerator {
+namespace ProcessScope {
+
+    // Thread enumeration with start address validation
+    class ThreadEnumerator {
     public:
-        std::vector<ThreadInfo> EnumerateThreads(DWORD pid);
+        std::vector<ThreadInfo> EnumerateThreads(DWORD pid, const ProcessScope::ScanContext& context);
         bool IsStartAddressInModule(uintptr_t address, const std::vector<ModuleInfo>& modules);
-};
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,72 @@
+#include "thread_sampler.h"
+#include "symbolizer.h"
+#include "memory_scan.h"
+#include <algorithm>
+
+namespace ProcessScope {
+
+    static const DWORD kExecutableProtection = PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+    void ClassifySamples(const std::vector<ThreadSamples>& samples, const Symbolizer& symbolizer,
+                         const std::vector<MemoryRegion>& regions, MemorySource* memory,
+                         std::vector<ThreadInfo>& threads, ThreadSamplingStats& stats) {
+        // Regions queried again, kept so samples landing in one cost a single query
+        std::vector<MEMORY_BASIC_INFORMATION> queried;
+
+        auto isUnbacked = [&](uintptr_t address) {
+            auto next = std::upper_bound(regions.begin(), regions.end(), address,
+                [](uintptr_t value, const MemoryRegion& region) { return value < region.baseAddress; });
+            if (next != regions.begin()) {
+                const MemoryRegion& region = *(next - 1);
+                if (address - region.baseAddress < region.size && (region.isImage || region.isExecutable)) {
+                    return !region.isImage;
+                }
+            }
+
+            // Allocated or reprotected since the region walk, or gone again already
+            MEMORY_BASIC_INFORMATION mbi = {};
+            auto known = std::find_if(queried.begin(), queried.end(), [&](const MEMORY_BASIC_INFORMATION& candidate) {
+                return address - reinterpret_cast<uintptr_t>(candidate.BaseAddress) < candidate.RegionSize;
+            });
+            if (known != queried.end()) {
+                mbi = *known;
+            } else {
+                if (!memory || !memory->Query(address, mbi)) {
+                    return true;
+                }
+                queried.push_back(mbi);
+                stats.regionQueries++;
+            }
+            if (mbi.State != MEM_COMMIT || !(mbi.Protect & kExecutableProtection)) {
+                return true;
+            }
+            return mbi.Type != MEM_IMAGE;
+        };
+
+        for (const auto& entry : samples) {
+            auto thread = std::find_if(threads.begin(), threads.end(),
+                [&](const ThreadInfo& candidate) { return candidate.tid == entry.tid; });
+            if (thread == threads.end()) {
+                continue;
+            }
+            thread->cpuTime = entry.cpuTime;
+            thread->samples = static_cast<DWORD>(entry.addresses.size());
+            stats.samples += entry.addresses.size();
+
+            // Report the first unbacked address, or else the most recent one
+            for (uintptr_t address : entry.addresses) {
+                SymbolInfo symbol = symbolizer.Resolve(address);
+                bool unbacked = !symbol.inModule && isUnbacked(address);
+                if (unbacked) {
+                    thread->unbackedSamples++;
+                    stats.unbackedSamples++;
+                }
+                if (unbacked ? thread->unbackedSamples == 1 : thread->unbackedSamples == 0) {
+                    thread->sampledAddress = address;
+                    thread->sampledSymbol = symbol.ToString();
+                }
+            }
+        }
+    }
+
+} // namespace ProcessScope
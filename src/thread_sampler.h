@@ -0,0 +1,81 @@
+#pragma once
+
+#include "util.h"
+#include "thread_enum.h"
+#include "scan_context.h"
+#include <vector>
+
+// Included from scan_backend.h, which memory_scan.h includes
+struct MemoryRegion;
+
+namespace ProcessScope {
+
+    class Symbolizer;
+    class MemorySource;
+
+    const DWORD kDefaultThreadSampleIntervalMs = 10;
+
+    struct ThreadSampleOptions {
+        DWORD rounds;           // Samples taken of each running thread; 0 disables sampling
+        DWORD intervalMs;       // Wait before each round
+        volatile LONG* suspendedThread;     // Holds the TID while it is suspended, so whoever kills
+                                            // this process can resume it; may be null
+
+        ThreadSampleOptions() : rounds(0), intervalMs(kDefaultThreadSampleIntervalMs), suspendedThread(nullptr) {}
+    };
+
+    // Instruction pointers captured from one thread
+    struct ThreadSamples {
+        DWORD tid;
+        ULONGLONG cpuTime;      // 100 ns units used over the sampling window
+        std::vector<uintptr_t> addresses;
+
+        ThreadSamples() : tid(0), cpuTime(0) {}
+    };
+
+    // What sampling found and what it cost the target and this process
+    struct ThreadSamplingStats {
+        bool sampled;
+        DWORD rounds;
+        size_t threads;         // Opened for sampling
+        size_t inaccessible;    // Could not be opened with suspend and context rights, or already gone
+        size_t suspensions;
+        size_t idleSkips;       // Used no CPU since its last sample, so not suspended again
+        size_t samples;
+        size_t unbackedSamples; // Outside every module, in non-image or freed memory
+        size_t regionQueries;   // Samples the scan's region map could not explain, queried again
+        double windowMs;
+        double suspendedMs;     // Summed over suspensions: thread time the target lost
+        double maxSuspendUs;
+        double overheadPercent; // suspendedMs over windowMs times threads
+        double samplerCpuMs;    // CPU this process spent sampling
+
+        ThreadSamplingStats() : sampled(false), rounds(0), threads(0), inaccessible(0), suspensions(0), idleSkips(0),
+                                samples(0), unbackedSamples(0), regionQueries(0), windowMs(0), suspendedMs(0), maxSuspendUs(0),
+                                overheadPercent(0), samplerCpuMs(0) {}
+    };
+
+    // Periodically captures where each thread of a process is executing. Every round reads each
+    // thread's CPU time with GetThreadTimes; only threads that ran since their last sample are
+    // suspended for GetThreadContext, so blocked threads cost one cheap query per round. The time
+    // each thread spends suspended is measured and reported as the overhead on the target.
+    class ThreadSampler {
+    private:
+        ThreadSamplingStats lastStats_;
+
+    public:
+        std::vector<ThreadSamples> Sample(HANDLE process, const std::vector<ThreadInfo>& threads,
+                                          const ThreadSampleOptions& options, const ScanContext& context);
+        const ThreadSamplingStats& LastStats() const { return lastStats_; }
+    };
+
+    // Attributes samples to their threads. A sample outside every module is unbacked unless its
+    // region is image-backed; executable private or mapped memory, and memory no longer executable
+    // or committed, all count. Whether an image normally runs such code (JIT) is left to scoring.
+    // The region map predates sampling, so an address it misses or maps as non-executable is
+    // queried again through memory when given. Regions must be sorted by base address.
+    void ClassifySamples(const std::vector<ThreadSamples>& samples, const Symbolizer& symbolizer,
+                         const std::vector<MemoryRegion>& regions, MemorySource* memory,
+                         std::vector<ThreadInfo>& threads, ThreadSamplingStats& stats);
+
+} // namespace ProcessScope
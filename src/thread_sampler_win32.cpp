@@ -0,0 +1,146 @@
+#include "thread_sampler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace ProcessScope {
+
+    static ULONGLONG FileTimeToTicks(const FILETIME& time) {
+        return (static_cast<ULONGLONG>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    }
+
+    // Kernel plus user time in 100 ns units
+    static bool GetThreadCpuTime(HANDLE thread, ULONGLONG& cpuTime) {
+        FILETIME creation, exitTime, kernel, user;
+        if (!GetThreadTimes(thread, &creation, &exitTime, &kernel, &user)) {
+            return false;
+        }
+        cpuTime = FileTimeToTicks(kernel) + FileTimeToTicks(user);
+        return true;
+    }
+
+    // Suspends the thread just long enough to read its instruction pointer. WOW64 threads are
+    // read through the 32-bit context; the native one would point into the WOW64 layer.
+    // The TID is published only while the suspension is certainly held, so a supervisor never
+    // resumes a thread this process did not suspend.
+    static bool CaptureInstructionPointer(HANDLE thread, DWORD tid, bool wow64, volatile LONG* suspendedThread,
+                                          uintptr_t& address, double& suspendedUs) {
+        auto start = std::chrono::steady_clock::now();
+        if (SuspendThread(thread) == static_cast<DWORD>(-1)) {
+            return false;
+        }
+        if (suspendedThread) {
+            InterlockedExchange(suspendedThread, static_cast<LONG>(tid));
+        }
+        bool captured = false;
+#ifdef _WIN64
+        if (wow64) {
+            WOW64_CONTEXT context = {};
+            context.ContextFlags = WOW64_CONTEXT_CONTROL;
+            if (Wow64GetThreadContext(thread, &context)) {
+                address = context.Eip;
+                captured = true;
+            }
+        } else {
+            alignas(16) CONTEXT context = {};
+            context.ContextFlags = CONTEXT_CONTROL;
+            if (GetThreadContext(thread, &context)) {
+                address = static_cast<uintptr_t>(context.Rip);
+                captured = true;
+            }
+        }
+#else
+        (void)wow64;
+        CONTEXT context = {};
+        context.ContextFlags = CONTEXT_CONTROL;
+        if (GetThreadContext(thread, &context)) {
+            address = context.Eip;
+            captured = true;
+        }
+#endif
+        if (suspendedThread) {
+            InterlockedExchange(suspendedThread, 0);
+        }
+        ResumeThread(thread);
+        suspendedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return captured;
+    }
+
+    std::vector<ThreadSamples> ThreadSampler::Sample(HANDLE process, const std::vector<ThreadInfo>& threads,
+                                                     const ThreadSampleOptions& options, const ScanContext& context) {
+        lastStats_ = ThreadSamplingStats();
+        std::vector<ThreadSamples> samples;
+
+        // Suspending one of our own threads could stop the sampler itself
+        if (options.rounds == 0 || GetProcessId(process) == GetCurrentProcessId()) {
+            return samples;
+        }
+        lastStats_.sampled = true;
+
+        BOOL wow64 = FALSE;
+        IsWow64Process(process, &wow64);
+
+        ULONGLONG samplerStart = 0;
+        GetThreadCpuTime(GetCurrentThread(), samplerStart);
+        auto windowStart = std::chrono::steady_clock::now();
+
+        std::vector<Handle> handles;
+        std::vector<ULONGLONG> lastCpuTime;
+        for (const auto& thread : threads) {
+            Handle handle(OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_LIMITED_INFORMATION,
+                                     FALSE, thread.tid));
+            ULONGLONG cpuTime = 0;
+            if (!handle || !GetThreadCpuTime(handle.get(), cpuTime)) {
+                lastStats_.inaccessible++;
+                continue;
+            }
+            ThreadSamples entry;
+            entry.tid = thread.tid;
+            samples.push_back(entry);
+            handles.push_back(std::move(handle));
+            lastCpuTime.push_back(cpuTime);
+        }
+        lastStats_.threads = handles.size();
+
+        for (DWORD round = 0; round < options.rounds && !handles.empty(); round++) {
+            Sleep(options.intervalMs);
+            if (context.ShouldStop()) {
+                break;
+            }
+            lastStats_.rounds++;
+
+            for (size_t i = 0; i < handles.size(); i++) {
+                ULONGLONG cpuTime = lastCpuTime[i];
+                GetThreadCpuTime(handles[i].get(), cpuTime);
+                ULONGLONG used = cpuTime - lastCpuTime[i];
+                lastCpuTime[i] = cpuTime;
+                samples[i].cpuTime += used;
+
+                // A thread that has not run is still where it was; every thread is read once
+                if (used == 0 && !samples[i].addresses.empty()) {
+                    lastStats_.idleSkips++;
+                    continue;
+                }
+
+                uintptr_t address = 0;
+                double suspendedUs = 0;
+                if (CaptureInstructionPointer(handles[i].get(), samples[i].tid, wow64 != FALSE, options.suspendedThread,
+                                              address, suspendedUs)) {
+                    samples[i].addresses.push_back(address);
+                }
+                lastStats_.suspensions++;
+                lastStats_.suspendedMs += suspendedUs / 1000.0;
+                lastStats_.maxSuspendUs = (std::max)(lastStats_.maxSuspendUs, suspendedUs);
+            }
+        }
+
+        lastStats_.windowMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - windowStart).count();
+        if (lastStats_.windowMs > 0 && lastStats_.threads > 0) {
+            lastStats_.overheadPercent = 100.0 * lastStats_.suspendedMs / (lastStats_.windowMs * lastStats_.threads);
+        }
+        ULONGLONG samplerEnd = samplerStart;
+        GetThreadCpuTime(GetCurrentThread(), samplerEnd);
+        lastStats_.samplerCpuMs = (samplerEnd - samplerStart) / 10000.0;
+        return samples;
+    }
+
+} // namespace ProcessScope
@@ -1,66 +1,8 @@
 #include "util.h"
+#include <algorithm>
 
 namespace ProcessScope {
 
-    std::string GetLastErrorString() {
-        DWORD errorCode = GetLastError();
-        if (errorCode == 0) return "No error";
-        
-        LPSTR messageBuffer = nullptr;
-        size_t size = FormatMessageA(
-            FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-            nullptr, errorCode, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-            (LPSTR)&messageBuffer, 0, nullptr);
-        
-        std::string message(messageBuffer, size);
-        LocalFree(messageBuffer);
-        return message;
-    }
-
-    std::string WStringToString(const std::wstring& wstr) {
-        if (wstr.empty()) return std::string();
-        
-        int size = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, nullptr, 0, nullptr, nullptr);
-        std::string result(size - 1, 0);
-        WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, &result[0], size, nullptr, nullptr);
-        return result;
-    }
-
-    std::wstring StringToWString(const std::string& str) {
-        if (str.empty()) return std::wstring();
-        
-        int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
-        std::wstring result(size - 1, 0);
-        MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &result[0], size);
-        return result;
-    }
-
-    std::string GetTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
-        
-        std::stringstream ss;
-        struct tm timeinfo;
-        localtime_s(&timeinfo, &time_t);
-        ss << std::put_time(&timeinfo, "%Y%m%d_%H%M%S");
-        ss << "_" << std::setfill('0') << std::setw(3) << ms.count();
-        return ss.str();
-    }
-
-    bool IsProcess64Bit(HANDLE hProcess) {
-        if constexpr (sizeof(void*) == 8) {
-            BOOL isWow64 = FALSE;
-            if (!IsWow64Process(hProcess, &isWow64)) {
-                return false;
-            }
-            return !isWow64;
-        } else {
-            return false;
-        }
-    }
-
     std::string GetProtectionString(DWORD protection) {
         std::string result;
         
@@ -101,31 +43,10 @@ namespace ProcessScope {
         }
     }
 
-    bool CreateDirectoryRecursive(const std::string& path) {
-        if (path.empty()) return false;
-        
-        std::wstring widePath = StringToWString(path);
-        
-        if (CreateDirectoryW(widePath.c_str(), nullptr)) {
-            return true;
-        }
-        
-        if (GetLastError() == ERROR_ALREADY_EXISTS) {
-            return true;
-        }
-        
-        if (GetLastError() == ERROR_PATH_NOT_FOUND) {
-            size_t pos = path.find_last_of("\\/");
-            if (pos != std::string::npos) {
-                std::string parent = path.substr(0, pos);
-                if (CreateDirectoryRecursive(parent)) {
-                    return CreateDirectoryW(widePath.c_str(), nullptr) != FALSE ||
-                           GetLastError() == ERROR_ALREADY_EXISTS;
-                }
-            }
-        }
-        
-        return false;
+    std::string ToLower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(::tolower(c)); });
+        return value;
     }
 
 } // namespace ProcessScope
@@ -1,6 +1,10 @@
 #pragma once
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include "win32_compat.h"
+#endif
 #include <string>
 #include <vector>
 #include <memory>
@@ -15,12 +19,25 @@ namespace ProcessScope {
     std::string WStringToString(const std::wstring& wstr);
     std::wstring StringToWString(const std::string& str);
     std::string GetTimestamp();
-    bool IsProcess64Bit(HANDLE hProcess);
+    size_t GetSystemPageSize();
+    ULONGLONG GetCurrentFileTime();
     std::string GetProtectionString(DWORD protection);
     std::string GetStateString(DWORD state);
     std::string GetTypeString(DWORD type);
     bool CreateDirectoryRecursive(const std::string& path);
-    
+    bool FileExists(const std::string& path);
+    bool RenameFileOver(const std::string& source, const std::string& destination);    // Replaces destination if it exists
+    void RemoveFile(const std::string& path);
+    std::string GetEnvironmentValue(const char* name);     // Empty when unset
+    std::string ExpandEnvironmentVariables(const std::string& text);   // %NAME% references; unknown ones are left as written
+    std::string ToLower(std::string value);     // ASCII only, for paths, names and query terms
+
+#ifdef _WIN32
+    bool IsProcess64Bit(HANDLE hProcess);
+    ULONGLONG GetProcessCreationTime(HANDLE hProcess);
+    ULONGLONG GetProcessPrivateBytes(HANDLE hProcess);
+    std::string GetProcessUser(HANDLE hProcess);
+
     // RAII wrapper for Windows handles
     class Handle {
     private:
@@ -42,5 +59,36 @@ namespace ProcessScope {
         HANDLE get() const { return handle_; }
         operator bool() const { return handle_ && handle_ != INVALID_HANDLE_VALUE; }
     };
+#endif
+
+    // Read-only memory mapping of a file on disk
+    class MappedFile {
+    private:
+#ifdef _WIN32
+        Handle file_;
+        Handle mapping_;
+#else
+        int descriptor_;
+#endif
+        const BYTE* data_;
+        size_t size_;
+    public:
+#ifdef _WIN32
+        MappedFile() : data_(nullptr), size_(0) {}
+#else
+        MappedFile() : descriptor_(-1), data_(nullptr), size_(0) {}
+#endif
+        ~MappedFile() { Close(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        bool Open(const std::string& path);
+        void Close();
+#ifdef _WIN32
+        HANDLE file() const { return file_.get(); }
+#endif
+        const BYTE* data() const { return data_; }
+        size_t size() const { return size_; }
+        operator bool() const { return data_ != nullptr; }
+    };
 
 } // namespace ProcessScope
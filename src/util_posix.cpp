@@ -0,0 +1,255 @@
+#include "util.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Non-Windows counterparts of util_win32.cpp, enough for replaying snapshots and writing reports
+
+static thread_local DWORD g_lastError = 0;
+
+DWORD GetLastError() {
+    return g_lastError;
+}
+
+void SetLastError(DWORD error) {
+    g_lastError = error;
+}
+
+namespace ProcessScope {
+
+    // Win32 codes the replay path sets, or errno values recorded by the functions below
+    static DWORD FromErrno(int error) {
+        switch (error) {
+            case ENOENT: return ERROR_FILE_NOT_FOUND;
+            case EACCES: return ERROR_ACCESS_DENIED;
+            case EEXIST: return ERROR_ALREADY_EXISTS;
+            default:     return static_cast<DWORD>(error);
+        }
+    }
+
+    std::string GetLastErrorString() {
+        DWORD errorCode = GetLastError();
+        switch (errorCode) {
+            case ERROR_SUCCESS:           return "No error";
+            case ERROR_FILE_NOT_FOUND:    return "The system cannot find the file specified.";
+            case ERROR_PATH_NOT_FOUND:    return "The system cannot find the path specified.";
+            case ERROR_ACCESS_DENIED:     return "Access is denied.";
+            case ERROR_ALREADY_EXISTS:    return "Cannot create a file when that file already exists.";
+            case ERROR_NOT_FOUND:         return "Element not found.";
+            default:                      return strerror(static_cast<int>(errorCode));
+        }
+    }
+
+    // Converts between UTF-8 and UTF-32 wchar_t; invalid sequences become U+FFFD
+    std::string WStringToString(const std::wstring& wstr) {
+        std::string result;
+        result.reserve(wstr.size());
+        for (wchar_t wc : wstr) {
+            uint32_t c = static_cast<uint32_t>(wc);
+            if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+                c = 0xFFFD;
+            }
+            if (c < 0x80) {
+                result += static_cast<char>(c);
+            } else if (c < 0x800) {
+                result += static_cast<char>(0xC0 | (c >> 6));
+                result += static_cast<char>(0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                result += static_cast<char>(0xE0 | (c >> 12));
+                result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (c & 0x3F));
+            } else {
+                result += static_cast<char>(0xF0 | (c >> 18));
+                result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return result;
+    }
+
+    std::wstring StringToWString(const std::string& str) {
+        std::wstring result;
+        result.reserve(str.size());
+        size_t i = 0;
+        while (i < str.size()) {
+            unsigned char lead = static_cast<unsigned char>(str[i]);
+            size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            uint32_t c = length == 1 ? lead : length == 2 ? (lead & 0x1F) : length == 3 ? (lead & 0x0F) : (lead & 0x07);
+            bool valid = length != 0 && i + length <= str.size();
+            for (size_t k = 1; valid && k < length; k++) {
+                unsigned char next = static_cast<unsigned char>(str[i + k]);
+                valid = (next & 0xC0) == 0x80;
+                c = (c << 6) | (next & 0x3F);
+            }
+            if (!valid) {
+                result += static_cast<wchar_t>(0xFFFD);
+                i++;
+                continue;
+            }
+            result += static_cast<wchar_t>(c);
+            i += length;
+        }
+        return result;
+    }
+
+    std::string GetTimestamp() {
+        auto now = std::chrono::system_clock::now();
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()) % 1000;
+
+        std::stringstream ss;
+        struct tm timeinfo;
+        localtime_r(&time_t, &timeinfo);
+        ss << std::put_time(&timeinfo, "%Y%m%d_%H%M%S");
+        ss << "_" << std::setfill('0') << std::setw(3) << ms.count();
+        return ss.str();
+    }
+
+    size_t GetSystemPageSize() {
+        static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return pageSize;
+    }
+
+    // FILETIME ticks: 100ns intervals since 1601-01-01
+    ULONGLONG GetCurrentFileTime() {
+        static const ULONGLONG kUnixEpochTicks = 116444736000000000ULL;
+        auto since = std::chrono::system_clock::now().time_since_epoch();
+        return kUnixEpochTicks + static_cast<ULONGLONG>(std::chrono::duration_cast<std::chrono::microseconds>(since).count()) * 10;
+    }
+
+    bool CreateDirectoryRecursive(const std::string& path) {
+        if (path.empty()) return false;
+
+        if (mkdir(path.c_str(), 0777) == 0 || errno == EEXIST) {
+            return true;
+        }
+
+        if (errno == ENOENT) {
+            size_t pos = path.find_last_of("\\/");
+            if (pos != std::string::npos && pos > 0) {
+                std::string parent = path.substr(0, pos);
+                if (CreateDirectoryRecursive(parent)) {
+                    return mkdir(path.c_str(), 0777) == 0 || errno == EEXIST;
+                }
+            }
+        }
+
+        SetLastError(FromErrno(errno));
+        return false;
+    }
+
+    bool FileExists(const std::string& path) {
+        struct stat status;
+        return stat(path.c_str(), &status) == 0;
+    }
+
+    bool RenameFileOver(const std::string& source, const std::string& destination) {
+        if (rename(source.c_str(), destination.c_str()) != 0) {
+            SetLastError(FromErrno(errno));
+            return false;
+        }
+        return true;
+    }
+
+    void RemoveFile(const std::string& path) {
+        unlink(path.c_str());
+    }
+
+    std::string GetEnvironmentValue(const char* name) {
+        const char* value = getenv(name);
+        return value ? value : "";
+    }
+
+    // Snapshots hold Windows paths, so the folders the built-in allowlist names resolve to their
+    // Windows defaults unless the environment says otherwise
+    static std::string GetWindowsFolder(const std::string& name) {
+        static const char* const kDefaults[][2] = {
+            { "systemroot", "C:\\Windows" },
+            { "windir", "C:\\Windows" },
+            { "programfiles", "C:\\Program Files" },
+            { "programfiles(x86)", "C:\\Program Files (x86)" },
+            { "programdata", "C:\\ProgramData" }
+        };
+        std::string value = GetEnvironmentValue(name.c_str());
+        if (!value.empty()) {
+            return value;
+        }
+        std::string folded = ToLower(name);
+        for (const auto& entry : kDefaults) {
+            if (folded == entry[0]) {
+                return entry[1];
+            }
+        }
+        return std::string();
+    }
+
+    std::string ExpandEnvironmentVariables(const std::string& text) {
+        std::string expanded;
+        size_t position = 0;
+        while (position < text.size()) {
+            size_t open = text.find('%', position);
+            size_t close = open == std::string::npos ? std::string::npos : text.find('%', open + 1);
+            if (close == std::string::npos) {
+                break;
+            }
+            std::string value = close > open + 1 ? GetWindowsFolder(text.substr(open + 1, close - open - 1)) : std::string();
+            if (value.empty()) {
+                // Left as written; the closing '%' may open the next reference
+                expanded.append(text, position, close - position);
+                position = close;
+                continue;
+            }
+            expanded.append(text, position, open - position);
+            expanded += value;
+            position = close + 1;
+        }
+        expanded.append(text, position, std::string::npos);
+        return expanded;
+    }
+
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+
+        descriptor_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor_ < 0) {
+            SetLastError(FromErrno(errno));
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(descriptor_, &status) != 0 || status.st_size == 0) {
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor_, 0);
+        if (view == MAP_FAILED) {
+            SetLastError(FromErrno(errno));
+            return false;
+        }
+
+        data_ = static_cast<const BYTE*>(view);
+        size_ = static_cast<size_t>(status.st_size);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data_) {
+            munmap(const_cast<BYTE*>(data_), size_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+        if (descriptor_ >= 0) {
+            close(descriptor_);
+            descriptor_ = -1;
+        }
+    }
+
+} // namespace ProcessScope
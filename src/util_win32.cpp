@@ -0,0 +1,231 @@
+#include "util.h"
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+
+namespace ProcessScope {
+
+    std::string GetLastErrorString() {
+        DWORD errorCode = GetLastError();
+        if (errorCode == 0) return "No error";
+        
+        LPSTR messageBuffer = nullptr;
+        size_t size = FormatMessageA(
+            FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+            nullptr, errorCode, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+            (LPSTR)&messageBuffer, 0, nullptr);
+        
+        std::string message(messageBuffer, size);
+        LocalFree(messageBuffer);
+        return message;
+    }
+
+    std::string WStringToString(const std::wstring& wstr) {
+        if (wstr.empty()) return std::string();
+        
+        int size = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, nullptr, 0, nullptr, nullptr);
+        std::string result(size - 1, 0);
+        WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, &result[0], size, nullptr, nullptr);
+        return result;
+    }
+
+    std::wstring StringToWString(const std::string& str) {
+        if (str.empty()) return std::wstring();
+        
+        int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
+        std::wstring result(size - 1, 0);
+        MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &result[0], size);
+        return result;
+    }
+
+    std::string GetTimestamp() {
+        auto now = std::chrono::system_clock::now();
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()) % 1000;
+        
+        std::stringstream ss;
+        struct tm timeinfo;
+        localtime_s(&timeinfo, &time_t);
+        ss << std::put_time(&timeinfo, "%Y%m%d_%H%M%S");
+        ss << "_" << std::setfill('0') << std::setw(3) << ms.count();
+        return ss.str();
+    }
+
+    size_t GetSystemPageSize() {
+        static const size_t pageSize = []() {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<size_t>(info.dwPageSize);
+        }();
+        return pageSize;
+    }
+
+    bool IsProcess64Bit(HANDLE hProcess) {
+        if constexpr (sizeof(void*) == 8) {
+            BOOL isWow64 = FALSE;
+            if (!IsWow64Process(hProcess, &isWow64)) {
+                return false;
+            }
+            return !isWow64;
+        } else {
+            return false;
+        }
+    }
+
+    ULONGLONG GetCurrentFileTime() {
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        return (static_cast<ULONGLONG>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    }
+
+    ULONGLONG GetProcessCreationTime(HANDLE hProcess) {
+        FILETIME creation, exitTime, kernel, user;
+        if (!GetProcessTimes(hProcess, &creation, &exitTime, &kernel, &user)) {
+            return 0;
+        }
+        return (static_cast<ULONGLONG>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+    }
+
+    ULONGLONG GetProcessPrivateBytes(HANDLE hProcess) {
+        PROCESS_MEMORY_COUNTERS_EX counters = {};
+        if (!GetProcessMemoryInfo(hProcess, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+            return 0;
+        }
+        return counters.PrivateUsage;
+    }
+
+    std::string GetProcessUser(HANDLE hProcess) {
+        HANDLE rawToken = nullptr;
+        if (!OpenProcessToken(hProcess, TOKEN_QUERY, &rawToken)) {
+            return std::string();
+        }
+        Handle hToken(rawToken);
+        
+        DWORD needed = 0;
+        GetTokenInformation(hToken.get(), TokenUser, nullptr, 0, &needed);
+        if (needed == 0) {
+            return std::string();
+        }
+        
+        std::vector<BYTE> buffer(needed);
+        if (!GetTokenInformation(hToken.get(), TokenUser, buffer.data(), needed, &needed)) {
+            return std::string();
+        }
+        
+        const TOKEN_USER* tokenUser = reinterpret_cast<const TOKEN_USER*>(buffer.data());
+        WCHAR name[256];
+        WCHAR domain[256];
+        DWORD nameSize = 256;
+        DWORD domainSize = 256;
+        SID_NAME_USE use;
+        if (!LookupAccountSidW(nullptr, tokenUser->User.Sid, name, &nameSize, domain, &domainSize, &use)) {
+            return std::string();
+        }
+        
+        return WStringToString(std::wstring(domain, domainSize)) + "\\" + WStringToString(std::wstring(name, nameSize));
+    }
+
+    bool CreateDirectoryRecursive(const std::string& path) {
+        if (path.empty()) return false;
+        
+        std::wstring widePath = StringToWString(path);
+        
+        if (CreateDirectoryW(widePath.c_str(), nullptr)) {
+            return true;
+        }
+        
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            return true;
+        }
+        
+        if (GetLastError() == ERROR_PATH_NOT_FOUND) {
+            size_t pos = path.find_last_of("\\/");
+            if (pos != std::string::npos) {
+                std::string parent = path.substr(0, pos);
+                if (CreateDirectoryRecursive(parent)) {
+                    return CreateDirectoryW(widePath.c_str(), nullptr) != FALSE ||
+                           GetLastError() == ERROR_ALREADY_EXISTS;
+                }
+            }
+        }
+        
+        return false;
+    }
+
+    bool FileExists(const std::string& path) {
+        return GetFileAttributesW(StringToWString(path).c_str()) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    bool RenameFileOver(const std::string& source, const std::string& destination) {
+        return MoveFileExW(StringToWString(source).c_str(), StringToWString(destination).c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    }
+
+    void RemoveFile(const std::string& path) {
+        DeleteFileW(StringToWString(path).c_str());
+    }
+
+    std::string GetEnvironmentValue(const char* name) {
+        char* env = nullptr;
+        size_t len = 0;
+        _dupenv_s(&env, &len, name);
+        std::string result = env ? env : "";
+        if (env) free(env);
+        return result;
+    }
+
+    std::string ExpandEnvironmentVariables(const std::string& text) {
+        std::wstring wide = StringToWString(text);
+        DWORD size = ExpandEnvironmentStringsW(wide.c_str(), nullptr, 0);
+        if (size == 0) {
+            return text;
+        }
+        std::wstring expanded(size, L'\0');
+        DWORD written = ExpandEnvironmentStringsW(wide.c_str(), &expanded[0], size);
+        if (written == 0 || written > size) {
+            return text;
+        }
+        expanded.resize(written - 1);
+        return WStringToString(expanded);
+    }
+
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+        
+        std::wstring widePath = StringToWString(path);
+        file_ = Handle(CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                   nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+        if (!file_) {
+            return false;
+        }
+        
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file_.get(), &fileSize) || fileSize.QuadPart == 0) {
+            return false;
+        }
+        
+        mapping_ = Handle(CreateFileMappingW(file_.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+        if (!mapping_) {
+            return false;
+        }
+        
+        data_ = static_cast<const BYTE*>(MapViewOfFile(mapping_.get(), FILE_MAP_READ, 0, 0, 0));
+        if (!data_) {
+            return false;
+        }
+        
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data_) {
+            UnmapViewOfFile(data_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+        mapping_ = Handle();
+        file_ = Handle();
+    }
+
+} // namespace ProcessScope
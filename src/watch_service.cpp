@@ -0,0 +1,185 @@
+#include "watch_service.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace ProcessScope {
+
+    // Shells, script hosts and proxy-execution binaries; starts of these, and their children,
+    // jump the queue because they are the usual second stage of an intrusion
+    static const char* const kLauncherImages[] = {
+        "cmd.exe", "powershell.exe", "pwsh.exe", "wscript.exe", "cscript.exe", "mshta.exe",
+        "rundll32.exe", "regsvr32.exe", "wmic.exe", "msbuild.exe", "installutil.exe"
+    };
+
+    static bool IsLauncherImage(const std::string& name) {
+        std::string lower = ToLower(name);
+        for (const char* launcher : kLauncherImages) {
+            if (lower == launcher) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static ULONGLONG TicksToMicros(ULONGLONG later, ULONGLONG earlier) {
+        return later > earlier ? (later - earlier) / 10 : 0;
+    }
+
+    LatencySummary LatencySummary::FromHistogram(const HistogramSnapshot& histogram) {
+        LatencySummary summary;
+        summary.count = static_cast<size_t>(histogram.total);
+        summary.p50Ms = histogram.ValueAtQuantile(0.50) / 1000.0;
+        summary.p90Ms = histogram.ValueAtQuantile(0.90) / 1000.0;
+        summary.p99Ms = histogram.ValueAtQuantile(0.99) / 1000.0;
+        summary.maxMs = histogram.maxMicros / 1000.0;
+        return summary;
+    }
+
+    struct QueuedScan {
+        ProcessEvent event;
+        int priority;           // Lower is served first
+        ULONGLONG sequence;     // Arrival order within a priority
+    };
+
+    struct QueuedScanOrder {
+        bool operator()(const QueuedScan& a, const QueuedScan& b) const {
+            return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+        }
+    };
+
+    bool WatchService::Run(const WatchOptions& options, const WatchCallbacks& callbacks, const CancellationToken& stop,
+                           WatchSummary& summary, std::string& error) {
+        summary = WatchSummary();
+
+        std::mutex queueMutex;
+        std::condition_variable queueReady;
+        std::priority_queue<QueuedScan, std::vector<QueuedScan>, QueuedScanOrder> queue;
+        ULONGLONG sequence = 0;
+        bool closed = false;
+
+        const ProcessFilter* filter = options.filter && !options.filter->IsEmpty() ? options.filter : nullptr;
+
+        // Runs on the watcher thread: cheap snapshot-field filtering and queueing only
+        ProcessWatcher watcher;
+        auto onEvent = [&](const ProcessEvent& event) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            summary.events++;
+            if (filter) {
+                ProcessInfo info;
+                info.pid = event.pid;
+                info.ppid = event.ppid;
+                info.name = event.name;
+                if (filter->Evaluate(info, false) == ProcessFilter::Match::No) {
+                    summary.filtered++;
+                    return;
+                }
+            }
+
+            QueuedScan item;
+            item.event = event;
+            item.priority = IsLauncherImage(event.name) || IsLauncherImage(event.parentName) ? 0 : 1;
+            item.sequence = sequence++;
+            if (item.priority == 0) {
+                summary.prioritized++;
+            }
+            queue.push(item);
+            queueReady.notify_one();
+        };
+
+        // Histograms and counters are per worker so recording never contends; the histograms keep
+        // memory fixed however long the watch runs
+        unsigned workerCount = (std::max)(options.workerCount, 1u);
+        std::mutex callbackMutex;
+        std::unique_ptr<LatencyHistogram[]> creationLatency(new LatencyHistogram[workerCount]);
+        std::unique_ptr<LatencyHistogram[]> eventLatency(new LatencyHistogram[workerCount]);
+        std::vector<size_t> scannedCounts(workerCount, 0);
+        std::vector<size_t> goneCounts(workerCount, 0);
+
+        auto worker = [&](size_t index) {
+            ProcessScanner scanner;
+            if (options.metrics) {
+                scanner.SetMetrics(options.metrics->CreateShard());
+            }
+            for (;;) {
+                QueuedScan item;
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    queueReady.wait(lock, [&]() { return closed || !queue.empty(); });
+                    if (closed) {
+                        return;
+                    }
+                    item = queue.top();
+                    queue.pop();
+                }
+
+                // Latency is measured up to the start of the scan, before any handle is opened
+                ULONGLONG scanStart = GetPreciseFileTime();
+                const ProcessEvent& event = item.event;
+                creationLatency[index].Record(TicksToMicros(scanStart, event.createTime != 0 ? event.createTime : event.observedTime));
+                eventLatency[index].Record(TicksToMicros(scanStart, event.observedTime));
+
+                ProcessInfo info = scanner.Backend().GetProcessInfo(event.pid);
+                if (info.pid == 0 || (event.createTime != 0 && info.creationTime != 0 && info.creationTime != event.createTime)) {
+                    goneCounts[index]++;
+                    continue;
+                }
+                if (filter && filter->Evaluate(info, true) != ProcessFilter::Match::Yes) {
+                    continue;
+                }
+
+                ScanResult result = scanner.ScanProcess(info, nullptr, options.scan);
+                if (!result.success) {
+                    goneCounts[index]++;
+                    continue;
+                }
+                scannedCounts[index]++;
+                if (callbacks.onResult) {
+                    std::lock_guard<std::mutex> lock(callbackMutex);
+                    callbacks.onResult(event, result);
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < workerCount; i++) {
+            workers.emplace_back(worker, i);
+        }
+
+        bool started = watcher.Start(onEvent, options.pollIntervalMs, options.preferEtw, error);
+        if (started) {
+            summary.source = watcher.ActiveSource();
+            summary.etwError = watcher.EtwError();
+            while (!stop.IsCancelled()) {
+                Sleep(50);
+            }
+            watcher.Stop();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            closed = true;
+            summary.dropped = queue.size();
+        }
+        queueReady.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        HistogramSnapshot creation;
+        HistogramSnapshot delivery;
+        for (size_t i = 0; i < workers.size(); i++) {
+            creation.Merge(creationLatency[i]);
+            delivery.Merge(eventLatency[i]);
+            summary.scanned += scannedCounts[i];
+            summary.gone += goneCounts[i];
+        }
+        summary.creationToScan = LatencySummary::FromHistogram(creation);
+        summary.eventToScan = LatencySummary::FromHistogram(delivery);
+        return started;
+    }
+
+} // namespace ProcessScope
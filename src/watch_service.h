@@ -0,0 +1,66 @@
+#pragma once
+
+#include "util.h"
+#include "scanner.h"
+#include "metrics.h"
+#include "process_watcher.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ProcessScope {
+
+    struct WatchOptions {
+        ScanOptions scan;
+        const ProcessFilter* filter;    // May be null
+        unsigned workerCount;
+        DWORD pollIntervalMs;           // Snapshot interval for the polling source, flush interval for ETW
+        bool preferEtw;
+        ScanMetrics* metrics;           // Each worker records into its own shard; may be null
+
+        WatchOptions() : filter(nullptr), workerCount(4), pollIntervalMs(5), preferEtw(true), metrics(nullptr) {}
+    };
+
+    // Percentiles of recorded latencies, to within one histogram bucket (about 6%)
+    struct LatencySummary {
+        size_t count;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double maxMs;
+
+        LatencySummary() : count(0), p50Ms(0), p90Ms(0), p99Ms(0), maxMs(0) {}
+
+        static LatencySummary FromHistogram(const HistogramSnapshot& histogram);
+    };
+
+    struct WatchSummary {
+        ProcessWatcher::Source source;
+        std::string etwError;
+        size_t events;
+        size_t filtered;        // Rejected by the filter
+        size_t prioritized;     // Queued ahead of others (launcher image or launcher parent)
+        size_t scanned;
+        size_t gone;            // Exited or inaccessible before the scan started
+        size_t dropped;         // Still queued when the watch stopped
+        LatencySummary creationToScan;  // Process creation time to scan start
+        LatencySummary eventToScan;     // Event delivery to scan start (queueing only)
+
+        WatchSummary() : source(ProcessWatcher::Source::None), events(0), filtered(0), prioritized(0),
+                         scanned(0), gone(0), dropped(0) {}
+    };
+
+    struct WatchCallbacks {
+        std::function<void(const ProcessEvent&, const ScanResult&)> onResult;  // Serialized across workers
+    };
+
+    // Scans processes as they start. Events go into a priority queue served by a pool of workers,
+    // each with its own ProcessScanner, so a burst of starts is scanned in parallel while the
+    // processes are still young. Runs until the stop token is cancelled.
+    class WatchService {
+    public:
+        bool Run(const WatchOptions& options, const WatchCallbacks& callbacks, const CancellationToken& stop,
+                 WatchSummary& summary, std::string& error);
+    };
+
+} // namespace ProcessScope
@@ -0,0 +1,609 @@
+// Replays recorded host snapshots through ProcessScanner::Sweep, risk scoring and JSON export.
+// Usage:
+//   replay_test fixture <snapshot.json> <expected>     findings must match the expected file
+//   replay_test large <baseline file> [--update]       generated host; wall time and allocations
+//                                                      are checked against the baseline file
+//   replay_test priority                               --prioritize must reach the High finding of
+//                                                      a generated host sooner than snapshot order
+//   replay_test images                                 symbols, sha256 rules and baseline keys come
+//                                                      from the snapshot's recorded images
+
+#include "replay_backend.h"
+#include "report.h"
+#include "scanner.h"
+#include "json.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace ProcessScope;
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* block = malloc(size ? size : 1);
+    if (!block) {
+        abort();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+// The large replay may take this much longer, or allocate this much more, than its baseline
+static const double kWallTimeTolerance = 0.5;
+static const double kAllocationTolerance = 0.1;
+
+static const size_t kLargeProcessCount = 2000;
+static const size_t kLargeModulesPerProcess = 30;
+static const size_t kLargeThreadsPerProcess = 16;
+static const size_t kLargeRegionsPerProcess = 120;
+static const size_t kPageSize = 4096;
+
+static int g_failures = 0;
+
+static void Fail(const std::string& message) {
+    fprintf(stderr, "FAIL: %s\n", message.c_str());
+    g_failures++;
+}
+
+// Sweeps the snapshot and exports each result, as the CLI does for --replay
+static std::vector<ScanResult> ReplaySweep(const HostSnapshot& snapshot, const SweepOptions& options,
+                                           std::vector<std::string>& reports, SweepSummary& summary) {
+    ReplayBackend backend(snapshot);
+    ProcessScanner scanner;
+    scanner.SetBackend(&backend);
+
+    std::vector<ScanResult> results;
+    SweepCallbacks callbacks;
+    callbacks.onResult = [&](const ScanResult& result) {
+        results.push_back(result);
+        reports.push_back(SerializeScanResult(result, 2));
+    };
+    summary = scanner.Sweep(options, callbacks);
+    return results;
+}
+
+static std::vector<ScanResult> ReplaySweep(const HostSnapshot& snapshot, std::vector<std::string>& reports) {
+    SweepSummary summary;
+    return ReplaySweep(snapshot, SweepOptions(), reports, summary);
+}
+
+static int RunFixture(const std::string& snapshotPath, const std::string& expectedPath) {
+    HostSnapshot snapshot;
+    std::string error;
+    if (!snapshot.Load(snapshotPath, error)) {
+        Fail(error);
+        return 1;
+    }
+
+    // One "<pid> <level> <score>" per line; '#' starts a comment
+    std::map<DWORD, std::pair<std::string, int>> expected;
+    std::ifstream expectedFile(expectedPath);
+    if (!expectedFile) {
+        Fail("cannot open " + expectedPath);
+        return 1;
+    }
+    std::string line;
+    while (std::getline(expectedFile, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        DWORD pid = 0;
+        std::string level;
+        int score = 0;
+        if (!(fields >> pid >> level >> score)) {
+            Fail(expectedPath + ": malformed line: " + line);
+            return 1;
+        }
+        expected[pid] = std::make_pair(level, score);
+    }
+
+    std::vector<std::string> reports;
+    std::vector<ScanResult> results = ReplaySweep(snapshot, reports);
+    if (results.size() != expected.size()) {
+        Fail("expected " + std::to_string(expected.size()) + " results, got " + std::to_string(results.size()));
+    }
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScanResult& result = results[i];
+        DWORD pid = result.processInfo.pid;
+        auto it = expected.find(pid);
+        if (it == expected.end()) {
+            Fail("unexpected result for PID " + std::to_string(pid));
+            continue;
+        }
+        if (!result.success) {
+            Fail("PID " + std::to_string(pid) + " failed: " + result.errorMessage);
+            continue;
+        }
+
+        // Check the exported report rather than the in-memory result, so export is covered too
+        json report = json::parse(reports[i]);
+        std::string level = report["risk_assessment"]["level"].get<std::string>();
+        int score = report["risk_assessment"]["score"].get<int>();
+        if (level != it->second.first || score != it->second.second) {
+            Fail("PID " + std::to_string(pid) + ": expected " + it->second.first + " " + std::to_string(it->second.second) +
+                 ", got " + level + " " + std::to_string(score) + " (" + result.riskAssessment.details + ")");
+        }
+    }
+
+    printf("%s: %zu processes replayed, %d failures\n", snapshotPath.c_str(), results.size(), g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
+
+// A host of kLargeProcessCount processes in a tree eight wide. Every 25th process has an RWX
+// region with recorded bytes (Medium); the rest are clean (Low).
+static HostSnapshot BuildLargeSnapshot() {
+    HostSnapshot snapshot;
+    const ULONGLONG baseTime = 133800000000000000ULL;
+    const uintptr_t imageBase = 0x7FF600000000ULL;
+    const size_t moduleSize = 0x100000;
+
+    std::vector<BYTE> payload(kPageSize);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<BYTE>((i * 2654435761u) >> 13);
+    }
+
+    for (size_t i = 0; i < kLargeProcessCount; i++) {
+        ProcessInfo process;
+        process.pid = static_cast<DWORD>(1000 + i * 4);
+        process.ppid = i == 0 ? 0 : static_cast<DWORD>(1000 + ((i - 1) / 8) * 4);
+        process.name = "app" + std::to_string(i) + ".exe";
+        process.fullPath = "C:\\Program Files\\Vendor\\" + process.name;
+        process.architecture = "x64";
+        process.user = "HOST\\alice";
+        process.sessionId = 1;
+        process.creationTime = baseTime + i * 10000;
+        process.privateBytes = 1048576 * (1 + i % 64);
+        snapshot.processes.push_back(process);
+
+        TargetSnapshot& target = snapshot.targets[process.pid];
+        target.readable = true;
+        for (size_t m = 0; m < kLargeModulesPerProcess; m++) {
+            ModuleInfo module;
+            module.name = m == 0 ? process.name : "lib" + std::to_string(m) + ".dll";
+            module.fullPath = "C:\\Program Files\\Vendor\\" + module.name;
+            module.baseAddress = imageBase + m * moduleSize;
+            module.size = moduleSize;
+            module.isSigned = true;
+            module.signerName = "Vendor Ltd";
+            target.modules.push_back(module);
+        }
+        for (size_t t = 0; t < kLargeThreadsPerProcess; t++) {
+            ThreadInfo thread;
+            thread.tid = static_cast<DWORD>(process.pid * 16 + t * 4);
+            thread.startAddress = imageBase + (t % kLargeModulesPerProcess) * moduleSize + 0x1000;
+            target.threads.push_back(thread);
+        }
+
+        // Image code and data for each module, then private heap and mapped views below them
+        uintptr_t address = 0x10000000;
+        for (size_t r = 0; r < kLargeRegionsPerProcess; r++) {
+            MEMORY_BASIC_INFORMATION mbi = {};
+            if (r < kLargeModulesPerProcess) {
+                mbi.BaseAddress = reinterpret_cast<PVOID>(imageBase + r * moduleSize);
+                mbi.RegionSize = moduleSize;
+                mbi.Protect = PAGE_EXECUTE_READ;
+                mbi.Type = MEM_IMAGE;
+            } else {
+                mbi.BaseAddress = reinterpret_cast<PVOID>(address);
+                mbi.RegionSize = 16 * kPageSize;
+                mbi.Protect = r % 3 == 0 ? PAGE_READONLY : PAGE_READWRITE;
+                mbi.Type = r % 3 == 0 ? MEM_MAPPED : MEM_PRIVATE;
+                address += mbi.RegionSize + kPageSize;
+            }
+            mbi.AllocationBase = mbi.BaseAddress;
+            mbi.AllocationProtect = mbi.Protect;
+            mbi.State = MEM_COMMIT;
+            target.regions[reinterpret_cast<uintptr_t>(mbi.BaseAddress)] = mbi;
+        }
+        if (i % 25 == 0) {
+            MEMORY_BASIC_INFORMATION mbi = {};
+            mbi.BaseAddress = reinterpret_cast<PVOID>(address);
+            mbi.AllocationBase = mbi.BaseAddress;
+            mbi.AllocationProtect = PAGE_EXECUTE_READWRITE;
+            mbi.RegionSize = 16 * kPageSize;
+            mbi.State = MEM_COMMIT;
+            mbi.Protect = PAGE_EXECUTE_READWRITE;
+            mbi.Type = MEM_PRIVATE;
+            target.regions[address] = mbi;
+            target.reads[address] = payload;
+        }
+    }
+    return snapshot;
+}
+
+// Gives the last process of the generated host a document host child that starts a shell, which
+// drops and runs a payload from Temp: the usual macro infection chain, last in snapshot order
+static DWORD AddInfectedChain(HostSnapshot& snapshot) {
+    const ProcessInfo& last = snapshot.processes.back();
+    const uintptr_t imageBase = 0x7FF600000000ULL;
+    const uintptr_t payloadBase = 0x20000000;
+
+    struct Step {
+        const char* path;
+        bool isSigned;
+    };
+    static const Step kChain[] = {
+        { "C:\\Program Files\\Microsoft Office\\root\\Office16\\WINWORD.EXE", true },
+        { "C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe", true },
+        { "C:\\Users\\alice\\AppData\\Local\\Temp\\update.exe", false }
+    };
+
+    DWORD parent = last.pid;
+    ULONGLONG creationTime = last.creationTime;
+    for (const Step& step : kChain) {
+        ProcessInfo process;
+        process.pid = parent + 4;
+        process.ppid = parent;
+        process.fullPath = step.path;
+        process.name = process.fullPath.substr(process.fullPath.rfind('\\') + 1);
+        process.architecture = "x64";
+        process.user = "HOST\\alice";
+        process.sessionId = 1;
+        process.creationTime = creationTime += 10000;
+        process.privateBytes = 8 * 1048576;
+        snapshot.processes.push_back(process);
+
+        TargetSnapshot& target = snapshot.targets[process.pid];
+        target.readable = true;
+        ModuleInfo module;
+        module.name = process.name;
+        module.fullPath = process.fullPath;
+        module.baseAddress = imageBase;
+        module.size = 0x100000;
+        module.isSigned = step.isSigned;
+        module.signerName = step.isSigned ? "Microsoft Corporation" : "";
+        target.modules.push_back(module);
+
+        ThreadInfo thread;
+        thread.tid = process.pid * 16;
+        thread.startAddress = imageBase + 0x1000;
+        target.threads.push_back(thread);
+
+        MEMORY_BASIC_INFORMATION mbi = {};
+        mbi.BaseAddress = reinterpret_cast<PVOID>(imageBase);
+        mbi.AllocationBase = mbi.BaseAddress;
+        mbi.AllocationProtect = PAGE_EXECUTE_WRITECOPY;
+        mbi.RegionSize = module.size;
+        mbi.State = MEM_COMMIT;
+        mbi.Protect = PAGE_EXECUTE_READ;
+        mbi.Type = MEM_IMAGE;
+        target.regions[imageBase] = mbi;
+        parent = process.pid;
+    }
+
+    // The payload runs a thread from an RWX allocation
+    TargetSnapshot& payload = snapshot.targets[parent];
+    ThreadInfo thread;
+    thread.tid = parent * 16 + 4;
+    thread.startAddress = payloadBase;
+    payload.threads.push_back(thread);
+    MEMORY_BASIC_INFORMATION mbi = {};
+    mbi.BaseAddress = reinterpret_cast<PVOID>(payloadBase);
+    mbi.AllocationBase = mbi.BaseAddress;
+    mbi.AllocationProtect = PAGE_EXECUTE_READWRITE;
+    mbi.RegionSize = 16 * kPageSize;
+    mbi.State = MEM_COMMIT;
+    mbi.Protect = PAGE_EXECUTE_READWRITE;
+    mbi.Type = MEM_PRIVATE;
+    payload.regions[payloadBase] = mbi;
+    return parent;
+}
+
+// Position (1-based) of the first High result, 0 when there is none
+static size_t FirstHighPosition(const std::vector<ScanResult>& results) {
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].success && results[i].riskAssessment.level == RiskLevel::High) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static int RunPriority() {
+    HostSnapshot snapshot = BuildLargeSnapshot();
+    DWORD payloadPid = AddInfectedChain(snapshot);
+
+    SweepOptions plain;
+    SweepOptions prioritized;
+    prioritized.priority.enabled = true;
+    std::vector<std::string> reports;
+    SweepSummary plainSummary;
+    SweepSummary prioritizedSummary;
+    size_t plainPosition = FirstHighPosition(ReplaySweep(snapshot, plain, reports, plainSummary));
+    reports.clear();
+    size_t prioritizedPosition = FirstHighPosition(ReplaySweep(snapshot, prioritized, reports, prioritizedSummary));
+
+    printf("First High: snapshot order result %zu after %.1f ms, prioritized result %zu after %.1f ms\n",
+           plainPosition, plainSummary.firstHighMs, prioritizedPosition, prioritizedSummary.firstHighMs);
+    if (plainSummary.firstHighPid != payloadPid || prioritizedSummary.firstHighPid != payloadPid) {
+        Fail("expected the payload (PID " + std::to_string(payloadPid) + ") to be the first High result");
+    } else {
+        // Its ancestors are pulled forward with it, so it lands within the first few results
+        if (prioritizedPosition == 0 || prioritizedPosition > 10 || prioritizedPosition >= plainPosition) {
+            Fail("prioritized order reached the payload at result " + std::to_string(prioritizedPosition) +
+                 ", snapshot order at " + std::to_string(plainPosition));
+        }
+        if (prioritizedSummary.firstHighMs >= plainSummary.firstHighMs) {
+            Fail("prioritized order took longer to the first High result than snapshot order");
+        }
+    }
+    return g_failures == 0 ? 0 : 1;
+}
+
+// Unused file name in the temporary directory; empty when there is no such directory
+static std::string TemporaryPath() {
+    static unsigned counter = 0;
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    if (error) {
+        return std::string();
+    }
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    return (directory / ("psr" + std::to_string(stamp) + "_" + std::to_string(counter++) + ".json")).string();
+}
+
+// Saves and reloads a snapshot, as a --record run followed by --replay would
+static bool RoundTrip(const HostSnapshot& snapshot, HostSnapshot& loaded) {
+    std::string tempPath = TemporaryPath();
+    if (tempPath.empty()) {
+        Fail("cannot create a temporary file");
+        return false;
+    }
+    std::string error;
+    bool ok = snapshot.Save(tempPath, error) && loaded.Load(tempPath, error);
+    std::remove(tempPath.c_str());
+    if (!ok) {
+        Fail(error);
+    }
+    return ok;
+}
+
+// One unsigned tool outside the trusted locations whose image exists only in the snapshot
+static int RunImages() {
+    const uintptr_t imageBase = 0x140000000ULL;
+    HostSnapshot recorded;
+    ProcessInfo process;
+    process.pid = 500;
+    process.ppid = 4;
+    process.name = "tool.exe";
+    process.fullPath = "Q:\\Recorded\\tool.exe";
+    process.architecture = "x64";
+    process.user = "HOST\\alice";
+    process.sessionId = 1;
+    process.creationTime = 133800000000000000ULL;
+    recorded.processes.push_back(process);
+
+    TargetSnapshot& target = recorded.targets[process.pid];
+    target.readable = true;
+    ModuleInfo module;
+    module.name = process.name;
+    module.fullPath = process.fullPath;
+    module.baseAddress = imageBase;
+    module.size = 0x10000;
+    module.isSigned = false;
+    target.modules.push_back(module);
+    ThreadInfo thread;
+    thread.tid = 504;
+    thread.startAddress = imageBase + 0x1234;
+    target.threads.push_back(thread);
+
+    ImageSnapshot& image = recorded.images[process.fullPath];
+    ExportSymbol symbol;
+    symbol.rva = 0x1000;
+    symbol.name = "DllMain";
+    image.exports.push_back(symbol);
+    symbol.rva = 0x1200;
+    symbol.name = "ToolMain";
+    image.exports.push_back(symbol);
+    for (size_t i = 0; i < sizeof(image.digest.bytes); i++) {
+        image.digest.bytes[i] = static_cast<BYTE>(i * 7 + 1);
+    }
+    image.hasDigest = true;
+
+    HostSnapshot snapshot;
+    if (!RoundTrip(recorded, snapshot)) {
+        return 1;
+    }
+
+    std::string rule = "sha256 ";
+    static const char kDigits[] = "0123456789abcdef";
+    for (BYTE b : image.digest.bytes) {
+        rule += kDigits[b >> 4];
+        rule += kDigits[b & 0x0F];
+    }
+    ModuleAllowlist allowlist;
+    std::string error;
+    if (!allowlist.AddRule(rule, error)) {
+        Fail(error);
+        return 1;
+    }
+    allowlist.Compile();
+
+    SweepOptions plain;
+    SweepOptions allowed;
+    allowed.scan.allowlist = &allowlist;
+    std::vector<std::string> reports;
+    SweepSummary summary;
+    std::vector<ScanResult> plainResults = ReplaySweep(snapshot, plain, reports, summary);
+    std::vector<ScanResult> allowedResults = ReplaySweep(snapshot, allowed, reports, summary);
+    if (plainResults.size() != 1 || allowedResults.size() != 1 || !plainResults[0].success || !allowedResults[0].success) {
+        Fail("expected one successful result per sweep");
+        return 1;
+    }
+
+    const ThreadInfo& resolved = plainResults[0].threads[0];
+    if (resolved.startSymbol != "tool.exe!ToolMain+0x34") {
+        Fail("thread start resolved to \"" + resolved.startSymbol + "\" instead of the recorded export");
+    }
+    // The unsigned module scores +1 unless the recorded digest matches the sha256 rule
+    if (plainResults[0].riskAssessment.score != allowedResults[0].riskAssessment.score + 1) {
+        Fail("sha256 rule did not match the recorded digest (" + plainResults[0].riskAssessment.details + " / " +
+             allowedResults[0].riskAssessment.details + ")");
+    }
+
+    // A different recorded digest is a different baseline key
+    ReplayBackend original(snapshot);
+    ULONGLONG key = BaselineStore::ImageKey(process, original.Images());
+    HostSnapshot replaced = snapshot;
+    replaced.images[process.fullPath].digest.bytes[0] ^= 0xFF;
+    ReplayBackend updated(replaced);
+    if (BaselineStore::ImageKey(process, original.Images()) != key || BaselineStore::ImageKey(process, updated.Images()) == key) {
+        Fail("baseline key does not follow the recorded image digest");
+    }
+
+    printf("images: start symbol %s, score %d without and %d with the sha256 rule\n", resolved.startSymbol.c_str(),
+           plainResults[0].riskAssessment.score, allowedResults[0].riskAssessment.score);
+    return g_failures == 0 ? 0 : 1;
+}
+
+static bool ReadBaseline(const std::string& path, std::map<std::string, double>& values) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key;
+        double value = 0;
+        if (fields >> key >> value) {
+            values[key] = value;
+        }
+    }
+    return true;
+}
+
+static bool WriteBaseline(const std::string& path, double wallMs, size_t allocations) {
+    std::ofstream file(path);
+    file << "# Large replay baseline, written by: replay_test large <this file> --update\n";
+    file << "# Record it on the build machine in a Release build; the test allows +"
+         << static_cast<int>(kWallTimeTolerance * 100) << "% wall time and +"
+         << static_cast<int>(kAllocationTolerance * 100) << "% allocations\n";
+    file << "wall_ms " << wallMs << "\n";
+    file << "allocations " << allocations << "\n";
+    return static_cast<bool>(file);
+}
+
+static int RunLarge(const std::string& baselinePath, bool update) {
+    HostSnapshot generated = BuildLargeSnapshot();
+    std::string tempPath = TemporaryPath();
+    if (tempPath.empty()) {
+        Fail("cannot create a temporary file");
+        return 1;
+    }
+    std::string error;
+    if (!generated.Save(tempPath, error)) {
+        Fail(error);
+        std::remove(tempPath.c_str());
+        return 1;
+    }
+
+    // Timed: load, sweep, score and export, as a --replay run does
+    size_t allocationsBefore = g_allocations;
+    auto start = std::chrono::steady_clock::now();
+    HostSnapshot snapshot;
+    bool loaded = snapshot.Load(tempPath, error);
+    std::vector<std::string> reports;
+    std::vector<ScanResult> results;
+    if (loaded) {
+        results = ReplaySweep(snapshot, reports);
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t allocations = g_allocations - allocationsBefore;
+    std::remove(tempPath.c_str());
+    if (!loaded) {
+        Fail(error);
+        return 1;
+    }
+
+    size_t medium = 0;
+    for (const auto& result : results) {
+        size_t index = (result.processInfo.pid - 1000) / 4;
+        RiskLevel expected = index % 25 == 0 ? RiskLevel::Medium : RiskLevel::Low;
+        if (!result.success) {
+            Fail("PID " + std::to_string(result.processInfo.pid) + " failed: " + result.errorMessage);
+        } else if (result.riskAssessment.level != expected) {
+            Fail("PID " + std::to_string(result.processInfo.pid) + ": expected " + GetRiskLevelName(expected) +
+                 ", got " + GetRiskLevelName(result.riskAssessment.level) + " (" + result.riskAssessment.details + ")");
+        }
+        medium += result.riskAssessment.level == RiskLevel::Medium ? 1 : 0;
+    }
+    if (results.size() != kLargeProcessCount) {
+        Fail("expected " + std::to_string(kLargeProcessCount) + " results, got " + std::to_string(results.size()));
+    }
+    printf("large: %zu processes, %zu Medium, %.1f ms, %zu allocations\n", results.size(), medium, wallMs, allocations);
+
+    if (update) {
+        if (!WriteBaseline(baselinePath, wallMs, allocations)) {
+            Fail("cannot write " + baselinePath);
+        } else {
+            printf("Baseline recorded in %s\n", baselinePath.c_str());
+        }
+        return g_failures == 0 ? 0 : 1;
+    }
+
+    // A missing baseline is a failure, not a fresh recording; record one explicitly with --update
+    std::map<std::string, double> baseline;
+    if (!ReadBaseline(baselinePath, baseline)) {
+        Fail("cannot read " + baselinePath + "; record it with: replay_test large " + baselinePath + " --update");
+        return 1;
+    }
+    if (baseline["wall_ms"] <= 0 || baseline["allocations"] <= 0) {
+        Fail(baselinePath + " lacks wall_ms or allocations");
+        return 1;
+    }
+
+    double baselineMs = baseline["wall_ms"];
+    double baselineAllocations = baseline["allocations"];
+    if (wallMs > baselineMs * (1 + kWallTimeTolerance)) {
+        Fail("wall time " + std::to_string(wallMs) + " ms exceeds baseline " + std::to_string(baselineMs) + " ms");
+    }
+    if (allocations > baselineAllocations * (1 + kAllocationTolerance)) {
+        Fail("allocations " + std::to_string(allocations) + " exceed baseline " +
+             std::to_string(static_cast<size_t>(baselineAllocations)));
+    }
+    printf("Baseline: %.1f ms, %.0f allocations\n", baselineMs, baselineAllocations);
+    return g_failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "fixture" && argc == 4) {
+        return RunFixture(argv[2], argv[3]);
+    }
+    if (mode == "large" && (argc == 3 || argc == 4)) {
+        return RunLarge(argv[2], argc == 4 && std::string(argv[3]) == "--update");
+    }
+    if (mode == "priority" && argc == 2) {
+        return RunPriority();
+    }
+    if (mode == "images" && argc == 2) {
+        return RunImages();
+    }
+    fprintf(stderr, "Usage: replay_test fixture <snapshot.json> <expected>\n"
+                    "       replay_test large <baseline file> [--update]\n"
+                    "       replay_test priority\n"
+                    "       replay_test images\n");
+    return 2;
+}